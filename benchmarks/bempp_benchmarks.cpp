@@ -0,0 +1,567 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Benchmarks of the assembly of boundary operators, of matrix-vector
+// products with their weak forms and of GMRES solves, run over all
+// combinations of the selected meshes, operators, spaces, assembly modes
+// and thread counts, and of point-in-grid tests (areInside()) over all
+// combinations of the selected meshes and thread counts. Results are
+// written in JSON format; run the program with --help for a list of
+// options.
+
+#include "bempp/common/config_ahmed.hpp"
+#include "bempp/common/config_trilinos.hpp"
+
+#include "benchmark_support.hpp"
+
+#include "assembly/assembly_options.hpp"
+#include "assembly/boundary_operator.hpp"
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/identity_operator.hpp"
+#include "assembly/laplace_3d_double_layer_boundary_operator.hpp"
+#include "assembly/laplace_3d_hypersingular_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "assembly/helmholtz_3d_double_layer_boundary_operator.hpp"
+#include "assembly/helmholtz_3d_single_layer_boundary_operator.hpp"
+#include "assembly/surface_normal_independent_function.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include "common/assembly_profile.hpp"
+#include "common/boost_make_shared_fwd.hpp"
+#include "common/global_parameters.hpp"
+#include "common/scalar_traits.hpp"
+#include "common/types.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+
+#ifdef WITH_TRILINOS
+#include "linalg/default_iterative_solver.hpp"
+#endif
+
+#include "space/piecewise_constant_scalar_space.hpp"
+#include "space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <Teuchos_ParameterList.hpp>
+#include <tbb/task_scheduler_init.h>
+#include <tbb/tick_count.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef BEMPP_BENCHMARK_MESH_DIR
+#define BEMPP_BENCHMARK_MESH_DIR "meshes"
+#endif
+
+using namespace Bempp;
+
+namespace {
+
+typedef double BFT;
+
+struct Options {
+  Options()
+      : meshDir(BEMPP_BENCHMARK_MESH_DIR),
+        meshes(splitList("sphere-h-0.2,cube-h-0.1")),
+        operators(splitList("laplace_slp,laplace_dlp,helmholtz_slp")),
+        spaces(splitList("p0,p1")),
+        modes(splitList("dense,hmat,hmat_single")),
+        threads(splitList("1,0")), repetitions(5), solve(true),
+        insidePoints(32) {}
+
+  std::string meshDir;
+  std::vector<std::string> meshes;
+  std::vector<std::string> operators;
+  std::vector<std::string> spaces;
+  std::vector<std::string> modes;
+  std::vector<std::string> threads;
+  int repetitions;
+  bool solve;
+  int insidePoints;
+  std::string output;
+};
+
+struct BenchmarkCase {
+  std::string mesh;
+  std::string op;
+  std::string space;
+  std::string mode;
+  int threadCount; // 0: automatic
+};
+
+void printUsage(const char *program) {
+  std::cout
+      << "Usage: " << program << " [options]\n\n"
+         "Lists are comma-separated; all combinations of their items are "
+         "benchmarked.\n\n"
+         "  --mesh-dir DIR        directory containing the meshes\n"
+         "                        (default: " BEMPP_BENCHMARK_MESH_DIR ")\n"
+         "  --meshes LIST         mesh files, with or without the .msh\n"
+         "                        extension (default: sphere-h-0.2,cube-h-0.1)\n"
+         "  --operators LIST      laplace_slp, laplace_dlp, laplace_hyp,\n"
+         "                        helmholtz_slp, helmholtz_dlp\n"
+         "                        (default: laplace_slp,laplace_dlp,"
+         "helmholtz_slp)\n"
+         "  --spaces LIST         p0, p1 (default: p0,p1)\n"
+         "  --modes LIST          dense, hmat, hmat_single (H-matrix with\n"
+         "                        single-precision low-rank blocks),\n"
+         "                        matrix_free"
+#ifdef WITH_AHMED
+         ", aca"
+#endif
+         " (default: dense,hmat,hmat_single)\n"
+         "  --threads LIST        thread counts, 0 meaning automatic\n"
+         "                        (default: 1,0)\n"
+         "  --repetitions N       repetitions of each measurement "
+         "(default: 5)\n"
+         "  --no-solve            skip the GMRES benchmarks\n"
+         "  --inside-points N     number of points along each axis of the\n"
+         "                        grid of points tested by the areInside\n"
+         "                        benchmarks, 0 skipping them (default: 32)\n"
+         "  --output FILE         write the results to FILE instead of\n"
+         "                        the standard output\n";
+}
+
+Options parseOptions(int argc, char *argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--no-solve") {
+      options.solve = false;
+      continue;
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument("missing value of option " + arg);
+    const std::string value = argv[++i];
+    if (arg == "--mesh-dir")
+      options.meshDir = value;
+    else if (arg == "--meshes")
+      options.meshes = splitList(value);
+    else if (arg == "--operators")
+      options.operators = splitList(value);
+    else if (arg == "--spaces")
+      options.spaces = splitList(value);
+    else if (arg == "--modes")
+      options.modes = splitList(value);
+    else if (arg == "--threads")
+      options.threads = splitList(value);
+    else if (arg == "--repetitions")
+      options.repetitions = std::atoi(value.c_str());
+    else if (arg == "--inside-points")
+      options.insidePoints = std::atoi(value.c_str());
+    else if (arg == "--output")
+      options.output = value;
+    else
+      throw std::invalid_argument("unknown option " + arg);
+  }
+  if (options.repetitions < 1)
+    throw std::invalid_argument("--repetitions must be positive");
+  if (options.insidePoints < 0)
+    throw std::invalid_argument("--inside-points must not be negative");
+  return options;
+}
+
+shared_ptr<const Grid> loadMesh(const Options &options,
+                                const std::string &mesh) {
+  std::string path = options.meshDir + "/" + mesh;
+  if (path.size() < 4 || path.compare(path.size() - 4, 4, ".msh") != 0)
+    path += ".msh";
+  GridParameters params;
+  params.topology = GridParameters::TRIANGULAR;
+  return GridFactory::importGmshGrid(params, path, false /* verbose */);
+}
+
+shared_ptr<const Space<BFT>> makeSpace(const std::string &name,
+                                       const shared_ptr<const Grid> &grid) {
+  if (name == "p0")
+    return boost::make_shared<PiecewiseConstantScalarSpace<BFT>>(grid);
+  if (name == "p1")
+    return boost::make_shared<PiecewiseLinearContinuousScalarSpace<BFT>>(grid);
+  throw std::invalid_argument("unknown space " + name);
+}
+
+template <typename ResultType>
+shared_ptr<const Context<BFT, ResultType>>
+makeContext(const std::string &mode, int threadCount) {
+  ParameterList parameters = GlobalParameters::parameterList();
+  parameters.set("maxThreadCount", threadCount > 0 ? threadCount : -1);
+  parameters.set("verbosityLevel", -5);
+  if (mode == "dense" || mode == "hmat" || mode == "matrix_free") {
+    parameters.set("boundaryOperatorAssemblyType", mode);
+    return boost::make_shared<Context<BFT, ResultType>>(parameters);
+  }
+  if (mode == "hmat_single") {
+    parameters.set("boundaryOperatorAssemblyType", std::string("hmat"));
+    parameters.sublist("HMat").set("singlePrecisionLowRankBlocks", true);
+    return boost::make_shared<Context<BFT, ResultType>>(parameters);
+  }
+#ifdef WITH_AHMED
+  if (mode == "aca") {
+    // ACA mode can only be selected through AssemblyOptions
+    Context<BFT, ResultType> denseContext(parameters);
+    AssemblyOptions assemblyOptions = denseContext.assemblyOptions();
+    assemblyOptions.switchToAcaMode(AcaOptions());
+    return boost::make_shared<Context<BFT, ResultType>>(
+        denseContext.quadStrategy(), assemblyOptions,
+        denseContext.globalParameterList());
+  }
+#endif
+  throw std::invalid_argument("unsupported assembly mode " + mode);
+}
+
+BoundaryOperator<BFT, double>
+makeOperator(const std::string &name,
+             const shared_ptr<const Context<BFT, double>> &context,
+             const shared_ptr<const Space<BFT>> &space) {
+  if (name == "laplace_slp")
+    return laplace3dSingleLayerBoundaryOperator<BFT, double>(context, space,
+                                                             space, space);
+  if (name == "laplace_dlp")
+    return laplace3dDoubleLayerBoundaryOperator<BFT, double>(context, space,
+                                                             space, space);
+  if (name == "laplace_hyp")
+    return laplace3dHypersingularBoundaryOperator<BFT, double>(context, space,
+                                                               space, space);
+  throw std::invalid_argument("unknown operator " + name);
+}
+
+BoundaryOperator<BFT, std::complex<double>>
+makeOperator(const std::string &name,
+             const shared_ptr<const Context<BFT, std::complex<double>>> &
+                 context,
+             const shared_ptr<const Space<BFT>> &space) {
+  const std::complex<double> waveNumber(1., 0.);
+  if (name == "helmholtz_slp")
+    return helmholtz3dSingleLayerBoundaryOperator<BFT>(context, space, space,
+                                                       space, waveNumber);
+  if (name == "helmholtz_dlp")
+    return helmholtz3dDoubleLayerBoundaryOperator<BFT>(context, space, space,
+                                                       space, waveNumber);
+  throw std::invalid_argument("unknown operator " + name);
+}
+
+/** Smooth data projected onto the space in the grid-function benchmarks. */
+template <typename ValueType_> class SmoothData {
+public:
+  typedef ValueType_ ValueType;
+  typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+  int argumentDimension() const { return 3; }
+  int resultDimension() const { return 1; }
+
+  void evaluate(const arma::Col<CoordinateType> &point,
+                arma::Col<ValueType> &result) const {
+    result(0) = std::sin(point(0)) + point(1) * point(2);
+  }
+};
+
+bool isHypersingular(const std::string &op) {
+  return op.size() >= 4 && op.compare(op.size() - 4, 4, "_hyp") == 0;
+}
+
+bool isDoubleLayer(const std::string &op) {
+  return op.size() >= 4 && op.compare(op.size() - 4, 4, "_dlp") == 0;
+}
+
+bool isHelmholtz(const std::string &op) {
+  return op.compare(0, 10, "helmholtz_") == 0;
+}
+
+template <typename ResultType>
+void runCase(const Options &options, const BenchmarkCase &benchmarkCase,
+             std::ostream &out) {
+  const int repetitions = options.repetitions;
+  shared_ptr<const Grid> grid = loadMesh(options, benchmarkCase.mesh);
+  shared_ptr<const Space<BFT>> space = makeSpace(benchmarkCase.space, grid);
+  shared_ptr<const Context<BFT, ResultType>> context =
+      makeContext<ResultType>(benchmarkCase.mode, benchmarkCase.threadCount);
+
+  resetPeakMemory();
+
+  // Assembly; the weak form of a BoundaryOperator is cached, so a new
+  // operator is created for each repetition
+  std::vector<double> assemblyTimes;
+  BoundaryOperator<BFT, ResultType> op;
+  shared_ptr<const DiscreteBoundaryOperator<ResultType>> weakForm;
+  for (int r = 0; r < repetitions; ++r) {
+    weakForm.reset();
+    op = BoundaryOperator<BFT, ResultType>();
+    const tbb::tick_count start = tbb::tick_count::now();
+    op = makeOperator(benchmarkCase.op, context, space);
+    weakForm = op.weakForm();
+    assemblyTimes.push_back((tbb::tick_count::now() - start).seconds());
+  }
+  const std::size_t assemblyPeakMemoryKb = peakMemoryKb();
+
+  // Matrix-vector products
+  std::vector<double> matvecTimes;
+  arma::Mat<ResultType> x(weakForm->columnCount(), 1);
+  arma::Mat<ResultType> y(weakForm->rowCount(), 1);
+  x.randu();
+  for (int r = 0; r < repetitions; ++r) {
+    const tbb::tick_count start = tbb::tick_count::now();
+    weakForm->apply(NO_TRANSPOSE, x, y, 1., 0.);
+    matvecTimes.push_back((tbb::tick_count::now() - start).seconds());
+  }
+
+  // Projection of a function onto the space, as done when building the
+  // right-hand side, and evaluation at the vertices, as done on export
+  std::vector<double> projectionTimes, specialPointTimes;
+  {
+    GridFunction<BFT, ResultType> function;
+    for (int r = 0; r < repetitions; ++r) {
+      const tbb::tick_count start = tbb::tick_count::now();
+      function = GridFunction<BFT, ResultType>(
+          context, space, space,
+          surfaceNormalIndependentFunction(SmoothData<ResultType>()));
+      projectionTimes.push_back((tbb::tick_count::now() - start).seconds());
+    }
+    arma::Mat<ResultType> values;
+    for (int r = 0; r < repetitions; ++r) {
+      const tbb::tick_count start = tbb::tick_count::now();
+      function.evaluateAtSpecialPoints(VtkWriter::VERTEX_DATA, values);
+      specialPointTimes.push_back((tbb::tick_count::now() - start).seconds());
+    }
+  }
+
+  // GMRES solves; double-layer operators are solved in second-kind form,
+  // the hypersingular operator (singular on closed surfaces) is skipped
+  std::vector<double> solveTimes;
+  int iterationCount = -1;
+#ifdef WITH_TRILINOS
+  if (options.solve && !isHypersingular(benchmarkCase.op)) {
+    BoundaryOperator<BFT, ResultType> systemOp = op;
+    if (isDoubleLayer(benchmarkCase.op))
+      systemOp =
+          0.5 * identityOperator<BFT, ResultType>(context, space, space,
+                                                  space) +
+          op;
+    systemOp.weakForm(); // not timed
+    GridFunction<BFT, ResultType> rhs(
+        context, space, arma::ones<arma::Col<ResultType>>(
+                            space->globalDofCount()));
+    DefaultIterativeSolver<BFT, ResultType> solver(systemOp);
+    solver.initializeSolver(defaultGmresParameterList(1e-5));
+    for (int r = 0; r < repetitions; ++r) {
+      const tbb::tick_count start = tbb::tick_count::now();
+      Solution<BFT, ResultType> solution = solver.solve(rhs);
+      solveTimes.push_back((tbb::tick_count::now() - start).seconds());
+      iterationCount = solution.iterationCount();
+    }
+  }
+#endif
+
+  out << "    {\"mesh\": ";
+  writeJsonString(out, benchmarkCase.mesh);
+  out << ", \"operator\": ";
+  writeJsonString(out, benchmarkCase.op);
+  out << ", \"space\": ";
+  writeJsonString(out, benchmarkCase.space);
+  out << ", \"assemblyMode\": ";
+  writeJsonString(out, benchmarkCase.mode);
+  out << ",\n     \"threads\": " << benchmarkCase.threadCount
+      << ", \"elements\": " << grid->leafView()->entityCount(0)
+      << ", \"dofs\": " << space->globalDofCount() << ",\n     \"assembly\": ";
+  writeJson(out, timingStatistics(assemblyTimes));
+  out << ",\n     \"matvec\": ";
+  writeJson(out, timingStatistics(matvecTimes));
+  out << ",\n     \"projection\": ";
+  writeJson(out, timingStatistics(projectionTimes));
+  out << ",\n     \"specialPoints\": ";
+  writeJson(out, timingStatistics(specialPointTimes));
+  out << ",\n     \"solve\": ";
+  if (solveTimes.empty())
+    out << "null";
+  else {
+    writeJson(out, timingStatistics(solveTimes));
+    out << ", \"gmresIterations\": " << iterationCount;
+  }
+  out << ",\n     \"assemblyPeakMemoryKb\": " << assemblyPeakMemoryKb
+      << ", \"peakMemoryKb\": " << peakMemoryKb()
+      << ",\n     \"assemblyProfile\": ";
+  shared_ptr<const AssemblyProfile> profile = weakForm->assemblyProfile();
+  if (profile)
+    profile->writeJson(out);
+  else
+    out << "null";
+  out << "}";
+}
+
+/** \brief Regular grid of points covering the bounding box of \p grid,
+ *  enlarged by 10% on each side. */
+arma::Mat<double> pointsAroundGrid(const Grid &grid, int pointsPerAxis) {
+  arma::Col<double> lowerBound, upperBound;
+  grid.getBoundingBox(lowerBound, upperBound);
+  const arma::Col<double> margin = 0.1 * (upperBound - lowerBound);
+  lowerBound -= margin;
+  upperBound += margin;
+  const int n = pointsPerAxis;
+  arma::Mat<double> points(3, n * n * n);
+  for (int k = 0, p = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i, ++p) {
+        const int indices[3] = {i, j, k};
+        for (int d = 0; d < 3; ++d)
+          points(d, p) = lowerBound(d) + (upperBound(d) - lowerBound(d)) *
+                                             (indices[d] + 0.5) / n;
+      }
+  return points;
+}
+
+void runAreInside(const Options &options, const std::string &mesh,
+                  int threadCount, std::ostream &out) {
+  const int repetitions = options.repetitions;
+  tbb::task_scheduler_init scheduler(
+      threadCount > 0 ? threadCount : tbb::task_scheduler_init::automatic);
+
+  // The bounding-volume hierarchy is built by the first call and cached in
+  // the grid, so the first call is timed separately, on a fresh grid for
+  // each repetition
+  const arma::Mat<double> points =
+      pointsAroundGrid(*loadMesh(options, mesh), options.insidePoints);
+  std::vector<double> firstCallTimes, times;
+  shared_ptr<const Grid> grid;
+  std::vector<bool> inside;
+  for (int r = 0; r < repetitions; ++r) {
+    grid = loadMesh(options, mesh);
+    const tbb::tick_count start = tbb::tick_count::now();
+    inside = areInside(*grid, points);
+    firstCallTimes.push_back((tbb::tick_count::now() - start).seconds());
+  }
+  for (int r = 0; r < repetitions; ++r) {
+    const tbb::tick_count start = tbb::tick_count::now();
+    inside = areInside(*grid, points);
+    times.push_back((tbb::tick_count::now() - start).seconds());
+  }
+  std::size_t insideCount = 0;
+  for (size_t i = 0; i < inside.size(); ++i)
+    insideCount += inside[i];
+
+  out << "    {\"mesh\": ";
+  writeJsonString(out, mesh);
+  out << ", \"threads\": " << threadCount
+      << ", \"elements\": " << grid->leafView()->entityCount(0)
+      << ", \"points\": " << points.n_cols
+      << ", \"pointsInside\": " << insideCount << ",\n     \"firstCall\": ";
+  writeJson(out, timingStatistics(firstCallTimes));
+  out << ",\n     \"areInside\": ";
+  writeJson(out, timingStatistics(times));
+  out << "}";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  try {
+    options = parseOptions(argc, argv);
+  } catch (std::exception &e) {
+    std::cerr << e.what() << "\n\n";
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output.c_str());
+    if (!file) {
+      std::cerr << "Cannot open " << options.output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = options.output.empty() ? std::cout : file;
+
+  int failureCount = 0;
+  bool first = true;
+  out << "{\"benchmarks\": [\n";
+  for (size_t m = 0; m < options.meshes.size(); ++m)
+    for (size_t o = 0; o < options.operators.size(); ++o)
+      for (size_t s = 0; s < options.spaces.size(); ++s)
+        for (size_t a = 0; a < options.modes.size(); ++a)
+          for (size_t t = 0; t < options.threads.size(); ++t) {
+            BenchmarkCase benchmarkCase;
+            benchmarkCase.mesh = options.meshes[m];
+            benchmarkCase.op = options.operators[o];
+            benchmarkCase.space = options.spaces[s];
+            benchmarkCase.mode = options.modes[a];
+            benchmarkCase.threadCount = std::atoi(options.threads[t].c_str());
+            if (isHypersingular(benchmarkCase.op) &&
+                benchmarkCase.space == "p0")
+              continue; // needs a continuous space
+
+            std::cerr << "Running " << benchmarkCase.mesh << " "
+                      << benchmarkCase.op << " " << benchmarkCase.space << " "
+                      << benchmarkCase.mode << " "
+                      << benchmarkCase.threadCount << std::endl;
+            std::ostringstream result;
+            try {
+              if (isHelmholtz(benchmarkCase.op))
+                runCase<std::complex<double>>(options, benchmarkCase, result);
+              else
+                runCase<double>(options, benchmarkCase, result);
+              if (!first)
+                out << ",\n";
+              out << result.str();
+              first = false;
+            } catch (std::exception &e) {
+              std::cerr << "  failed: " << e.what() << std::endl;
+              ++failureCount;
+            }
+            out.flush();
+          }
+  out << "\n],\n\"areInside\": [\n";
+
+  first = true;
+  if (options.insidePoints > 0)
+    for (size_t m = 0; m < options.meshes.size(); ++m)
+      for (size_t t = 0; t < options.threads.size(); ++t) {
+        const int threadCount = std::atoi(options.threads[t].c_str());
+        std::cerr << "Running areInside " << options.meshes[m] << " "
+                  << threadCount << std::endl;
+        std::ostringstream result;
+        try {
+          runAreInside(options, options.meshes[m], threadCount, result);
+          if (!first)
+            out << ",\n";
+          out << result.str();
+          first = false;
+        } catch (std::exception &e) {
+          std::cerr << "  failed: " << e.what() << std::endl;
+          ++failureCount;
+        }
+        out.flush();
+      }
+  out << "\n]}\n";
+
+  return failureCount == 0 ? 0 : 1;
+}
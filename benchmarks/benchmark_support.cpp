@@ -0,0 +1,112 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+namespace Bempp {
+
+namespace {
+
+double percentile(const std::vector<double> &sorted, double fraction) {
+  const double position = fraction * (sorted.size() - 1);
+  const std::size_t lower = static_cast<std::size_t>(position);
+  if (lower + 1 >= sorted.size())
+    return sorted.back();
+  const double weight = position - lower;
+  return (1. - weight) * sorted[lower] + weight * sorted[lower + 1];
+}
+
+} // namespace
+
+TimingStatistics timingStatistics(std::vector<double> seconds) {
+  if (seconds.empty())
+    throw std::invalid_argument("timingStatistics(): no samples");
+  std::sort(seconds.begin(), seconds.end());
+
+  TimingStatistics stats;
+  stats.repetitions = seconds.size();
+  stats.min = seconds.front();
+  stats.max = seconds.back();
+  stats.mean = std::accumulate(seconds.begin(), seconds.end(), 0.) /
+               seconds.size();
+  stats.median = percentile(seconds, 0.5);
+  stats.p10 = percentile(seconds, 0.1);
+  stats.p90 = percentile(seconds, 0.9);
+  return stats;
+}
+
+void writeJson(std::ostream &out, const TimingStatistics &stats) {
+  const std::streamsize precision = out.precision(9);
+  out << "{\"repetitions\": " << stats.repetitions
+      << ", \"min\": " << stats.min << ", \"max\": " << stats.max
+      << ", \"mean\": " << stats.mean << ", \"median\": " << stats.median
+      << ", \"p10\": " << stats.p10 << ", \"p90\": " << stats.p90 << "}";
+  out.precision(precision);
+}
+
+void resetPeakMemory() {
+  // On Linux, writing 5 to clear_refs resets the VmHWM entry of
+  // /proc/self/status
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs)
+    clearRefs << "5" << std::flush;
+}
+
+std::size_t peakMemoryKb() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      std::istringstream value(line.substr(6));
+      std::size_t kb = 0;
+      if (value >> kb)
+        return kb;
+    }
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024; // bytes
+#else
+  return usage.ru_maxrss; // kB
+#endif
+}
+
+std::vector<std::string> splitList(const std::string &list) {
+  std::vector<std::string> result;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ','))
+    if (!item.empty())
+      result.push_back(item);
+  return result;
+}
+
+} // namespace Bempp
@@ -0,0 +1,67 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_benchmark_support_hpp
+#define bempp_benchmark_support_hpp
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Bempp {
+
+/** \brief Summary of the timings of the repetitions of a benchmark. */
+struct TimingStatistics {
+  std::size_t repetitions;
+  double min;
+  double max;
+  double mean;
+  double median;
+  /** \brief 10th percentile. */
+  double p10;
+  /** \brief 90th percentile. */
+  double p90;
+};
+
+/** \brief Compute the statistics of the timings \p seconds.
+ *
+ *  Percentiles are interpolated linearly between the sorted samples. */
+TimingStatistics timingStatistics(std::vector<double> seconds);
+
+/** \brief Write \p stats to \p out as a JSON object. */
+void writeJson(std::ostream &out, const TimingStatistics &stats);
+
+/** \brief Reset the resident set high-water mark of the process.
+ *
+ *  Has no effect on systems where this is not supported, in which case
+ *  peakMemoryKb() reports the high-water mark since the start of the
+ *  process. */
+void resetPeakMemory();
+
+/** \brief Resident set high-water mark of the process in kB. */
+std::size_t peakMemoryKb();
+
+/** \brief Split a comma-separated list. */
+std::vector<std::string> splitList(const std::string &list);
+
+} // namespace Bempp
+
+#endif
@@ -1,6 +1,7 @@
 # Options (can be modified by user)
 option(WITH_TESTS "Compile unit tests (can be run with 'make test')" ON)
 option(WITH_INTEGRATION_TESTS "Compile integration tests" OFF)
+option(WITH_BENCHMARKS "Compile the bempp_benchmarks performance harness" OFF)
 option(WITH_OPENCL "Add OpenCL support for Fiber module" OFF)
 option(WITH_CUDA "Add CUDA support for Fiber module" OFF)
 option(WITH_ALUGRID "Have or install Alugrid" OFF)
@@ -32,6 +32,8 @@
 #include "../fiber/quadrature_strategy.hpp"
 #include "../space/space.hpp"
 
+#include <boost/enable_shared_from_this.hpp>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -91,7 +93,9 @@ class ScaledAbstractBoundaryOperator;
  *  set to a complex type, then \p ResultType_ must be set to the same type.
  */
 template <typename BasisFunctionType_, typename ResultType_>
-class AbstractBoundaryOperator {
+class AbstractBoundaryOperator
+    : public boost::enable_shared_from_this<
+          AbstractBoundaryOperator<BasisFunctionType_, ResultType_>> {
 public:
   /** \brief Type of the values of the (components of the) basis functions into
    *  which functions acted upon by the operator are expanded. */
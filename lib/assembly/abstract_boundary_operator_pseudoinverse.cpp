@@ -169,6 +169,11 @@ AbstractBoundaryOperatorPseudoinverse<BasisFunctionType, ResultType>::
   DiscreteInverseSparseOp;
 
   shared_ptr<const Epetra_CrsMatrix> matrix = wrappedDiscreteOp->epetraMatrix();
+  if (wrappedDiscreteOp->epetraImaginaryMatrix())
+    throw std::runtime_error(
+        "AbstractBoundaryOperatorPseudoinverse::"
+        "assembleWeakFormForSparseOperator(): "
+        "sparse matrices with an imaginary part are not supported yet");
 
   const int rowCount = matrix->NumGlobalRows();
   const int colCount = matrix->NumGlobalCols();
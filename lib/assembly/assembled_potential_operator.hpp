@@ -108,6 +108,22 @@ public:
   arma::Mat<ResultType>
   apply(const GridFunction<BasisFunctionType, ResultType> &argument) const;
 
+  /** \brief Apply the operator to several charge distributions at once.
+   *
+   *  \param[in] coefficients A matrix whose <em>k</em>th column contains the
+   *  expansion coefficients, in the space returned by space(), of the
+   *  <em>k</em>th charge distribution.
+   *
+   *  \returns A matrix whose (<em>j</em> * \e c + \e i, \e k)th element
+   *  contains the value of the <em>i</em>th component of the potential
+   *  generated by the <em>k</em>th charge distribution at the <em>j</em>th
+   *  evaluation point, \e c being componentCount().
+   *
+   *  All distributions are processed in a single operator application; for
+   *  operators assembled in dense mode this amounts to one matrix-matrix
+   *  product. */
+  arma::Mat<ResultType> apply(const arma::Mat<ResultType> &coefficients) const;
+
 private:
   /** \cond PRIVATE */
   shared_ptr<const Space<BasisFunctionType>> m_space;
@@ -34,6 +34,8 @@ void AssemblyOptions::switchToDenseMode() { m_assemblyMode = DENSE; }
 
 void AssemblyOptions::switchToHMatMode() { m_assemblyMode = HMAT; }
 
+void AssemblyOptions::switchToMatrixFreeMode() { m_assemblyMode = MATRIX_FREE; }
+
 void AssemblyOptions::switchToAcaMode(const AcaOptions &acaOptions) {
   AcaOptions canonicalAcaOptions = acaOptions;
   if (!canonicalAcaOptions.globalAssemblyBeforeCompression) {
@@ -61,7 +61,10 @@ public:
        (ACA). */
     ACA,
     /** \brief Assemble hierarchical matrices using the HMat library. */
-    HMAT
+    HMAT,
+    /** \brief Store only the near field of the operator and recompute the
+       far field in each matrix-vector product. */
+    MATRIX_FREE
   };
 
   /** \brief Use dense-matrix representations of weak forms of boundary integral
@@ -80,6 +83,17 @@ public:
   /** \brief Assemble using the HMat hierarchical matrix library. */
   void switchToHMatMode();
 
+  /** \brief Assemble matrix-free representations of weak forms of boundary
+   *  integral operators.
+   *
+   *  Weak forms are partitioned into blocks as in the HMAT mode, but only
+   *  the near-field (inadmissible) blocks are stored. The far-field blocks
+   *  are recomputed, with the quadrature orders chosen for distant
+   *  elements, whenever the operator is applied. This mode uses much less
+   *  memory than the others at the price of much slower matrix-vector
+   *  products. */
+  void switchToMatrixFreeMode();
+
   /** \brief Use dense-matrix representations of weak forms of boundary integral
    *operators.
    *
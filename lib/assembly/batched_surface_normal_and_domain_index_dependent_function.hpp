@@ -0,0 +1,82 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_batched_surface_normal_and_domain_index_dependent_function_hpp
+#define bempp_batched_surface_normal_and_domain_index_dependent_function_hpp
+
+#include "../common/common.hpp"
+
+#include "../fiber/batched_surface_normal_and_domain_index_dependent_function.hpp"
+
+namespace Bempp {
+using Fiber::BatchedSurfaceNormalAndDomainIndexDependentFunction;
+
+/** \ingroup assembly_functions
+
+  \brief Use a functor evaluated on many points at once, taking their global
+  coordinates, the local surface-normal unit vectors and the domain indices of
+  the elements containing the points, to construct an instance of the Function
+  class.
+
+  Projections of functions constructed in this way onto a space are computed
+  by calling the functor once per chunk of elements rather than once per
+  quadrature point.
+
+  The template parameter \p Functor should be a class implementing the following
+  interface:
+
+  \code
+  class Functor
+  {
+  public:
+      // Type of the function's values (e.g. float or std::complex<double>)
+      typedef <implementation-defined> ValueType;
+      typedef ScalarTraits<ValueType>::RealType CoordinateType;
+
+      // Number of components of the function's arguments ("points" and
+      // "normals")
+      int argumentDimension() const;
+
+      // Number of components of the function's result
+      int resultDimension() const;
+
+      // Evaluate the function at the points stored in the columns of
+      // "points", with "normals" the corresponding local unit normal vectors
+      // and "domainIndices" the indices of the domains containing the
+      // points, and store the values in the columns of "result". All arrays
+      // will be preinitialised to correct dimensions.
+      void evaluate(const arma::Mat<CoordinateType>& points,
+                    const arma::Mat<CoordinateType>& normals,
+                    const std::vector<int>& domainIndices,
+                    arma::Mat<ValueType>& result) const;
+  };
+  \endcode
+
+  The constructed Function object can subsequently be passed into a constructor
+  of the GridFunction class. */
+template <typename Functor>
+inline BatchedSurfaceNormalAndDomainIndexDependentFunction<Functor>
+batchedSurfaceNormalAndDomainIndexDependentFunction(const Functor &functor) {
+  return BatchedSurfaceNormalAndDomainIndexDependentFunction<Functor>(functor);
+}
+
+} // namespace Bempp
+
+#endif
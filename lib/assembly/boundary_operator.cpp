@@ -60,6 +60,7 @@ void BoundaryOperator<BasisFunctionType, ResultType>::initialize(
   m_abstractOp = abstractOp;
   m_weakFormContainer.reset(new ConstWeakFormContainer);
   m_weakWeakFormContainer.reset(new WeakConstWeakFormContainer);
+  m_weakFormMutex.reset(new tbb::mutex);
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -68,6 +69,7 @@ void BoundaryOperator<BasisFunctionType, ResultType>::uninitialize() {
   m_abstractOp.reset();
   m_weakFormContainer.reset();
   m_weakWeakFormContainer.reset();
+  m_weakFormMutex.reset();
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -98,7 +100,9 @@ BoundaryOperator<BasisFunctionType, ResultType>::weakForm() const {
                                    // (which may be null, though)
   assert(m_weakWeakFormContainer); // contains a weak_ptr to DiscreteOp
                                    // (which may be null, though)
+  assert(m_weakFormMutex);
   typedef DiscreteBoundaryOperator<ResultType> DiscreteOp;
+  tbb::mutex::scoped_lock lock(*m_weakFormMutex);
   shared_ptr<const DiscreteOp> discreteOp = m_weakWeakFormContainer->lock();
   if (!discreteOp) {
     discreteOp = m_abstractOp->assembleWeakForm(*m_context);
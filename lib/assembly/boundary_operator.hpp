@@ -30,6 +30,7 @@
 #include <boost/utility/enable_if.hpp>
 #include <boost/weak_ptr.hpp>
 #include <string>
+#include <tbb/mutex.h>
 
 namespace Bempp {
 
@@ -202,6 +203,9 @@ private:
   typedef boost::weak_ptr<const DiscreteBoundaryOperator<ResultType>>
   WeakConstWeakFormContainer;
   mutable shared_ptr<WeakConstWeakFormContainer> m_weakWeakFormContainer;
+  // Shared by all copies of this operator, like the containers above, so
+  // that concurrent calls to weakForm() assemble the weak form only once.
+  mutable shared_ptr<tbb::mutex> m_weakFormMutex;
   /** \endcond */
 };
 
@@ -25,6 +25,7 @@
 #include "../fiber/verbosity_level.hpp"
 #include "../fiber/accuracy_options.hpp"
 #include "numerical_quadrature_strategy.hpp"
+#include "synthetic_internal_operator_cache.hpp"
 #include <Teuchos_ParameterList.hpp>
 
 #include <boost/make_shared.hpp>
@@ -38,7 +39,9 @@ Context<BasisFunctionType, ResultType>::Context(
     const AssemblyOptions &assemblyOptions,
     const ParameterList &globalParameterList)
     : m_quadStrategy(quadStrategy), m_assemblyOptions(assemblyOptions),
-      m_globalParameterList(globalParameterList) {
+      m_globalParameterList(globalParameterList),
+      m_syntheticInternalOperatorCache(boost::make_shared<
+          SyntheticInternalOperatorCache<BasisFunctionType, ResultType>>()) {
   if (quadStrategy.get() == 0)
     throw std::invalid_argument("Context::Context(): "
                                 "quadStrategy must not be null");
@@ -51,7 +54,9 @@ Context<BasisFunctionType, ResultType>::Context() :
 
 template <typename BasisFunctionType, typename ResultType>
 Context<BasisFunctionType, ResultType>::Context(
-    const ParameterList &globalParameterList) {
+    const ParameterList &globalParameterList)
+    : m_syntheticInternalOperatorCache(boost::make_shared<
+          SyntheticInternalOperatorCache<BasisFunctionType, ResultType>>()) {
 
   ParameterList parameters(globalParameterList);
   parameters.setParametersNotAlreadySet(GlobalParameters::parameterList());
@@ -62,6 +67,8 @@ Context<BasisFunctionType, ResultType>::Context(
     m_assemblyOptions.switchToHMatMode();
   else if (assemblyType == "dense")
     m_assemblyOptions.switchToDenseMode();
+  else if (assemblyType == "matrix_free")
+    m_assemblyOptions.switchToMatrixFreeMode();
   else
     throw std::runtime_error(
         "Context::Context(): boundaryOperatorAssemblyType has "
@@ -116,6 +123,11 @@ Context<BasisFunctionType, ResultType>::Context(
       quadOps.sublist("far").get<int>("doubleOrder"),
       quadOps.get<bool>("quadratureOrdersAreRelative"));
 
+  if (quadOps.get<double>("doubleRegularTolerance") > 0.)
+    accuracyOptions.setDoubleRegularAdaptive(
+        quadOps.get<double>("doubleRegularTolerance"),
+        quadOps.get<int>("maxDoubleRegularOrder"));
+
   accuracyOptions.setDoubleSingular(
       quadOps.get<int>("doubleSingular"),
       quadOps.get<bool>("quadratureOrdersAreRelative"));
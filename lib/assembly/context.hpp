@@ -16,6 +16,8 @@ class GeometryFactory;
 template <typename ValueType> class DiscreteBoundaryOperator;
 template <typename BasisFunctionType, typename ResultType>
 class AbstractBoundaryOperator;
+template <typename BasisFunctionType, typename ResultType>
+class SyntheticInternalOperatorCache;
 /** \endcond */
 
 /** \ingroup weak_form_assembly
@@ -94,10 +96,22 @@ public:
     return m_globalParameterList;
   }
 
+  /** \brief Return the cache of the internal operators of synthetic
+   *  boundary operators assembled with this Context.
+   *
+   *  The cache is shared by copies of the Context and released with the
+   *  last of them. */
+  shared_ptr<SyntheticInternalOperatorCache<BasisFunctionType, ResultType>>
+  syntheticInternalOperatorCache() const {
+    return m_syntheticInternalOperatorCache;
+  }
+
 private:
   shared_ptr<const QuadratureStrategy> m_quadStrategy;
   AssemblyOptions m_assemblyOptions;
   ParameterList m_globalParameterList;
+  shared_ptr<SyntheticInternalOperatorCache<BasisFunctionType, ResultType>>
+      m_syntheticInternalOperatorCache;
 };
 
 } // namespace Bempp
@@ -25,13 +25,15 @@
 #include "assembly_options.hpp"
 #include "discrete_dense_boundary_operator.hpp"
 #include "context.hpp"
+#include "evaluation_options.hpp"
 
-#include "../common/auto_timer.hpp"
+#include "../common/assembly_profile.hpp"
 #include "../common/multidimensional_arrays.hpp"
 #include "../common/not_implemented_error.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/serial_blas_region.hpp"
 #include "../fiber/local_assembler_for_integral_operators.hpp"
+#include "../fiber/local_assembler_for_potential_operators.hpp"
 #include "../grid/entity.hpp"
 #include "../grid/entity_iterator.hpp"
 #include "../grid/grid.hpp"
@@ -41,13 +43,17 @@
 
 #include "../common/armadillo_fwd.hpp"
 #include "../common/complex_aux.hpp"
+#include <algorithm>
+#include <functional>
 #include <stdexcept>
 #include <iostream>
 
+#include <tbb/blocked_range.h>
+#include <tbb/combinable.h>
 #include <tbb/parallel_for.h>
 #include <tbb/spin_mutex.h>
 #include <tbb/task_scheduler_init.h>
-//#include <tbb/tick_count.h>
+#include <tbb/tick_count.h>
 
 namespace Bempp {
 
@@ -69,14 +75,18 @@ public:
       const std::vector<std::vector<BasisFunctionType>> &testLocalDofWeights,
       const std::vector<std::vector<BasisFunctionType>> &trialLocalDofWeights,
       Fiber::LocalAssemblerForIntegralOperators<ResultType> &assembler,
-      arma::Mat<ResultType> &result, MutexType &mutex)
+      arma::Mat<ResultType> &result, MutexType &mutex,
+      tbb::combinable<double> &busyTime)
       : m_testIndices(testIndices), m_testGlobalDofs(testGlobalDofs),
         m_trialGlobalDofs(trialGlobalDofs),
         m_testLocalDofWeights(testLocalDofWeights),
         m_trialLocalDofWeights(trialLocalDofWeights), m_assembler(assembler),
-        m_result(result), m_mutex(mutex) {}
+        m_result(result), m_mutex(mutex), m_busyTime(busyTime),
+        m_profile(AssemblyProfile::current()) {}
 
   void operator()(const tbb::blocked_range<size_t> &r) const {
+    AssemblyProfile::Activation activation(m_profile);
+    const tbb::tick_count start = tbb::tick_count::now();
     const int elementCount = m_testIndices.size();
     std::vector<arma::Mat<ResultType>> localResult;
     for (size_t trialIndex = r.begin(); trialIndex != r.end(); ++trialIndex) {
@@ -113,6 +123,7 @@ public:
         }
       }
     }
+    m_busyTime.local() += (tbb::tick_count::now() - start).seconds();
   }
 
 private:
@@ -130,6 +141,84 @@ private:
 
   // mutex must be mutable because we need to lock and unlock it
   MutexType &m_mutex;
+  // Time spent in the loop body by each thread
+  tbb::combinable<double> &m_busyTime;
+  // Profile of the thread starting the loop
+  AssemblyProfile *m_profile;
+};
+
+// Body of parallel loop over tiles of evaluation points. Each tile owns
+// a distinct set of matrix rows, so no locking is needed.
+
+template <typename BasisFunctionType, typename ResultType>
+class DensePotentialOperatorAssemblerLoopBody {
+public:
+  DensePotentialOperatorAssemblerLoopBody(
+      int componentCount,
+      const std::vector<std::vector<GlobalDofIndex>> &trialGlobalDofs,
+      const std::vector<std::vector<BasisFunctionType>> &trialLocalDofWeights,
+      Fiber::LocalAssemblerForPotentialOperators<ResultType> &assembler,
+      arma::Mat<ResultType> &result, tbb::combinable<double> &busyTime)
+      : m_componentCount(componentCount), m_trialGlobalDofs(trialGlobalDofs),
+        m_trialLocalDofWeights(trialLocalDofWeights), m_assembler(assembler),
+        m_result(result), m_busyTime(busyTime),
+        m_profile(AssemblyProfile::current()) {}
+
+  void operator()(const tbb::blocked_range<size_t> &r) const {
+    // Number of trial elements processed in one call to the local assembler
+    const size_t ELEMENT_TILE_SIZE = 64;
+
+    AssemblyProfile::Activation activation(m_profile);
+    const tbb::tick_count start = tbb::tick_count::now();
+    std::vector<int> pointIndices(r.size());
+    for (size_t i = 0; i < r.size(); ++i)
+      pointIndices[i] = r.begin() + i;
+
+    const size_t trialElementCount = m_trialGlobalDofs.size();
+    std::vector<int> trialIndices;
+    Fiber::_2dArray<arma::Mat<ResultType>> localResult;
+    for (size_t tileStart = 0; tileStart < trialElementCount;
+         tileStart += ELEMENT_TILE_SIZE) {
+      const size_t tileEnd =
+          std::min(tileStart + ELEMENT_TILE_SIZE, trialElementCount);
+      trialIndices.resize(tileEnd - tileStart);
+      for (size_t e = tileStart; e < tileEnd; ++e)
+        trialIndices[e - tileStart] = e;
+      m_assembler.evaluateLocalContributions(pointIndices, trialIndices,
+                                             localResult);
+
+      for (size_t e = 0; e < trialIndices.size(); ++e) {
+        const int trialIndex = trialIndices[e];
+        const int trialDofCount = m_trialGlobalDofs[trialIndex].size();
+        for (int trialDof = 0; trialDof < trialDofCount; ++trialDof) {
+          const int trialGlobalDof = m_trialGlobalDofs[trialIndex][trialDof];
+          if (trialGlobalDof < 0)
+            continue;
+          const BasisFunctionType weight =
+              m_trialLocalDofWeights[trialIndex][trialDof];
+          for (size_t p = 0; p < pointIndices.size(); ++p)
+            for (int c = 0; c < m_componentCount; ++c)
+              m_result(pointIndices[p] * m_componentCount + c,
+                       trialGlobalDof) +=
+                  weight * localResult(p, e)(c, trialDof);
+        }
+      }
+    }
+    m_busyTime.local() += (tbb::tick_count::now() - start).seconds();
+  }
+
+private:
+  int m_componentCount;
+  const std::vector<std::vector<GlobalDofIndex>> &m_trialGlobalDofs;
+  const std::vector<std::vector<BasisFunctionType>> &m_trialLocalDofWeights;
+  // The assembler is thread-safe
+  typename Fiber::LocalAssemblerForPotentialOperators<ResultType> &m_assembler;
+  // Each loop iteration writes to different rows of this matrix
+  arma::Mat<ResultType> &m_result;
+  // Time spent in the loop body by each thread
+  tbb::combinable<double> &m_busyTime;
+  // Profile of the thread starting the loop
+  AssemblyProfile *m_profile;
 };
 
 /** Build a list of lists of global DOF indices corresponding to the local DOFs
@@ -209,12 +298,26 @@ DenseGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
       maxThreadCount = parallelOptions.maxThreadCount();
   }
   tbb::task_scheduler_init scheduler(maxThreadCount);
+  tbb::combinable<double> busyTime;
+  const tbb::tick_count start = tbb::tick_count::now();
   {
     Fiber::SerialBlasRegion region;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, trialElementCount),
                       Body(testIndices, testGlobalDofs, trialGlobalDofs,
                            testLocalDofWeights, trialLocalDofWeights, assembler,
-                           result, mutex));
+                           result, mutex, busyTime));
+  }
+  if (AssemblyProfile *profile = AssemblyProfile::current()) {
+    profile->addParallelLoop(
+        "denseAssembly",
+        maxThreadCount == tbb::task_scheduler_init::automatic
+            ? tbb::task_scheduler_init::default_num_threads()
+            : maxThreadCount,
+        (tbb::tick_count::now() - start).seconds(),
+        busyTime.combine(std::plus<double>()));
+    profile->addCount("accessedEntries", result.n_elem);
+    profile->addCount("localWeakFormEvaluations",
+                      testElementCount * trialElementCount);
   }
 
   //// Old serial code (TODO: decide whether to keep it behind e.g. #ifndef
@@ -248,6 +351,65 @@ DenseGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
       new DiscreteDenseBoundaryOperator<ResultType>(result));
 }
 
+template <typename BasisFunctionType, typename ResultType>
+std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
+DenseGlobalAssembler<BasisFunctionType, ResultType>::assemblePotentialOperator(
+    const arma::Mat<CoordinateType> &points,
+    const Space<BasisFunctionType> &trialSpace,
+    LocalAssemblerForPotentialOperators &localAssembler,
+    const EvaluationOptions &options) {
+  // Points per task of the parallel loop
+  const size_t POINT_TILE_SIZE = 32;
+
+  std::vector<std::vector<GlobalDofIndex>> trialGlobalDofs;
+  std::vector<std::vector<BasisFunctionType>> trialLocalDofWeights;
+  gatherGlobalDofs(trialSpace, trialGlobalDofs, trialLocalDofWeights);
+
+  const size_t pointCount = points.n_cols;
+  const int componentCount = localAssembler.resultDimension();
+
+  // Create the operator's matrix
+  arma::Mat<ResultType> result(pointCount * componentCount,
+                               trialSpace.globalDofCount());
+  result.fill(0.);
+
+  typedef DensePotentialOperatorAssemblerLoopBody<BasisFunctionType, ResultType>
+  Body;
+
+  const ParallelizationOptions &parallelOptions =
+      options.parallelizationOptions();
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+  tbb::task_scheduler_init scheduler(maxThreadCount);
+  tbb::combinable<double> busyTime;
+  const tbb::tick_count start = tbb::tick_count::now();
+  {
+    Fiber::SerialBlasRegion region;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, pointCount, POINT_TILE_SIZE),
+        Body(componentCount, trialGlobalDofs, trialLocalDofWeights,
+             localAssembler, result, busyTime));
+  }
+  if (AssemblyProfile *profile = AssemblyProfile::current()) {
+    profile->addParallelLoop(
+        "densePotentialAssembly",
+        maxThreadCount == tbb::task_scheduler_init::automatic
+            ? tbb::task_scheduler_init::default_num_threads()
+            : maxThreadCount,
+        (tbb::tick_count::now() - start).seconds(),
+        busyTime.combine(std::plus<double>()));
+    profile->addCount("accessedEntries", result.n_elem);
+  }
+
+  return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
+      new DiscreteDenseBoundaryOperator<ResultType>(result));
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DenseGlobalAssembler);
 
 } // namespace Bempp
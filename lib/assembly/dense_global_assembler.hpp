@@ -3,12 +3,16 @@
 
 #include "../common/common.hpp"
 
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/scalar_traits.hpp"
+
 #include <memory>
 
 namespace Fiber {
 
 /** \cond FORWARD_DECL */
 template <typename ResultType> class LocalAssemblerForIntegralOperators;
+template <typename ResultType> class LocalAssemblerForPotentialOperators;
 /** \endcond */
 
 } // namespace Fiber
@@ -17,6 +21,7 @@ namespace Bempp {
 
 /** \cond FORWARD_DECL */
 class AssemblyOptions;
+class EvaluationOptions;
 template <typename ValueType> class DiscreteBoundaryOperator;
 template <typename BasisFunctionType> class Space;
 template <typename BasisFunctionType, typename ResultType> class Context;
@@ -28,8 +33,11 @@ template <typename BasisFunctionType, typename ResultType> class Context;
 template <typename BasisFunctionType, typename ResultType>
 class DenseGlobalAssembler {
 public:
+  typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
   typedef Fiber::LocalAssemblerForIntegralOperators<ResultType>
   LocalAssemblerForIntegralOperators;
+  typedef Fiber::LocalAssemblerForPotentialOperators<ResultType>
+  LocalAssemblerForPotentialOperators;
 
   static std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
   assembleDetachedWeakForm(
@@ -37,6 +45,18 @@ public:
       const Space<BasisFunctionType> &trialSpace,
       LocalAssemblerForIntegralOperators &assembler,
       const Context<BasisFunctionType, ResultType> &context);
+
+  /** \brief Assemble the dense matrix of a potential operator.
+   *
+   *  The (i * c + k, j)th element of the matrix is the kth component of the
+   *  potential generated at the ith column of \p points by the jth basis
+   *  function of \p trialSpace, c being the number of components of the
+   *  potential. */
+  static std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
+  assemblePotentialOperator(const arma::Mat<CoordinateType> &points,
+                            const Space<BasisFunctionType> &trialSpace,
+                            LocalAssemblerForPotentialOperators &localAssembler,
+                            const EvaluationOptions &options);
 };
 
 } // namespace Bempp
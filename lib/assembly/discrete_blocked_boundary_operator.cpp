@@ -32,12 +32,81 @@
 #include "../fiber/explicit_instantiation.hpp"
 
 #include <numeric>
+#include <tbb/parallel_for.h>
 #ifdef WITH_TRILINOS
 #include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 #endif // WITH_TRILINOS
 
 namespace Bempp {
 
+namespace {
+
+// Body of the parallel loop over block rows of the output vector
+
+template <typename ValueType> class BlockedApplyLoopBody {
+public:
+  typedef DiscreteBoundaryOperator<ValueType> Op;
+
+  BlockedApplyLoopBody(const Fiber::_2dArray<shared_ptr<const Op>> &blocks,
+                       bool transpose, TranspositionMode trans,
+                       const std::vector<size_t> &xCounts,
+                       const std::vector<size_t> &xStarts,
+                       const std::vector<size_t> &yCounts,
+                       const std::vector<size_t> &yStarts,
+                       const arma::Col<ValueType> &x_in,
+                       arma::Col<ValueType> &y_inout, ValueType alpha,
+                       ValueType beta)
+      : m_blocks(blocks), m_transpose(transpose), m_trans(trans),
+        m_xCounts(xCounts), m_xStarts(xStarts), m_yCounts(yCounts),
+        m_yStarts(yStarts), m_x_in(x_in), m_y_inout(y_inout), m_alpha(alpha),
+        m_beta(beta) {}
+
+  void operator()(const tbb::blocked_range<size_t> &r) const {
+    for (size_t yi = r.begin(); yi != r.end(); ++yi) {
+      // Non-owning views of the chunks of the input and output vectors
+      arma::Col<ValueType> y_chunk(m_y_inout.memptr() + m_yStarts[yi],
+                                   m_yCounts[yi], false /* copy_aux_mem */,
+                                   true /* strict */);
+      bool yInitialized = false;
+      for (size_t xi = 0; xi < m_xCounts.size(); ++xi) {
+        const shared_ptr<const Op> &op =
+            m_transpose ? m_blocks(xi, yi) : m_blocks(yi, xi);
+        if (!op)
+          continue;
+        const arma::Col<ValueType> x_chunk(
+            const_cast<ValueType *>(m_x_in.memptr()) + m_xStarts[xi],
+            m_xCounts[xi], false /* copy_aux_mem */, true /* strict */);
+        // The first nonzero block takes care of the "y := beta * y" part
+        op->apply(m_trans, x_chunk, y_chunk, m_alpha,
+                  yInitialized ? static_cast<ValueType>(1.) : m_beta);
+        yInitialized = true;
+      }
+      if (!yInitialized) {
+        if (m_beta == static_cast<ValueType>(0.))
+          y_chunk.fill(0.);
+        else
+          y_chunk *= m_beta;
+      }
+    }
+  }
+
+private:
+  const Fiber::_2dArray<shared_ptr<const Op>> &m_blocks;
+  bool m_transpose;
+  TranspositionMode m_trans;
+  const std::vector<size_t> &m_xCounts;
+  const std::vector<size_t> &m_xStarts;
+  const std::vector<size_t> &m_yCounts;
+  const std::vector<size_t> &m_yStarts;
+  const arma::Col<ValueType> &m_x_in;
+  // Each task writes to a different chunk of this vector
+  arma::Col<ValueType> &m_y_inout;
+  ValueType m_alpha;
+  ValueType m_beta;
+};
+
+} // namespace
+
 // Functions used in
 // DiscreteBlockBoundaryOperator::asDiscreteAcaBoundaryOperator().
 namespace {
@@ -487,6 +556,17 @@ DiscreteBlockedBoundaryOperator<ValueType>::DiscreteBlockedBoundaryOperator(
               toString(rowCounts[row]) + ", " + toString(columnCounts[col]) +
               ")");
       }
+
+  m_rowStarts.resize(m_rowCounts.size());
+  m_columnStarts.resize(m_columnCounts.size());
+  for (size_t row = 0, start = 0; row < m_rowCounts.size(); ++row) {
+    m_rowStarts[row] = start;
+    start += m_rowCounts[row];
+  }
+  for (size_t col = 0, start = 0; col < m_columnCounts.size(); ++col) {
+    m_columnStarts[col] = start;
+    start += m_columnCounts[col];
+  }
 #ifdef WITH_TRILINOS
   m_domainSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
       std::accumulate(m_columnCounts.begin(), m_columnCounts.end(), 0));
@@ -814,40 +894,21 @@ void DiscreteBlockedBoundaryOperator<ValueType>::applyBuiltInImpl(
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
   bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
-  size_t y_count = transpose ? m_columnCounts.size() : m_rowCounts.size();
-  size_t x_count = transpose ? m_rowCounts.size() : m_columnCounts.size();
-
-  for (int yi = 0, y_start = 0; yi < y_count; ++yi) {
-    size_t y_chunk_size = transpose ? m_columnCounts[yi] : m_rowCounts[yi];
-    arma::Col<ValueType> y_chunk(&y_inout[y_start], y_chunk_size,
-                                 false /* copy_aux_mem */);
-    for (int xi = 0, x_start = 0; xi < x_count; ++xi) {
-      size_t x_chunk_size = transpose ? m_rowCounts[xi] : m_columnCounts[xi];
-      shared_ptr<const Base> op =
-          transpose ? m_blocks(xi, yi) : m_blocks(yi, xi);
-      //            arma::Col<ValueType> x_chunk(&x_in[colStart],
-      // m_columnCounts[col],
-      //                                         false /* copy_aux_mem */);
-      if (xi == 0) {
-        // This branch ensures that the "y += beta * y" part is done
-        if (op)
-          //                    op->apply(trans, x_chunk, y_chunk, alpha, beta);
-          op->apply(trans, x_in.rows(x_start, x_start + x_chunk_size - 1),
-                    y_chunk, alpha, beta);
-        else {
-          if (beta == static_cast<ValueType>(0.))
-            y_chunk.fill(0.);
-          else
-            y_chunk *= beta;
-        }
-      } else if (op)
-        //                    op->apply(trans, x_chunk, y_chunk, alpha, 1.);
-        op->apply(trans, x_in.rows(x_start, x_start + x_chunk_size - 1),
-                  y_chunk, alpha, 1.);
-      x_start += x_chunk_size;
-    }
-    y_start += y_chunk_size;
-  }
+  const std::vector<size_t> &yCounts =
+      transpose ? m_columnCounts : m_rowCounts;
+  const std::vector<size_t> &xCounts =
+      transpose ? m_rowCounts : m_columnCounts;
+  const std::vector<size_t> &yStarts =
+      transpose ? m_columnStarts : m_rowStarts;
+  const std::vector<size_t> &xStarts =
+      transpose ? m_rowStarts : m_columnStarts;
+
+  // Block rows of the output vector are independent of each other and are
+  // processed concurrently
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, yCounts.size(), 1),
+                    BlockedApplyLoopBody<ValueType>(
+                        m_blocks, transpose, trans, xCounts, xStarts, yCounts,
+                        yStarts, x_in, y_inout, alpha, beta));
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteBlockedBoundaryOperator);
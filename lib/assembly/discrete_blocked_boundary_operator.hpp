@@ -146,6 +146,10 @@ private:
   Fiber::_2dArray<shared_ptr<const Base>> m_blocks;
   std::vector<size_t> m_rowCounts;
   std::vector<size_t> m_columnCounts;
+  // Offsets of the block rows and columns in the vectors the operator acts
+  // on
+  std::vector<size_t> m_rowStarts;
+  std::vector<size_t> m_columnStarts;
 #ifdef WITH_TRILINOS
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> m_domainSpace;
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> m_rangeSpace;
@@ -27,11 +27,14 @@
 #include "discrete_boundary_operator_composition.hpp"
 #include "scaled_discrete_boundary_operator.hpp"
 #include "transposed_discrete_boundary_operator.hpp"
+#include "../common/assembly_profile.hpp"
 #include "../common/shared_ptr.hpp"
 
 #include "../fiber/explicit_instantiation.hpp"
 
 #include <Thyra_DetachedSpmdVectorView.hpp>
+#include <Thyra_SpmdMultiVectorBase.hpp>
+#include <Thyra_SpmdVectorSpaceBase.hpp>
 
 namespace Bempp {
 
@@ -74,6 +77,14 @@ void DiscreteBoundaryOperator<ValueType>::apply(
                                 "vectors x_in and y_inout must have "
                                 "the same number of columns");
 
+  applyBuiltInMultiImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteBoundaryOperator<ValueType>::applyBuiltInMultiImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
   for (size_t i = 0; i < x_in.n_cols; ++i) {
     const arma::Col<ValueType> x_in_col = x_in.unsafe_col(i);
     arma::Col<ValueType> y_inout_col = y_inout.unsafe_col(i);
@@ -103,6 +114,18 @@ void DiscreteBoundaryOperator<ValueType>::dump() const {
   std::cout << asMatrix() << std::endl;
 }
 
+template <typename ValueType>
+shared_ptr<const AssemblyProfile>
+DiscreteBoundaryOperator<ValueType>::assemblyProfile() const {
+  return m_assemblyProfile;
+}
+
+template <typename ValueType>
+void DiscreteBoundaryOperator<ValueType>::setAssemblyProfile(
+    const shared_ptr<const AssemblyProfile> &profile) {
+  m_assemblyProfile = profile;
+}
+
 #ifdef WITH_TRILINOS
 template <typename ValueType>
 void DiscreteBoundaryOperator<ValueType>::applyImpl(
@@ -122,6 +145,40 @@ void DiscreteBoundaryOperator<ValueType>::applyImpl(
 
   const Ordinal colCount = X_in.domain()->dim();
 
+  // If both multivectors are stored contiguously, pass all columns to
+  // applyBuiltInMultiImpl() at once, so that operators able to process
+  // several vectors in one sweep (e.g. H-matrices) can do so. The local data
+  // of SPMD multivectors are accessed directly; detached column views are
+  // only used below for other multivectors.
+  if (colCount > 1) {
+    typedef Thyra::SpmdMultiVectorBase<ValueType> SpmdMultiVector;
+    const SpmdMultiVector *xSpmd =
+        dynamic_cast<const SpmdMultiVector *>(&X_in);
+    SpmdMultiVector *ySpmd = dynamic_cast<SpmdMultiVector *>(Y_inout.get());
+    if (xSpmd && ySpmd) {
+      Teuchos::ArrayRCP<const ValueType> xValues;
+      Teuchos::ArrayRCP<ValueType> yValues;
+      Ordinal xLeadingDim, yLeadingDim;
+      xSpmd->getLocalData(Teuchos::outArg(xValues),
+                          Teuchos::outArg(xLeadingDim));
+      ySpmd->getNonconstLocalData(Teuchos::outArg(yValues),
+                                  Teuchos::outArg(yLeadingDim));
+      const Ordinal xRowCount = xSpmd->spmdSpace()->localSubDim();
+      const Ordinal yRowCount = ySpmd->spmdSpace()->localSubDim();
+      if (xLeadingDim == xRowCount && yLeadingDim == yRowCount) {
+        // const_cast: see the comment in the loop below
+        const arma::Mat<ValueType> xMat(
+            const_cast<ValueType *>(xValues.get()), xRowCount, colCount,
+            false /* copy_aux_mem */);
+        arma::Mat<ValueType> yMat(yValues.get(), yRowCount, colCount,
+                                  false /* copy_aux_mem */);
+        applyBuiltInMultiImpl(static_cast<TranspositionMode>(M_trans), xMat,
+                              yMat, alpha, beta);
+        return;
+      }
+    }
+  }
+
   // Loop over the input columns
 
   for (Ordinal col = 0; col < colCount; ++col) {
@@ -41,6 +41,10 @@
 
 namespace Bempp {
 
+/** \cond FORWARD_DECL */
+class AssemblyProfile;
+/** \endcond */
+
 /** \ingroup discrete_boundary_operators
  *  \brief Discrete boundary operator.
  *
@@ -196,6 +200,15 @@ public:
   /** \brief Number of columns of the operator. */
   virtual unsigned int columnCount() const = 0;
 
+  /** \brief Profile of the assembly of this operator.
+   *
+   *  Returns a null pointer if the operator was not produced by an assembler
+   *  recording profiles. */
+  shared_ptr<const AssemblyProfile> assemblyProfile() const;
+
+  /** \brief Attach the profile of the assembly of this operator. */
+  void setAssemblyProfile(const shared_ptr<const AssemblyProfile> &profile);
+
   /** \brief Add a subblock of this operator to a matrix.
    *
    *  Perform the operation <tt>block += alpha * L[rows, cols]</tt>,
@@ -234,6 +247,19 @@ private:
                                 arma::Col<ValueType> &y_inout,
                                 const ValueType alpha,
                                 const ValueType beta) const = 0;
+
+  /** \brief Apply the operator to all columns of \p x_in.
+   *
+   *  Called by apply() for multivectors. The default implementation calls
+   *  applyBuiltInImpl() for each column in turn; operators that can process
+   *  several vectors in a single pass over their data should override it. */
+  virtual void applyBuiltInMultiImpl(const TranspositionMode trans,
+                                     const arma::Mat<ValueType> &x_in,
+                                     arma::Mat<ValueType> &y_inout,
+                                     const ValueType alpha,
+                                     const ValueType beta) const;
+
+  shared_ptr<const AssemblyProfile> m_assemblyProfile;
 };
 
 /** \relates DiscreteBoundaryOperator
@@ -104,6 +104,22 @@ void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  applyToMatrix(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInMultiImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  applyToMatrix(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteDenseBoundaryOperator<ValueType>::applyToMatrix(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
   if (beta == static_cast<ValueType>(0.))
     y_inout.fill(static_cast<ValueType>(0.));
   else
@@ -74,6 +74,15 @@ private:
                                 arma::Col<ValueType> &y_inout,
                                 const ValueType alpha,
                                 const ValueType beta) const;
+  virtual void applyBuiltInMultiImpl(const TranspositionMode trans,
+                                     const arma::Mat<ValueType> &x_in,
+                                     arma::Mat<ValueType> &y_inout,
+                                     const ValueType alpha,
+                                     const ValueType beta) const;
+  void applyToMatrix(const TranspositionMode trans,
+                     const arma::Mat<ValueType> &x_in,
+                     arma::Mat<ValueType> &y_inout, const ValueType alpha,
+                     const ValueType beta) const;
 
 private:
   /** \cond PRIVATE */
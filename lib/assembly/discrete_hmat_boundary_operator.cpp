@@ -25,6 +25,21 @@
 
 namespace Bempp {
 
+namespace {
+
+hmat::TransposeMode hmatTransposeMode(TranspositionMode trans) {
+  if (trans == TranspositionMode::NO_TRANSPOSE)
+    return hmat::NOTRANS;
+  else if (trans == TranspositionMode::TRANSPOSE)
+    return hmat::TRANS;
+  else if (trans == TranspositionMode::CONJUGATE)
+    return hmat::CONJ;
+  else
+    return hmat::CONJTRANS;
+}
+
+} // namespace
+
 template <typename ValueType>
 DiscreteHMatBoundaryOperator<ValueType>::DiscreteHMatBoundaryOperator(
     const shared_ptr<hmat::CompressedMatrix<ValueType>> &compressedMatrix)
@@ -48,6 +63,23 @@ unsigned int DiscreteHMatBoundaryOperator<ValueType>::columnCount() const {
       m_compressedMatrix->columns());
 }
 
+template <typename ValueType>
+double DiscreteHMatBoundaryOperator<ValueType>::memSizeKb() const {
+  return m_compressedMatrix->memSizeKb();
+}
+
+template <typename ValueType>
+hmat::HMatrixStatistics DiscreteHMatBoundaryOperator<ValueType>::statistics(
+    std::size_t numberOfLargestBlocks) const {
+  return m_compressedMatrix->statistics(numberOfLargestBlocks);
+}
+
+template <typename ValueType>
+shared_ptr<const hmat::CompressedMatrix<ValueType>>
+DiscreteHMatBoundaryOperator<ValueType>::compressedMatrix() const {
+  return m_compressedMatrix;
+}
+
 template <typename ValueType>
 void DiscreteHMatBoundaryOperator<ValueType>::addBlock(
     const std::vector<int> &rows, const std::vector<int> &cols,
@@ -58,17 +90,17 @@ void DiscreteHMatBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  m_compressedMatrix->apply(x_in, y_inout, hmatTransposeMode(trans), alpha,
+                            beta);
+}
 
-  hmat::TransposeMode hmatTrans;
-  if (trans == TranspositionMode::NO_TRANSPOSE)
-    hmatTrans = hmat::NOTRANS;
-  else if (trans == TranspositionMode::TRANSPOSE)
-    hmatTrans = hmat::TRANS;
-  else if (trans == TranspositionMode::CONJUGATE)
-    hmatTrans = hmat::CONJ;
-  else
-    hmatTrans = hmat::CONJTRANS;
-  m_compressedMatrix->apply(x_in, y_inout, hmatTrans, alpha, beta);
+template <typename ValueType>
+void DiscreteHMatBoundaryOperator<ValueType>::applyBuiltInMultiImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  m_compressedMatrix->apply(x_in, y_inout, hmatTransposeMode(trans), alpha,
+                            beta);
 }
 
 template <typename ValueType>
@@ -26,6 +26,7 @@
 #include "../common/shared_ptr.hpp"
 #include "discrete_boundary_operator.hpp"
 #include "../common/armadillo_fwd.hpp"
+#include "../hmat/hmatrix_statistics.hpp"
 #include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 
 namespace hmat {
@@ -54,6 +55,21 @@ public:
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> domain() const;
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> range() const;
 
+  /** \brief Memory taken by the compressed matrix. */
+  double memSizeKb() const;
+
+  /** \brief Memory and compression statistics of the compressed matrix.
+   *
+   *  \p numberOfLargestBlocks is the number of blocks, taking the most
+   *  memory, listed in the \p largestBlocks member of the result. Error
+   *  estimates are available only if the operator was assembled with the
+   *  "estimateBlockErrors" H-matrix parameter set. */
+  hmat::HMatrixStatistics statistics(std::size_t numberOfLargestBlocks = 10)
+      const;
+
+  /** \brief The compressed matrix represented by this operator. */
+  shared_ptr<const hmat::CompressedMatrix<ValueType>> compressedMatrix() const;
+
 protected:
   bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
 
@@ -63,6 +79,13 @@ private:
                         arma::Col<ValueType> &y_inout, const ValueType alpha,
                         const ValueType beta) const override;
 
+  // Applies the H-matrix to all columns in a single pass over its blocks
+  void applyBuiltInMultiImpl(const TranspositionMode trans,
+                             const arma::Mat<ValueType> &x_in,
+                             arma::Mat<ValueType> &y_inout,
+                             const ValueType alpha,
+                             const ValueType beta) const override;
+
   shared_ptr<hmat::CompressedMatrix<ValueType>> m_compressedMatrix;
 
   Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_domainSpace;
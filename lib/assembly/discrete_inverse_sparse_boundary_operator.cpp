@@ -237,7 +237,6 @@ void DiscreteInverseSparseBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
-  // TODO: protect with a mutex (this function is not thread-safe)
   if (trans != NO_TRANSPOSE)
     throw std::invalid_argument("DiscreteInverseSparseBoundaryOperator::"
                                 "applyBuiltInImpl(): "
@@ -249,7 +248,10 @@ void DiscreteInverseSparseBoundaryOperator<ValueType>::applyBuiltInImpl(
                                 "incorrect vector lengths");
   arma::Col<ValueType> solution(dim);
   solution.fill(0.);
-  solveWithAmesos(*m_problem, *m_solver, solution, x_in);
+  {
+    tbb::mutex::scoped_lock lock(m_solverMutex);
+    solveWithAmesos(*m_problem, *m_solver, solution, x_in);
+  }
   if (beta == static_cast<ValueType>(0.))
     y_inout = alpha * solution;
   else {
@@ -263,6 +265,9 @@ shared_ptr<const DiscreteBoundaryOperator<ValueType>> discreteSparseInverse(
     const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &discreteOp) {
   shared_ptr<const DiscreteSparseBoundaryOperator<ValueType>> sparseOp =
       DiscreteSparseBoundaryOperator<ValueType>::castToSparse(discreteOp);
+  if (sparseOp->epetraImaginaryMatrix())
+    throw std::runtime_error("discreteSparseInverse(): sparse matrices with an "
+                             "imaginary part are not supported yet");
 
   shared_ptr<const DiscreteBoundaryOperator<ValueType>> op(
       new DiscreteInverseSparseBoundaryOperator<ValueType>(
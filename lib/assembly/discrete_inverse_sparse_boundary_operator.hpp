@@ -33,6 +33,7 @@
 
 #include <memory>
 
+#include <tbb/mutex.h>
 #include <Teuchos_RCP.hpp>
 #include <Thyra_SpmdVectorSpaceBase_decl.hpp>
 
@@ -93,6 +94,8 @@ private:
   Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_space;
   int m_symmetry;
   std::unique_ptr<Amesos_BaseSolver> m_solver;
+  // Amesos solvers are not thread-safe
+  mutable tbb::mutex m_solverMutex;
   /** \endcond */
 };
 
@@ -0,0 +1,300 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "discrete_matrix_free_boundary_operator.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+#include "../fiber/serial_blas_region.hpp"
+#include "../hmat/cluster_tree.hpp"
+
+#include <boost/numeric/conversion/converter.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Bempp {
+
+template <typename ValueType>
+DiscreteMatrixFreeBoundaryOperator<ValueType>::
+    DiscreteMatrixFreeBoundaryOperator(
+        const shared_ptr<const hmat::DefaultBlockClusterTreeType> &
+            blockClusterTree,
+        const hmat::DataAccessor<ValueType, 2> &nearFieldAccessor,
+        const shared_ptr<const hmat::DataAccessor<ValueType, 2>> &
+            farFieldAccessor,
+        const ParallelizationOptions &parallelizationOptions)
+    : m_blockClusterTree(blockClusterTree),
+      m_farFieldAccessor(farFieldAccessor),
+      m_parallelizationOptions(parallelizationOptions),
+      m_nearFieldBlockCount(0) {
+  if (!m_blockClusterTree)
+    throw std::invalid_argument("DiscreteMatrixFreeBoundaryOperator::"
+                                "DiscreteMatrixFreeBoundaryOperator(): "
+                                "blockClusterTree must not be null");
+  if (!m_farFieldAccessor)
+    throw std::invalid_argument("DiscreteMatrixFreeBoundaryOperator::"
+                                "DiscreteMatrixFreeBoundaryOperator(): "
+                                "farFieldAccessor must not be null");
+
+  const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &
+      leafNodes = m_blockClusterTree->leafNodes();
+  m_rowTargets = makeTargetClusters(*m_blockClusterTree->rowClusterTree(),
+                                    leafNodes, true /* byRows */);
+  m_columnTargets =
+      makeTargetClusters(*m_blockClusterTree->columnClusterTree(), leafNodes,
+                         false /* byRows */);
+  m_domainSpace =
+      Thyra::defaultSpmdVectorSpace<ValueType>(m_blockClusterTree->columns());
+  m_rangeSpace =
+      Thyra::defaultSpmdVectorSpace<ValueType>(m_blockClusterTree->rows());
+
+  m_nearFieldBlocks.resize(leafNodes.size());
+  for (std::size_t i = 0; i < leafNodes.size(); ++i)
+    if (!leafNodes[i]->data().admissible)
+      ++m_nearFieldBlockCount;
+
+  tbb::task_scheduler_init scheduler(maxThreadCount());
+  Fiber::SerialBlasRegion region;
+  tbb::parallel_for(
+      tbb::blocked_range<std::size_t>(0, leafNodes.size()),
+      [&](const tbb::blocked_range<std::size_t> &r) {
+        for (std::size_t i = r.begin(); i != r.end(); ++i) {
+          const hmat::BlockClusterTreeNodeData<2> &data =
+              leafNodes[i]->data();
+          if (data.admissible)
+            continue;
+          nearFieldAccessor.computeMatrixBlock(
+              data.rowClusterTreeNode->data().indexRange,
+              data.columnClusterTreeNode->data().indexRange, *leafNodes[i],
+              m_nearFieldBlocks[i]);
+        }
+      });
+}
+
+template <typename ValueType>
+typename DiscreteMatrixFreeBoundaryOperator<ValueType>::TargetClusters
+DiscreteMatrixFreeBoundaryOperator<ValueType>::makeTargetClusters(
+    const hmat::DefaultClusterTreeType &clusterTree,
+    const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &
+        leafNodes,
+    bool byRows) {
+  TargetClusters result;
+  const std::vector<shared_ptr<const hmat::DefaultClusterTreeNodeType>>
+      clusterLeaves = clusterTree.leafNodes();
+  for (std::size_t i = 0; i < clusterLeaves.size(); ++i)
+    result.indexRanges.push_back(clusterLeaves[i]->data().indexRange);
+  std::sort(result.indexRanges.begin(), result.indexRanges.end());
+  result.blocks.resize(result.indexRanges.size());
+
+  // The leaves of a cluster tree partition its index range, and the output
+  // range of each block is the union of the ranges of some of them
+  for (std::size_t i = 0; i < leafNodes.size(); ++i) {
+    const hmat::BlockClusterTreeNodeData<2> &data = leafNodes[i]->data();
+    const hmat::IndexRangeType &range =
+        byRows ? data.rowClusterTreeNode->data().indexRange
+               : data.columnClusterTreeNode->data().indexRange;
+    auto target = std::lower_bound(
+        result.indexRanges.begin(), result.indexRanges.end(), range[0],
+        [](const hmat::IndexRangeType &targetRange, std::size_t index) {
+          return targetRange[0] < index;
+        });
+    for (; target != result.indexRanges.end() && (*target)[0] < range[1];
+         ++target)
+      result.blocks[target - result.indexRanges.begin()].push_back(i);
+  }
+  return result;
+}
+
+template <typename ValueType>
+int DiscreteMatrixFreeBoundaryOperator<ValueType>::maxThreadCount() const {
+  if (m_parallelizationOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+    return tbb::task_scheduler_init::automatic;
+  return m_parallelizationOptions.maxThreadCount();
+}
+
+template <typename ValueType>
+unsigned int DiscreteMatrixFreeBoundaryOperator<ValueType>::rowCount() const {
+  return boost::numeric::converter<unsigned int, std::size_t>::convert(
+      m_blockClusterTree->rows());
+}
+
+template <typename ValueType>
+unsigned int
+DiscreteMatrixFreeBoundaryOperator<ValueType>::columnCount() const {
+  return boost::numeric::converter<unsigned int, std::size_t>::convert(
+      m_blockClusterTree->columns());
+}
+
+template <typename ValueType>
+double DiscreteMatrixFreeBoundaryOperator<ValueType>::memSizeKb() const {
+  double result = 0;
+  for (std::size_t i = 0; i < m_nearFieldBlocks.size(); ++i)
+    result += m_nearFieldBlocks[i].n_elem * sizeof(ValueType);
+  return result / 1024;
+}
+
+template <typename ValueType>
+std::size_t
+DiscreteMatrixFreeBoundaryOperator<ValueType>::nearFieldBlockCount() const {
+  return m_nearFieldBlockCount;
+}
+
+template <typename ValueType>
+std::size_t
+DiscreteMatrixFreeBoundaryOperator<ValueType>::farFieldBlockCount() const {
+  return m_nearFieldBlocks.size() - m_nearFieldBlockCount;
+}
+
+template <typename ValueType>
+void DiscreteMatrixFreeBoundaryOperator<ValueType>::addBlock(
+    const std::vector<int> &rows, const std::vector<int> &cols,
+    const ValueType alpha, arma::Mat<ValueType> &block) const {
+  throw std::runtime_error("DiscreteMatrixFreeBoundaryOperator::"
+                           "addBlock(): not implemented");
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+DiscreteMatrixFreeBoundaryOperator<ValueType>::domain() const {
+  return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+DiscreteMatrixFreeBoundaryOperator<ValueType>::range() const {
+  return m_rangeSpace;
+}
+
+template <typename ValueType>
+bool DiscreteMatrixFreeBoundaryOperator<ValueType>::opSupportedImpl(
+    Thyra::EOpTransp M_trans) const {
+  return (M_trans == Thyra::NOTRANS || M_trans == Thyra::CONJ ||
+          M_trans == Thyra::TRANS || M_trans == Thyra::CONJTRANS);
+}
+
+template <typename ValueType>
+void DiscreteMatrixFreeBoundaryOperator<ValueType>::applyBuiltInImpl(
+    const TranspositionMode trans, const arma::Col<ValueType> &x_in,
+    arma::Col<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  applyBuiltInMultiImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteMatrixFreeBoundaryOperator<ValueType>::applyBuiltInMultiImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  const bool transposed = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+  const hmat::DefaultClusterTreeType &inputTree =
+      transposed ? *m_blockClusterTree->rowClusterTree()
+                 : *m_blockClusterTree->columnClusterTree();
+  const hmat::DefaultClusterTreeType &outputTree =
+      transposed ? *m_blockClusterTree->columnClusterTree()
+                 : *m_blockClusterTree->rowClusterTree();
+  const TargetClusters &targets = transposed ? m_columnTargets : m_rowTargets;
+  const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &
+      leafNodes = m_blockClusterTree->leafNodes();
+  const std::size_t colCount = x_in.n_cols;
+
+  arma::Mat<ValueType> xPermuted(x_in.n_rows, colCount);
+  for (std::size_t i = 0; i < x_in.n_rows; ++i) {
+    const std::size_t hMatDof = inputTree.mapOriginalDofToHMatDof(i);
+    for (std::size_t j = 0; j < colCount; ++j)
+      xPermuted(hMatDof, j) = x_in(i, j);
+  }
+  arma::Mat<ValueType> yPermuted(outputTree.numberOfDofs(), colCount);
+
+  // Each task writes only the rows of yPermuted of its own target cluster
+  tbb::task_scheduler_init scheduler(maxThreadCount());
+  Fiber::SerialBlasRegion region;
+  tbb::parallel_for(
+      tbb::blocked_range<std::size_t>(0, targets.indexRanges.size()),
+      [&](const tbb::blocked_range<std::size_t> &r) {
+        arma::Mat<ValueType> piece;
+        for (std::size_t t = r.begin(); t != r.end(); ++t) {
+          const hmat::IndexRangeType &targetRange = targets.indexRanges[t];
+          arma::Mat<ValueType> targetResult(targetRange[1] - targetRange[0],
+                                            colCount);
+          targetResult.fill(0.);
+          for (std::size_t b = 0; b < targets.blocks[t].size(); ++b) {
+            const std::size_t leaf = targets.blocks[t][b];
+            const hmat::BlockClusterTreeNodeData<2> &data =
+                leafNodes[leaf]->data();
+            const hmat::IndexRangeType &rowRange =
+                data.rowClusterTreeNode->data().indexRange;
+            const hmat::IndexRangeType &columnRange =
+                data.columnClusterTreeNode->data().indexRange;
+
+            // Rows (or columns, if transposed) of the block lying in the
+            // target cluster
+            if (!data.admissible) {
+              const arma::Mat<ValueType> &block = m_nearFieldBlocks[leaf];
+              if (transposed)
+                piece = block.cols(targetRange[0] - columnRange[0],
+                                   targetRange[1] - columnRange[0] - 1);
+              else
+                piece = block.rows(targetRange[0] - rowRange[0],
+                                   targetRange[1] - rowRange[0] - 1);
+            } else
+              m_farFieldAccessor->computeMatrixBlock(
+                  transposed ? rowRange : targetRange,
+                  transposed ? targetRange : columnRange, *leafNodes[leaf],
+                  piece);
+
+            const hmat::IndexRangeType &inputRange =
+                transposed ? rowRange : columnRange;
+            const arma::subview<ValueType> xData =
+                xPermuted.rows(inputRange[0], inputRange[1] - 1);
+            switch (trans) {
+            case NO_TRANSPOSE:
+              targetResult += piece * xData;
+              break;
+            case CONJUGATE:
+              targetResult += arma::conj(piece) * xData;
+              break;
+            case TRANSPOSE:
+              targetResult += piece.st() * xData;
+              break;
+            default: // CONJUGATE_TRANSPOSE
+              targetResult += piece.t() * xData;
+            }
+          }
+          yPermuted.rows(targetRange[0], targetRange[1] - 1) = targetResult;
+        }
+      });
+
+  if (beta == static_cast<ValueType>(0.))
+    y_inout.fill(static_cast<ValueType>(0.));
+  else
+    y_inout *= beta;
+  for (std::size_t i = 0; i < yPermuted.n_rows; ++i) {
+    const std::size_t originalDof = outputTree.mapHMatDofToOriginalDof(i);
+    for (std::size_t j = 0; j < colCount; ++j)
+      y_inout(originalDof, j) += alpha * yPermuted(i, j);
+  }
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteMatrixFreeBoundaryOperator);
+
+} // namespace Bempp
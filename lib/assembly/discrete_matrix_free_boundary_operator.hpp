@@ -0,0 +1,154 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_discrete_matrix_free_boundary_operator_hpp
+#define bempp_discrete_matrix_free_boundary_operator_hpp
+
+#include "bempp/common/config_trilinos.hpp"
+#include "../common/common.hpp"
+
+#include "assembly_options.hpp"
+#include "discrete_boundary_operator.hpp"
+#include "../common/armadillo_fwd.hpp"
+#include "../common/shared_ptr.hpp"
+#include "../hmat/block_cluster_tree.hpp"
+#include "../hmat/data_accessor.hpp"
+
+#include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
+
+#include <vector>
+
+namespace Bempp {
+
+/** \ingroup discrete_boundary_operators
+ *  \brief Discrete boundary operator whose far field is recomputed on the fly.
+ *
+ *  The blocks of the operator are defined by a block cluster tree, as for
+ *  an H-matrix. Only the inadmissible (near-field) blocks are evaluated
+ *  once and stored; the admissible (far-field) blocks are evaluated anew,
+ *  through a data accessor, each time the operator is applied and
+ *  discarded immediately afterwards. The memory taken by the operator is
+ *  therefore that of its near field and cluster trees only, at the price of
+ *  much slower matrix-vector products.
+ *
+ *  Applications are parallelized over the leaves of the cluster tree of the
+ *  output space: each task computes the part of the result belonging to one
+ *  target cluster, evaluating only the rows (or, for transposed products,
+ *  columns) of the far-field blocks that it needs. */
+template <typename ValueType>
+class DiscreteMatrixFreeBoundaryOperator
+    : public DiscreteBoundaryOperator<ValueType> {
+public:
+  /** \brief Constructor.
+   *
+   *  \param[in] blockClusterTree
+   *    Block cluster tree defining the near and far field.
+   *  \param[in] nearFieldAccessor
+   *    Accessor used to evaluate the inadmissible blocks. It is used only by
+   *    the constructor.
+   *  \param[in] farFieldAccessor
+   *    Accessor used to evaluate the admissible blocks during each
+   *    application of the operator. It must be safe to call from several
+   *    threads at once.
+   *  \param[in] parallelizationOptions
+   *    Options controlling the number of threads used by the constructor
+   *    and by matrix-vector products.
+   *
+   *  Both accessors work in the H-matrix ordering of dofs defined by the
+   *  cluster trees. */
+  DiscreteMatrixFreeBoundaryOperator(
+      const shared_ptr<const hmat::DefaultBlockClusterTreeType> &
+          blockClusterTree,
+      const hmat::DataAccessor<ValueType, 2> &nearFieldAccessor,
+      const shared_ptr<const hmat::DataAccessor<ValueType, 2>> &
+          farFieldAccessor,
+      const ParallelizationOptions &parallelizationOptions);
+
+  unsigned int rowCount() const override;
+
+  unsigned int columnCount() const override;
+
+  void addBlock(const std::vector<int> &rows, const std::vector<int> &cols,
+                const ValueType alpha, arma::Mat<ValueType> &block) const
+      override;
+
+  Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> domain() const;
+  Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> range() const;
+
+  /** \brief Memory taken by the stored near-field blocks. */
+  double memSizeKb() const;
+
+  /** \brief Number of stored (inadmissible) blocks. */
+  std::size_t nearFieldBlockCount() const;
+
+  /** \brief Number of admissible blocks evaluated during each application
+   *  of the operator. */
+  std::size_t farFieldBlockCount() const;
+
+protected:
+  bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+
+private:
+  void applyBuiltInImpl(const TranspositionMode trans,
+                        const arma::Col<ValueType> &x_in,
+                        arma::Col<ValueType> &y_inout, const ValueType alpha,
+                        const ValueType beta) const override;
+
+  void applyBuiltInMultiImpl(const TranspositionMode trans,
+                             const arma::Mat<ValueType> &x_in,
+                             arma::Mat<ValueType> &y_inout,
+                             const ValueType alpha,
+                             const ValueType beta) const override;
+
+  /** \cond PRIVATE */
+  // For each leaf of a cluster tree (a target cluster), the indices of the
+  // leaves of the block cluster tree whose output range contains it
+  struct TargetClusters {
+    std::vector<hmat::IndexRangeType> indexRanges;
+    std::vector<std::vector<std::size_t>> blocks;
+  };
+
+  static TargetClusters
+  makeTargetClusters(const hmat::DefaultClusterTreeType &clusterTree,
+                     const std::vector<const hmat::DefaultBlockClusterTreeNodeType
+                                           *> &leafNodes,
+                     bool byRows);
+
+  int maxThreadCount() const;
+
+  shared_ptr<const hmat::DefaultBlockClusterTreeType> m_blockClusterTree;
+  shared_ptr<const hmat::DataAccessor<ValueType, 2>> m_farFieldAccessor;
+  ParallelizationOptions m_parallelizationOptions;
+
+  // Indexed by leaf number; empty for admissible leaves
+  std::vector<arma::Mat<ValueType>> m_nearFieldBlocks;
+  std::size_t m_nearFieldBlockCount;
+
+  TargetClusters m_rowTargets;
+  TargetClusters m_columnTargets;
+
+  Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_domainSpace;
+  Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_rangeSpace;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
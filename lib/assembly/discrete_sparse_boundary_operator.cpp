@@ -33,6 +33,8 @@
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/parallelization_options.hpp"
 
+#include <boost/type_traits/is_complex.hpp>
+#include <complex>
 #include <iostream>
 #include <stdexcept>
 
@@ -176,6 +178,83 @@ void reallyApplyBuiltInImpl<std::complex<double>>(
     y_inout(i) = std::complex<double>(y_real(i), y_imag(i));
 }
 
+// Value of the entry i * value of a matrix; only complex matrices may have
+// an imaginary part
+template <typename ValueType> struct ImaginaryEntry {
+  static ValueType value(double) {
+    throw std::logic_error("ImaginaryEntry::value(): real matrices "
+                           "cannot have an imaginary part");
+  }
+};
+
+template <typename CoordinateType>
+struct ImaginaryEntry<std::complex<CoordinateType>> {
+  static std::complex<CoordinateType> value(double value) {
+    return std::complex<CoordinateType>(0., value);
+  }
+};
+
+// Add factor * mat (transposed if requested) to result
+template <typename ValueType>
+void addMatrixEntries(const Epetra_CrsMatrix &mat, bool transposed,
+                      ValueType factor, arma::Mat<ValueType> &result) {
+  const int untransposedRowCount = mat.NumGlobalRows();
+  for (int row = 0; row < untransposedRowCount; ++row) {
+    int entryCount = 0;
+    double *values = 0;
+    int *indices = 0;
+    int errorCode = mat.ExtractMyRowView(row, entryCount, values, indices);
+    if (errorCode != 0)
+      throw std::runtime_error("DiscreteSparseBoundaryOperator::asMatrix(): "
+                               "Epetra_CrsMatrix::ExtractMyRowView()) failed");
+    if (transposed)
+      for (int entry = 0; entry < entryCount; ++entry)
+        result(indices[entry], row) +=
+            factor * static_cast<ValueType>(values[entry]);
+    else
+      for (int entry = 0; entry < entryCount; ++entry)
+        result(row, indices[entry]) +=
+            factor * static_cast<ValueType>(values[entry]);
+  }
+}
+
+// Add factor * (the rows untransposedRows of mat) to block
+template <typename ValueType>
+void addMatrixBlock(const Epetra_CrsMatrix &mat,
+                    const std::vector<int> &untransposedRows,
+                    const std::vector<int> &untransposedCols,
+                    const std::vector<int> &cols, bool transposed,
+                    ValueType factor, arma::Mat<ValueType> &block) {
+  int entryCount = 0;
+  double *values = 0;
+  int *indices = 0;
+
+  for (size_t row = 0; row < untransposedRows.size(); ++row) {
+    // Provision for future MPI support.
+    if (mat.IndicesAreLocal()) {
+      int errorCode = mat.ExtractMyRowView(untransposedRows[row], entryCount,
+                                           values, indices);
+      if (errorCode != 0)
+        throw std::runtime_error(
+            "DiscreteSparseBoundaryOperator::addBlock(): "
+            "Epetra_CrsMatrix::ExtractMyRowView()) failed");
+    } else {
+      int errorCode = mat.ExtractGlobalRowView(untransposedRows[row],
+                                               entryCount, values, indices);
+      if (errorCode != 0)
+        throw std::runtime_error(
+            "DiscreteSparseBoundaryOperator::addBlock(): "
+            "Epetra_CrsMatrix::ExtractGlobalRowView()) failed");
+    }
+
+    for (size_t col = 0; col < untransposedCols.size(); ++col)
+      for (int entry = 0; entry < entryCount; ++entry)
+        if (indices[entry] == cols[col])
+          block(transposed ? col : row, transposed ? row : col) +=
+              factor * static_cast<ValueType>(values[entry]);
+  }
+}
+
 } // namespace
 
 template <typename ValueType>
@@ -193,12 +272,42 @@ DiscreteSparseBoundaryOperator<ValueType>::DiscreteSparseBoundaryOperator(
       isTransposed() ? m_mat->NumGlobalCols() : m_mat->NumGlobalRows());
 }
 
+template <typename ValueType>
+DiscreteSparseBoundaryOperator<ValueType>::DiscreteSparseBoundaryOperator(
+    const shared_ptr<const Epetra_CrsMatrix> &realMat,
+    const shared_ptr<const Epetra_CrsMatrix> &imagMat, int symmetry,
+    TranspositionMode trans, const shared_ptr<AhmedBemBlcluster> &blockCluster,
+    const shared_ptr<IndexPermutation> &domainPermutation,
+    const shared_ptr<IndexPermutation> &rangePermutation)
+    : m_mat(realMat), m_imagMat(imagMat), m_symmetry(symmetry),
+      m_trans(trans), m_blockCluster(blockCluster),
+      m_domainPermutation(domainPermutation),
+      m_rangePermutation(rangePermutation) {
+  if (m_imagMat) {
+    if (!boost::is_complex<ValueType>::value)
+      throw std::invalid_argument(
+          "DiscreteSparseBoundaryOperator::DiscreteSparseBoundaryOperator(): "
+          "real operators cannot have an imaginary part");
+    if (m_imagMat->NumGlobalRows() != m_mat->NumGlobalRows() ||
+        m_imagMat->NumGlobalCols() != m_mat->NumGlobalCols())
+      throw std::invalid_argument(
+          "DiscreteSparseBoundaryOperator::DiscreteSparseBoundaryOperator(): "
+          "real and imaginary parts must have the same dimensions");
+  }
+  m_domainSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
+      isTransposed() ? m_mat->NumGlobalRows() : m_mat->NumGlobalCols());
+  m_rangeSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
+      isTransposed() ? m_mat->NumGlobalCols() : m_mat->NumGlobalRows());
+}
+
 template <typename ValueType>
 void DiscreteSparseBoundaryOperator<ValueType>::dump() const {
   if (isTransposed())
     std::cout << "Transpose of " << *m_mat << std::endl;
   else
     std::cout << *m_mat << std::endl;
+  if (m_imagMat)
+    std::cout << "Imaginary part:\n" << *m_imagMat << std::endl;
 }
 
 template <typename ValueType>
@@ -210,24 +319,14 @@ DiscreteSparseBoundaryOperator<ValueType>::asMatrix() const {
         "conversion of distributed matrices to local matrices is unsupported");
 
   bool transposed = isTransposed();
-  const int untransposedRowCount = m_mat->NumGlobalRows();
   arma::Mat<ValueType> mat(rowCount(), columnCount());
   mat.fill(0.);
-  for (int row = 0; row < untransposedRowCount; ++row) {
-    int entryCount = 0;
-    double *values = 0;
-    int *indices = 0;
-    int errorCode = m_mat->ExtractMyRowView(row, entryCount, values, indices);
-    if (errorCode != 0)
-      throw std::runtime_error("DiscreteSparseBoundaryOperator::asMatrix(): "
-                               "Epetra_CrsMatrix::ExtractMyRowView()) failed");
-    if (transposed)
-      for (int entry = 0; entry < entryCount; ++entry)
-        mat(indices[entry], row) = values[entry];
-    else
-      for (int entry = 0; entry < entryCount; ++entry)
-        mat(row, indices[entry]) = values[entry];
-  }
+  addMatrixEntries(*m_mat, transposed, static_cast<ValueType>(1.), mat);
+  if (m_imagMat)
+    addMatrixEntries(*m_imagMat, transposed,
+                     ImaginaryEntry<ValueType>::value(
+                         (m_trans & CONJUGATE) ? -1. : 1.),
+                     mat);
   return mat;
 }
 
@@ -254,34 +353,13 @@ void DiscreteSparseBoundaryOperator<ValueType>::addBlock(
     throw std::invalid_argument("DiscreteSparseBoundaryOperator::addBlock(): "
                                 "incorrect block size");
 
-  int entryCount = 0;
-  double *values = 0;
-  int *indices = 0;
-
-  for (size_t row = 0; row < untransposedRows.size(); ++row) {
-    // Provision for future MPI support.
-    if (m_mat->IndicesAreLocal()) {
-      int errorCode = m_mat->ExtractMyRowView(untransposedRows[row], entryCount,
-                                              values, indices);
-      if (errorCode != 0)
-        throw std::runtime_error(
-            "DiscreteSparseBoundaryOperator::addBlock(): "
-            "Epetra_CrsMatrix::ExtractMyRowView()) failed");
-    } else {
-      int errorCode = m_mat->ExtractGlobalRowView(untransposedRows[row],
-                                                  entryCount, values, indices);
-      if (errorCode != 0)
-        throw std::runtime_error(
-            "DiscreteSparseBoundaryOperator::addBlock(): "
-            "Epetra_CrsMatrix::ExtractGlobalRowView()) failed");
-    }
-
-    for (size_t col = 0; col < untransposedCols.size(); ++col)
-      for (int entry = 0; entry < entryCount; ++entry)
-        if (indices[entry] == cols[col])
-          block(transposed ? col : row, transposed ? row : col) +=
-              alpha * static_cast<ValueType>(values[entry]);
-  }
+  addMatrixBlock(*m_mat, untransposedRows, untransposedCols, cols,
+                 transposed, alpha, block);
+  if (m_imagMat)
+    addMatrixBlock(*m_imagMat, untransposedRows, untransposedCols, cols,
+                   transposed, alpha * ImaginaryEntry<ValueType>::value(
+                                           (m_trans & CONJUGATE) ? -1. : 1.),
+                   block);
 }
 
 #ifdef WITH_AHMED
@@ -303,6 +381,11 @@ DiscreteSparseBoundaryOperator<ValueType>::asDiscreteAcaBoundaryOperator(
     throw std::runtime_error("DiscreteSparseBoundaryOperator::"
                              "asDiscreteAcaBoundaryOperator(): "
                              "transposed operators are not supported yet");
+  if (m_imagMat)
+    throw std::runtime_error("DiscreteSparseBoundaryOperator::"
+                             "asDiscreteAcaBoundaryOperator(): "
+                             "operators with an imaginary part are not "
+                             "supported yet");
 
   int *rowOffsets = 0;
   int *colIndices = 0;
@@ -354,6 +437,12 @@ DiscreteSparseBoundaryOperator<ValueType>::epetraMatrix() const {
   return m_mat;
 }
 
+template <typename ValueType>
+shared_ptr<const Epetra_CrsMatrix>
+DiscreteSparseBoundaryOperator<ValueType>::epetraImaginaryMatrix() const {
+  return m_imagMat;
+}
+
 template <typename ValueType>
 TranspositionMode
 DiscreteSparseBoundaryOperator<ValueType>::transpositionMode() const {
@@ -409,6 +498,16 @@ void DiscreteSparseBoundaryOperator<ValueType>::applyBuiltInImpl(
     }
 
   reallyApplyBuiltInImpl(*m_mat, realTrans, x_in, y_inout, alpha, beta);
+  if (m_imagMat) {
+    // The imaginary part changes sign if exactly one of the stored and the
+    // requested transformation involves conjugation
+    const bool conjugated =
+        bool(trans & CONJUGATE) != bool(m_trans & CONJUGATE);
+    reallyApplyBuiltInImpl(
+        *m_imagMat, realTrans, x_in, y_inout,
+        alpha * ImaginaryEntry<ValueType>::value(conjugated ? -1. : 1.),
+        static_cast<ValueType>(1.));
+  }
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteSparseBoundaryOperator);
@@ -81,6 +81,31 @@ public:
           shared_ptr<IndexPermutation>(),
       const shared_ptr<IndexPermutation> &rangePermutation =
           shared_ptr<IndexPermutation>());
+
+  /** \brief Constructor of an operator with complex entries.
+   *
+   *  Epetra matrices are real, so the real and imaginary parts of the
+   *  represented matrix are passed separately.
+   *
+   *  \param[in] realMat
+   *    Real part of the matrix. Must not be null.
+   *  \param[in] imagMat
+   *    Imaginary part of the matrix. May be null, in which case the matrix is
+   *    real; otherwise it must have the same dimensions as \p realMat and
+   *    \p ValueType must be complex.
+   *
+   *  The remaining parameters have the same meaning as in the constructor
+   *  above. */
+  DiscreteSparseBoundaryOperator(
+      const shared_ptr<const Epetra_CrsMatrix> &realMat,
+      const shared_ptr<const Epetra_CrsMatrix> &imagMat,
+      int symmetry = NO_SYMMETRY, TranspositionMode trans = NO_TRANSPOSE,
+      const shared_ptr<AhmedBemBlcluster> &blockCluster =
+          shared_ptr<AhmedBemBlcluster>(),
+      const shared_ptr<IndexPermutation> &domainPermutation =
+          shared_ptr<IndexPermutation>(),
+      const shared_ptr<IndexPermutation> &rangePermutation =
+          shared_ptr<IndexPermutation>());
 #else
   // This class cannot be used without Trilinos
 private:
@@ -123,6 +148,14 @@ public:
    *  function *and possibly transposed and/or complex-conjugated*, depending on
    *  the value returned by transpositionMode(). */
   shared_ptr<const Epetra_CrsMatrix> epetraMatrix() const;
+
+  /** \brief Return a shared pointer to the imaginary part of the sparse
+   *  matrix stored within this operator.
+   *
+   *  If the matrix is real, a null pointer is returned and
+   *  epetraMatrix() holds the complete matrix. Otherwise epetraMatrix()
+   *  holds its real part. */
+  shared_ptr<const Epetra_CrsMatrix> epetraImaginaryMatrix() const;
 #endif
 
   /** \brief Return the active sparse matrix transformation.
@@ -167,6 +200,7 @@ private:
 /** \cond PRIVATE */
 #ifdef WITH_TRILINOS
   shared_ptr<const Epetra_CrsMatrix> m_mat;
+  shared_ptr<const Epetra_CrsMatrix> m_imagMat;
   int m_symmetry;
   TranspositionMode m_trans;
   shared_ptr<AhmedBemBlcluster> m_blockCluster;
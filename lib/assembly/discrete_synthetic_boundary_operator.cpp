@@ -0,0 +1,190 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "discrete_synthetic_boundary_operator.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+
+namespace Bempp {
+
+template <typename ValueType>
+DiscreteSyntheticBoundaryOperator<ValueType>::DiscreteSyntheticBoundaryOperator(
+    const std::vector<shared_ptr<const Base>> &testOps,
+    const shared_ptr<const Base> &integralOp,
+    const std::vector<shared_ptr<const Base>> &trialOps,
+    const std::vector<ValueType> &weights)
+    : m_testOps(testOps), m_trialOps(trialOps), m_integralOp(integralOp),
+      m_weights(weights) {
+  if (!m_integralOp)
+    throw std::invalid_argument("DiscreteSyntheticBoundaryOperator::"
+                                "DiscreteSyntheticBoundaryOperator(): "
+                                "integralOp must not be null");
+  if (!m_testOps.empty() && !m_trialOps.empty() &&
+      m_testOps.size() != m_trialOps.size())
+    throw std::invalid_argument("DiscreteSyntheticBoundaryOperator::"
+                                "DiscreteSyntheticBoundaryOperator(): "
+                                "testOps and trialOps must have the same "
+                                "length");
+  const size_t termCount = std::max(m_testOps.size(), m_trialOps.size());
+  if (m_weights.empty())
+    m_weights.resize(termCount, static_cast<ValueType>(1.));
+  else if (m_weights.size() != termCount)
+    throw std::invalid_argument("DiscreteSyntheticBoundaryOperator::"
+                                "DiscreteSyntheticBoundaryOperator(): "
+                                "incorrect number of weights");
+  for (size_t i = 0; i < m_testOps.size(); ++i)
+    if (!m_testOps[i] ||
+        m_testOps[i]->columnCount() != m_integralOp->rowCount() ||
+        m_testOps[i]->rowCount() != m_testOps[0]->rowCount())
+      throw std::invalid_argument("DiscreteSyntheticBoundaryOperator::"
+                                  "DiscreteSyntheticBoundaryOperator(): "
+                                  "invalid test operator");
+  for (size_t i = 0; i < m_trialOps.size(); ++i)
+    if (!m_trialOps[i] ||
+        m_trialOps[i]->rowCount() != m_integralOp->columnCount() ||
+        m_trialOps[i]->columnCount() != m_trialOps[0]->columnCount())
+      throw std::invalid_argument("DiscreteSyntheticBoundaryOperator::"
+                                  "DiscreteSyntheticBoundaryOperator(): "
+                                  "invalid trial operator");
+}
+
+template <typename ValueType>
+unsigned int DiscreteSyntheticBoundaryOperator<ValueType>::rowCount() const {
+  return m_testOps.empty() ? m_integralOp->rowCount()
+                           : m_testOps[0]->rowCount();
+}
+
+template <typename ValueType>
+unsigned int DiscreteSyntheticBoundaryOperator<ValueType>::columnCount() const {
+  return m_trialOps.empty() ? m_integralOp->columnCount()
+                            : m_trialOps[0]->columnCount();
+}
+
+template <typename ValueType>
+void DiscreteSyntheticBoundaryOperator<ValueType>::addBlock(
+    const std::vector<int> &rows, const std::vector<int> &cols,
+    const ValueType alpha, arma::Mat<ValueType> &block) const {
+  throw std::runtime_error("DiscreteSyntheticBoundaryOperator::"
+                           "addBlock(): not implemented");
+}
+
+#ifdef WITH_TRILINOS
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+DiscreteSyntheticBoundaryOperator<ValueType>::domain() const {
+  return m_trialOps.empty() ? m_integralOp->domain() : m_trialOps[0]->domain();
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+DiscreteSyntheticBoundaryOperator<ValueType>::range() const {
+  return m_testOps.empty() ? m_integralOp->range() : m_testOps[0]->range();
+}
+
+template <typename ValueType>
+bool DiscreteSyntheticBoundaryOperator<ValueType>::opSupportedImpl(
+    Thyra::EOpTransp M_trans) const {
+  if (!m_integralOp->opSupported(M_trans))
+    return false;
+  for (size_t i = 0; i < m_testOps.size(); ++i)
+    if (!m_testOps[i]->opSupported(M_trans))
+      return false;
+  for (size_t i = 0; i < m_trialOps.size(); ++i)
+    if (!m_trialOps[i]->opSupported(M_trans))
+      return false;
+  return true;
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+void DiscreteSyntheticBoundaryOperator<ValueType>::applyBuiltInImpl(
+    const TranspositionMode trans, const arma::Col<ValueType> &x_in,
+    arma::Col<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  applyBuiltInMultiImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteSyntheticBoundaryOperator<ValueType>::applyBuiltInMultiImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  const bool transposed = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+  const bool conjugated = (trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE);
+  // Operators applied before and after the integral operator
+  const std::vector<shared_ptr<const Base>> &innerOps =
+      transposed ? m_testOps : m_trialOps;
+  const std::vector<shared_ptr<const Base>> &outerOps =
+      transposed ? m_trialOps : m_testOps;
+  const size_t termCount = m_weights.size();
+  const size_t colCount = x_in.n_cols;
+  const size_t integralInputSize =
+      transposed ? m_integralOp->rowCount() : m_integralOp->columnCount();
+  const size_t integralOutputSize =
+      transposed ? m_integralOp->columnCount() : m_integralOp->rowCount();
+
+  // Gather the inputs of the integral operator of all terms (a single one
+  // if there are no inner operators) side by side and apply the integral
+  // operator to all of them at once
+  arma::Mat<ValueType> integralOutput;
+  if (innerOps.empty()) {
+    integralOutput.set_size(integralOutputSize, colCount);
+    m_integralOp->apply(trans, x_in, integralOutput, 1., 0.);
+  } else {
+    arma::Mat<ValueType> integralInput(integralInputSize,
+                                       termCount * colCount);
+    for (size_t term = 0; term < termCount; ++term) {
+      arma::Mat<ValueType> termInput(integralInput.colptr(term * colCount),
+                                     integralInputSize, colCount,
+                                     false /* copy_aux_mem */,
+                                     true /* strict */);
+      innerOps[term]->apply(trans, x_in, termInput, 1., 0.);
+    }
+    integralOutput.set_size(integralOutputSize, termCount * colCount);
+    m_integralOp->apply(trans, integralInput, integralOutput, 1., 0.);
+  }
+
+  if (beta == static_cast<ValueType>(0.))
+    y_inout.fill(static_cast<ValueType>(0.));
+  else
+    y_inout *= beta;
+  for (size_t term = 0; term < termCount; ++term) {
+    const ValueType weight =
+        alpha * (conjugated ? Fiber::conj(m_weights[term]) : m_weights[term]);
+    const size_t firstCol = innerOps.empty() ? 0 : term * colCount;
+    const arma::Mat<ValueType> termOutput(integralOutput.colptr(firstCol),
+                                          integralOutputSize, colCount,
+                                          false /* copy_aux_mem */,
+                                          true /* strict */);
+    if (outerOps.empty())
+      y_inout += weight * termOutput;
+    else
+      outerOps[term]->apply(trans, termOutput, y_inout, weight, 1.);
+  }
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteSyntheticBoundaryOperator);
+
+} // namespace Bempp
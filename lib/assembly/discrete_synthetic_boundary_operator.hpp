@@ -0,0 +1,124 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_discrete_synthetic_boundary_operator_hpp
+#define bempp_discrete_synthetic_boundary_operator_hpp
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "../common/common.hpp"
+
+#include "discrete_boundary_operator.hpp"
+
+#include "../common/shared_ptr.hpp"
+
+#ifdef WITH_TRILINOS
+#include <Teuchos_RCP.hpp>
+#endif
+
+#include <vector>
+
+namespace Bempp {
+
+/** \ingroup composite_discrete_boundary_operators
+ *  \brief Weighted sum of products of discrete operators sharing a common
+ *  middle factor.
+ *
+ *  This class represents the operator
+ *
+ *  \f[
+ *      A = \sum_{\alpha} w_\alpha U_\alpha K V_\alpha,
+ *  \f]
+ *
+ *  which arises as the weak form of a SyntheticIntegralOperator. Instead of
+ *  applying \f$K\f$ once per term, as a sum of operator compositions would,
+ *  it gathers the vectors \f$V_\alpha x\f$ of all terms in the columns of a
+ *  single multivector and applies \f$K\f$ to all of them in one call, which
+ *  for H-matrices means a single pass over the blocks of \f$K\f$.
+ *
+ *  Either list of outer operators may be empty, in which case the
+ *  corresponding factors \f$U_\alpha\f$ or \f$V_\alpha\f$ are taken to be
+ *  identities. */
+template <typename ValueType>
+class DiscreteSyntheticBoundaryOperator
+    : public DiscreteBoundaryOperator<ValueType> {
+public:
+  typedef DiscreteBoundaryOperator<ValueType> Base;
+
+  /** \brief Constructor.
+   *
+   *  \param[in] testOps
+   *    Operators \f$U_\alpha\f$.
+   *  \param[in] integralOp
+   *    Operator \f$K\f$.
+   *  \param[in] trialOps
+   *    Operators \f$V_\alpha\f$.
+   *  \param[in] weights
+   *    Weights \f$w_\alpha\f$. If empty, all weights are set to 1.
+   *
+   *  \note If both \p testOps and \p trialOps are non-empty, they must have
+   *  the same length. All operators must be non-null and have compatible
+   *  dimensions, otherwise a <tt>std::invalid_argument</tt> exception is
+   *  thrown. */
+  DiscreteSyntheticBoundaryOperator(
+      const std::vector<shared_ptr<const Base>> &testOps,
+      const shared_ptr<const Base> &integralOp,
+      const std::vector<shared_ptr<const Base>> &trialOps,
+      const std::vector<ValueType> &weights = std::vector<ValueType>());
+
+  virtual unsigned int rowCount() const;
+  virtual unsigned int columnCount() const;
+
+  virtual void addBlock(const std::vector<int> &rows,
+                        const std::vector<int> &cols, const ValueType alpha,
+                        arma::Mat<ValueType> &block) const;
+
+#ifdef WITH_TRILINOS
+public:
+  virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> domain() const;
+  virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> range() const;
+
+protected:
+  virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+#endif
+
+private:
+  virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                const arma::Col<ValueType> &x_in,
+                                arma::Col<ValueType> &y_inout,
+                                const ValueType alpha,
+                                const ValueType beta) const;
+  virtual void applyBuiltInMultiImpl(const TranspositionMode trans,
+                                     const arma::Mat<ValueType> &x_in,
+                                     arma::Mat<ValueType> &y_inout,
+                                     const ValueType alpha,
+                                     const ValueType beta) const;
+
+private:
+  /** \cond PRIVATE */
+  std::vector<shared_ptr<const Base>> m_testOps, m_trialOps;
+  shared_ptr<const Base> m_integralOp;
+  std::vector<ValueType> m_weights;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
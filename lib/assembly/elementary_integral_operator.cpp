@@ -32,15 +32,34 @@
 #include "../fiber/local_assembler_for_integral_operators.hpp"
 #include "../fiber/quadrature_strategy.hpp"
 
+#include "../common/assembly_profile.hpp"
 #include "../common/boost_make_shared_fwd.hpp"
 
 #include <stdexcept>
 #include <iostream>
 
-#include <tbb/tick_count.h>
 
 namespace Bempp {
 
+namespace {
+
+std::string assemblyModeName(AssemblyOptions::Mode mode) {
+  switch (mode) {
+  case AssemblyOptions::DENSE:
+    return "dense";
+  case AssemblyOptions::ACA:
+    return "aca";
+  case AssemblyOptions::HMAT:
+    return "hmat";
+  case AssemblyOptions::MATRIX_FREE:
+    return "matrix_free";
+  default:
+    return "unknown";
+  }
+}
+
+} // namespace
+
 template <typename BasisFunctionType, typename KernelType, typename ResultType>
 ElementaryIntegralOperator<BasisFunctionType, KernelType, ResultType>::
     ElementaryIntegralOperator(
@@ -98,16 +117,24 @@ ElementaryIntegralOperator<BasisFunctionType, KernelType, ResultType>::
     std::cout << "Assembling the weak form of operator '" << this->label()
               << "'..." << std::endl;
 
-  tbb::tick_count start = tbb::tick_count::now();
-  std::unique_ptr<LocalAssembler> assembler =
-      this->makeAssembler(*context.quadStrategy(), context.assemblyOptions());
-  shared_ptr<DiscreteBoundaryOperator<ResultType>> result =
-      assembleWeakFormInternalImpl2(*assembler, context);
-  tbb::tick_count end = tbb::tick_count::now();
+  shared_ptr<AssemblyProfile> profile = boost::make_shared<AssemblyProfile>();
+  profile->setLabel(this->label());
+  profile->setAssemblyMode(assemblyModeName(context.assemblyOptions().assemblyMode()));
+  AssemblyProfile::Activation activation(*profile);
 
-  if (verbose)
-    std::cout << "Assembly of the weak form of operator '" << this->label()
-              << "' took " << (end - start).seconds() << " s" << std::endl;
+  std::unique_ptr<LocalAssembler> assembler;
+  {
+    AssemblyProfile::PhaseTimer timer("assemblerConstruction");
+    assembler =
+        this->makeAssembler(*context.quadStrategy(), context.assemblyOptions());
+  }
+  shared_ptr<DiscreteBoundaryOperator<ResultType>> result;
+  {
+    AssemblyProfile::PhaseTimer timer("globalAssembly");
+    result = assembleWeakFormInternalImpl2(*assembler, context);
+  }
+  assembler->reportStatistics();
+  result->setAssemblyProfile(profile);
   return result;
 }
 
@@ -127,6 +154,9 @@ ElementaryIntegralOperator<BasisFunctionType, KernelType, ResultType>::
   case AssemblyOptions::HMAT:
     return shared_ptr<DiscreteBoundaryOperator<ResultType>>(
         assembleWeakFormInHMatMode(assembler, context).release());
+  case AssemblyOptions::MATRIX_FREE:
+    return shared_ptr<DiscreteBoundaryOperator<ResultType>>(
+        assembleWeakFormInMatrixFreeMode(assembler, context).release());
   default:
     throw std::runtime_error(
         "ElementaryIntegralOperator::assembleWeakFormInternalImpl2(): "
@@ -186,6 +216,39 @@ ElementaryIntegralOperator<BasisFunctionType, KernelType, ResultType>::
                                             this->symmetry() & SYMMETRIC);
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType>
+std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
+ElementaryIntegralOperator<BasisFunctionType, KernelType, ResultType>::
+    assembleWeakFormInMatrixFreeMode(
+        LocalAssembler &assembler,
+        const Context<BasisFunctionType, ResultType> &context) const {
+  // The far field is evaluated long after assembly, by an assembler that
+  // refers to the kernels and transformations of this operator; its deleter
+  // keeps the operator alive.
+  shared_ptr<const AbstractBoundaryOperator<BasisFunctionType, ResultType>>
+      self;
+  try {
+    self = this->shared_from_this();
+  } catch (boost::bad_weak_ptr &) {
+    throw std::runtime_error(
+        "ElementaryIntegralOperator::assembleWeakFormInMatrixFreeMode(): "
+        "operators assembled in the matrix-free mode must be owned by a "
+        "shared pointer");
+  }
+
+  // Singular integrals occur only in the near field, which is evaluated
+  // with the original assembler
+  AssemblyOptions farFieldOptions = context.assemblyOptions();
+  farFieldOptions.enableSingularIntegralCaching(false);
+  shared_ptr<LocalAssembler> farFieldAssembler(
+      this->makeAssembler(*context.quadStrategy(), farFieldOptions).release(),
+      [self](LocalAssembler *farFieldAssembler) { delete farFieldAssembler; });
+
+  return HMatGlobalAssembler<BasisFunctionType, ResultType>::
+      assembleMatrixFreeWeakForm(this->dualToRange(), this->domain(),
+                                 assembler, farFieldAssembler, context);
+}
+
 /** \endcond */
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_KERNEL_AND_RESULT(
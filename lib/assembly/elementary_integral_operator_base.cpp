@@ -24,6 +24,7 @@
 #include "discrete_sparse_boundary_operator.hpp"
 #include "numerical_quadrature_strategy.hpp"
 
+#include "../common/assembly_profile.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/local_assembler_for_integral_operators.hpp"
 
@@ -95,10 +96,13 @@ ElementaryIntegralOperatorBase<BasisFunctionType, ResultType>::makeAssembler(
 
   if (verbose)
     std::cout << "Collecting data for assembler construction..." << std::endl;
-  this->collectDataForAssemblerConstruction(
-      options, testRawGeometry, trialRawGeometry, testGeometryFactory,
-      trialGeometryFactory, testShapesets, trialShapesets, openClHandler,
-      cacheSingularIntegrals);
+  {
+    AssemblyProfile::PhaseTimer timer("geometrySetup");
+    this->collectDataForAssemblerConstruction(
+        options, testRawGeometry, trialRawGeometry, testGeometryFactory,
+        trialGeometryFactory, testShapesets, trialShapesets, openClHandler,
+        cacheSingularIntegrals);
+  }
   if (verbose)
     std::cout << "Data collection finished." << std::endl;
 
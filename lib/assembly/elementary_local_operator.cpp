@@ -34,6 +34,7 @@
 #include "discrete_sparse_boundary_operator.hpp"
 #include "context.hpp"
 
+#include "../common/assembly_profile.hpp"
 #include "../common/types.hpp"
 #include "../common/complex_aux.hpp"
 #include "../fiber/basis.hpp"
@@ -54,8 +55,14 @@
 #include "../common/boost_make_shared_fwd.hpp"
 #include <boost/type_traits/is_complex.hpp>
 
-#include <tbb/tick_count.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/spin_mutex.h>
+#include <tbb/task_scheduler_init.h>
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <vector>
 
@@ -67,12 +74,12 @@
 // solution would be for AHMED to use namespaces.
 #ifndef __IBMCPP__
 #define __IBMCPP__
-#include <Epetra_FECrsMatrix.h>
+#include <Epetra_CrsMatrix.h>
 #include <Epetra_LocalMap.h>
 #include <Epetra_SerialComm.h>
 #undef __IBMCPP__
 #else
-#include <Epetra_FECrsMatrix.h>
+#include <Epetra_CrsMatrix.h>
 #include <Epetra_LocalMap.h>
 #include <Epetra_SerialComm.h>
 #endif
@@ -83,72 +90,174 @@ namespace Bempp {
 namespace {
 
 #ifdef WITH_TRILINOS
-// Internal helper functions for Epetra
-template <typename ValueType>
-int epetraSumIntoGlobalValues(Epetra_FECrsMatrix &matrix,
-                              const std::vector<int> &rowIndices,
-                              const std::vector<int> &colIndices,
-                              const arma::Mat<ValueType> &values);
-
-// Specialisation for double -- no intermediate array is needed
-template <>
-inline int epetraSumIntoGlobalValues<double>(Epetra_FECrsMatrix &matrix,
-                                             const std::vector<int> &rowIndices,
-                                             const std::vector<int> &colIndices,
-                                             const arma::Mat<double> &values) {
-  assert(rowIndices.size() == values.n_rows);
-  assert(colIndices.size() == values.n_cols);
-  return matrix.SumIntoGlobalValues(
-      rowIndices.size(), &rowIndices[0], colIndices.size(), &colIndices[0],
-      values.memptr(), Epetra_FECrsMatrix::COLUMN_MAJOR);
-}
+/** Sparsity pattern of the weak form of a local operator in compressed
+ *  sparse row format. The column indices of each row are sorted. */
+struct CsrPattern {
+  std::vector<int> rowOffsets;
+  std::vector<int> columnIndices;
+};
+
+/** Build the sparsity pattern coupling the global DOFs of the test and trial
+ *  spaces that share an element. Negative DOF indices are ignored. */
+void buildCsrPattern(const std::vector<std::vector<GlobalDofIndex>> &testGdofs,
+                     const std::vector<std::vector<GlobalDofIndex>> &trialGdofs,
+                     int testGlobalDofCount, CsrPattern &pattern) {
+  const size_t elementCount = testGdofs.size();
 
-// Specialisation for float
-template <>
-inline int epetraSumIntoGlobalValues<float>(Epetra_FECrsMatrix &matrix,
-                                            const std::vector<int> &rowIndices,
-                                            const std::vector<int> &colIndices,
-                                            const arma::Mat<float> &values) {
-  // Convert data from float into double (expected by Epetra)
-  arma::Mat<double> doubleValues(values.n_rows, values.n_cols);
-  std::copy(values.begin(), values.end(), doubleValues.begin());
-  return epetraSumIntoGlobalValues<double>(matrix, rowIndices, colIndices,
-                                           doubleValues);
-}
+  // Upper estimate for the number of global trial DOFs coupled to a given
+  // global test DOF: sum of the valid local trial DOF counts for each
+  // element that contributes to the global test DOF in question
+  std::vector<int> validTrialDofCounts(elementCount, 0);
+  std::vector<int> rowCounts(testGlobalDofCount + 1, 0);
+  for (size_t e = 0; e < elementCount; ++e) {
+    for (size_t i = 0; i < trialGdofs[e].size(); ++i)
+      if (trialGdofs[e][i] >= 0)
+        ++validTrialDofCounts[e];
+    for (size_t i = 0; i < testGdofs[e].size(); ++i)
+      if (testGdofs[e][i] >= 0)
+        rowCounts[testGdofs[e][i] + 1] += validTrialDofCounts[e];
+  }
+  std::vector<int> offsets(testGlobalDofCount + 1, 0);
+  std::partial_sum(rowCounts.begin(), rowCounts.end(), offsets.begin());
+
+  std::vector<int> columns(offsets.back());
+  std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+  for (size_t e = 0; e < elementCount; ++e)
+    for (size_t i = 0; i < testGdofs[e].size(); ++i) {
+      const int row = testGdofs[e][i];
+      if (row < 0)
+        continue;
+      for (size_t j = 0; j < trialGdofs[e].size(); ++j)
+        if (trialGdofs[e][j] >= 0)
+          columns[cursors[row]++] = trialGdofs[e][j];
+    }
 
-// Specialisation for std::complex<float>.
-// WARNING: at present only the real part is taken into account!
-// This is sufficient as long as we provide real-valued basis functions only.
-template <>
-inline int epetraSumIntoGlobalValues<std::complex<float>>(
-    Epetra_FECrsMatrix &matrix, const std::vector<int> &rowIndices,
-    const std::vector<int> &colIndices,
-    const arma::Mat<std::complex<float>> &values) {
-  // Extract the real part of "values" into an array of type double
-  arma::Mat<double> doubleValues(values.n_rows, values.n_cols);
-  // Check whether arma::real returns a view or a copy (if the latter,
-  // this assert will fail)
-  for (size_t i = 0; i < values.n_elem; ++i)
-    doubleValues[i] = values[i].real();
-  return epetraSumIntoGlobalValues<double>(matrix, rowIndices, colIndices,
-                                           doubleValues);
+  // Sort the columns of each row and drop duplicates
+  std::vector<int> uniqueCounts(testGlobalDofCount + 1, 0);
+  tbb::parallel_for(tbb::blocked_range<int>(0, testGlobalDofCount),
+                    [&](const tbb::blocked_range<int> &r) {
+    for (int row = r.begin(); row != r.end(); ++row) {
+      std::vector<int>::iterator begin = columns.begin() + offsets[row];
+      std::vector<int>::iterator end = columns.begin() + offsets[row + 1];
+      std::sort(begin, end);
+      uniqueCounts[row + 1] = std::unique(begin, end) - begin;
+    }
+  });
+
+  pattern.rowOffsets.resize(testGlobalDofCount + 1);
+  std::partial_sum(uniqueCounts.begin(), uniqueCounts.end(),
+                   pattern.rowOffsets.begin());
+  pattern.columnIndices.resize(pattern.rowOffsets.back());
+  tbb::parallel_for(tbb::blocked_range<int>(0, testGlobalDofCount),
+                    [&](const tbb::blocked_range<int> &r) {
+    for (int row = r.begin(); row != r.end(); ++row)
+      std::copy(columns.begin() + offsets[row],
+                columns.begin() + offsets[row] + uniqueCounts[row + 1],
+                pattern.columnIndices.begin() + pattern.rowOffsets[row]);
+  });
 }
 
-// Specialisation for std::complex<double>.
-// WARNING: at present only the real part is taken into account!
-// This is sufficient as long as we provide real-valued basis functions only.
-template <>
-inline int epetraSumIntoGlobalValues<std::complex<double>>(
-    Epetra_FECrsMatrix &matrix, const std::vector<int> &rowIndices,
-    const std::vector<int> &colIndices,
-    const arma::Mat<std::complex<double>> &values) {
-  // Extract the real part of "values" into an array of type double
-  arma::Mat<double> doubleValues(values.n_rows, values.n_cols);
-  for (size_t i = 0; i < values.n_elem; ++i)
-    doubleValues[i] = values[i].real();
-  return epetraSumIntoGlobalValues<double>(matrix, rowIndices, colIndices,
-                                           doubleValues);
+/** Copy values stored in the layout of \p pattern into a new, fill-completed
+ *  Epetra matrix. */
+shared_ptr<Epetra_CrsMatrix> makeEpetraMatrix(const CsrPattern &pattern,
+                                              const std::vector<double> &values,
+                                              const Epetra_Map &rowMap,
+                                              const Epetra_Map &colMap) {
+  const int rowCount = pattern.rowOffsets.size() - 1;
+  std::vector<int> rowCounts(rowCount);
+  for (int row = 0; row < rowCount; ++row)
+    rowCounts[row] = pattern.rowOffsets[row + 1] - pattern.rowOffsets[row];
+  shared_ptr<Epetra_CrsMatrix> result = boost::make_shared<Epetra_CrsMatrix>(
+      Copy, rowMap, colMap, rowCount ? &rowCounts[0] : 0,
+      true /* static profile */);
+  for (int row = 0; row < rowCount; ++row)
+    if (rowCounts[row] > 0)
+      result->InsertGlobalValues(
+          row, rowCounts[row],
+          const_cast<double *>(&values[pattern.rowOffsets[row]]),
+          const_cast<int *>(&pattern.columnIndices[pattern.rowOffsets[row]]));
+  result->FillComplete(colMap /* domain map */, rowMap /* range map */);
+  return result;
 }
+
+/** Loop body evaluating the local weak forms on a range of elements and
+ *  adding them, weighted by the local DOF weights, to the values of a CSR
+ *  matrix. The real and imaginary parts are accumulated separately. */
+template <typename BasisFunctionType, typename ResultType>
+class SparseLocalOperatorAssemblerLoopBody {
+public:
+  typedef Fiber::LocalAssemblerForLocalOperators<ResultType> LocalAssembler;
+  typedef tbb::spin_mutex MutexType;
+  enum {
+    MUTEX_COUNT = 1024
+  };
+
+  SparseLocalOperatorAssemblerLoopBody(
+      LocalAssembler &assembler,
+      const std::vector<std::vector<GlobalDofIndex>> &testGdofs,
+      const std::vector<std::vector<GlobalDofIndex>> &trialGdofs,
+      const std::vector<std::vector<BasisFunctionType>> &testLdofWeights,
+      const std::vector<std::vector<BasisFunctionType>> &trialLdofWeights,
+      const CsrPattern &pattern, std::vector<double> &realValues,
+      std::vector<double> &imagValues, MutexType *rowMutexes)
+      : m_assembler(assembler), m_testGdofs(testGdofs),
+        m_trialGdofs(trialGdofs), m_testLdofWeights(testLdofWeights),
+        m_trialLdofWeights(trialLdofWeights), m_pattern(pattern),
+        m_realValues(realValues), m_imagValues(imagValues),
+        m_rowMutexes(rowMutexes), m_profile(AssemblyProfile::current()) {}
+
+  void operator()(const tbb::blocked_range<int> &r) const {
+    AssemblyProfile::Activation activation(m_profile);
+    std::vector<int> elementIndices;
+    elementIndices.reserve(r.size());
+    for (int e = r.begin(); e != r.end(); ++e)
+      elementIndices.push_back(e);
+    std::vector<arma::Mat<ResultType>> localResult;
+    m_assembler.evaluateLocalWeakForms(elementIndices, localResult);
+
+    std::vector<int> positions;
+    for (int e = r.begin(); e != r.end(); ++e) {
+      const arma::Mat<ResultType> &local = localResult[e - r.begin()];
+      const std::vector<GlobalDofIndex> &testGdofs = m_testGdofs[e];
+      const std::vector<GlobalDofIndex> &trialGdofs = m_trialGdofs[e];
+      for (size_t testDof = 0; testDof < testGdofs.size(); ++testDof) {
+        const int row = testGdofs[testDof];
+        if (row < 0)
+          continue;
+        const std::vector<int>::const_iterator rowBegin =
+            m_pattern.columnIndices.begin() + m_pattern.rowOffsets[row];
+        const std::vector<int>::const_iterator rowEnd =
+            m_pattern.columnIndices.begin() + m_pattern.rowOffsets[row + 1];
+        MutexType::scoped_lock lock(m_rowMutexes[row % MUTEX_COUNT]);
+        for (size_t trialDof = 0; trialDof < trialGdofs.size(); ++trialDof) {
+          const int col = trialGdofs[trialDof];
+          if (col < 0)
+            continue;
+          const size_t pos = std::lower_bound(rowBegin, rowEnd, col) -
+                             m_pattern.columnIndices.begin();
+          const ResultType value =
+              conj(m_testLdofWeights[e][testDof]) *
+              m_trialLdofWeights[e][trialDof] * local(testDof, trialDof);
+          m_realValues[pos] += realPart(value);
+          m_imagValues[pos] += imagPart(value);
+        }
+      }
+    }
+  }
+
+private:
+  LocalAssembler &m_assembler;
+  const std::vector<std::vector<GlobalDofIndex>> &m_testGdofs;
+  const std::vector<std::vector<GlobalDofIndex>> &m_trialGdofs;
+  const std::vector<std::vector<BasisFunctionType>> &m_testLdofWeights;
+  const std::vector<std::vector<BasisFunctionType>> &m_trialLdofWeights;
+  const CsrPattern &m_pattern;
+  std::vector<double> &m_realValues;
+  std::vector<double> &m_imagValues;
+  MutexType *m_rowMutexes;
+  // Profile of the thread starting the loop
+  AssemblyProfile *m_profile;
+};
 #endif
 
 /** Build a list of lists of global DOF indices corresponding to the local DOFs
@@ -221,16 +330,26 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::assembleWeakFormImpl(
     std::cout << "Assembling the weak form of operator '" << this->label()
               << "'..." << std::endl;
 
-  tbb::tick_count start = tbb::tick_count::now();
-  std::unique_ptr<LocalAssembler> assembler =
-      this->makeAssembler(*context.quadStrategy(), context.assemblyOptions());
-  shared_ptr<DiscreteBoundaryOperator<ResultType>> result =
-      assembleWeakFormInternalImpl2(*assembler, context);
-  tbb::tick_count end = tbb::tick_count::now();
-
-  if (verbose)
-    std::cout << "Assembly of the weak form of operator '" << this->label()
-              << "' took " << (end - start).seconds() << " s" << std::endl;
+  shared_ptr<AssemblyProfile> profile = boost::make_shared<AssemblyProfile>();
+  profile->setLabel(this->label());
+  profile->setAssemblyMode(
+      context.assemblyOptions().isSparseStorageOfLocalOperatorsEnabled()
+          ? "sparse"
+          : "dense");
+  AssemblyProfile::Activation activation(*profile);
+
+  std::unique_ptr<LocalAssembler> assembler;
+  {
+    AssemblyProfile::PhaseTimer timer("assemblerConstruction");
+    assembler =
+        this->makeAssembler(*context.quadStrategy(), context.assemblyOptions());
+  }
+  shared_ptr<DiscreteBoundaryOperator<ResultType>> result;
+  {
+    AssemblyProfile::PhaseTimer timer("globalAssembly");
+    result = assembleWeakFormInternalImpl2(*assembler, context);
+  }
+  result->setAssemblyProfile(profile);
   return result;
 }
 
@@ -308,25 +427,12 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::
     assembleWeakFormInSparseMode(LocalAssembler &assembler,
                                  const AssemblyOptions &options) const {
 #ifdef WITH_TRILINOS
-  if (boost::is_complex<BasisFunctionType>::value)
-    throw std::runtime_error(
-        "ElementaryLocalOperator::assembleWeakFormInSparseMode(): "
-        "sparse-mode assembly of identity operators for "
-        "complex-valued basis functions is not supported yet");
-
   const Space<BasisFunctionType> &testSpace = *this->dualToRange();
   const Space<BasisFunctionType> &trialSpace = *this->domain();
 
-  // Fill local submatrices
-  const GridView &view = testSpace.gridView();
-  const size_t elementCount = view.entityCount(0);
-  std::vector<int> elementIndices(elementCount);
-  for (size_t i = 0; i < elementCount; ++i)
-    elementIndices[i] = i;
-  std::vector<arma::Mat<ResultType>> localResult;
-  assembler.evaluateLocalWeakForms(elementIndices, localResult);
-
   // Global DOF indices corresponding to local DOFs on elements
+  const GridView &view = testSpace.gridView();
+  const int elementCount = view.entityCount(0);
   std::vector<std::vector<GlobalDofIndex>> testGdofs(elementCount);
   std::vector<std::vector<GlobalDofIndex>> trialGdofs(elementCount);
   std::vector<std::vector<BasisFunctionType>> testLdofWeights(elementCount);
@@ -334,15 +440,6 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::
   gatherGlobalDofs(testSpace, trialSpace, testGdofs, trialGdofs,
                    testLdofWeights, trialLdofWeights);
 
-  // Multiply matrix entries by DOF weights
-  for (size_t e = 0; e < elementCount; ++e)
-    for (size_t trialDof = 0; trialDof < trialGdofs[e].size(); ++trialDof)
-      for (size_t testDof = 0; testDof < testGdofs[e].size(); ++testDof)
-        localResult[e](testDof, trialDof) *=
-            conj(testLdofWeights[e][testDof]) * trialLdofWeights[e][trialDof];
-
-  // Estimate number of entries in each row
-
   //    This will be useful when we begin to use MPI
   //    // Get global DOF indices for which this process is responsible
   //    const int testGlobalDofCount = testSpace.globalDofCount();
@@ -354,45 +451,50 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::
 
   const int testGlobalDofCount = testSpace.globalDofCount();
   const int trialGlobalDofCount = trialSpace.globalDofCount();
-  arma::Col<int> nonzeroEntryCountEstimates(testGlobalDofCount);
-  nonzeroEntryCountEstimates.fill(0);
 
-  // Upper estimate for the number of global trial DOFs coupled to a given
-  // global test DOF: sum of the local trial DOF counts for each element that
-  // contributes to the global test DOF in question
-  for (size_t e = 0; e < elementCount; ++e)
-    for (size_t testLdof = 0; testLdof < testGdofs[e].size(); ++testLdof) {
-      int testGdof = testGdofs[e][testLdof];
-      if (testGdof >= 0)
-        nonzeroEntryCountEstimates(testGdof) += trialGdofs[e].size();
-    }
+  const ParallelizationOptions &parallelOptions =
+      options.parallelizationOptions();
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+  tbb::task_scheduler_init scheduler(maxThreadCount);
+
+  // The sparsity pattern is fixed before any integral is evaluated, so the
+  // local weak forms can be added straight into the final value arrays
+  // chunk by chunk instead of being stored for the whole grid
+  CsrPattern pattern;
+  buildCsrPattern(testGdofs, trialGdofs, testGlobalDofCount, pattern);
+  std::vector<double> realValues(pattern.columnIndices.size(), 0.);
+  std::vector<double> imagValues(pattern.columnIndices.size(), 0.);
+
+  typedef SparseLocalOperatorAssemblerLoopBody<BasisFunctionType, ResultType>
+  Body;
+  std::unique_ptr<typename Body::MutexType[]> rowMutexes(
+      new typename Body::MutexType[Body::MUTEX_COUNT]);
+  tbb::parallel_for(tbb::blocked_range<int>(0, elementCount, 256),
+                    Body(assembler, testGdofs, trialGdofs, testLdofWeights,
+                         trialLdofWeights, pattern, realValues, imagValues,
+                         rowMutexes.get()));
 
   Epetra_SerialComm comm; // To be replaced once we begin to use MPI
   Epetra_LocalMap rowMap(testGlobalDofCount, 0 /* index_base */, comm);
   Epetra_LocalMap colMap(trialGlobalDofCount, 0 /* index_base */, comm);
-  shared_ptr<Epetra_FECrsMatrix> result =
-      boost::make_shared<Epetra_FECrsMatrix>(
-          Copy, rowMap, colMap, nonzeroEntryCountEstimates.memptr());
-
-  // TODO: make each process responsible for a subset of elements
-  // Find maximum number of local dofs per element
-  size_t maxLdofCount = 0;
-  for (size_t e = 0; e < elementCount; ++e)
-    maxLdofCount =
-        std::max(maxLdofCount, testGdofs[e].size() * trialGdofs[e].size());
-
-  // Initialise sparse matrix with zeros at required positions
-  arma::Col<double> zeros(maxLdofCount);
-  zeros.fill(0.);
-  for (size_t e = 0; e < elementCount; ++e)
-    result->InsertGlobalValues(testGdofs[e].size(), &testGdofs[e][0],
-                               trialGdofs[e].size(), &trialGdofs[e][0],
-                               zeros.memptr());
-  // Add contributions from individual elements
-  for (size_t e = 0; e < elementCount; ++e)
-    epetraSumIntoGlobalValues(*result, testGdofs[e], trialGdofs[e],
-                              localResult[e]);
-  result->GlobalAssemble();
+  shared_ptr<Epetra_CrsMatrix> result =
+      makeEpetraMatrix(pattern, realValues, rowMap, colMap);
+
+  // Epetra matrices are real, so a nonzero imaginary part (which can only
+  // arise for complex basis functions) is stored in a second matrix with
+  // the same sparsity pattern
+  shared_ptr<Epetra_CrsMatrix> imagResult;
+  if (boost::is_complex<BasisFunctionType>::value &&
+      std::find_if(imagValues.begin(), imagValues.end(), [](double v) {
+        return v != 0.;
+      }) != imagValues.end())
+    imagResult = makeEpetraMatrix(pattern, imagValues, rowMap, colMap);
 
   // If assembly mode is equal to ACA and we have AHMED,
   // construct the block cluster tree. Otherwise leave it uninitialized.
@@ -431,7 +533,7 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::
   // has just been calculated
   return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
       new DiscreteSparseBoundaryOperator<ResultType>(
-          result, this->symmetry(), NO_TRANSPOSE, blockCluster,
+          result, imagResult, this->symmetry(), NO_TRANSPOSE, blockCluster,
           trial_o2pPermutation, test_o2pPermutation));
 #else // WITH_TRILINOS
   throw std::runtime_error(
@@ -0,0 +1,169 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "frequency_sweep.hpp"
+
+#include "assembly_options.hpp"
+#include "context.hpp"
+#include "discrete_boundary_operator.hpp"
+#include "elementary_integral_operator_base.hpp"
+#include "hmat_global_assembler.hpp"
+#include "local_assembler_construction_helper.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+#include "../fiber/local_assembler_for_integral_operators.hpp"
+#include "../fiber/quadrature_strategy.hpp"
+#include "../hmat/block_cluster_tree.hpp"
+#include "../hmat/hmatrix_aca_compressor.hpp"
+#include "../space/space.hpp"
+
+#include <stdexcept>
+
+namespace Bempp {
+
+template <typename BasisFunctionType, typename ResultType>
+FrequencySweep<BasisFunctionType, ResultType>::FrequencySweep(
+    const shared_ptr<const Context<BasisFunctionType, ResultType>> &context,
+    const OperatorFactory &operatorFactory)
+    : m_context(context), m_operatorFactory(operatorFactory),
+      m_cacheSingularIntegrals(false) {
+  if (!context)
+    throw std::invalid_argument(
+        "FrequencySweep::FrequencySweep(): context must not be null");
+  if (!operatorFactory)
+    throw std::invalid_argument(
+        "FrequencySweep::FrequencySweep(): operatorFactory must not be empty");
+}
+
+template <typename BasisFunctionType, typename ResultType>
+FrequencySweep<BasisFunctionType, ResultType>::~FrequencySweep() {}
+
+template <typename BasisFunctionType, typename ResultType>
+BoundaryOperator<BasisFunctionType, ResultType>
+FrequencySweep<BasisFunctionType, ResultType>::boundaryOperator(
+    WaveNumberType waveNumber) const {
+  return m_operatorFactory(m_context, waveNumber);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+shared_ptr<const DiscreteBoundaryOperator<ResultType>>
+FrequencySweep<BasisFunctionType, ResultType>::weakForm(
+    WaveNumberType waveNumber) {
+  typedef ElementaryIntegralOperatorBase<BasisFunctionType, ResultType>
+  ElementaryOp;
+  typedef typename ElementaryOp::LocalAssembler LocalAssembler;
+
+  BoundaryOperator<BasisFunctionType, ResultType> op =
+      boundaryOperator(waveNumber);
+  shared_ptr<const ElementaryOp> elementaryOp =
+      boost::dynamic_pointer_cast<const ElementaryOp>(op.abstractOperator());
+  if (!elementaryOp)
+    return op.weakForm();
+
+  if (!m_testRawGeometry)
+    collectSharedData(*elementaryOp);
+  else
+    checkSpaces(*elementaryOp);
+
+  const AssemblyOptions &options = m_context->assemblyOptions();
+  std::unique_ptr<LocalAssembler> assembler = elementaryOp->makeAssembler(
+      *m_context->quadStrategy(), m_testGeometryFactory,
+      m_trialGeometryFactory, m_testRawGeometry, m_trialRawGeometry,
+      m_testShapesets, m_trialShapesets, m_openClHandler,
+      options.parallelizationOptions(), options.verbosityLevel(),
+      m_cacheSingularIntegrals);
+
+  if (options.assemblyMode() != AssemblyOptions::HMAT)
+    return elementaryOp->assembleWeakFormInternal(*assembler, *m_context);
+
+  typedef HMatGlobalAssembler<BasisFunctionType, ResultType> Assembler;
+  if (!m_blockClusterTree) {
+    m_blockClusterTree = Assembler::generateBlockClusterTree(
+        *m_dualToRange, *m_domain, *m_context);
+    m_pivotMemory.reset(new hmat::AcaPivotMemory<2>);
+  }
+  std::vector<LocalAssembler *> localAssemblers(1, assembler.get());
+  std::vector<const DiscreteBoundaryOperator<ResultType> *> sparseTermsToAdd;
+  std::vector<ResultType> denseTermMultipliers(1, 1.0);
+  std::vector<ResultType> sparseTermMultipliers;
+  return shared_ptr<const DiscreteBoundaryOperator<ResultType>>(
+      Assembler::assembleDetachedWeakForm(
+          *m_dualToRange, *m_domain, localAssemblers, localAssemblers,
+          sparseTermsToAdd, denseTermMultipliers, sparseTermMultipliers,
+          *m_context, elementaryOp->symmetry() & SYMMETRIC, m_blockClusterTree,
+          m_pivotMemory.get()).release());
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::vector<shared_ptr<const DiscreteBoundaryOperator<ResultType>>>
+FrequencySweep<BasisFunctionType, ResultType>::weakForms(
+    const std::vector<WaveNumberType> &waveNumbers) {
+  std::vector<shared_ptr<const DiscreteBoundaryOperator<ResultType>>> result;
+  result.reserve(waveNumbers.size());
+  for (size_t i = 0; i < waveNumbers.size(); ++i)
+    result.push_back(weakForm(waveNumbers[i]));
+  return result;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void FrequencySweep<BasisFunctionType, ResultType>::collectSharedData(
+    const ElementaryIntegralOperatorBase<BasisFunctionType, ResultType> &op) {
+  typedef LocalAssemblerConstructionHelper Helper;
+
+  m_domain = op.domain();
+  m_dualToRange = op.dualToRange();
+
+  // Same logic as in
+  // AbstractBoundaryOperator::collectDataForAssemblerConstruction()
+  Helper::collectGridData(*m_dualToRange, m_testRawGeometry,
+                          m_testGeometryFactory);
+  if (m_dualToRange->grid() == m_domain->grid()) {
+    m_trialRawGeometry = m_testRawGeometry;
+    m_trialGeometryFactory = m_testGeometryFactory;
+  } else
+    Helper::collectGridData(*m_domain, m_trialRawGeometry,
+                            m_trialGeometryFactory);
+
+  Helper::collectShapesets(*m_dualToRange, m_testShapesets);
+  if (m_dualToRange == m_domain)
+    m_trialShapesets = m_testShapesets;
+  else
+    Helper::collectShapesets(*m_domain, m_trialShapesets);
+
+  const AssemblyOptions &options = m_context->assemblyOptions();
+  Helper::makeOpenClHandler(options.parallelizationOptions().openClOptions(),
+                            m_testRawGeometry, m_trialRawGeometry,
+                            m_openClHandler);
+  m_cacheSingularIntegrals = options.isSingularIntegralCachingEnabled();
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void FrequencySweep<BasisFunctionType, ResultType>::checkSpaces(
+    const ElementaryIntegralOperatorBase<BasisFunctionType, ResultType> &op)
+    const {
+  if (op.domain() != m_domain || op.dualToRange() != m_dualToRange)
+    throw std::invalid_argument(
+        "FrequencySweep::weakForm(): the operator factory must return "
+        "operators acting on the same spaces for all wavenumbers");
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(FrequencySweep);
+
+} // namespace Bempp
@@ -0,0 +1,174 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_frequency_sweep_hpp
+#define bempp_frequency_sweep_hpp
+
+#include "../common/common.hpp"
+
+#include "boundary_operator.hpp"
+
+#include "../common/shared_ptr.hpp"
+#include "../fiber/scalar_traits.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Fiber {
+
+/** \cond FORWARD_DECL */
+template <typename CoordinateType> class RawGridGeometry;
+template <typename ValueType> class Shapeset;
+class OpenClHandler;
+/** \endcond */
+
+} // namespace Fiber
+
+namespace hmat {
+
+/** \cond FORWARD_DECL */
+template <int N> class BlockClusterTree;
+template <int N> class AcaPivotMemory;
+/** \endcond */
+
+} // namespace hmat
+
+namespace Bempp {
+
+/** \cond FORWARD_DECL */
+class GeometryFactory;
+template <typename ValueType> class DiscreteBoundaryOperator;
+template <typename BasisFunctionType, typename ResultType>
+class ElementaryIntegralOperatorBase;
+/** \endcond */
+
+/** \ingroup weak_form_assembly
+ *  \brief Assembly of the weak forms of a wavenumber-dependent operator for
+ *  many wavenumbers.
+ *
+ *  A FrequencySweep is constructed from an assembly context and a factory
+ *  returning the operator to be discretised at a given wavenumber, e.g.
+ *
+ *  \code
+ *  FrequencySweep<double, std::complex<double>> sweep(
+ *      context, [&](const shared_ptr<const Context<double,
+ *                                                  std::complex<double>>> &c,
+ *                   std::complex<double> k) {
+ *        return helmholtz3dSingleLayerBoundaryOperator<double>(
+ *            c, space, space, space, k);
+ *      });
+ *  auto weakForms = sweep.weakForms(waveNumbers);
+ *  \endcode
+ *
+ *  All operators returned by the factory must act on the same spaces. The
+ *  data that do not depend on the wavenumber are constructed only once and
+ *  shared by all assemblies:
+ *
+ *  - the raw grid geometry and element geometry factories of the test and
+ *    trial spaces,
+ *  - the lists of test and trial shapesets,
+ *  - the OpenCL handler,
+ *  - in HMAT mode, the block cluster tree.
+ *
+ *  In HMAT mode the adaptive cross approximation of each admissible block
+ *  additionally starts from the pivots chosen for the same block at the
+ *  previously assembled wavenumber, so the wavenumbers should be passed in
+ *  ascending (or otherwise slowly varying) order.
+ *
+ *  Operators that are not elementary integral operators (e.g. the
+ *  synthetic operators used for some Helmholtz operators in ACA mode with
+ *  local assembly) are assembled by calling BoundaryOperator::weakForm() and
+ *  do not benefit from the shared data.
+ *
+ *  This class is not thread-safe. */
+template <typename BasisFunctionType, typename ResultType>
+class FrequencySweep {
+public:
+  /** \brief Type used to represent wavenumbers. */
+  typedef ResultType WaveNumberType;
+  /** \brief Type used to represent coordinates. */
+  typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
+  /** \brief Type of the function constructing the operator to be
+   *  discretised at a given wavenumber. */
+  typedef std::function<BoundaryOperator<BasisFunctionType, ResultType>(
+      const shared_ptr<const Context<BasisFunctionType, ResultType>> &,
+      WaveNumberType)> OperatorFactory;
+
+  /** \brief Constructor.
+   *
+   *  \param[in] context Assembly context used for all wavenumbers.
+   *  \param[in] operatorFactory Function returning the operator to be
+   *    discretised at a given wavenumber. */
+  FrequencySweep(
+      const shared_ptr<const Context<BasisFunctionType, ResultType>> &context,
+      const OperatorFactory &operatorFactory);
+
+  /** \brief Destructor. */
+  ~FrequencySweep();
+
+  /** \brief Return the operator corresponding to the wavenumber
+   *  \p waveNumber. */
+  BoundaryOperator<BasisFunctionType, ResultType>
+  boundaryOperator(WaveNumberType waveNumber) const;
+
+  /** \brief Assemble the weak form of the operator corresponding to the
+   *  wavenumber \p waveNumber. */
+  shared_ptr<const DiscreteBoundaryOperator<ResultType>>
+  weakForm(WaveNumberType waveNumber);
+
+  /** \brief Assemble the weak forms of the operators corresponding to the
+   *  wavenumbers \p waveNumbers, in the order in which they are given. */
+  std::vector<shared_ptr<const DiscreteBoundaryOperator<ResultType>>>
+  weakForms(const std::vector<WaveNumberType> &waveNumbers);
+
+private:
+  /** \cond PRIVATE */
+  void collectSharedData(
+      const ElementaryIntegralOperatorBase<BasisFunctionType, ResultType> &op);
+  void checkSpaces(
+      const ElementaryIntegralOperatorBase<BasisFunctionType, ResultType> &op)
+      const;
+
+  shared_ptr<const Context<BasisFunctionType, ResultType>> m_context;
+  OperatorFactory m_operatorFactory;
+
+  shared_ptr<const Space<BasisFunctionType>> m_domain;
+  shared_ptr<const Space<BasisFunctionType>> m_dualToRange;
+
+  shared_ptr<Fiber::RawGridGeometry<CoordinateType>> m_testRawGeometry;
+  shared_ptr<Fiber::RawGridGeometry<CoordinateType>> m_trialRawGeometry;
+  shared_ptr<GeometryFactory> m_testGeometryFactory;
+  shared_ptr<GeometryFactory> m_trialGeometryFactory;
+  shared_ptr<std::vector<const Fiber::Shapeset<BasisFunctionType> *>>
+      m_testShapesets;
+  shared_ptr<std::vector<const Fiber::Shapeset<BasisFunctionType> *>>
+      m_trialShapesets;
+  shared_ptr<Fiber::OpenClHandler> m_openClHandler;
+  bool m_cacheSingularIntegrals;
+
+  shared_ptr<hmat::BlockClusterTree<2>> m_blockClusterTree;
+  std::unique_ptr<hmat::AcaPivotMemory<2>> m_pivotMemory;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
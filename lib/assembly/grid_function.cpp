@@ -53,22 +53,34 @@
 
 #include <boost/array.hpp>
 #include <fstream>
+#include <map>
 #include <set>
 #include <sstream>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
 namespace Bempp {
 
 // Internal routines
 
 namespace {
 
+/** \brief Number of threads to pass to tbb::task_scheduler_init. */
+int maxThreadCount(const ParallelizationOptions &parallelOptions) {
+  if (parallelOptions.isOpenClEnabled())
+    return 1;
+  if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+    return tbb::task_scheduler_init::automatic;
+  return parallelOptions.maxThreadCount();
+}
+
 template <typename BasisFunctionType, typename ResultType>
 shared_ptr<arma::Col<ResultType>> reallyCalculateProjections(
     const Space<BasisFunctionType> &dualSpace,
     Fiber::LocalAssemblerForGridFunctions<ResultType> &assembler,
     const AssemblyOptions &options) {
-  // TODO: parallelise using TBB (the parameter options will then start be used)
-
   // Get the grid's leaf view so that we can iterate over elements
   const GridView &view = dualSpace.gridView();
   const size_t elementCount = view.entityCount(0);
@@ -88,19 +100,29 @@ shared_ptr<arma::Col<ResultType>> reallyCalculateProjections(
     it->next();
   }
 
-  // Make a vector of all element indices
-  std::vector<int> testIndices(elementCount);
-  for (size_t i = 0; i < elementCount; ++i)
-    testIndices[i] = i;
-
   // Create the weak form's column vector
   shared_ptr<arma::Col<ResultType>> result(
       new arma::Col<ResultType>(dualSpace.globalDofCount()));
   result->fill(0.);
 
-  std::vector<arma::Col<ResultType>> localResult;
-  // Evaluate local weak forms
-  assembler.evaluateLocalWeakForms(testIndices, localResult);
+  // Evaluate local weak forms in chunks of elements. The assembler is
+  // thread-safe; each chunk writes to its own part of localResult.
+  std::vector<arma::Col<ResultType>> localResult(elementCount);
+  {
+    tbb::task_scheduler_init scheduler(
+        maxThreadCount(options.parallelizationOptions()));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, elementCount, 256),
+                      [&](const tbb::blocked_range<size_t> &r) {
+      std::vector<int> testIndices;
+      testIndices.reserve(r.size());
+      for (size_t e = r.begin(); e != r.end(); ++e)
+        testIndices.push_back(e);
+      std::vector<arma::Col<ResultType>> chunkResult;
+      assembler.evaluateLocalWeakForms(testIndices, chunkResult);
+      for (size_t e = r.begin(); e != r.end(); ++e)
+        localResult[e].swap(chunkResult[e - r.begin()]);
+    });
+  }
 
   // Loop over test indices
   for (size_t testIndex = 0; testIndex < elementCount; ++testIndex)
@@ -836,9 +858,6 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
   shared_ptr<const Grid> grid = m_space->grid();
   std::unique_ptr<GeometryFactory> geometryFactory =
       grid->elementGeometryFactory();
-  std::unique_ptr<typename GeometryFactory::Geometry> geometry(
-      geometryFactory->make());
-  Fiber::GeometricalData<CoordinateType> geomData;
 
   // For each element, get its shapeset and corner count (this is sufficient
   // to identify its geometry) as well as its local coefficients
@@ -874,6 +893,15 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
   assert(nComponents == transformations.resultDimension(0));
   transformations.addDependencies(basisDeps, geomDeps);
 
+  // Local coordinates of the special points and basis data at these points
+  // for each unique combination of shapeset and element corner count
+  struct Tabulation {
+    arma::Mat<CoordinateType> local;
+    Fiber::BasisData<BasisFunctionType> basisData;
+  };
+  typedef std::map<ShapesetAndCornerCount, Tabulation> TabulationMap;
+  TabulationMap tabulations;
+
   // Loop over unique combinations of basis and element corner count
   typedef typename ShapesetAndCornerCountSet::const_iterator
   BasisAndCornerCountSetConstIt;
@@ -887,7 +915,8 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
 
     // Set the local coordinates of either all vertices or the barycentre
     // of the active element type
-    arma::Mat<CoordinateType> local;
+    arma::Mat<CoordinateType> &local =
+        tabulations[activeBasisAndCornerCount].local;
     if (dataType == VtkWriter::CELL_DATA) {
       local.set_size(gridDim, 1);
 
@@ -932,25 +961,59 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     }
 
     // Get basis data
-    Fiber::BasisData<BasisFunctionType> basisData;
-    activeShapeset.evaluate(basisDeps, local, ALL_DOFS, basisData);
+    activeShapeset.evaluate(basisDeps, local, ALL_DOFS,
+                            tabulations[activeBasisAndCornerCount].basisData);
+  }
+
+  // Values and global coordinates at the corners of each element, stored
+  // in columns [maxCornerCount * e, maxCornerCount * (e + 1)). Only used for
+  // VERTEX_DATA, where several elements contribute to the same column of
+  // the result; the contributions are summed after the parallel loop.
+  const int maxCornerCount = rawGeometry.elementCornerIndices().n_rows;
+  arma::Mat<ResultType> cornerValues;
+  arma::Mat<CoordinateType> cornerPoints;
+  if (dataType == VtkWriter::VERTEX_DATA) {
+    cornerValues.set_size(nComponents, maxCornerCount * elementCount);
+    cornerPoints.set_size(worldDim, maxCornerCount * elementCount);
+  }
 
+  const int threadCount =
+      m_context ? maxThreadCount(
+                      m_context->assemblyOptions().parallelizationOptions())
+                : int(tbb::task_scheduler_init::automatic);
+  tbb::task_scheduler_init scheduler(threadCount);
+
+  // Loop over elements in chunks; each chunk has its own geometry and
+  // scratch arrays
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, elementCount, 256),
+                    [&](const tbb::blocked_range<size_t> &r) {
+    std::unique_ptr<typename GeometryFactory::Geometry> geometry(
+        geometryFactory->make());
+    Fiber::GeometricalData<CoordinateType> geomData;
     Fiber::BasisData<ResultType> functionData;
-    if (basisDeps & Fiber::VALUES)
-      functionData.values.set_size(basisData.values.extent(0),
-                                   1, // just one function
-                                   basisData.values.extent(2));
-    if (basisDeps & Fiber::DERIVATIVES)
-      functionData.derivatives.set_size(basisData.derivatives.extent(0),
-                                        basisData.derivatives.extent(1),
-                                        1, // just one function
-                                        basisData.derivatives.extent(3));
     Fiber::CollectionOf3dArrays<ResultType> functionValues;
-
-    // Loop over elements and process those that use the active shapeset
-    for (size_t e = 0; e < elementCount; ++e) {
-      if (basesAndCornerCounts[e].first != &activeShapeset)
-        continue;
+    const Tabulation *previousTabulation = 0;
+
+    for (size_t e = r.begin(); e != r.end(); ++e) {
+      const Tabulation &tabulation =
+          tabulations.find(basesAndCornerCounts[e])->second;
+      const arma::Mat<CoordinateType> &local = tabulation.local;
+      const Fiber::BasisData<BasisFunctionType> &basisData =
+          tabulation.basisData;
+      const int activeCornerCount = basesAndCornerCounts[e].second;
+
+      if (&tabulation != previousTabulation) {
+        if (basisDeps & Fiber::VALUES)
+          functionData.values.set_size(basisData.values.extent(0),
+                                       1, // just one function
+                                       basisData.values.extent(2));
+        if (basisDeps & Fiber::DERIVATIVES)
+          functionData.derivatives.set_size(basisData.derivatives.extent(0),
+                                            basisData.derivatives.extent(1),
+                                            1, // just one function
+                                            basisData.derivatives.extent(3));
+        previousTabulation = &tabulation;
+      }
 
       // Local coefficients of the argument in the current element
       const std::vector<ResultType> &activeLocalCoefficients =
@@ -998,27 +1061,36 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
         for (int dim = 0; dim < worldDim; ++dim)
           points(dim, e) = geomData.globals(dim, 0);
       } else { // VERTEX_DATA
-        // Add the calculated values to the columns of the result array
-        // corresponding to the active element's vertices
         for (int c = 0; c < activeCornerCount; ++c) {
-          int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
           for (int dim = 0; dim < nComponents; ++dim)
-            values(dim, vertexIndex) += functionValues[0](dim, 0, c);
-          ++multiplicities[vertexIndex];
-        }
-        for (int c = 0; c < activeCornerCount; ++c) {
-          int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
+            cornerValues(dim, maxCornerCount * e + c) =
+                functionValues[0](dim, 0, c);
           for (int dim = 0; dim < worldDim; ++dim)
-            points(dim, vertexIndex) = geomData.globals(dim, c);
+            cornerPoints(dim, maxCornerCount * e + c) =
+                geomData.globals(dim, c);
         }
       }
     } // end of loop over elements
-  }   // end of loop over unique combinations of shapeset and corner count
+  });
+
+  if (dataType == VtkWriter::VERTEX_DATA) {
+    // Add the calculated values to the columns of the result array
+    // corresponding to each element's vertices
+    for (size_t e = 0; e < elementCount; ++e) {
+      const int activeCornerCount = basesAndCornerCounts[e].second;
+      for (int c = 0; c < activeCornerCount; ++c) {
+        int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
+        values.col(vertexIndex) += cornerValues.col(maxCornerCount * e + c);
+        points.col(vertexIndex) = cornerPoints.col(maxCornerCount * e + c);
+        ++multiplicities[vertexIndex];
+      }
+    }
 
-  // Take average of the vertex values obtained in each of the adjacent elements
-  if (dataType == VtkWriter::VERTEX_DATA)
+    // Take average of the vertex values obtained in each of the adjacent
+    // elements
     for (size_t v = 0; v < vertexCount; ++v)
       values.col(v) /= multiplicities[v];
+  }
 }
 
 template <typename BasisFunctionType, typename ResultType>
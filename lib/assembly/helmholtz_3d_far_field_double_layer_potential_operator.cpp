@@ -27,7 +27,7 @@
 #include "../fiber/scalar_function_value_functor.hpp"
 #include "../fiber/simple_scalar_kernel_trial_integrand_functor.hpp"
 
-#include "../fiber/default_collection_of_kernels.hpp"
+#include "../fiber/far_field_collection_of_kernels.hpp"
 #include "../fiber/default_collection_of_basis_transformations.hpp"
 #include "../fiber/default_kernel_trial_integral.hpp"
 
@@ -56,7 +56,7 @@ struct Helmholtz3dFarFieldDoubleLayerPotentialOperatorImpl {
         transformations(TransformationFunctor()), integral(IntegrandFunctor()) {
   }
 
-  Fiber::DefaultCollectionOfKernels<KernelFunctor> kernels;
+  Fiber::FarFieldCollectionOfKernels<KernelFunctor> kernels;
   Fiber::DefaultCollectionOfBasisTransformations<TransformationFunctor>
   transformations;
   Fiber::DefaultKernelTrialIntegral<IntegrandFunctor> integral;
@@ -30,9 +30,10 @@
 #include "discrete_sparse_boundary_operator.hpp"
 #include "weak_form_hmat_assembly_helper.hpp"
 #include "discrete_hmat_boundary_operator.hpp"
+#include "discrete_matrix_free_boundary_operator.hpp"
 
 #include "../common/armadillo_fwd.hpp"
-#include "../common/auto_timer.hpp"
+#include "../common/assembly_profile.hpp"
 #include "../common/chunk_statistics.hpp"
 #include "../common/to_string.hpp"
 #include "../fiber/explicit_instantiation.hpp"
@@ -43,13 +44,16 @@
 #include "../common/bounding_box.hpp"
 
 #include "../hmat/block_cluster_tree.hpp"
+#include "../hmat/cluster_tree.hpp"
 #include "../hmat/geometry_interface.hpp"
 #include "../hmat/geometry_data_type.hpp"
 #include "../hmat/geometry.hpp"
 #include "../hmat/hmatrix.hpp"
+#include "../hmat/hmatrix_statistics.hpp"
 #include "../hmat/data_accessor.hpp"
 #include "../hmat/hmatrix_dense_compressor.hpp"
 #include "../hmat/hmatrix_aca_compressor.hpp"
+#include "../hmat/hmatrix_mixed_precision_compressor.hpp"
 
 #include <stdexcept>
 #include <fstream>
@@ -103,11 +107,46 @@ private:
   std::vector<BoundingBox<CoordinateType>> m_bemppBoundingBoxes;
 };
 
+void printClusterTreeStatistics(const std::string &name,
+                                const hmat::DefaultClusterTreeType &tree) {
+  const hmat::ClusterTreeStatistics stats = tree.statistics();
+  std::cout << name << " cluster tree: " << stats.numberOfLeaves
+            << " leaves, depth " << stats.depth << std::endl;
+  std::cout << "  Leaf sizes (size: count):";
+  for (std::size_t size = 0; size < stats.leafSizeHistogram.size(); ++size)
+    if (stats.leafSizeHistogram[size] > 0)
+      std::cout << " " << size << ": " << stats.leafSizeHistogram[size];
+  std::cout << std::endl;
+  std::cout << "  Leaf depths (depth: count):";
+  for (std::size_t depth = 0; depth < stats.leafDepthHistogram.size(); ++depth)
+    if (stats.leafDepthHistogram[depth] > 0)
+      std::cout << " " << depth << ": " << stats.leafDepthHistogram[depth];
+  std::cout << std::endl;
+}
+
+hmat::ClusterSplittingStrategy
+clusterSplittingStrategy(const ParameterList &hMatParameterList) {
+  if (!hMatParameterList.isParameter("clusterSplittingStrategy"))
+    return hmat::GEOMETRIC_BISECTION;
+  const std::string strategy =
+      hMatParameterList.get<std::string>("clusterSplittingStrategy");
+  if (strategy == "GeometricBisection")
+    return hmat::GEOMETRIC_BISECTION;
+  if (strategy == "Median")
+    return hmat::MEDIAN_SPLIT;
+  if (strategy == "PrincipalAxis")
+    return hmat::PRINCIPAL_AXIS_SPLIT;
+  throw std::invalid_argument("clusterSplittingStrategy(): unknown cluster "
+                              "splitting strategy '" + strategy + "'");
+}
+
 template <typename BasisFunctionType>
 shared_ptr<hmat::DefaultBlockClusterTreeType>
-generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
-                         const Space<BasisFunctionType> &trialSpace,
-                         int minBlockSize, int maxBlockSize, double eta) {
+buildBlockClusterTree(const Space<BasisFunctionType> &testSpace,
+                      const Space<BasisFunctionType> &trialSpace,
+                      int minBlockSize, int maxBlockSize, double eta,
+                      hmat::ClusterSplittingStrategy strategy,
+                      VerbosityLevel::Level verbosityLevel) {
 
   hmat::Geometry testGeometry;
   hmat::Geometry trialGeometry;
@@ -122,10 +161,15 @@ generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
   hmat::fillGeometry(trialGeometry, *trialSpaceGeometryInterface);
 
   auto testClusterTree = shared_ptr<hmat::DefaultClusterTreeType>(
-      new hmat::DefaultClusterTreeType(testGeometry, minBlockSize));
+      new hmat::DefaultClusterTreeType(testGeometry, minBlockSize, strategy));
 
   auto trialClusterTree = shared_ptr<hmat::DefaultClusterTreeType>(
-      new hmat::DefaultClusterTreeType(trialGeometry, minBlockSize));
+      new hmat::DefaultClusterTreeType(trialGeometry, minBlockSize, strategy));
+
+  if (verbosityLevel >= VerbosityLevel::HIGH) {
+    printClusterTreeStatistics("Test", *testClusterTree);
+    printClusterTreeStatistics("Trial", *trialClusterTree);
+  }
 
   shared_ptr<hmat::DefaultBlockClusterTreeType> blockClusterTree(
       new hmat::DefaultBlockClusterTreeType(testClusterTree, trialClusterTree,
@@ -134,7 +178,116 @@ generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
 
   return blockClusterTree;
 }
+
+template <typename BasisFunctionType>
+void makeActualSpaces(
+    const shared_ptr<const Space<BasisFunctionType>> &testSpace,
+    const shared_ptr<const Space<BasisFunctionType>> &trialSpace,
+    bool indexWithGlobalDofs,
+    shared_ptr<const Space<BasisFunctionType>> &actualTestSpace,
+    shared_ptr<const Space<BasisFunctionType>> &actualTrialSpace) {
+  if (indexWithGlobalDofs) {
+    actualTestSpace = testSpace->discontinuousSpace(testSpace);
+    actualTrialSpace = trialSpace->discontinuousSpace(trialSpace);
+  } else {
+    actualTestSpace = testSpace;
+    actualTrialSpace = trialSpace;
+  }
+}
+
+template <typename BasisFunctionType>
+void makeActualSpaces(
+    const Space<BasisFunctionType> &testSpace,
+    const Space<BasisFunctionType> &trialSpace, bool indexWithGlobalDofs,
+    shared_ptr<const Space<BasisFunctionType>> &actualTestSpace,
+    shared_ptr<const Space<BasisFunctionType>> &actualTrialSpace) {
+  makeActualSpaces(Fiber::make_shared_from_const_ref(testSpace),
+                   Fiber::make_shared_from_const_ref(trialSpace),
+                   indexWithGlobalDofs, actualTestSpace, actualTrialSpace);
+}
+
+// Data accessor owning everything the WeakFormHMatAssemblyHelper it wraps
+// refers to, so that it can outlive the assembly
+template <typename BasisFunctionType, typename ResultType>
+class OwningHMatDataAccessor : public hmat::DataAccessor<ResultType, 2> {
+public:
+  typedef Fiber::LocalAssemblerForIntegralOperators<ResultType> LocalAssembler;
+
+  OwningHMatDataAccessor(
+      const shared_ptr<const Space<BasisFunctionType>> &testSpace,
+      const shared_ptr<const Space<BasisFunctionType>> &trialSpace,
+      const shared_ptr<hmat::DefaultBlockClusterTreeType> &blockClusterTree,
+      const shared_ptr<LocalAssembler> &assembler)
+      : m_testSpace(testSpace), m_trialSpace(trialSpace),
+        m_assembler(assembler), m_assemblers(1, assembler.get()),
+        m_denseTermMultipliers(1, 1.),
+        m_helper(*m_testSpace, *m_trialSpace, blockClusterTree, m_assemblers,
+                 m_sparseTermsToAdd, m_denseTermMultipliers,
+                 m_sparseTermMultipliers) {}
+
+  void computeMatrixBlock(
+      const hmat::IndexRangeType &testIndexRange,
+      const hmat::IndexRangeType &trialIndexRange,
+      const hmat::DefaultBlockClusterTreeNodeType &blockClusterTreeNode,
+      arma::Mat<ResultType> &data) const override {
+    m_helper.computeMatrixBlock(testIndexRange, trialIndexRange,
+                                blockClusterTreeNode, data);
+  }
+
+private:
+  shared_ptr<const Space<BasisFunctionType>> m_testSpace;
+  shared_ptr<const Space<BasisFunctionType>> m_trialSpace;
+  shared_ptr<LocalAssembler> m_assembler;
+  std::vector<LocalAssembler *> m_assemblers;
+  std::vector<const DiscreteBoundaryOperator<ResultType> *> m_sparseTermsToAdd;
+  std::vector<ResultType> m_denseTermMultipliers;
+  std::vector<ResultType> m_sparseTermMultipliers;
+  WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType> m_helper;
+};
+
+template <typename ResultType>
+void recordHMatrixBlocks(const hmat::DefaultHMatrixType<ResultType> &hMatrix,
+                         AssemblyProfile &profile) {
+  const std::vector<hmat::HMatrixBlockStatistics> blocks =
+      hMatrix.blockStatistics();
+  for (std::size_t i = 0; i < blocks.size(); ++i)
+    profile.addBlock(blocks[i].rows, blocks[i].columns, blocks[i].rank,
+                     blocks[i].memSizeKb);
+}
+
+bool indexWithGlobalDofs(const ParameterList &hMatParameterList) {
+  return (hMatParameterList.get<std::string>("HMatAssemblyMode") ==
+          "GlobalAssembly");
+}
 } // end anonymous namespace
+
+template <typename BasisFunctionType, typename ResultType>
+shared_ptr<hmat::BlockClusterTree<2>>
+HMatGlobalAssembler<BasisFunctionType, ResultType>::generateBlockClusterTree(
+    const Space<BasisFunctionType> &testSpace,
+    const Space<BasisFunctionType> &trialSpace,
+    const Context<BasisFunctionType, ResultType> &context) {
+
+  const auto hMatParameterList =
+      context.globalParameterList().sublist("HMat");
+
+  shared_ptr<const Space<BasisFunctionType>> actualTestSpace;
+  shared_ptr<const Space<BasisFunctionType>> actualTrialSpace;
+  makeActualSpaces(testSpace, trialSpace, indexWithGlobalDofs(hMatParameterList),
+                   actualTestSpace, actualTrialSpace);
+
+  auto minBlockSize =
+      hMatParameterList.template get<int>("minBlockSize");
+  auto maxBlockSize =
+      hMatParameterList.template get<int>("maxBlockSize");
+  auto eta = hMatParameterList.template get<double>("eta");
+
+  return buildBlockClusterTree(
+      *actualTestSpace, *actualTrialSpace, minBlockSize, maxBlockSize, eta,
+      clusterSplittingStrategy(hMatParameterList),
+      context.assemblyOptions().verbosityLevel());
+}
+
 template <typename BasisFunctionType, typename ResultType>
 std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
 HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
@@ -148,38 +301,41 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
     const std::vector<ResultType> &sparseTermMultipliers,
     const Context<BasisFunctionType, ResultType> &context, int symmetry) {
 
-  const AssemblyOptions &options = context.assemblyOptions();
+  shared_ptr<hmat::BlockClusterTree<2>> blockClusterTree;
+  {
+    AssemblyProfile::PhaseTimer timer("clusterTree");
+    blockClusterTree = generateBlockClusterTree(testSpace, trialSpace, context);
+  }
+
+  return assembleDetachedWeakForm(
+      testSpace, trialSpace, localAssemblers,
+      localAssemblersForAdmissibleBlocks, sparseTermsToAdd,
+      denseTermMultipliers, sparseTermMultipliers, context, symmetry,
+      blockClusterTree);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
+HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
+    const Space<BasisFunctionType> &testSpace,
+    const Space<BasisFunctionType> &trialSpace,
+    const std::vector<LocalAssemblerForIntegralOperators *> &localAssemblers,
+    const std::vector<LocalAssemblerForIntegralOperators *> &
+        localAssemblersForAdmissibleBlocks,
+    const std::vector<const DiscreteBndOp *> &sparseTermsToAdd,
+    const std::vector<ResultType> &denseTermMultipliers,
+    const std::vector<ResultType> &sparseTermMultipliers,
+    const Context<BasisFunctionType, ResultType> &context, int symmetry,
+    const shared_ptr<hmat::BlockClusterTree<2>> &blockClusterTree,
+    hmat::AcaPivotMemory<2> *pivotMemory) {
+
   const auto hMatParameterList =
-      context.globalParameterList().sublist("HMatParameters");
-  const bool indexWithGlobalDofs =
-      (hMatParameterList.template get<std::string>("HMatAssemblyMode") ==
-       "GlobalAssembly");
-  const bool verbosityAtLeastDefault =
-      (options.verbosityLevel() >= VerbosityLevel::DEFAULT);
-  const bool verbosityAtLeastHigh =
-      (options.verbosityLevel() >= VerbosityLevel::HIGH);
-
-  auto testSpacePointer = Fiber::make_shared_from_const_ref(testSpace);
-  auto trialSpacePointer = Fiber::make_shared_from_const_ref(trialSpace);
+      context.globalParameterList().sublist("HMat");
 
   shared_ptr<const Space<BasisFunctionType>> actualTestSpace;
   shared_ptr<const Space<BasisFunctionType>> actualTrialSpace;
-  if (indexWithGlobalDofs) {
-    actualTestSpace = testSpacePointer->discontinuousSpace(testSpacePointer);
-    actualTrialSpace = trialSpacePointer->discontinuousSpace(trialSpacePointer);
-  } else {
-    actualTestSpace = testSpacePointer;
-    actualTrialSpace = trialSpacePointer;
-  }
-
-  auto minBlockSize =
-      hMatParameterList.template get<unsigned int>("minBlockSize");
-  auto maxBlockSize =
-      hMatParameterList.template get<unsigned int>("maxBlockSize");
-  auto eta = hMatParameterList.template get<double>("eta");
-
-  auto blockClusterTree = generateBlockClusterTree(
-      *actualTestSpace, *actualTrialSpace, minBlockSize, maxBlockSize, eta);
+  makeActualSpaces(testSpace, trialSpace, indexWithGlobalDofs(hMatParameterList),
+                   actualTestSpace, actualTrialSpace);
 
   // blockClusterTree->writeToPdfFile("tree.pdf", 1024, 1024);
 
@@ -191,14 +347,57 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
   // shared_ptr<hmat::CompressedMatrix<ResultType>> hMatrix(
   //    new hmat::DefaultHMatrixType<ResultType>(blockClusterTree, compressor));
 
-  hmat::HMatrixAcaCompressor<ResultType, 2> compressor(helper, 1E-3, 30);
-  shared_ptr<hmat::CompressedMatrix<ResultType>> hMatrix(
-      new hmat::DefaultHMatrixType<ResultType>(blockClusterTree, compressor));
+  hmat::HMatrixAcaCompressor<ResultType, 2> compressor(helper, 1E-3, 30, 10,
+                                                       pivotMemory);
 
-  return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
-      new DiscreteHMatBoundaryOperator<ResultType>(hMatrix));
+  const bool singlePrecisionLowRankBlocks =
+      hMatParameterList.isParameter("singlePrecisionLowRankBlocks") &&
+      hMatParameterList.template get<bool>("singlePrecisionLowRankBlocks");
+
+  shared_ptr<hmat::DefaultHMatrixType<ResultType>> hMatrix;
+  if (!singlePrecisionLowRankBlocks) {
+    AssemblyProfile::PhaseTimer timer("compression");
+    hMatrix.reset(
+        new hmat::DefaultHMatrixType<ResultType>(blockClusterTree, compressor));
+  } else {
+    hmat::HMatrixMixedPrecisionCompressor<ResultType, 2> mixedCompressor(
+        compressor);
+    {
+      AssemblyProfile::PhaseTimer timer("compression");
+      hMatrix.reset(new hmat::DefaultHMatrixType<ResultType>(blockClusterTree,
+                                                             mixedCompressor));
+    }
+
+    if (context.assemblyOptions().verbosityLevel() >=
+        VerbosityLevel::DEFAULT) {
+      const hmat::MixedPrecisionStatistics stats =
+          mixedCompressor.statistics();
+      std::cout << "Stored " << stats.numberOfBlocks
+                << " low-rank blocks in single precision: "
+                << stats.storedMemSizeKb << " kB instead of "
+                << stats.fullPrecisionMemSizeKb
+                << " kB, relative rounding error of the low-rank part "
+                << stats.roundingRelativeError << std::endl;
+    }
+  }
+
+  AssemblyProfile *profile = AssemblyProfile::current();
+  if (profile) {
+    // Recorded before the error estimation, which accesses further entries
+    profile->addCount("accessedEntries", helper.accessedEntryCount());
+    profile->addCount("localWeakFormEvaluations", helper.localWeakFormCount());
+    recordHMatrixBlocks(*hMatrix, *profile);
+  }
+
+  if (hMatParameterList.isParameter("estimateBlockErrors") &&
+      hMatParameterList.template get<bool>("estimateBlockErrors")) {
+    AssemblyProfile::PhaseTimer timer("errorEstimation");
+    hMatrix->estimateBlockErrors(helper);
+  }
 
-  // return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>();
+  return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
+      new DiscreteHMatBoundaryOperator<ResultType>(
+          shared_ptr<hmat::CompressedMatrix<ResultType>>(hMatrix)));
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -223,6 +422,72 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
                                   sparseTermsMultipliers, context, symmetry);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+std::unique_ptr<DiscreteBoundaryOperator<ResultType>>
+HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleMatrixFreeWeakForm(
+    const shared_ptr<const Space<BasisFunctionType>> &testSpace,
+    const shared_ptr<const Space<BasisFunctionType>> &trialSpace,
+    LocalAssemblerForIntegralOperators &localAssembler,
+    const shared_ptr<LocalAssemblerForIntegralOperators> &
+        localAssemblerForAdmissibleBlocks,
+    const Context<BasisFunctionType, ResultType> &context) {
+
+  const auto hMatParameterList =
+      context.globalParameterList().sublist("HMat");
+
+  shared_ptr<const Space<BasisFunctionType>> actualTestSpace;
+  shared_ptr<const Space<BasisFunctionType>> actualTrialSpace;
+  makeActualSpaces(testSpace, trialSpace, indexWithGlobalDofs(hMatParameterList),
+                   actualTestSpace, actualTrialSpace);
+
+  shared_ptr<hmat::BlockClusterTree<2>> blockClusterTree;
+  {
+    AssemblyProfile::PhaseTimer timer("clusterTree");
+    blockClusterTree =
+        generateBlockClusterTree(*testSpace, *trialSpace, context);
+  }
+
+  typedef LocalAssemblerForIntegralOperators Assembler;
+  std::vector<Assembler *> localAssemblers(1, &localAssembler);
+  std::vector<const DiscreteBndOp *> sparseTermsToAdd;
+  std::vector<ResultType> denseTermsMultipliers(1, 1.0);
+  std::vector<ResultType> sparseTermsMultipliers;
+  WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType> nearFieldHelper(
+      *actualTestSpace, *actualTrialSpace, blockClusterTree, localAssemblers,
+      sparseTermsToAdd, denseTermsMultipliers, sparseTermsMultipliers);
+
+  shared_ptr<const hmat::DataAccessor<ResultType, 2>> farFieldAccessor(
+      new OwningHMatDataAccessor<BasisFunctionType, ResultType>(
+          actualTestSpace, actualTrialSpace, blockClusterTree,
+          localAssemblerForAdmissibleBlocks));
+
+  std::unique_ptr<DiscreteMatrixFreeBoundaryOperator<ResultType>> result;
+  {
+    AssemblyProfile::PhaseTimer timer("nearField");
+    result.reset(new DiscreteMatrixFreeBoundaryOperator<ResultType>(
+        blockClusterTree, nearFieldHelper, farFieldAccessor,
+        context.assemblyOptions().parallelizationOptions()));
+  }
+
+  if (AssemblyProfile *profile = AssemblyProfile::current()) {
+    profile->addCount("accessedEntries", nearFieldHelper.accessedEntryCount());
+    profile->addCount("localWeakFormEvaluations",
+                      nearFieldHelper.localWeakFormCount());
+    profile->addCount("nearFieldBlocks", result->nearFieldBlockCount());
+    profile->addCount("farFieldBlocks", result->farFieldBlockCount());
+  }
+
+  if (context.assemblyOptions().verbosityLevel() >= VerbosityLevel::DEFAULT)
+    std::cout << "Stored " << result->nearFieldBlockCount()
+              << " near-field blocks (" << result->memSizeKb()
+              << " kB); " << result->farFieldBlockCount()
+              << " far-field blocks will be recomputed in each product"
+              << std::endl;
+
+  return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
+      result.release());
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(HMatGlobalAssembler);
 
 } // namespace Bempp
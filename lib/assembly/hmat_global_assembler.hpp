@@ -41,6 +41,15 @@ template <typename ResultType> class LocalAssemblerForPotentialOperators;
 
 } // namespace Fiber
 
+namespace hmat {
+
+/** \cond FORWARD_DECL */
+template <int N> class BlockClusterTree;
+template <int N> class AcaPivotMemory;
+/** \endcond */
+
+} // namespace hmat
+
 namespace Bempp {
 
 /** \cond FORWARD_DECL */
@@ -68,6 +77,37 @@ public:
   typedef Fiber::LocalAssemblerForPotentialOperators<ResultType>
   LocalAssemblerForPotentialOperators;
 
+  /** \brief Construct the block cluster tree used by
+   *  assembleDetachedWeakForm() for the given pair of spaces.
+   *
+   *  The tree depends only on the spaces and on the "HMat"
+   *  sublist of the context's global parameter list. It can therefore be
+   *  built once and passed to assembleDetachedWeakForm() for each operator
+   *  of a family sharing these spaces, e.g. in a frequency sweep. */
+  static shared_ptr<hmat::BlockClusterTree<2>>
+  generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
+                           const Space<BasisFunctionType> &trialSpace,
+                           const Context<BasisFunctionType, ResultType> &context);
+
+  /** \brief Assemble an H-matrix using a precomputed block cluster tree.
+   *
+   *  \p blockClusterTree must have been obtained from
+   *  generateBlockClusterTree() for the same spaces and context. If
+   *  \p pivotMemory is not null, ACA starts from the pivots stored in it
+   *  and overwrites them with the pivots it ends up choosing. */
+  static std::unique_ptr<DiscreteBndOp> assembleDetachedWeakForm(
+      const Space<BasisFunctionType> &testSpace,
+      const Space<BasisFunctionType> &trialSpace,
+      const std::vector<LocalAssemblerForIntegralOperators *> &localAssemblers,
+      const std::vector<LocalAssemblerForIntegralOperators *> &
+          localAssemblersForAdmissibleBlocks,
+      const std::vector<const DiscreteBndOp *> &sparseTermsToAdd,
+      const std::vector<ResultType> &denseTermMultipliers,
+      const std::vector<ResultType> &sparseTermMultipliers,
+      const Context<BasisFunctionType, ResultType> &context, int symmetry,
+      const shared_ptr<hmat::BlockClusterTree<2>> &blockClusterTree,
+      hmat::AcaPivotMemory<2> *pivotMemory = 0);
+
   static std::unique_ptr<DiscreteBndOp> assembleDetachedWeakForm(
       const Space<BasisFunctionType> &testSpace,
       const Space<BasisFunctionType> &trialSpace,
@@ -88,6 +128,21 @@ public:
       int symmetry); // used to be "bool symmetric"; fortunately "true"
                      // is converted to 1 == SYMMETRIC
 
+  /** \brief Assemble a matrix-free operator.
+   *
+   *  Only the inadmissible blocks of the block cluster tree are evaluated,
+   *  with \p localAssembler, and stored. The admissible blocks are
+   *  recomputed with \p localAssemblerForAdmissibleBlocks each time the
+   *  returned DiscreteMatrixFreeBoundaryOperator is applied; it therefore
+   *  keeps that assembler and the two spaces alive. */
+  static std::unique_ptr<DiscreteBndOp> assembleMatrixFreeWeakForm(
+      const shared_ptr<const Space<BasisFunctionType>> &testSpace,
+      const shared_ptr<const Space<BasisFunctionType>> &trialSpace,
+      LocalAssemblerForIntegralOperators &localAssembler,
+      const shared_ptr<LocalAssemblerForIntegralOperators> &
+          localAssemblerForAdmissibleBlocks,
+      const Context<BasisFunctionType, ResultType> &context);
+
   static std::unique_ptr<DiscreteBndOp> assemblePotentialOperator(
       const arma::Mat<CoordinateType> &points,
       const Space<BasisFunctionType> &trialSpace,
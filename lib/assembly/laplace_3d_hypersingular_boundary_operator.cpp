@@ -26,6 +26,7 @@
 #include "general_hypersingular_integral_operator_imp.hpp"
 #include "laplace_3d_single_layer_boundary_operator.hpp"
 #include "synthetic_integral_operator.hpp"
+#include "synthetic_internal_operator_cache.hpp"
 
 #include "../common/boost_make_shared_fwd.hpp"
 
@@ -108,10 +109,30 @@ laplace3dSyntheticHypersingularBoundaryOperator(
 
   if (!externalSlp.isInitialized()) {
 
-    slp = laplace3dSingleLayerBoundaryOperator<BasisFunctionType, ResultType>(
-        internalContext, internalTrialSpace,
-        internalTestSpace /* or whatever */, internalTestSpace,
-        "(" + label + ")_internal_SLP", internalSymmetry);
+    // Shared with the single-layer operators assembled on the same
+    // discontinuous spaces
+    typedef SyntheticInternalOperatorCache<BasisFunctionType, ResultType>
+        Cache;
+    BoundaryOperator<BasisFunctionType, ResultType>(*slpConstructor)(
+        const shared_ptr<const Context<BasisFunctionType, ResultType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &,
+        const std::string &, int) =
+        &laplace3dSingleLayerBoundaryOperator<BasisFunctionType, ResultType>;
+    slp = context->syntheticInternalOperatorCache()->internalOperator(
+        Cache::kernelKey(slpConstructor), internalTrialSpace,
+        internalTestSpace, internalSymmetry, [&]() {
+          // The range of a cached operator must not depend on the caller
+          return slpConstructor(internalContext, internalTrialSpace,
+                                internalTestSpace, internalTestSpace,
+                                "(" + label + ")_internal_SLP",
+                                internalSymmetry);
+        });
+    // A cached operator may act on discontinuous spaces created for other
+    // synthetic operators
+    internalTrialSpace = slp.domain();
+    internalTestSpace = slp.dualToRange();
 
   } else {
 
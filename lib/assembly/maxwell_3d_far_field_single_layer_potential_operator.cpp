@@ -27,7 +27,7 @@
 #include "../fiber/modified_maxwell_3d_single_layer_operators_transformation_functor.hpp"
 #include "../fiber/modified_maxwell_3d_single_layer_potential_operator_integrand_functor.hpp"
 
-#include "../fiber/default_collection_of_kernels.hpp"
+#include "../fiber/far_field_collection_of_kernels.hpp"
 #include "../fiber/default_collection_of_basis_transformations.hpp"
 #include "../fiber/default_kernel_trial_integral.hpp"
 
@@ -57,7 +57,7 @@ struct Maxwell3dFarFieldSingleLayerPotentialOperatorImpl {
         transformations(TransformationFunctor()), integral(IntegrandFunctor()) {
   }
 
-  Fiber::DefaultCollectionOfKernels<KernelFunctor> kernels;
+  Fiber::FarFieldCollectionOfKernels<KernelFunctor> kernels;
   Fiber::DefaultCollectionOfBasisTransformations<TransformationFunctor>
   transformations;
   Fiber::DefaultKernelTrialIntegral<IntegrandFunctor> integral;
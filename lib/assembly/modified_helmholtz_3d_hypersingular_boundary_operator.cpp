@@ -30,6 +30,7 @@
 #include "general_hypersingular_integral_operator_imp.hpp"
 #include "modified_helmholtz_3d_single_layer_boundary_operator.hpp"
 #include "synthetic_integral_operator.hpp"
+#include "synthetic_internal_operator_cache.hpp"
 
 #include "../fiber/explicit_instantiation.hpp"
 
@@ -114,12 +115,33 @@ modifiedHelmholtz3dSyntheticHypersingularBoundaryOperator(
   BoundaryOperator<BasisFunctionType, ResultType> slp;
   if (!externalSlp.isInitialized()) {
 
-    slp = modifiedHelmholtz3dSingleLayerBoundaryOperator<
-        BasisFunctionType, KernelType, ResultType>(
-        internalContext, internalTrialSpace,
-        internalTestSpace /* or whatever */, internalTestSpace, waveNumber,
-        "(" + label + ")_internal_SLP", internalSymmetry, useInterpolation,
-        interpPtsPerWavelength);
+    // Shared with the single-layer operators assembled on the same
+    // discontinuous spaces
+    typedef SyntheticInternalOperatorCache<BasisFunctionType, ResultType>
+        Cache;
+    BoundaryOperator<BasisFunctionType, ResultType>(*slpConstructor)(
+        const shared_ptr<const Context<BasisFunctionType, ResultType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &,
+        const shared_ptr<const Space<BasisFunctionType>> &, KernelType,
+        const std::string &, int, bool, int) =
+        &modifiedHelmholtz3dSingleLayerBoundaryOperator<BasisFunctionType,
+                                                        KernelType, ResultType>;
+    slp = context->syntheticInternalOperatorCache()->internalOperator(
+        Cache::kernelKey(slpConstructor, waveNumber, useInterpolation,
+                         interpPtsPerWavelength),
+        internalTrialSpace, internalTestSpace, internalSymmetry, [&]() {
+          // The range of a cached operator must not depend on the caller
+          return slpConstructor(
+              internalContext, internalTrialSpace,
+              internalTestSpace, internalTestSpace,
+              waveNumber, "(" + label + ")_internal_SLP", internalSymmetry,
+              useInterpolation, interpPtsPerWavelength);
+        });
+    // A cached operator may act on discontinuous spaces created for other
+    // synthetic operators
+    internalTrialSpace = slp.domain();
+    internalTestSpace = slp.dualToRange();
   } else {
 
     slp = externalSlp;
@@ -131,57 +153,55 @@ modifiedHelmholtz3dSyntheticHypersingularBoundaryOperator(
     syntheseSymmetry =
         HERMITIAN | (boost::is_complex<BasisFunctionType>() ? 0 : SYMMETRIC);
 
+  // Both the curl-curl term and the normal-normal term, weighted with the
+  // squared wave number, are built on the single-layer operator. They are
+  // kept in a single synthetic operator so that the mass matrices are
+  // inverted once and each application of the weak form applies the
+  // single-layer operator to the vectors of all six terms in one go.
   std::vector<BoundaryOperator<BasisFunctionType, ResultType>> testLocalOps;
   std::vector<BoundaryOperator<BasisFunctionType, ResultType>> trialLocalOps;
-  testLocalOps.resize(dimWorld);
-  for (size_t i = 0; i < dimWorld; ++i)
-    testLocalOps[i] = BoundaryOperator<BasisFunctionType, ResultType>(
+  std::vector<ResultType> weights;
+  for (size_t i = 0; i < dimWorld; ++i) {
+    testLocalOps.push_back(BoundaryOperator<BasisFunctionType, ResultType>(
         auxContext, boost::make_shared<LocalOp>(
                         internalTestSpace, range, newDualToRange,
                         ("(" + label + ")_test_curl_") + xyz[i], NO_SYMMETRY,
-                        CurlFunctor(), ValueFunctor(), IntegrandFunctor(i, 0)));
+                        CurlFunctor(), ValueFunctor(), IntegrandFunctor(i, 0))));
+    weights.push_back(static_cast<ResultType>(1.));
+  }
+  for (size_t i = 0; i < dimWorld; ++i) {
+    testLocalOps.push_back(BoundaryOperator<BasisFunctionType, ResultType>(
+        auxContext,
+        boost::make_shared<LocalOp>(
+            internalTestSpace, range, newDualToRange,
+            ("(" + label + ")_test_k_value_n_") + xyz[i], NO_SYMMETRY,
+            ValueTimesNormalFunctor(), ValueFunctor(), IntegrandFunctor(i, 0))));
+    weights.push_back(static_cast<ResultType>(waveNumber * waveNumber));
+  }
 
   if (!syntheseSymmetry) {
-    trialLocalOps.resize(dimWorld);
     for (size_t i = 0; i < dimWorld; ++i)
-      trialLocalOps[i] = BoundaryOperator<BasisFunctionType, ResultType>(
+      trialLocalOps.push_back(BoundaryOperator<BasisFunctionType, ResultType>(
           auxContext,
           boost::make_shared<LocalOp>(
               newDomain, internalTrialSpace /* or whatever */,
               internalTrialSpace, ("(" + label + ")_trial_curl_") + xyz[i],
               NO_SYMMETRY, ValueFunctor(), CurlFunctor(),
-              IntegrandFunctor(0, i)));
-  }
-  // It might be more prudent to distinguish between the symmetry of the total
-  // operator and the symmetry of the decomposition
-  BoundaryOperator<BasisFunctionType, ResultType> term0(
-      context, boost::make_shared<SyntheticOp>(testLocalOps, slp, trialLocalOps,
-                                               label, syntheseSymmetry));
-
-  for (size_t i = 0; i < dimWorld; ++i)
-    testLocalOps[i] = BoundaryOperator<BasisFunctionType, ResultType>(
-        auxContext,
-        boost::make_shared<LocalOp>(
-            internalTestSpace, range, newDualToRange,
-            ("(" + label + ")_test_k_value_n_") + xyz[i], NO_SYMMETRY,
-            ValueTimesNormalFunctor(), ValueFunctor(), IntegrandFunctor(i, 0)));
-  if (!syntheseSymmetry)
+              IntegrandFunctor(0, i))));
     for (size_t i = 0; i < dimWorld; ++i)
-      trialLocalOps[i] = BoundaryOperator<BasisFunctionType, ResultType>(
+      trialLocalOps.push_back(BoundaryOperator<BasisFunctionType, ResultType>(
           auxContext,
           boost::make_shared<LocalOp>(
               newDomain, internalTrialSpace /* or whatever */,
               internalTrialSpace, ("(" + label + ")_trial_k_value_n_") + xyz[i],
               NO_SYMMETRY, ValueFunctor(), ValueTimesNormalFunctor(),
-              IntegrandFunctor(0, i)));
-  BoundaryOperator<BasisFunctionType, ResultType> slp_waveNumberSq =
-      (waveNumber * waveNumber) * slp;
-  BoundaryOperator<BasisFunctionType, ResultType> term1(
-      context,
-      boost::make_shared<SyntheticOp>(testLocalOps, slp_waveNumberSq,
-                                      trialLocalOps, label, syntheseSymmetry));
+              IntegrandFunctor(0, i))));
+  }
 
-  return term0 + term1;
+  return BoundaryOperator<BasisFunctionType, ResultType>(
+      context,
+      boost::make_shared<SyntheticOp>(testLocalOps, slp, trialLocalOps, label,
+                                      syntheseSymmetry, weights));
 }
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType>
@@ -23,6 +23,7 @@
 #include "abstract_boundary_operator.hpp"
 #include "boundary_operator.hpp"
 #include "context.hpp"
+#include "synthetic_internal_operator_cache.hpp"
 #include "synthetic_nonhypersingular_integral_operator_builder.hpp"
 
 #include "../fiber/explicit_instantiation.hpp"
@@ -80,14 +81,32 @@ modifiedHelmholtz3dSyntheticBoundaryOperator(
   if (label.empty())
     label =
         AbstractBoundaryOperator<BasisFunctionType, ResultType>::uniqueLabel();
+  // The range of a cached operator must not depend on the caller
+  auto makeInternalOp = [&]() {
+    return constructor(internalContext, internalTrialSpace,
+                       internalTestSpace, internalTestSpace, waveNumber,
+                       "(" + label + ")_internal", internalSymmetry,
+                       useInterpolation, interpPtsPerWavelength);
+  };
+  // If either transfer operator is missing, the internal operator acts
+  // directly on one of the requested spaces and so cannot be shared
+  typedef SyntheticInternalOperatorCache<BasisFunctionType, ResultType> Cache;
+  BoundaryOperator<BasisFunctionType, ResultType> internalOp =
+      (newDomain == internalTrialSpace || newDualToRange == internalTestSpace)
+          ? makeInternalOp()
+          : context->syntheticInternalOperatorCache()->internalOperator(
+                Cache::kernelKey(constructor, waveNumber, useInterpolation,
+                                 interpPtsPerWavelength),
+                internalTrialSpace, internalTestSpace, internalSymmetry,
+                makeInternalOp);
+  // A cached operator may act on discontinuous spaces created for other
+  // synthetic operators
+  internalTrialSpace = internalOp.domain();
+  internalTestSpace = internalOp.dualToRange();
   int syntheseSymmetry =
       (newDomain == newDualToRange && internalTrialSpace == internalTestSpace)
           ? maximumSyntheseSymmetry
           : 0;
-  BoundaryOperator<BasisFunctionType, ResultType> internalOp =
-      constructor(internalContext, internalTrialSpace, range /* or whatever */,
-                  internalTestSpace, waveNumber, "(" + label + ")_internal",
-                  internalSymmetry, useInterpolation, interpPtsPerWavelength);
   return syntheticNonhypersingularIntegralOperator(
       internalOp, newDomain, range, newDualToRange, internalTrialSpace,
       internalTestSpace, label, syntheseSymmetry);
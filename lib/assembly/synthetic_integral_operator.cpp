@@ -27,11 +27,13 @@
 #include "context.hpp"
 #include "discrete_boundary_operator.hpp"
 #include "discrete_sparse_boundary_operator.hpp"
+#include "discrete_synthetic_boundary_operator.hpp"
 #include "identity_operator.hpp"
 #include "sparse_inverse.hpp"
 #include "transposed_discrete_boundary_operator.hpp"
 
 #include "../common/boost_make_shared_fwd.hpp"
+#include "../common/complex_aux.hpp"
 #include "../common/shared_ptr.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 
@@ -46,6 +48,8 @@
 
 #include <tbb/tick_count.h>
 
+#include <algorithm>
+
 namespace Bempp {
 
 namespace {
@@ -75,6 +79,10 @@ coalesceTestOperators(
     shared_ptr<const SparseOp> op =
         boost::dynamic_pointer_cast<const SparseOp>(discreteLocalOps[i]);
     if (op) {
+      if (op->epetraImaginaryMatrix())
+        throw std::runtime_error(
+            "SyntheticIntegralOperator::coalesceTestOperators(): "
+            "local operators with an imaginary part are not supported yet");
       shared_ptr<const Epetra_CrsMatrix> opMat = op->epetraMatrix();
       shared_ptr<Epetra_CrsMatrix> composition(
           new Epetra_CrsMatrix(Copy, opMat->Graph()));
@@ -110,6 +118,10 @@ coalesceTrialOperators(
     shared_ptr<const SparseOp> op =
         boost::dynamic_pointer_cast<const SparseOp>(discreteLocalOps[i]);
     if (op) {
+      if (op->epetraImaginaryMatrix())
+        throw std::runtime_error(
+            "SyntheticIntegralOperator::coalesceTrialOperators(): "
+            "local operators with an imaginary part are not supported yet");
       shared_ptr<const Epetra_CrsMatrix> opMat = op->epetraMatrix();
       shared_ptr<Epetra_CrsMatrix> composition(
           new Epetra_CrsMatrix(Copy, opMat->Graph()));
@@ -150,7 +162,9 @@ transposeTestOperators(
         mode &= ~TRANSPOSE;
       else
         mode |= TRANSPOSE;
-      result[i].reset(new SparseOp(op->epetraMatrix(), op->symmetryMode(),
+      result[i].reset(new SparseOp(op->epetraMatrix(),
+                                   op->epetraImaginaryMatrix(),
+                                   op->symmetryMode(),
                                    static_cast<TranspositionMode>(mode)));
     } else
       result[i].reset(new TransposedDiscreteBoundaryOperator<ResultType>(
@@ -204,6 +218,14 @@ shared_ptr<const Space<BasisFunctionType>> determineDualToRange(
     return testLocalOps[0].dualToRange();
 }
 
+template <typename ResultType>
+int weightedSymmetry(int symmetry, const std::vector<ResultType> &weights) {
+  for (size_t i = 0; i < weights.size(); ++i)
+    if (Fiber::imagPart(weights[i]) != 0.)
+      return symmetry & ~HERMITIAN;
+  return symmetry;
+}
+
 } // namespace
 
 template <typename BasisFunctionType, typename ResultType>
@@ -214,14 +236,18 @@ SyntheticIntegralOperator<BasisFunctionType, ResultType>::
         const BoundaryOperator<BasisFunctionType, ResultType> &integralOp,
         const std::vector<BoundaryOperator<BasisFunctionType, ResultType>> &
             trialLocalOps,
-        const std::string &label, int syntheseSymmetry)
+        const std::string &label, int syntheseSymmetry,
+        const std::vector<ResultType> &weights)
     : Base(determineDomain(testLocalOps, integralOp, trialLocalOps,
                            syntheseSymmetry),
            determineRange(testLocalOps, integralOp),
            determineDualToRange(testLocalOps, integralOp), label,
-           syntheseSymmetry & integralOp.abstractOperator()->symmetry()),
+           weightedSymmetry(syntheseSymmetry &
+                                integralOp.abstractOperator()->symmetry(),
+                            weights)),
       m_integralOp(integralOp), m_testLocalOps(testLocalOps),
-      m_trialLocalOps(trialLocalOps), m_syntheseSymmetry(syntheseSymmetry) {
+      m_trialLocalOps(trialLocalOps), m_syntheseSymmetry(syntheseSymmetry),
+      m_weights(weights) {
   // Note: the code does not at present distinguish properly between symmetric
   // and/or hermitian operators (in fact symmetry handling is, frankly, a
   // mess). We get away with this because sparse operators can only contain
@@ -247,6 +273,12 @@ SyntheticIntegralOperator<BasisFunctionType, ResultType>::
     throw std::invalid_argument(
         "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
         "testLocalOps and trialLocalOps must not both be empty.");
+  if (!m_weights.empty() &&
+      m_weights.size() !=
+          std::max(m_testLocalOps.size(), m_trialLocalOps.size()))
+    throw std::invalid_argument(
+        "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
+        "the number of weights must match the number of local operators");
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -372,6 +404,10 @@ SyntheticIntegralOperator<BasisFunctionType, ResultType>::assembleWeakFormImpl(
       throw std::runtime_error(
           "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
           "identity operator must be represented by a sparse matrix");
+    if (discreteTestId->epetraImaginaryMatrix())
+      throw std::runtime_error(
+          "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
+          "identity operators with an imaginary part are not supported yet");
 
     // NOTE: here we form the explicit inverse of the mass matrix. Of
     // course it is not the right way to do it and we'd be better off using
@@ -400,6 +436,10 @@ SyntheticIntegralOperator<BasisFunctionType, ResultType>::assembleWeakFormImpl(
         throw std::runtime_error(
             "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
             "identity operator must be represented by a sparse matrix");
+      if (discreteTrialId->epetraImaginaryMatrix())
+        throw std::runtime_error(
+            "SyntheticIntegralOperator::SyntheticIntegralOperator(): "
+            "identity operators with an imaginary part are not supported yet");
       trialInverse = sparseInverse(*discreteTrialId->epetraMatrix());
     }
   }
@@ -415,29 +455,12 @@ SyntheticIntegralOperator<BasisFunctionType, ResultType>::assembleWeakFormImpl(
     discreteTrialLocalOps =
         coalesceTrialOperators(discreteTrialLocalOps, trialInverse);
 
-  // Now join all the pieces together
-  shared_ptr<DiscreteLinOp> result;
-  if (discreteTestLocalOps.empty()) {
-    result = mul<ResultType>(discreteIntegralOp, discreteTrialLocalOps[0]);
-    for (size_t i = 1; i < discreteTestLocalOps.size(); ++i)
-      result =
-          sum<ResultType>(result, mul<ResultType>(discreteIntegralOp,
-                                                  discreteTrialLocalOps[i]));
-  } else if (discreteTrialLocalOps.empty()) {
-    result = mul<ResultType>(discreteTestLocalOps[0], discreteIntegralOp);
-    for (size_t i = 1; i < discreteTestLocalOps.size(); ++i)
-      result = sum<ResultType>(
-          result, mul<ResultType>(discreteTestLocalOps[i], discreteIntegralOp));
-  } else {
-    result = mul<ResultType>(
-        mul<ResultType>(discreteTestLocalOps[0], discreteIntegralOp),
-        discreteTrialLocalOps[0]);
-    for (size_t i = 1; i < discreteTestLocalOps.size(); ++i)
-      result = sum<ResultType>(
-          result, mul<ResultType>(mul<ResultType>(discreteTestLocalOps[i],
-                                                  discreteIntegralOp),
-                                  discreteTrialLocalOps[i]));
-  }
+  // Now join all the pieces together; the integral operator is applied to
+  // the vectors of all terms at once
+  shared_ptr<DiscreteLinOp> result(
+      new DiscreteSyntheticBoundaryOperator<ResultType>(
+          discreteTestLocalOps, discreteIntegralOp, discreteTrialLocalOps,
+          m_weights));
 
   tbb::tick_count end = tbb::tick_count::now();
 
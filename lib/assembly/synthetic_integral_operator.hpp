@@ -92,11 +92,12 @@ namespace Bempp {
  *  elements, while the entries of \f$A\f$ may contain contributions from many
  *  element pairs.
  *
- *  In the current implementation we only handle the case of equal
- *  \f$K_\alpha\f$, i.e. \f$K_\alpha = K\f$ for all \f$\alpha\f$. In addition,
- *we
- *  coalesce \f$U_{\alpha} I_{\mathcal U}^{-1}\f$ and \f$I_{\mathcal V}^{-1}
- *  V_{\alpha}\f$ into single sparse matrices.
+ *  In the current implementation we only handle the case of \f$K_\alpha\f$
+ *  equal up to scalar factors, i.e. \f$K_\alpha = w_\alpha K\f$ for all
+ *  \f$\alpha\f$. In addition, we coalesce \f$U_{\alpha} I_{\mathcal
+ *  U}^{-1}\f$ and \f$I_{\mathcal V}^{-1} V_{\alpha}\f$ into single sparse
+ *  matrices. The resulting weak form (a DiscreteSyntheticBoundaryOperator)
+ *  applies \f$K\f$ to the vectors of all terms in a single call.
  *
  *  [1] This method was proposed by Lars Kielhorn in "On single- and
  *  multi-trace implementations for scattering problems with BETL", 10.
@@ -127,6 +128,8 @@ public:
    *described above.
    *  \param[in] label (Optional) operator label.
    *  \param[in] syntheseSymmetry Symmetry flag (see below).
+   *  \param[in] weights (Optional) Vector of the factors \f$w_\alpha\f$, as
+   *described above. If empty, all factors are equal to 1.
    *
    *  All operators passed as elements of \p testLocalOps and \p trialLocalOps
    *  must be local.
@@ -141,7 +144,9 @@ public:
    *  If \p syntheseSymmetry contains the flag \p SYMMETRIC and/or \p HERMITIAN,
    *\p
    *  trialLocalOps should be left empty and \f$V_\alpha\f$ are taken as the
-   *  transposes or Hermitian transposes of \f$U_\alpha\f$.
+   *  transposes or Hermitian transposes of \f$U_\alpha\f$. The factors
+   *  \f$w_\alpha\f$ do not take part in the decomposition; if any of them is
+   *  not real, the assembled operator is not Hermitian.
    */
   SyntheticIntegralOperator(
       const std::vector<BoundaryOperator<BasisFunctionType, ResultType>> &
@@ -149,7 +154,8 @@ public:
       const BoundaryOperator<BasisFunctionType, ResultType> &integralOp,
       const std::vector<BoundaryOperator<BasisFunctionType, ResultType>> &
           trialLocalOps,
-      const std::string &label = "", int syntheseSymmetry = NO_SYMMETRY);
+      const std::string &label = "", int syntheseSymmetry = NO_SYMMETRY,
+      const std::vector<ResultType> &weights = std::vector<ResultType>());
 
   virtual bool isLocal() const;
 
@@ -176,6 +182,7 @@ private:
   std::vector<BoundaryOperator<BasisFunctionType, ResultType>> m_testLocalOps;
   std::vector<BoundaryOperator<BasisFunctionType, ResultType>> m_trialLocalOps;
   int m_syntheseSymmetry;
+  std::vector<ResultType> m_weights;
   /** \endcond */
 };
 
@@ -0,0 +1,128 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "synthetic_internal_operator_cache.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+#include "../space/space.hpp"
+
+namespace Bempp {
+
+template <typename BasisFunctionType, typename ResultType>
+SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::SpaceKey::
+    SpaceKey(const Space<BasisFunctionType> &space)
+    : grid(space.grid().get()), identifier(space.spaceIdentifier()),
+      globalDofCount(space.globalDofCount()) {}
+
+template <typename BasisFunctionType, typename ResultType>
+bool SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::SpaceKey::
+operator==(const SpaceKey &other) const {
+  return grid == other.grid && identifier == other.identifier &&
+         globalDofCount == other.globalDofCount;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::
+    SyntheticInternalOperatorCache(std::size_t maxEntryCount)
+    : m_maxEntryCount(maxEntryCount) {}
+
+template <typename BasisFunctionType, typename ResultType>
+typename SyntheticInternalOperatorCache<BasisFunctionType,
+                                        ResultType>::BoundaryOp
+SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::
+    internalOperator(
+        const std::string &kernelKey,
+        const shared_ptr<const Space<BasisFunctionType>> &internalTrialSpace,
+        const shared_ptr<const Space<BasisFunctionType>> &internalTestSpace,
+        int symmetry, const Factory &factory) {
+  if (!internalTrialSpace || !internalTestSpace)
+    throw std::invalid_argument(
+        "SyntheticInternalOperatorCache::internalOperator(): "
+        "internalTrialSpace and internalTestSpace must not be null");
+
+  const SpaceKey trialKey(*internalTrialSpace);
+  const SpaceKey testKey(*internalTestSpace);
+  {
+    tbb::mutex::scoped_lock lock(m_mutex);
+    typename std::list<Entry>::iterator it =
+        find(kernelKey, trialKey, testKey, symmetry);
+    if (it != m_entries.end())
+      return it->op;
+  }
+
+  // The factory may itself construct operators, so it is called without
+  // holding the lock
+  BoundaryOp op = factory();
+  if (!op.isInitialized())
+    throw std::runtime_error(
+        "SyntheticInternalOperatorCache::internalOperator(): "
+        "factory returned an uninitialized operator");
+
+  tbb::mutex::scoped_lock lock(m_mutex);
+  // Another thread may have registered an operator in the meantime
+  typename std::list<Entry>::iterator it =
+      find(kernelKey, trialKey, testKey, symmetry);
+  if (it != m_entries.end())
+    return it->op;
+  if (m_maxEntryCount == 0)
+    return op;
+  Entry entry = {kernelKey, trialKey, testKey, symmetry, op};
+  m_entries.push_front(entry);
+  if (m_entries.size() > m_maxEntryCount)
+    m_entries.pop_back();
+  return op;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+typename std::list<typename SyntheticInternalOperatorCache<
+    BasisFunctionType, ResultType>::Entry>::iterator
+SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::find(
+    const std::string &kernelKey, const SpaceKey &internalTrialSpace,
+    const SpaceKey &internalTestSpace, int symmetry) {
+  for (typename std::list<Entry>::iterator it = m_entries.begin();
+       it != m_entries.end(); ++it)
+    if (it->kernelKey == kernelKey &&
+        it->internalTrialSpace == internalTrialSpace &&
+        it->internalTestSpace == internalTestSpace &&
+        it->symmetry == symmetry) {
+      m_entries.splice(m_entries.begin(), m_entries, it);
+      return m_entries.begin();
+    }
+  return m_entries.end();
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::clear() {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_entries.clear();
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::size_t
+SyntheticInternalOperatorCache<BasisFunctionType, ResultType>::entryCount()
+    const {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  return m_entries.size();
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(
+    SyntheticInternalOperatorCache);
+
+} // namespace Bempp
@@ -0,0 +1,178 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_synthetic_internal_operator_cache_hpp
+#define bempp_synthetic_internal_operator_cache_hpp
+
+#include "../common/common.hpp"
+
+#include "boundary_operator.hpp"
+
+#include "../common/shared_ptr.hpp"
+#include "../space/space_identifier.hpp"
+
+#include <tbb/mutex.h>
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <sstream>
+#include <string>
+
+namespace Bempp {
+
+/** \cond FORWARD_DECL */
+class Grid;
+template <typename BasisFunctionType> class Space;
+/** \endcond */
+
+/** \ingroup abstract_boundary_operators
+ *  \brief Cache of the internal operators of synthetic boundary operators.
+ *
+ *  A synthetic operator (see SyntheticIntegralOperator) obtains its weak form
+ *  from that of an internal integral operator acting on discontinuous spaces,
+ *  typically defined on the barycentric refinement of the grid, and sparse
+ *  transfer matrices. The internal weak form is by far the most expensive
+ *  part of the assembly, but it depends only on the kernel, on the
+ *  discontinuous spaces and on the assembly context, and not on the spaces
+ *  of the synthetic operator itself.
+ *
+ *  Each Context owns a cache (see Context::syntheticInternalOperatorCache())
+ *  handing out a single internal BoundaryOperator for each kernel, pair of
+ *  discontinuous spaces and symmetry. Since copies of a BoundaryOperator
+ *  share its weak form, all synthetic operators built with the same context,
+ *  kernel and discontinuous spaces (e.g. the single-layer operators on the
+ *  primal and the dual spaces used for Calder&oacute;n preconditioning and
+ *  the single-layer operator underlying the hypersingular operator) then
+ *  trigger only one assembly of the internal weak form.
+ *
+ *  Spaces are not compared by address, since each continuous space creates
+ *  its own discontinuous space, but by grid, type (SpaceIdentifier) and
+ *  number of degrees of freedom; this is the criterion used by
+ *  Space::spaceIsCompatible(). Synthetic operators must therefore take the
+ *  internal spaces from the domain and dual to range of the returned
+ *  operator rather than use their own.
+ *
+ *  The cache holds at most maxEntryCount() operators, discarding the least
+ *  recently used ones; operators discarded from the cache remain valid in
+ *  the synthetic operators that use them. All entries are released together
+ *  with the Context. */
+template <typename BasisFunctionType, typename ResultType>
+class SyntheticInternalOperatorCache {
+public:
+  typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+  typedef std::function<BoundaryOp()> Factory;
+
+  /** \brief Constructor.
+   *
+   *  \param[in] maxEntryCount
+   *    Maximum number of internal operators kept in the cache. */
+  explicit SyntheticInternalOperatorCache(std::size_t maxEntryCount = 4);
+
+  /** \brief Return the internal operator registered for the given
+   *  parameters, constructing it with \p factory if necessary.
+   *
+   *  \param[in] kernelKey
+   *    String identifying the kernel and its parameters, e.g. obtained from
+   *    kernelKey().
+   *  \param[in] internalTrialSpace, internalTestSpace
+   *    Discontinuous spaces on which the internal operator acts.
+   *  \param[in] symmetry
+   *    Symmetry of the internal operator.
+   *  \param[in] factory
+   *    Function returning a new internal operator with the above parameters.
+   *
+   *  The domain and dual to range of the returned operator are compatible
+   *  with, but not necessarily identical to, \p internalTrialSpace and
+   *  \p internalTestSpace. */
+  BoundaryOp internalOperator(
+      const std::string &kernelKey,
+      const shared_ptr<const Space<BasisFunctionType>> &internalTrialSpace,
+      const shared_ptr<const Space<BasisFunctionType>> &internalTestSpace,
+      int symmetry, const Factory &factory);
+
+  /** \brief Forget all cached internal operators. */
+  void clear();
+
+  /** \brief Number of internal operators currently in the cache. */
+  std::size_t entryCount() const;
+
+  /** \brief Maximum number of internal operators kept in the cache. */
+  std::size_t maxEntryCount() const { return m_maxEntryCount; }
+
+  /** \brief Return a string identifying the function \p constructor used to
+   *  construct internal operators, called with the kernel parameters
+   *  \p parameters (e.g. the wave number). */
+  template <typename FunctionPointer, typename... Parameters>
+  static std::string kernelKey(FunctionPointer constructor,
+                               const Parameters &... parameters) {
+    std::ostringstream key;
+    key.precision(17);
+    key.write(reinterpret_cast<const char *>(&constructor),
+              sizeof(constructor));
+    appendToKey(key, parameters...);
+    return key.str();
+  }
+
+private:
+  /** \cond PRIVATE */
+  static void appendToKey(std::ostream &) {}
+
+  template <typename Parameter, typename... Parameters>
+  static void appendToKey(std::ostream &key, const Parameter &parameter,
+                          const Parameters &... parameters) {
+    key << ' ' << parameter;
+    appendToKey(key, parameters...);
+  }
+
+  struct SpaceKey {
+    explicit SpaceKey(const Space<BasisFunctionType> &space);
+    bool operator==(const SpaceKey &other) const;
+
+    const Grid *grid;
+    SpaceIdentifier identifier;
+    std::size_t globalDofCount;
+  };
+
+  struct Entry {
+    std::string kernelKey;
+    SpaceKey internalTrialSpace;
+    SpaceKey internalTestSpace;
+    int symmetry;
+    BoundaryOp op;
+  };
+
+  // Returns m_entries.end() if not found; otherwise moves the entry found to
+  // the front of the list
+  typename std::list<Entry>::iterator find(const std::string &kernelKey,
+                                           const SpaceKey &internalTrialSpace,
+                                           const SpaceKey &internalTestSpace,
+                                           int symmetry);
+
+  std::size_t m_maxEntryCount;
+  // Most recently used first
+  std::list<Entry> m_entries;
+  mutable tbb::mutex m_mutex;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
@@ -27,6 +27,7 @@
 #include "discrete_boundary_operator.hpp"
 #include "../fiber/local_assembler_for_integral_operators.hpp"
 #include "../fiber/conjugate.hpp"
+#include "../common/assembly_profile.hpp"
 
 namespace Bempp {
 
@@ -69,6 +70,8 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::
           "WeakFormAcaAssemblyHelper::WeakFormAcaAssemblyHelper(): "
           "no elements of the 'sparseTermsToAdd' vector may be null");
   m_accessedEntryCount = 0;
+  m_localWeakFormCount = 0;
+  m_profile = AssemblyProfile::current();
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -94,6 +97,8 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
     const hmat::DefaultBlockClusterTreeNodeType &blockClusterTreeNode,
     arma::Mat<ResultType> &data) const {
 
+  AssemblyProfile::Activation activation(m_profile);
+
   auto numberOfTestIndices = testIndexRange[1] - testIndexRange[0];
   auto numberOfTrialIndices = trialIndexRange[1] - trialIndexRange[0];
 
@@ -162,6 +167,7 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
           m_assemblers[nTerm]->evaluateLocalWeakForms(
               Fiber::TEST_TRIAL, testElementIndices, activeTrialElementIndex,
               activeTrialLocalDof, localResult, minDist);
+          m_localWeakFormCount += testElementIndices.size();
           for (size_t nTestElem = 0; nTestElem < testElementIndices.size();
                ++nTestElem)
             for (size_t nTestDof = 0;
@@ -195,6 +201,7 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
           m_assemblers[nTerm]->evaluateLocalWeakForms(
               Fiber::TRIAL_TEST, trialElementIndices, activeTestElementIndex,
               activeTestLocalDof, localResult, minDist);
+          m_localWeakFormCount += trialElementIndices.size();
           for (size_t nTrialElem = 0; nTrialElem < trialElementIndices.size();
                ++nTrialElem)
             for (size_t nTrialDof = 0;
@@ -220,6 +227,8 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
     for (size_t nTerm = 0; nTerm < m_assemblers.size(); ++nTerm) {
       m_assemblers[nTerm]->evaluateLocalWeakForms(
           testElementIndices, trialElementIndices, localResult, minDist);
+      m_localWeakFormCount +=
+          testElementIndices.size() * trialElementIndices.size();
       for (size_t nTrialElem = 0; nTrialElem < trialElementIndices.size();
            ++nTrialElem)
         for (size_t nTrialDof = 0;
@@ -253,6 +262,7 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
           m_assemblers[nTerm]->evaluateLocalWeakForms(
               Fiber::TRIAL_TEST, trialElementIndices, activeTestElementIndex,
               activeTestLocalDof, localResult, minDist);
+          m_localWeakFormCount += trialElementIndices.size();
           for (size_t nTrialElem = 0; nTrialElem < trialElementIndices.size();
                ++nTrialElem)
             for (size_t nTrialDof = 0;
@@ -278,6 +288,20 @@ WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::computeMatrixBlock(
         m_sparseTermsMultipliers[nTerm], data);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+size_t
+WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::accessedEntryCount()
+    const {
+  return m_accessedEntryCount;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+size_t
+WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType>::localWeakFormCount()
+    const {
+  return m_localWeakFormCount;
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(
     WeakFormHMatAssemblyHelper);
 }
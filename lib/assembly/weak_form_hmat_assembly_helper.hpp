@@ -49,6 +49,7 @@ namespace Bempp {
 
 /** \cond FORWARD_DECL */
 class AssemblyOptions;
+class AssemblyProfile;
 template <typename ResultType> class DiscreteBoundaryOperator;
 template <typename BasisFunctionType> class LocalDofListsCache;
 template <typename BasisFunctionType> class Space;
@@ -83,10 +84,14 @@ public:
       const hmat::DefaultBlockClusterTreeNodeType &blockClusterTreeNode,
       arma::Mat<ResultType> &data) const override;
 
-  // /** \brief Return the number of entries in the matrix that have been
-  //  *  accessed so far. */
-  // size_t accessedEntryCount() const;
- 
+  /** \brief Return the number of entries in the matrix that have been
+   *  accessed so far. */
+  size_t accessedEntryCount() const;
+
+  /** \brief Return the number of local weak forms (integrals over pairs of
+   *  elements) evaluated so far. */
+  size_t localWeakFormCount() const;
+
   // /** \brief Reset the number of entries in the matrix that have been
   //  *  accessed so far. */
   // void resetAccessedEntryCount();
@@ -109,10 +114,14 @@ private:
       m_trialDofListsCache;
 
   mutable tbb::atomic<size_t> m_accessedEntryCount;
+  mutable tbb::atomic<size_t> m_localWeakFormCount;
+
+  // Profile active when the helper was created; computeMatrixBlock() is
+  // called on worker threads and activates it there
+  AssemblyProfile *m_profile;
 
   typedef tbb::concurrent_unordered_map<
-      shared_ptr<const hmat::DefaultBlockClusterTreeNodeType>, CoordinateType,
-      std::hash<shared_ptr<const hmat::DefaultBlockClusterTreeNodeType>>> DistanceMap;
+      const hmat::DefaultBlockClusterTreeNodeType *, CoordinateType> DistanceMap;
   mutable DistanceMap m_distancesCache;
 
   /** \endcond */
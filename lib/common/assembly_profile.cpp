@@ -0,0 +1,287 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "assembly_profile.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace Bempp {
+
+namespace {
+
+typedef tbb::enumerable_thread_specific<AssemblyProfile *> CurrentProfiles;
+
+CurrentProfiles &currentProfiles() {
+  static CurrentProfiles profiles(static_cast<AssemblyProfile *>(0));
+  return profiles;
+}
+
+// JSON has no representation of infinities and NaNs
+void writeJsonNumber(std::ostream &out, double x) {
+  if (std::isfinite(x))
+    out << x;
+  else
+    out << "null";
+}
+
+} // namespace
+
+AssemblyProfile::Activation::Activation(AssemblyProfile &profile)
+    : m_previous(currentProfiles().local()) {
+  currentProfiles().local() = &profile;
+}
+
+AssemblyProfile::Activation::Activation(AssemblyProfile *profile)
+    : m_previous(currentProfiles().local()) {
+  currentProfiles().local() = profile;
+}
+
+AssemblyProfile::Activation::~Activation() {
+  currentProfiles().local() = m_previous;
+}
+
+AssemblyProfile::PhaseTimer::PhaseTimer(const std::string &phase)
+    : m_profile(AssemblyProfile::current()), m_phase(phase),
+      m_start(tbb::tick_count::now()) {}
+
+AssemblyProfile::PhaseTimer::~PhaseTimer() {
+  if (m_profile)
+    m_profile->addPhaseTime(m_phase,
+                            (tbb::tick_count::now() - m_start).seconds());
+}
+
+AssemblyProfile::AssemblyProfile() {}
+
+AssemblyProfile *AssemblyProfile::current() {
+  return currentProfiles().local();
+}
+
+void AssemblyProfile::setLabel(const std::string &label) {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_label = label;
+}
+
+std::string AssemblyProfile::label() const {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  return m_label;
+}
+
+void AssemblyProfile::setAssemblyMode(const std::string &mode) {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_assemblyMode = mode;
+}
+
+void AssemblyProfile::addPhaseTime(const std::string &phase, double seconds) {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  for (size_t i = 0; i < m_phases.size(); ++i)
+    if (m_phases[i].first == phase) {
+      m_phases[i].second += seconds;
+      return;
+    }
+  m_phases.push_back(std::make_pair(phase, seconds));
+}
+
+double AssemblyProfile::phaseTime(const std::string &phase) const {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  for (size_t i = 0; i < m_phases.size(); ++i)
+    if (m_phases[i].first == phase)
+      return m_phases[i].second;
+  return 0.;
+}
+
+void AssemblyProfile::addCount(const std::string &counter, std::size_t count) {
+  m_threadCounters.local()[counter] += count;
+}
+
+std::size_t AssemblyProfile::count(const std::string &counter) const {
+  std::size_t result = 0;
+  for (tbb::enumerable_thread_specific<CounterMap>::const_iterator it =
+           m_threadCounters.begin();
+       it != m_threadCounters.end(); ++it) {
+    CounterMap::const_iterator entry = it->find(counter);
+    if (entry != it->end())
+      result += entry->second;
+  }
+  return result;
+}
+
+AssemblyProfile::CounterMap AssemblyProfile::combinedCounters() const {
+  CounterMap result;
+  for (tbb::enumerable_thread_specific<CounterMap>::const_iterator it =
+           m_threadCounters.begin();
+       it != m_threadCounters.end(); ++it)
+    for (CounterMap::const_iterator entry = it->begin(); entry != it->end();
+         ++entry)
+      result[entry->first] += entry->second;
+  return result;
+}
+
+void AssemblyProfile::addBlock(std::size_t rows, std::size_t columns, int rank,
+                               double memSizeKb) {
+  Block block = {rows, columns, rank, memSizeKb};
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_blocks.push_back(block);
+}
+
+void AssemblyProfile::addParallelLoop(const std::string &loop, int threadCount,
+                                      double wallSeconds, double busySeconds) {
+  ParallelLoop parallelLoop = {loop, threadCount, wallSeconds, busySeconds};
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_parallelLoops.push_back(parallelLoop);
+}
+
+void AssemblyProfile::writeJson(std::ostream &out) const {
+  tbb::mutex::scoped_lock lock(m_mutex);
+
+  std::ios::fmtflags flags = out.flags();
+  std::streamsize precision =
+      out.precision(std::numeric_limits<double>::digits10);
+
+  out << "{\"label\": ";
+  writeJsonString(out, m_label);
+  out << ", \"assemblyMode\": ";
+  writeJsonString(out, m_assemblyMode);
+
+  out << ", \"phases\": {";
+  for (size_t i = 0; i < m_phases.size(); ++i) {
+    if (i > 0)
+      out << ", ";
+    writeJsonString(out, m_phases[i].first);
+    out << ": ";
+    writeJsonNumber(out, m_phases[i].second);
+  }
+  out << "}";
+
+  const CounterMap counters = combinedCounters();
+  out << ", \"counters\": {";
+  for (CounterMap::const_iterator it = counters.begin(); it != counters.end();
+       ++it) {
+    if (it != counters.begin())
+      out << ", ";
+    writeJsonString(out, it->first);
+    out << ": " << it->second;
+  }
+  out << "}";
+
+  size_t denseCount = 0;
+  double memSizeKb = 0.;
+  std::map<int, size_t> rankHistogram;
+  for (size_t i = 0; i < m_blocks.size(); ++i) {
+    memSizeKb += m_blocks[i].memSizeKb;
+    if (m_blocks[i].rank < 0)
+      ++denseCount;
+    else
+      ++rankHistogram[m_blocks[i].rank];
+  }
+  out << ", \"blocks\": {\"count\": " << m_blocks.size()
+      << ", \"denseCount\": " << denseCount
+      << ", \"lowRankCount\": " << m_blocks.size() - denseCount
+      << ", \"memSizeKb\": ";
+  writeJsonNumber(out, memSizeKb);
+  out << ", \"rankHistogram\": {";
+  for (std::map<int, size_t>::const_iterator it = rankHistogram.begin();
+       it != rankHistogram.end(); ++it) {
+    if (it != rankHistogram.begin())
+      out << ", ";
+    out << "\"" << it->first << "\": " << it->second;
+  }
+  // Each block as [rows, columns, rank, memSizeKb]; rank -1 means dense
+  out << "}, \"list\": [";
+  for (size_t i = 0; i < m_blocks.size(); ++i) {
+    if (i > 0)
+      out << ", ";
+    out << "[" << m_blocks[i].rows << ", " << m_blocks[i].columns << ", "
+        << (m_blocks[i].rank < 0 ? -1 : m_blocks[i].rank) << ", ";
+    writeJsonNumber(out, m_blocks[i].memSizeKb);
+    out << "]";
+  }
+  out << "]}";
+
+  out << ", \"parallelLoops\": [";
+  for (size_t i = 0; i < m_parallelLoops.size(); ++i) {
+    const ParallelLoop &loop = m_parallelLoops[i];
+    if (i > 0)
+      out << ", ";
+    out << "{\"name\": ";
+    writeJsonString(out, loop.name);
+    const double capacity = loop.threadCount * loop.wallSeconds;
+    out << ", \"threadCount\": " << loop.threadCount << ", \"wallTime\": ";
+    writeJsonNumber(out, loop.wallSeconds);
+    out << ", \"busyTime\": ";
+    writeJsonNumber(out, loop.busySeconds);
+    out << ", \"utilization\": ";
+    writeJsonNumber(out, capacity > 0. ? loop.busySeconds / capacity : 0.);
+    out << "}";
+  }
+  out << "]}";
+
+  out.precision(precision);
+  out.flags(flags);
+}
+
+std::string AssemblyProfile::toJson() const {
+  std::ostringstream out;
+  writeJson(out);
+  return out.str();
+}
+
+void writeJsonString(std::ostream &out, const std::string &s) {
+  out << '"';
+  for (size_t i = 0; i < s.size(); ++i) {
+    const char c = s[i];
+    switch (c) {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    case '\n':
+      out << "\\n";
+      break;
+    case '\t':
+      out << "\\t";
+      break;
+    case '\r':
+      out << "\\r";
+      break;
+    case '\b':
+      out << "\\b";
+      break;
+    case '\f':
+      out << "\\f";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        std::sprintf(buffer, "\\u%04x", static_cast<unsigned int>(c));
+        out << buffer;
+      } else
+        out << c;
+    }
+  }
+  out << '"';
+}
+
+} // namespace Bempp
@@ -0,0 +1,175 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_assembly_profile_hpp
+#define bempp_assembly_profile_hpp
+
+#include "common.hpp"
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/mutex.h>
+#include <tbb/tick_count.h>
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bempp {
+
+/** \ingroup common
+ *  \brief Machine-readable record of the assembly of a discrete operator.
+ *
+ *  A profile collects the time spent in the phases of the assembly (e.g.
+ *  geometry setup, caching of singular integrals, cluster tree construction,
+ *  compression), event counters (e.g. matrix entries accessed), a summary of
+ *  the blocks of the assembled matrix and the utilization of the threads
+ *  taking part in parallel loops. It can be written out in JSON format.
+ *
+ *  Code taking part in the assembly does not need to be handed the profile
+ *  explicitly: while an Activation object exists, the profile is returned by
+ *  current() on the thread that created it. The bodies of parallel loops
+ *  capture current() on the thread starting the loop and activate it again
+ *  on the worker threads, so that code running in the loop records into the
+ *  same profile.
+ *
+ *  All member functions may be called concurrently from different threads.
+ *  Counters are accumulated separately by each thread and combined when
+ *  they are read, so they should only be read once the parallel loops
+ *  adding to them have finished. */
+class AssemblyProfile {
+public:
+  /** \brief Make \p profile the current profile of the calling thread for
+   *  the lifetime of this object. */
+  class Activation {
+  public:
+    explicit Activation(AssemblyProfile &profile);
+    /** \brief Make \p profile, which may be null, the current profile of
+     *  the calling thread for the lifetime of this object.
+     *
+     *  Used in the bodies of parallel loops to pass on the profile of the
+     *  thread that started the loop. */
+    explicit Activation(AssemblyProfile *profile);
+    ~Activation();
+
+  private:
+    Activation(const Activation &);
+    Activation &operator=(const Activation &);
+
+    AssemblyProfile *m_previous;
+  };
+
+  /** \brief Timer adding the time elapsed between its construction and
+   *  destruction to a phase of the current profile, if there is one. */
+  class PhaseTimer {
+  public:
+    explicit PhaseTimer(const std::string &phase);
+    ~PhaseTimer();
+
+  private:
+    PhaseTimer(const PhaseTimer &);
+    PhaseTimer &operator=(const PhaseTimer &);
+
+    AssemblyProfile *m_profile;
+    std::string m_phase;
+    tbb::tick_count m_start;
+  };
+
+  AssemblyProfile();
+
+  /** \brief Profile of the calling thread, or null if no profile is active
+   *  on it. */
+  static AssemblyProfile *current();
+
+  void setLabel(const std::string &label);
+  std::string label() const;
+  void setAssemblyMode(const std::string &mode);
+
+  /** \brief Add \p seconds to the time spent in \p phase. */
+  void addPhaseTime(const std::string &phase, double seconds);
+  /** \brief Time spent in \p phase, or 0 if it has not been recorded. */
+  double phaseTime(const std::string &phase) const;
+
+  /** \brief Add \p count to the counter \p counter.
+   *
+   *  Does not lock, so it may be called from the inner loops of the
+   *  assembly. */
+  void addCount(const std::string &counter, std::size_t count);
+  /** \brief Value of \p counter, or 0 if it has not been recorded. */
+  std::size_t count(const std::string &counter) const;
+
+  /** \brief Record a block of the assembled matrix.
+   *
+   *  \p rank should be negative for blocks stored as dense matrices. */
+  void addBlock(std::size_t rows, std::size_t columns, int rank,
+                double memSizeKb);
+
+  /** \brief Record the execution of a parallel loop.
+   *
+   *  \p busySeconds is the time spent in the loop body summed over all
+   *  threads, so that the utilization is
+   *  <tt>busySeconds / (threadCount * wallSeconds)</tt>. */
+  void addParallelLoop(const std::string &loop, int threadCount,
+                       double wallSeconds, double busySeconds);
+
+  /** \brief Write the profile to \p out as a JSON object. */
+  void writeJson(std::ostream &out) const;
+  /** \brief Return the profile as a JSON string. */
+  std::string toJson() const;
+
+private:
+  struct Block {
+    std::size_t rows;
+    std::size_t columns;
+    int rank;
+    double memSizeKb;
+  };
+
+  struct ParallelLoop {
+    std::string name;
+    int threadCount;
+    double wallSeconds;
+    double busySeconds;
+  };
+
+  mutable tbb::mutex m_mutex;
+  std::string m_label;
+  std::string m_assemblyMode;
+  // Phases are reported in the order in which they were first recorded
+  std::vector<std::pair<std::string, double>> m_phases;
+  typedef std::map<std::string, std::size_t> CounterMap;
+  CounterMap combinedCounters() const;
+
+  tbb::enumerable_thread_specific<CounterMap> m_threadCounters;
+  std::vector<Block> m_blocks;
+  std::vector<ParallelLoop> m_parallelLoops;
+};
+
+/** \ingroup common
+ *  \brief Write \p s to \p out as a JSON string literal.
+ *
+ *  Quotes, backslashes and control characters are escaped. */
+void writeJsonString(std::ostream &out, const std::string &s);
+
+} // namespace Bempp
+
+#endif
@@ -35,7 +35,7 @@ ParameterList GlobalParameters::parameterList() {
 
   parameters.set("boundaryOperatorAssemblyType", std::string("dense"),
                   "(string) Default assembly type for boundary operators. "
-                  "Allowed values are dense and hmat.");
+                  "Allowed values are dense, hmat and matrix_free.");
 
   parameters.set("potentialOperatorAssemblyType", std::string("dense"),
           "(string) Default assembly type for potential oeprators. "
@@ -95,6 +95,16 @@ ParameterList GlobalParameters::parameterList() {
 
   quadratureOrders.sublist("far").remove("maxRelDist");
 
+  quadratureOrders.set("doubleRegularTolerance", static_cast<double>(0),
+          "(double) If positive, the orders of regular double integrals are "
+          "chosen adaptively for each pair of elements so that their estimated "
+          "relative error does not exceed this value; the near, medium and far "
+          "doubleOrder settings are then ignored.");
+
+  quadratureOrders.set("maxDoubleRegularOrder", static_cast<int>(10),
+          "(int) Maximum (absolute) order of regular double integrals chosen "
+          "adaptively. Must lie between 1 and 20.");
+
   ParameterList& hmatParameters = parameters.sublist("HMat");
 
   hmatParameters.set("HMatAssemblyMode", std::string("GlobalAssembly"),
@@ -113,6 +123,26 @@ ParameterList GlobalParameters::parameterList() {
   hmatParameters.set("eta", static_cast<double>(1.2),
                      "(double) Specifies the block separation parameter eta");
 
+  hmatParameters.set(
+      "clusterSplittingStrategy", std::string("GeometricBisection"),
+      "(string) Specifies how clusters are split. Allowed values are "
+      "GeometricBisection (bisect the bounding box), Median (equal numbers "
+      "of dofs in both sons) and PrincipalAxis (median along the direction "
+      "of largest variance)");
+
+  hmatParameters.set(
+      "singlePrecisionLowRankBlocks", false,
+      "(bool) If true then the factors of admissible (low-rank) blocks are "
+      "stored in single precision. Dense blocks and the accumulation of "
+      "matrix-vector products remain in full precision.");
+
+  hmatParameters.set(
+      "estimateBlockErrors", false,
+      "(bool) If true then the relative error of each low-rank block is "
+      "estimated after compression by evaluating a few of its columns "
+      "exactly. The estimates are reported by the statistics of the "
+      "assembled operator.");
+
   return parameters;
 }
 }
@@ -44,14 +44,16 @@ struct Equal {
 
 } // namespace
 
-AccuracyOptionsEx::AccuracyOptionsEx() {
+AccuracyOptionsEx::AccuracyOptionsEx()
+    : m_doubleRegularTolerance(0.), m_doubleRegularMaxOrder(10) {
   m_singleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), QuadratureOptions()));
   m_doubleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), QuadratureOptions()));
 }
 
-AccuracyOptionsEx::AccuracyOptionsEx(const AccuracyOptions &oldStyleOpts) {
+AccuracyOptionsEx::AccuracyOptionsEx(const AccuracyOptions &oldStyleOpts)
+    : m_doubleRegularTolerance(0.), m_doubleRegularMaxOrder(10) {
   m_singleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), oldStyleOpts.singleRegular));
   m_doubleRegular.push_back(std::make_pair(
@@ -195,6 +197,7 @@ AccuracyOptionsEx::doubleRegular(double relativeDistance) const {
 
 void AccuracyOptionsEx::setDoubleRegular(int accuracyOrder,
                                          bool relativeToDefault) {
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   m_doubleRegular.push_back(
       std::make_pair(std::numeric_limits<double>::infinity(),
@@ -204,6 +207,7 @@ void AccuracyOptionsEx::setDoubleRegular(int accuracyOrder,
 void AccuracyOptionsEx::setDoubleRegular(double maxNormalizedDistance1,
                                          int accuracyOrder1, int accuracyOrder2,
                                          bool relativeToDefault) {
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   m_doubleRegular.push_back(
       std::make_pair(maxNormalizedDistance1,
@@ -220,6 +224,7 @@ void AccuracyOptionsEx::setDoubleRegular(double maxNormalizedDistance1,
                                          double maxNormalizedDistance2,
                                          int accuracyOrder2, int accuracyOrder3,
                                          bool relativeToDefault) {
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   m_doubleRegular.push_back(
       std::make_pair(maxNormalizedDistance1,
@@ -241,6 +246,7 @@ void AccuracyOptionsEx::setDoubleRegular(double maxNormalizedDistance1,
                                          double maxNormalizedDistance3,
                                          int accuracyOrder3, int accuracyOrder4,
                                          bool relativeToDefault) {
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   m_doubleRegular.push_back(
       std::make_pair(maxNormalizedDistance1,
@@ -264,6 +270,7 @@ void AccuracyOptionsEx::setDoubleRegular(
     double maxNormalizedDistance3, int accuracyOrder3,
     double maxNormalizedDistance4, int accuracyOrder4, int accuracyOrder5,
     bool relativeToDefault) {
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   m_doubleRegular.push_back(
       std::make_pair(maxNormalizedDistance1,
@@ -291,6 +298,7 @@ void AccuracyOptionsEx::setDoubleRegular(
     throw std::invalid_argument("AccuracyOptionsEx::setDoubleRegular(): "
                                 "maxNormalizedDistances must have one "
                                 "element less than accuracyOrders");
+  m_doubleRegularTolerance = 0.;
   m_doubleRegular.clear();
   for (size_t i = 0; i < maxNormalizedDistances.size(); ++i)
     m_doubleRegular.push_back(std::make_pair(
@@ -317,10 +325,39 @@ namespace {
 }
 
 void AccuracyOptionsEx::setDoubleRegular(const t_range& input)
-    { implementation::setRegular(m_doubleRegular, input); }
+    {
+        m_doubleRegularTolerance = 0.;
+        implementation::setRegular(m_doubleRegular, input);
+    }
 void AccuracyOptionsEx::setSingleRegular(const t_range& input)
     { implementation::setRegular(m_singleRegular, input); }
 
+void AccuracyOptionsEx::setDoubleRegularAdaptive(double relativeTolerance,
+                                                 int maxAccuracyOrder) {
+  if (!(relativeTolerance > 0.))
+    throw std::invalid_argument(
+        "AccuracyOptionsEx::setDoubleRegularAdaptive(): "
+        "relativeTolerance must be positive");
+  if (maxAccuracyOrder < 1 || maxAccuracyOrder > 20)
+    throw std::invalid_argument(
+        "AccuracyOptionsEx::setDoubleRegularAdaptive(): "
+        "maxAccuracyOrder must lie between 1 and 20");
+  m_doubleRegularTolerance = relativeTolerance;
+  m_doubleRegularMaxOrder = maxAccuracyOrder;
+}
+
+bool AccuracyOptionsEx::doubleRegularIsAdaptive() const {
+  return m_doubleRegularTolerance > 0.;
+}
+
+double AccuracyOptionsEx::doubleRegularTolerance() const {
+  return m_doubleRegularTolerance;
+}
+
+int AccuracyOptionsEx::doubleRegularMaxOrder() const {
+  return m_doubleRegularMaxOrder;
+}
+
 const QuadratureOptions& AccuracyOptionsEx::doubleSingular() const
 {
     return m_doubleSingular;
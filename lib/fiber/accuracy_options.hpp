@@ -333,6 +333,40 @@ public:
                           bool relativeToDefault = true);
     void setDoubleRegular(const t_range& options);
 
+  /** \brief Choose the order of quadrature rules used to integrate regular
+   *  functions on pairs of elements adaptively.
+   *
+   *  For each pair of elements, the lowest order is used whose estimated
+   *  relative error does not exceed \p relativeTolerance. The estimate
+   *  accounts for the distance between the elements relative to their size
+   *  and for the rate of oscillation and decay of the kernels; it is based
+   *  on an a-priori error model calibrated once per process. The order is
+   *  never raised above \p maxAccuracyOrder (and never lowered below the
+   *  order needed to integrate the basis functions exactly).
+   *
+   *  In this mode the options set by setDoubleRegular() are ignored.
+   *  Call setDoubleRegular() again to switch the adaptive mode off.
+   *
+   *  \p relativeTolerance must be positive and \p maxAccuracyOrder must lie
+   *  between 1 and 20. */
+  void setDoubleRegularAdaptive(double relativeTolerance,
+                                int maxAccuracyOrder = 10);
+
+  /** \brief Return true if the orders of quadrature rules used to integrate
+   *  regular functions on pairs of elements are chosen adaptively.
+   *
+   *  \see setDoubleRegularAdaptive(). */
+  bool doubleRegularIsAdaptive() const;
+
+  /** \brief Relative tolerance of the adaptive choice of the order of
+   *  quadrature rules used to integrate regular functions on pairs of
+   *  elements. */
+  double doubleRegularTolerance() const;
+
+  /** \brief Maximum order of accuracy of quadrature rules used to integrate
+   *  regular functions on pairs of elements in the adaptive mode. */
+  int doubleRegularMaxOrder() const;
+
   /** \brief Return the options controlling integration of singular functions
    *  on pairs of elements. */
   const QuadratureOptions &doubleSingular() const;
@@ -352,6 +386,8 @@ private:
     t_range m_singleRegular;
     t_range m_doubleRegular;
     QuadratureOptions m_doubleSingular;
+    double m_doubleRegularTolerance; // non-positive: adaptive mode off
+    int m_doubleRegularMaxOrder;
     /** \endcond */
 };
 
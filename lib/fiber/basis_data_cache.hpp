@@ -0,0 +1,133 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_basis_data_cache_hpp
+#define fiber_basis_data_cache_hpp
+
+#include "../common/common.hpp"
+
+#include "basis_data.hpp"
+#include "collection_of_shapeset_transformations.hpp"
+#include "scalar_traits.hpp"
+#include "shapeset.hpp"
+#include "types.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <tbb/concurrent_unordered_map.h>
+
+#include <memory>
+#include <vector>
+
+namespace Fiber {
+
+/** \brief Values and/or derivatives of shape functions tabulated at a fixed
+ *  set of points on the reference element.
+ *
+ *  Integrators use a fixed quadrature rule on the reference element, so the
+ *  shape functions of a given shapeset only need to be evaluated once per
+ *  integrator. This class stores the results of these evaluations, keyed by
+ *  shapeset. Entries are created on first use and never modified afterwards,
+ *  so the references returned by get() may be used concurrently by any
+ *  number of threads for the lifetime of the cache.
+ *
+ *  \note Shapesets are identified by address and must outlive the cache. */
+template <typename BasisFunctionType> class BasisDataCache {
+public:
+  typedef typename ScalarTraits<BasisFunctionType>::RealType CoordinateType;
+
+  /** \brief Constructor.
+   *
+   *  \param[in] points
+   *    Points on the reference element at which the shape functions are
+   *    evaluated.
+   *  \param[in] basisDeps
+   *    Combination of BasisDataType flags specifying whether values,
+   *    derivatives or both are to be tabulated. */
+  BasisDataCache(const arma::Mat<CoordinateType> &points, size_t basisDeps)
+      : m_points(points), m_basisDeps(basisDeps) {}
+
+  /** \brief Constructor.
+   *
+   *  Tabulate the data needed to evaluate \p transformations at
+   *  \p points. */
+  BasisDataCache(const arma::Mat<CoordinateType> &points,
+                 const CollectionOfShapesetTransformations<CoordinateType> &
+                     transformations)
+      : m_points(points), m_basisDeps(0) {
+    size_t geomDeps = 0;
+    transformations.addDependencies(m_basisDeps, geomDeps);
+  }
+
+  ~BasisDataCache() {
+    // The destructor is assumed to be called only after all threads have
+    // ceased using the cache
+    for (typename EntryMap::const_iterator it = m_entries.begin();
+         it != m_entries.end(); ++it)
+      delete it->second;
+  }
+
+  /** \brief Return the data of shape function \p localDofIndex of
+   *  \p shapeset, or of all its shape functions if \p localDofIndex is
+   *  ALL_DOFS. */
+  const BasisData<BasisFunctionType> &
+  get(const Shapeset<BasisFunctionType> &shapeset,
+      LocalDofIndex localDofIndex = ALL_DOFS) const {
+    typename EntryMap::const_iterator it = m_entries.find(&shapeset);
+    if (it == m_entries.end()) {
+      std::unique_ptr<Entry> entry(new Entry);
+      shapeset.evaluate(m_basisDeps, m_points, ALL_DOFS, entry->allDofs);
+      entry->singleDofs.resize(shapeset.size());
+      for (int dof = 0; dof < shapeset.size(); ++dof)
+        shapeset.evaluate(m_basisDeps, m_points, dof, entry->singleDofs[dof]);
+      // If another thread has inserted an entry for this shapeset in the
+      // meantime, the insertion fails and our entry is discarded
+      Entry *ptrEntry = entry.release();
+      std::pair<typename EntryMap::iterator, bool> result =
+          m_entries.insert(std::make_pair(&shapeset, ptrEntry));
+      if (!result.second)
+        delete ptrEntry;
+      it = result.first;
+    }
+    return localDofIndex == ALL_DOFS ? it->second->allDofs
+                                     : it->second->singleDofs[localDofIndex];
+  }
+
+private:
+  /** \cond PRIVATE */
+  BasisDataCache(const BasisDataCache &);
+  BasisDataCache &operator=(const BasisDataCache &);
+
+  struct Entry {
+    BasisData<BasisFunctionType> allDofs;
+    std::vector<BasisData<BasisFunctionType>> singleDofs;
+  };
+  typedef tbb::concurrent_unordered_map<const Shapeset<BasisFunctionType> *,
+                                        Entry *> EntryMap;
+
+  arma::Mat<CoordinateType> m_points;
+  size_t m_basisDeps;
+  mutable EntryMap m_entries;
+  /** \endcond */
+};
+
+} // namespace Fiber
+
+#endif
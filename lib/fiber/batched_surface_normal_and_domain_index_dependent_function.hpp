@@ -0,0 +1,129 @@
+// Copyright (C) 2011-2012 by the Bem++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_batched_surface_normal_and_domain_index_dependent_function_hpp
+#define fiber_batched_surface_normal_and_domain_index_dependent_function_hpp
+
+#include "../common/common.hpp"
+
+#include "function.hpp"
+#include "geometrical_data.hpp"
+
+#include <vector>
+
+namespace Fiber {
+
+/** \brief %Function intended to be evaluated on a boundary-element grid,
+  defined via a user-supplied functor evaluated on many points at once.
+
+  This class is the vectorized counterpart of
+  SurfaceNormalAndDomainIndexDependentFunction. Its functor receives the
+  global coordinates, unit normals and domain indices of a whole batch of
+  points, typically the quadrature points of a chunk of elements, which
+  makes it possible to amortize the cost of each call (e.g. a call into an
+  interpreter) over many points.
+
+  The template parameter \p Functor should be a class implementing the following
+  interface:
+
+  \code
+  class Functor
+  {
+  public:
+      // Type of the function's values (e.g. float or std::complex<double>)
+      typedef <implementation-defined> ValueType;
+      typedef ScalarTraits<ValueType>::RealType CoordinateType;
+
+      // Number of components of the function's arguments ("points" and
+      // "normals")
+      int argumentDimension() const;
+
+      // Number of components of the function's result
+      int resultDimension() const;
+
+      // Evaluate the function at the points stored in the columns of
+      // "points", with "normals" the corresponding local unit normal vectors
+      // and "domainIndices" the indices of the domains containing the
+      // points, and store the values in the columns of "result". All arrays
+      // will be preinitialised to correct dimensions.
+      void evaluate(const arma::Mat<CoordinateType>& points,
+                    const arma::Mat<CoordinateType>& normals,
+                    const std::vector<int>& domainIndices,
+                    arma::Mat<ValueType>& result) const;
+  };
+  \endcode
+*/
+template <typename Functor>
+class BatchedSurfaceNormalAndDomainIndexDependentFunction
+    : public Function<typename Functor::ValueType> {
+public:
+  typedef Function<typename Functor::ValueType> Base;
+  typedef typename Base::ValueType ValueType;
+  typedef typename Base::CoordinateType CoordinateType;
+
+  BatchedSurfaceNormalAndDomainIndexDependentFunction(const Functor &functor)
+      : m_functor(functor) {}
+
+  virtual int worldDimension() const { return m_functor.argumentDimension(); }
+
+  virtual int codomainDimension() const { return m_functor.resultDimension(); }
+
+  virtual void addGeometricalDependencies(size_t &geomDeps) const {
+    geomDeps |= GLOBALS | NORMALS | DOMAIN_INDEX;
+  }
+
+  virtual void evaluate(const GeometricalData<CoordinateType> &geomData,
+                        arma::Mat<ValueType> &result) const {
+    const std::vector<int> domainIndices(geomData.globals.n_cols,
+                                         geomData.domainIndex);
+    evaluateBatch(geomData, domainIndices, result);
+  }
+
+  virtual bool supportsBatchEvaluation() const { return true; }
+
+  virtual void evaluateBatch(const GeometricalData<CoordinateType> &geomData,
+                             const std::vector<int> &domainIndices,
+                             arma::Mat<ValueType> &result) const {
+    const arma::Mat<CoordinateType> &points = geomData.globals;
+    const arma::Mat<CoordinateType> &normals = geomData.normals;
+
+#ifndef NDEBUG
+    if ((int)points.n_rows != worldDimension() ||
+        (int)normals.n_rows != worldDimension())
+      throw std::invalid_argument(
+          "BatchedSurfaceNormalAndDomainIndexDependentFunction::"
+          "evaluateBatch(): incompatible world dimension");
+    if (domainIndices.size() != points.n_cols)
+      throw std::invalid_argument(
+          "BatchedSurfaceNormalAndDomainIndexDependentFunction::"
+          "evaluateBatch(): incorrect number of domain indices");
+#endif
+
+    result.set_size(codomainDimension(), points.n_cols);
+    m_functor.evaluate(points, normals, domainIndices, result);
+  }
+
+private:
+  Functor m_functor;
+};
+
+} // namespace Fiber
+
+#endif
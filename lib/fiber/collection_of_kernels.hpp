@@ -147,6 +147,14 @@ public:
 
   virtual CoordinateType
   estimateRelativeScale(CoordinateType distance) const = 0;
+
+  /** \brief Return an estimate of the rate of oscillation of the kernels.
+   *
+   *  For kernels behaving like \f$\exp(ikr)\f$, with \f$r\f$ the distance
+   *  between the test and trial points, this should be \f$|\mathrm{Re}\,
+   *  k|\f$. The default implementation returns 0, i.e. assumes the kernels
+   *  do not oscillate. */
+  virtual CoordinateType estimateOscillationRate() const { return 0.; }
 };
 
 } // namespace Fiber
@@ -78,6 +78,13 @@ namespace Fiber {
         // defined, the kernel behaves as if its estimated magnitude was 1
         // everywhere.
         CoordinateType estimateRelativeScale(CoordinateType distance) const;
+
+        // (Optional)
+        // Return the wave number of the kernel, using the convention of the
+        // modified Helmholtz equation (i.e. the kernels behave like
+        // exp(-waveNumber * r)). If defined, it is used to estimate the rate
+        // of oscillation of the kernels.
+        ValueType waveNumber() const;
     };
     \endcode
 
@@ -117,6 +124,8 @@ public:
 
   virtual CoordinateType estimateRelativeScale(CoordinateType distance) const;
 
+  virtual CoordinateType estimateOscillationRate() const;
+
 private:
   Functor m_functor;
 };
@@ -26,6 +26,7 @@
 #include "collection_of_3d_arrays.hpp"
 #include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
+#include "../common/complex_aux.hpp"
 
 #include <boost/utility/enable_if.hpp>
 #include <stdexcept>
@@ -43,6 +44,7 @@
 namespace Fiber {
 
 FIBER_HAS_MEM_FUNC(estimateRelativeScale, hasEstimateRelativeScale);
+FIBER_HAS_MEM_FUNC(waveNumber, hasWaveNumber);
 
 // template <class Type>
 // class TypeHasEstimateRelativeScale
@@ -97,6 +99,24 @@ estimateRelativeScaleInternal(const Functor &functor,
   return 1.;
 }
 
+// The kernels behave like exp(-waveNumber * r), so they oscillate with the
+// imaginary part of the wave number
+template <typename Functor>
+typename boost::enable_if<
+    hasWaveNumber<Functor, typename Functor::ValueType (Functor::*)() const>,
+    typename Functor::CoordinateType>::type
+estimateOscillationRateInternal(const Functor &functor) {
+  return std::abs(imagPart(functor.waveNumber()));
+}
+
+template <typename Functor>
+typename boost::disable_if<
+    hasWaveNumber<Functor, typename Functor::ValueType (Functor::*)() const>,
+    typename Functor::CoordinateType>::type
+estimateOscillationRateInternal(const Functor &functor) {
+  return 0.;
+}
+
 // template<typename Functor>
 // typename boost::enable_if<TypeHasEstimateRelativeScale<Functor>,
 //                          typename Functor::CoordinateType>::type
@@ -176,6 +196,12 @@ DefaultCollectionOfKernels<Functor>::estimateRelativeScale(
   return estimateRelativeScaleInternal(m_functor, distance);
 }
 
+template <typename Functor>
+typename DefaultCollectionOfKernels<Functor>::CoordinateType
+DefaultCollectionOfKernels<Functor>::estimateOscillationRate() const {
+  return estimateOscillationRateInternal(m_functor);
+}
+
 } // namespace Fiber
 
 #endif
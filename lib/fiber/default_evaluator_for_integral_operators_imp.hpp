@@ -180,9 +180,8 @@ void DefaultEvaluatorForIntegralOperators<
   // nature of kernels nor the fact that there may be more than one kernel
   const size_t kernelValuesSizePerEvalPoint =
       trialGeomData.globals.n_cols * sizeof(KernelType);
-  const size_t chunkSize =
+  size_t chunkSize =
       std::max(1ul, 10 * 1024 * 1024 / kernelValuesSizePerEvalPoint);
-  const size_t chunkCount = (pointCount + chunkSize - 1) / chunkSize;
 
   int maxThreadCount = 1;
   if (!m_parallelizationOptions.isOpenClEnabled()) {
@@ -192,6 +191,17 @@ void DefaultEvaluatorForIntegralOperators<
     else
       maxThreadCount = m_parallelizationOptions.maxThreadCount();
   }
+
+  // Make sure there are enough chunks to keep all threads busy
+  const size_t threadCount =
+      maxThreadCount == tbb::task_scheduler_init::automatic
+          ? tbb::task_scheduler_init::default_num_threads()
+          : maxThreadCount;
+  const size_t CHUNKS_PER_THREAD = 4;
+  chunkSize = std::min(
+      chunkSize,
+      std::max(1ul, pointCount / (CHUNKS_PER_THREAD * threadCount)));
+  const size_t chunkCount = (pointCount + chunkSize - 1) / chunkSize;
   tbb::task_scheduler_init scheduler(maxThreadCount);
   typedef EvaluationLoopBody<BasisFunctionType, KernelType, ResultType> Body;
   {
@@ -109,6 +109,8 @@ public:
 
   virtual CoordinateType estimateRelativeScale(CoordinateType minDist) const;
 
+  virtual void reportStatistics() const;
+
 private:
   /** \cond PRIVATE */
   typedef TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType>
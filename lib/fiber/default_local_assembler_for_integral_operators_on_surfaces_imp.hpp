@@ -24,6 +24,7 @@
 #include "default_local_assembler_for_integral_operators_on_surfaces.hpp"
 
 #include "double_quadrature_rule_family.hpp"
+#include "flat_triangle_test_kernel_trial_integrator.hpp"
 #include "nonseparable_numerical_test_kernel_trial_integrator.hpp"
 #include "quadrature_descriptor_selector_for_integral_operators.hpp"
 #include "separable_numerical_test_kernel_trial_integrator.hpp"
@@ -32,7 +33,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
 
-#include "../common/auto_timer.hpp"
+#include "../common/assembly_profile.hpp"
 
 namespace Fiber {
 
@@ -54,9 +55,11 @@ public:
       : m_activeIntegrator(activeIntegrator),
         m_activeElementPairs(activeElementPairs),
         m_activeTestBasis(activeTestShapeset),
-        m_activeTrialBasis(activeTrialShapeset), m_localResult(localResult) {}
+        m_activeTrialBasis(activeTrialShapeset), m_localResult(localResult),
+        m_profile(Bempp::AssemblyProfile::current()) {}
 
   void operator()(const tbb::blocked_range<size_t> &r) const {
+    Bempp::AssemblyProfile::Activation activation(m_profile);
     // copy the relevant subset of m_activeElementPairs into
     // localActiveElementPairs
     std::vector<ElementIndexPair> localActiveElementPairs(
@@ -73,6 +76,8 @@ private:
   const Shapeset<BasisFunctionType> &m_activeTestBasis;
   const Shapeset<BasisFunctionType> &m_activeTrialBasis;
   const std::vector<arma::Mat<ResultType> *> &m_localResult;
+  // Profile of the thread starting the loop
+  Bempp::AssemblyProfile *m_profile;
 };
 
 } // namespace
@@ -371,6 +376,14 @@ DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
   return m_kernels->estimateRelativeScale(minDist);
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
+    BasisFunctionType, KernelType, ResultType,
+    GeometryFactory>::reportStatistics() const {
+  m_quadDescSelector->reportStatistics();
+}
+
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
 void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
@@ -433,13 +446,12 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     BasisFunctionType, KernelType, ResultType,
     GeometryFactory>::cacheLocalWeakForms(const ElementIndexPairSet &
                                               elementIndexPairs) {
-  tbb::tick_count start = tbb::tick_count::now();
-
   if (elementIndexPairs.empty())
     return;
 
   if (m_verbosityLevel >= VerbosityLevel::DEFAULT)
     std::cout << "Precalculating singular integrals..." << std::endl;
+  Bempp::AssemblyProfile::PhaseTimer timer("singularIntegralCaching");
 
   // Get the maximum number of neighbours a trial element can have.
   // This will be used to allocate a cache of correct size.
@@ -562,10 +574,8 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
                activeTrialShapeset, activeLocalResults));
     }
   }
-  tbb::tick_count end = tbb::tick_count::now();
-  if (m_verbosityLevel >= VerbosityLevel::DEFAULT)
-    std::cout << "Precalculation of singular integrals took "
-              << (end - start).seconds() << " s" << std::endl;
+  if (Bempp::AssemblyProfile *profile = Bempp::AssemblyProfile::current())
+    profile->addCount("cachedSingularIntegrals", elementPairCount);
 }
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
@@ -604,14 +614,25 @@ DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
           desc, testPoints, trialPoints, testWeights, trialWeights, isTensor);
       Integrator *integrator = 0;
       if (isTensor) {
-        typedef SeparableNumericalTestKernelTrialIntegrator<
-            BasisFunctionType, KernelType, ResultType, GeometryFactory>
-        ConcreteIntegrator;
-        integrator = new ConcreteIntegrator(
-            testPoints, trialPoints, testWeights, trialWeights,
-            *m_testGeometryFactory, *m_trialGeometryFactory, *m_testRawGeometry,
-            *m_trialRawGeometry, *m_testTransformations, *m_kernels,
-            *m_trialTransformations, *m_integral, *m_openClHandler);
+        // Fast path for the common case of layer potentials on flat triangles
+        integrator =
+            makeFlatTriangleTestKernelTrialIntegrator<BasisFunctionType,
+                                                      KernelType, ResultType>(
+                desc, testPoints, trialPoints, testWeights, trialWeights,
+                *m_testRawGeometry, *m_trialRawGeometry, *m_testShapesets,
+                *m_trialShapesets, *m_testTransformations, *m_kernels,
+                *m_trialTransformations, *m_integral, *m_openClHandler);
+        if (!integrator) {
+          typedef SeparableNumericalTestKernelTrialIntegrator<
+              BasisFunctionType, KernelType, ResultType, GeometryFactory>
+          ConcreteIntegrator;
+          integrator = new ConcreteIntegrator(
+              testPoints, trialPoints, testWeights, trialWeights,
+              *m_testGeometryFactory, *m_trialGeometryFactory,
+              *m_testRawGeometry, *m_trialRawGeometry, *m_testTransformations,
+              *m_kernels, *m_trialTransformations, *m_integral,
+              *m_openClHandler);
+        }
       } else {
         typedef NonseparableNumericalTestKernelTrialIntegrator<
             BasisFunctionType, KernelType, ResultType, GeometryFactory>
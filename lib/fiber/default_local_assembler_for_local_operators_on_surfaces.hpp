@@ -37,6 +37,7 @@
 #include <set>
 #include <utility>
 #include <vector>
+#include <tbb/mutex.h>
 
 namespace Fiber {
 
@@ -111,6 +112,7 @@ private:
   shared_ptr<const SingleQuadratureRuleFamily<CoordinateType>> m_quadRuleFamily;
 
   IntegratorMap m_testTrialIntegrators;
+  tbb::mutex m_integratorMapMutex;
   /** \endcond */
 };
 
@@ -140,6 +140,7 @@ const TestTrialIntegrator<BasisFunctionType, ResultType> &
 DefaultLocalAssemblerForLocalOperatorsOnSurfaces<
     BasisFunctionType, ResultType,
     GeometryFactory>::getIntegrator(const SingleQuadratureDescriptor &desc) {
+  tbb::mutex::scoped_lock lock(m_integratorMapMutex);
   typename IntegratorMap::iterator it = m_testTrialIntegrators.find(desc);
   if (it != m_testTrialIntegrators.end()) {
     //            std::cout << "getIntegrator(: " << index << "): integrator
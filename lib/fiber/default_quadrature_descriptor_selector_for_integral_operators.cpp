@@ -22,12 +22,98 @@
 
 #include "default_local_assembler_for_operators_on_surfaces_utilities.hpp"
 #include "explicit_instantiation.hpp"
+#include "numerical_quadrature.hpp"
 #include "quadrature_options.hpp"
 #include "raw_grid_geometry.hpp"
 #include "shapeset.hpp"
 
+#include "../common/assembly_profile.hpp"
+#include "../common/to_string.hpp"
+
+#include <algorithm>
+#include <cmath>
+
 namespace Fiber {
 
+namespace {
+
+// Highest order of the available quadrature rules on triangles
+const int MAX_REGULAR_ORDER = 20;
+
+// A-priori model of the relative error of a quadrature rule of order
+// (basisOrder + increase) applied to a kernel behaving like exp(ikr) / r on a
+// pair of elements of size h lying at distance d = normalisedDistance * h,
+// with oscillation = |k| h. The first term is the convergence rate of Gauss
+// rules for an integrand analytic in an ellipse reaching the singularity,
+// the second the remainder of the Taylor series of the oscillatory factor.
+double modelledRegularQuadratureError(double normalisedDistance,
+                                      double oscillation, int increase) {
+  const int n = increase + 1;
+  const double beta = 2. * normalisedDistance;
+  const double rho =
+      (beta > 1.) ? 1. / (beta + std::sqrt(beta * beta - 1.)) : 1.;
+  const double phase = std::exp(1.) * oscillation / (2. * n);
+  return std::pow(rho, n) + std::pow(phase, n);
+}
+
+double integrateInverseDistanceOnReferenceTriangle(
+    const arma::Mat<double> &points, const std::vector<double> &weights,
+    const double *source) {
+  double result = 0.;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const double dx = points(0, i) - source[0];
+    const double dy = points(1, i) - source[1];
+    const double dz = -source[2];
+    result += weights[i] / std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  return result;
+}
+
+// Compare the errors of rules of increasing order applied to 1 / r on the
+// reference triangle with the model and return the largest ratio
+double calibrateRegularQuadratureErrorModel() {
+  arma::Mat<double> referencePoints, points;
+  std::vector<double> referenceWeights, weights;
+  fillSingleQuadraturePointsAndWeights(3, MAX_REGULAR_ORDER, referencePoints,
+                                       referenceWeights);
+  const double elementSize = std::sqrt(2.); // longest edge
+  const double normalisedDistances[] = {1.5, 2., 3., 5., 8.};
+  const int distanceCount =
+      sizeof(normalisedDistances) / sizeof(normalisedDistances[0]);
+  const int maxIncrease = 10;
+
+  double constant = 0.;
+  for (int i = 0; i < distanceCount; ++i) {
+    const double source[3] = {1. / 3., 1. / 3.,
+                              normalisedDistances[i] * elementSize};
+    const double reference = integrateInverseDistanceOnReferenceTriangle(
+        referencePoints, referenceWeights, source);
+    for (int increase = 0; increase <= maxIncrease; ++increase) {
+      const double model =
+          modelledRegularQuadratureError(normalisedDistances[i], 0., increase);
+      // Skip samples whose error is dominated by that of the reference
+      if (model < 1e-12)
+        break;
+      fillSingleQuadraturePointsAndWeights(3, increase, points, weights);
+      const double error =
+          std::abs(integrateInverseDistanceOnReferenceTriangle(
+                       points, weights, source) -
+                   reference) /
+          std::abs(reference);
+      constant = std::max(constant, error / model);
+    }
+  }
+  return (constant > 0.) ? constant : 1.;
+}
+
+double regularQuadratureErrorModelConstant() {
+  // Calibrated on first use; initialisation of local statics is thread-safe
+  static const double constant = calibrateRegularQuadratureErrorModel();
+  return constant;
+}
+
+} // namespace
+
 template <typename BasisFunctionType>
 DefaultQuadratureDescriptorSelectorForIntegralOperators<BasisFunctionType>::
     DefaultQuadratureDescriptorSelectorForIntegralOperators(
@@ -42,7 +128,9 @@ DefaultQuadratureDescriptorSelectorForIntegralOperators<BasisFunctionType>::
         const AccuracyOptionsEx &accuracyOptions)
     : m_testRawGeometry(testRawGeometry), m_trialRawGeometry(trialRawGeometry),
       m_testShapesets(testShapesets), m_trialShapesets(trialShapesets),
-      m_accuracyOptions(accuracyOptions) {
+      m_accuracyOptions(accuracyOptions), m_oscillationRate(0.),
+      m_decayRate(0.),
+      m_regularOrderCounts(std::vector<size_t>(MAX_REGULAR_ORDER + 1, 0)) {
   Utilities::checkConsistencyOfGeometryAndShapesets(*testRawGeometry,
                                                     *testShapesets);
   Utilities::checkConsistencyOfGeometryAndShapesets(*trialRawGeometry,
@@ -50,6 +138,47 @@ DefaultQuadratureDescriptorSelectorForIntegralOperators<BasisFunctionType>::
   precalculateElementSizesAndCenters();
 }
 
+template <typename BasisFunctionType>
+void DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::setKernelProperties(CoordinateType oscillationRate,
+                                            CoordinateType decayRate) {
+  m_oscillationRate = oscillationRate;
+  m_decayRate = decayRate;
+}
+
+template <typename BasisFunctionType>
+void DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::reportStatistics() const {
+  if (!m_accuracyOptions.doubleRegularIsAdaptive())
+    return;
+  Bempp::AssemblyProfile *profile = Bempp::AssemblyProfile::current();
+  if (!profile)
+    return;
+  const std::vector<size_t> histogram = regularOrderHistogram();
+  for (size_t order = 0; order < histogram.size(); ++order)
+    if (histogram[order])
+      profile->addCount("regularQuadratureOrder" + Bempp::toString(order),
+                        histogram[order]);
+  typedef typename tbb::enumerable_thread_specific<
+      std::vector<size_t>>::iterator Iterator;
+  for (Iterator it = m_regularOrderCounts.begin();
+       it != m_regularOrderCounts.end(); ++it)
+    std::fill(it->begin(), it->end(), 0);
+}
+
+template <typename BasisFunctionType>
+std::vector<size_t> DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::regularOrderHistogram() const {
+  std::vector<size_t> result(MAX_REGULAR_ORDER + 1, 0);
+  typedef typename tbb::enumerable_thread_specific<
+      std::vector<size_t>>::const_iterator Iterator;
+  for (Iterator it = m_regularOrderCounts.begin();
+       it != m_regularOrderCounts.end(); ++it)
+    for (size_t order = 0; order < result.size(); ++order)
+      result[order] += (*it)[order];
+  return result;
+}
+
 template <typename BasisFunctionType>
 inline bool DefaultQuadratureDescriptorSelectorForIntegralOperators<
     BasisFunctionType>::testAndTrialGridsAreIdentical() const {
@@ -119,9 +248,7 @@ void DefaultQuadratureDescriptorSelectorForIntegralOperators<
                                          int &trialQuadOrder,
                                          CoordinateType nominalDistance) const {
   // TODO:
-  // 1. Check the size of elements and the distance between them
-  //    and estimate the variability of the kernel
-  // 2. Take into account the fact that elements might be isoparametric.
+  // Take into account the fact that elements might be isoparametric.
 
   // Order required for exact quadrature on affine elements with a constant
   // kernel
@@ -130,27 +257,66 @@ void DefaultQuadratureDescriptorSelectorForIntegralOperators<
   testQuadOrder = testBasisOrder;
   trialQuadOrder = trialBasisOrder;
 
-  CoordinateType normalisedDistance;
+  CoordinateType elementSize, distance;
   if (nominalDistance < 0.) {
     CoordinateType testElementSizeSquared =
         m_testElementSizesSquared[testElementIndex];
     CoordinateType trialElementSizeSquared =
         m_trialElementSizesSquared[trialElementIndex];
-    CoordinateType distanceSquared =
-        elementDistanceSquared(testElementIndex, trialElementIndex);
-    CoordinateType normalisedDistanceSquared =
-        distanceSquared /
-        std::max(testElementSizeSquared, trialElementSizeSquared);
-    normalisedDistance = sqrt(normalisedDistanceSquared);
-  } else
-    normalisedDistance = nominalDistance / m_averageElementSize;
+    elementSize =
+        sqrt(std::max(testElementSizeSquared, trialElementSizeSquared));
+    distance =
+        sqrt(elementDistanceSquared(testElementIndex, trialElementIndex));
+  } else {
+    elementSize = m_averageElementSize;
+    distance = nominalDistance;
+  }
+
+  if (m_accuracyOptions.doubleRegularIsAdaptive()) {
+    const int maxIncrease =
+        std::max(0, m_accuracyOptions.doubleRegularMaxOrder() -
+                        std::max(testBasisOrder, trialBasisOrder));
+    const int increase =
+        adaptiveRegularOrderIncrease(elementSize, distance, maxIncrease);
+    testQuadOrder += increase;
+    trialQuadOrder += increase;
+    const size_t bin = std::min<size_t>(std::max(testQuadOrder, trialQuadOrder),
+                                        MAX_REGULAR_ORDER);
+    ++m_regularOrderCounts.local()[bin];
+    return;
+  }
 
   const QuadratureOptions &options =
-      m_accuracyOptions.doubleRegular(normalisedDistance);
+      m_accuracyOptions.doubleRegular(distance / elementSize);
   testQuadOrder = options.quadratureOrder(testQuadOrder);
   trialQuadOrder = options.quadratureOrder(trialQuadOrder);
 }
 
+template <typename BasisFunctionType>
+int DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::adaptiveRegularOrderIncrease(CoordinateType elementSize,
+                                                     CoordinateType distance,
+                                                     int maxIncrease) const {
+  // The contributions of pairs further apart than the nearest neighbours are
+  // smaller by the decay of the kernels, so their tolerance can be relaxed
+  const double decay =
+      std::min(double(m_decayRate * std::max(distance - elementSize,
+                                             CoordinateType(0.))),
+               700.);
+  const double tolerance = m_accuracyOptions.doubleRegularTolerance() *
+                           std::exp(decay) /
+                           regularQuadratureErrorModelConstant();
+  const double normalisedDistance = distance / elementSize;
+  const double oscillation = m_oscillationRate * elementSize;
+
+  int increase = 0;
+  while (increase < maxIncrease &&
+         modelledRegularQuadratureError(normalisedDistance, oscillation,
+                                        increase) > tolerance)
+    ++increase;
+  return increase;
+}
+
 template <typename BasisFunctionType>
 int DefaultQuadratureDescriptorSelectorForIntegralOperators<
     BasisFunctionType>::singularOrder(int elementIndex,
@@ -27,6 +27,9 @@
 #include "accuracy_options.hpp"
 #include "scalar_traits.hpp"
 
+#include <tbb/enumerable_thread_specific.h>
+#include <vector>
+
 namespace Fiber {
 
 template <typename BasisFunctionType> class Shapeset;
@@ -38,7 +41,11 @@ class DefaultLocalAssemblerForOperatorsOnSurfacesUtilities;
  *  used during the discretization of boundary integral operators.
  *
  *  The choice of quadrature rule accuracy can be influenced by the
- *  \p accuracyOptions parameter taken by the constructor. */
+ *  \p accuracyOptions parameter taken by the constructor. If
+ *  AccuracyOptionsEx::doubleRegularIsAdaptive() is true, the orders of
+ *  regular quadrature rules are chosen from an error estimate for each pair
+ *  of elements; the number of pairs integrated with each order can then be
+ *  retrieved with regularOrderHistogram(). */
 template <typename BasisFunctionType>
 class DefaultQuadratureDescriptorSelectorForIntegralOperators
     : public QuadratureDescriptorSelectorForIntegralOperators<
@@ -59,6 +66,24 @@ public:
   quadratureDescriptor(int testElementIndex, int trialElementIndex,
                        CoordinateType nominalDistance) const;
 
+  virtual void setKernelProperties(CoordinateType oscillationRate,
+                                   CoordinateType decayRate);
+
+  /** \brief In the adaptive mode, add the distribution of the regular
+   *  quadrature orders selected since the previous call to the current
+   *  AssemblyProfile, if there is one, and reset the histogram.
+   *
+   *  Must not be called concurrently with quadratureDescriptor(). */
+  virtual void reportStatistics() const;
+
+  /** \brief Return the number of times a regular quadrature rule of each
+   *  order has been selected in the adaptive mode.
+   *
+   *  Element \em i of the returned vector counts the element pairs assigned
+   *  a rule of order \em i (the larger of the test and trial order) since
+   *  the last call to reportStatistics(). */
+  std::vector<size_t> regularOrderHistogram() const;
+
 private:
   /** \cond PRIVATE */
   typedef DefaultLocalAssemblerForOperatorsOnSurfacesUtilities<
@@ -74,6 +99,9 @@ private:
   void getRegularOrders(int testElementIndex, int trialElementIndex,
                         int &testQuadOrder, int &trialQuadOrder,
                         CoordinateType nominalDistance) const;
+  int adaptiveRegularOrderIncrease(CoordinateType elementSize,
+                                   CoordinateType distance,
+                                   int maxIncrease) const;
   int singularOrder(int elementIndex, ElementType elementType) const;
   CoordinateType elementDistanceSquared(int testElementIndex,
                                         int trialElementIndex) const;
@@ -91,6 +119,13 @@ private:
   arma::Mat<CoordinateType> m_testElementCenters;
   arma::Mat<CoordinateType> m_trialElementCenters;
   CoordinateType m_averageElementSize;
+
+  CoordinateType m_oscillationRate;
+  CoordinateType m_decayRate;
+  // Counted separately by each thread to keep the assembly loops free of
+  // contention; combined by regularOrderHistogram()
+  mutable tbb::enumerable_thread_specific<std::vector<size_t>>
+  m_regularOrderCounts;
   /** \endcond */
 };
 
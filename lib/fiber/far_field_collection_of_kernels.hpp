@@ -0,0 +1,81 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_far_field_collection_of_kernels_hpp
+#define fiber_far_field_collection_of_kernels_hpp
+
+#include "default_collection_of_kernels.hpp"
+
+namespace Fiber {
+
+/** \ingroup weak_form_elements
+ *  \brief Collection of far-field kernels sharing the factor
+ *  <tt>exp(waveNumber * x.y)</tt>.
+
+    The kernels used to evaluate far-field patterns of Helmholtz and Maxwell
+    potentials are all of the form <tt>f(x, y) exp(waveNumber * x.y)</tt>,
+    where \c x is a unit direction and \c y a point on the surface. This
+    collection evaluates them on a grid of direction/point pairs as follows:
+    the dot products <tt>x.y</tt> are obtained with a single matrix-matrix
+    product, the exponentials are then computed in a contiguous loop (which
+    reduces to a pair of vectorizable cosine and sine evaluations if the wave
+    number is purely imaginary) and finally the functor combines them with
+    the remaining factors \c f.
+
+    In addition to the interface required by DefaultCollectionOfKernels, the
+    Functor class should provide the following member functions:
+
+    \code
+    // Return the wave number appearing in the exponential
+    ValueType waveNumber() const;
+
+    // Evaluate the kernels at the pair of points whose geometrical data are
+    // provided in the testGeomData and trialGeomData arguments, given the
+    // value of exp(waveNumber * x.y) at these points.
+    template <template <typename T> class CollectionOf2dSlicesOfNdArrays>
+    void evaluateWithPhaseFactor(
+            const ConstGeometricalDataSlice<CoordinateType>& testGeomData,
+            const ConstGeometricalDataSlice<CoordinateType>& trialGeomData,
+            ValueType phaseFactor,
+            CollectionOf2dSlicesOfNdArrays<ValueType>& result) const;
+    \endcode
+ */
+template <typename Functor>
+class FarFieldCollectionOfKernels : public DefaultCollectionOfKernels<Functor> {
+  typedef DefaultCollectionOfKernels<Functor> Base;
+
+public:
+  typedef typename Base::ValueType ValueType;
+  typedef typename Base::CoordinateType CoordinateType;
+
+  explicit FarFieldCollectionOfKernels(const Functor &functor)
+      : Base(functor) {}
+
+  virtual void
+  evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                 const GeometricalData<CoordinateType> &trialGeomData,
+                 CollectionOf4dArrays<ValueType> &result) const;
+};
+
+} // namespace Fiber
+
+#include "far_field_collection_of_kernels_imp.hpp"
+
+#endif
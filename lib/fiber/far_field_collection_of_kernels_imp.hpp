@@ -0,0 +1,98 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_far_field_collection_of_kernels_imp_hpp
+#define fiber_far_field_collection_of_kernels_imp_hpp
+
+#include "far_field_collection_of_kernels.hpp"
+
+#include "collection_of_4d_arrays.hpp"
+#include "geometrical_data.hpp"
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace Fiber {
+
+namespace {
+
+template <typename T>
+inline void makePhaseFactor(T cosValue, T /* sinValue */, T &result) {
+  result = cosValue;
+}
+
+template <typename T>
+inline void makePhaseFactor(T cosValue, T sinValue, std::complex<T> &result) {
+  result = std::complex<T>(cosValue, sinValue);
+}
+
+} // namespace
+
+template <typename Functor>
+void FarFieldCollectionOfKernels<Functor>::evaluateOnGrid(
+    const GeometricalData<CoordinateType> &testGeomData,
+    const GeometricalData<CoordinateType> &trialGeomData,
+    CollectionOf4dArrays<ValueType> &result) const {
+  const Functor &functor = this->functor();
+  const size_t testPointCount = testGeomData.pointCount();
+  const size_t trialPointCount = trialGeomData.pointCount();
+  const size_t kernelCount = functor.kernelCount();
+  result.set_size(kernelCount);
+  for (size_t k = 0; k < kernelCount; ++k)
+    result[k].set_size(functor.kernelRowCount(k), functor.kernelColCount(k),
+                       testPointCount, trialPointCount);
+
+  // Dot products of all test and trial points, (test, trial)-indexed
+  const arma::Mat<CoordinateType> dotProducts =
+      testGeomData.globals.t() * trialGeomData.globals;
+  const size_t pairCount = dotProducts.n_elem;
+  const CoordinateType *dotProductPtr = dotProducts.memptr();
+
+  const ValueType waveNumber = functor.waveNumber();
+  std::vector<ValueType> phaseFactors(pairCount);
+  if (std::real(waveNumber) == static_cast<CoordinateType>(0.)) {
+    // Oscillatory kernel: exp(i b t) = cos(b t) + i sin(b t). The cosines
+    // and sines are computed in separate loops over contiguous arrays so
+    // that they can be vectorized.
+    const CoordinateType b = std::imag(waveNumber);
+    std::vector<CoordinateType> cosValues(pairCount), sinValues(pairCount);
+    for (size_t i = 0; i < pairCount; ++i)
+      cosValues[i] = std::cos(b * dotProductPtr[i]);
+    for (size_t i = 0; i < pairCount; ++i)
+      sinValues[i] = std::sin(b * dotProductPtr[i]);
+    for (size_t i = 0; i < pairCount; ++i)
+      makePhaseFactor(cosValues[i], sinValues[i], phaseFactors[i]);
+  } else
+    for (size_t i = 0; i < pairCount; ++i)
+      phaseFactors[i] = std::exp(waveNumber * dotProductPtr[i]);
+
+  for (size_t trialIndex = 0; trialIndex < trialPointCount; ++trialIndex)
+    for (size_t testIndex = 0; testIndex < testPointCount; ++testIndex)
+      functor.evaluateWithPhaseFactor(
+          testGeomData.const_slice(testIndex),
+          trialGeomData.const_slice(trialIndex),
+          phaseFactors[trialIndex * testPointCount + testIndex],
+          result.slice(testIndex, trialIndex).self());
+}
+
+} // namespace Fiber
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_flat_triangle_test_kernel_trial_integrator_hpp
+#define fiber_flat_triangle_test_kernel_trial_integrator_hpp
+
+#include "../common/common.hpp"
+
+#include "basis_data_cache.hpp"
+#include "double_quadrature_descriptor.hpp"
+#include "test_kernel_trial_integrator.hpp"
+
+#include <vector>
+
+namespace Fiber {
+
+/** \cond FORWARD_DECL */
+class OpenClHandler;
+template <typename CoordinateType> class CollectionOfShapesetTransformations;
+template <typename ValueType> class CollectionOfKernels;
+template <typename CoordinateType> class RawGridGeometry;
+template <typename BasisFunctionType, typename KernelType, typename ResultType>
+class TestKernelTrialIntegral;
+/** \endcond */
+
+/** \brief Integration of scalar kernels over pairs of disjoint flat
+ *  triangles, specialised for shapesets with one or three functions.
+
+    This integrator covers the most common case of boundary element assembly:
+    the single- and double-layer operators of the Laplace and (modified)
+    Helmholtz equations discretised with piecewise constant or piecewise
+    linear functions. Compared to SeparableNumericalTestKernelTrialIntegrator
+    it
+
+    - computes the global coordinates of quadrature points from the affine
+      map of each triangle, set up from the RawGridGeometry when the element
+      changes, instead of from cached GeometricalData objects,
+    - calls the kernel functor directly (through its evaluateAtPointPair()
+      member function) rather than through CollectionOfKernels,
+    - keeps all intermediate values in stack-allocated arrays, sized at
+      compile time by the maximum number of quadrature points and by the
+      numbers of test and trial functions.
+
+    Objects of this class are created by
+    makeFlatTriangleTestKernelTrialIntegrator(), which checks that the
+    operator being assembled fits these assumptions.
+ */
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+class FlatTriangleTestKernelTrialIntegrator
+    : public TestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                       ResultType> {
+public:
+  typedef TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType>
+  Base;
+  typedef typename Base::CoordinateType CoordinateType;
+  typedef typename Base::ElementIndexPair ElementIndexPair;
+
+  /** \brief Maximum number of quadrature points on a single triangle. */
+  static const int MAX_POINT_COUNT = 16;
+
+  FlatTriangleTestKernelTrialIntegrator(
+      const arma::Mat<CoordinateType> &localTestQuadPoints,
+      const arma::Mat<CoordinateType> &localTrialQuadPoints,
+      const std::vector<CoordinateType> &testQuadWeights,
+      const std::vector<CoordinateType> &trialQuadWeights,
+      const RawGridGeometry<CoordinateType> &testRawGeometry,
+      const RawGridGeometry<CoordinateType> &trialRawGeometry,
+      const CollectionOfShapesetTransformations<CoordinateType> &
+          testTransformations,
+      const KernelFunctor &kernelFunctor,
+      const CollectionOfShapesetTransformations<CoordinateType> &
+          trialTransformations);
+
+  virtual void
+  integrate(CallVariant callVariant, const std::vector<int> &elementIndicesA,
+            int elementIndexB, const Shapeset<BasisFunctionType> &basisA,
+            const Shapeset<BasisFunctionType> &basisB,
+            LocalDofIndex localDofIndexB,
+            const std::vector<arma::Mat<ResultType> *> &result) const;
+
+  virtual void
+  integrate(const std::vector<ElementIndexPair> &elementIndexPairs,
+            const Shapeset<BasisFunctionType> &testShapeset,
+            const Shapeset<BasisFunctionType> &trialShapeset,
+            const std::vector<arma::Mat<ResultType> *> &result) const;
+
+private:
+  /** \cond PRIVATE */
+  // Affine map x = origin + xi * edge1 + eta * edge2 of a triangle
+  struct Triangle {
+    CoordinateType origin[3];
+    CoordinateType edge1[3];
+    CoordinateType edge2[3];
+    CoordinateType normal[3];
+    CoordinateType integrationElement;
+  };
+
+  static void setUpTriangle(const RawGridGeometry<CoordinateType> &rawGeometry,
+                            int elementIndex, Triangle &triangle);
+
+  template <int TestDofCount, int TrialDofCount>
+  void integratePairs(const ElementIndexPair *elementIndexPairs,
+                      size_t pairCount,
+                      const BasisData<BasisFunctionType> &testBasisData,
+                      const BasisData<BasisFunctionType> &trialBasisData,
+                      arma::Mat<ResultType> *const *result) const;
+
+  void dispatch(const ElementIndexPair *elementIndexPairs, size_t pairCount,
+                const BasisData<BasisFunctionType> &testBasisData,
+                const BasisData<BasisFunctionType> &trialBasisData,
+                arma::Mat<ResultType> *const *result) const;
+
+  int m_testPointCount;
+  int m_trialPointCount;
+  CoordinateType m_localTestQuadPoints[2][MAX_POINT_COUNT];
+  CoordinateType m_localTrialQuadPoints[2][MAX_POINT_COUNT];
+  CoordinateType m_testQuadWeights[MAX_POINT_COUNT];
+  CoordinateType m_trialQuadWeights[MAX_POINT_COUNT];
+
+  const RawGridGeometry<CoordinateType> &m_testRawGeometry;
+  const RawGridGeometry<CoordinateType> &m_trialRawGeometry;
+
+  const KernelFunctor &m_kernelFunctor;
+
+  BasisDataCache<BasisFunctionType> m_testBasisData;
+  BasisDataCache<BasisFunctionType> m_trialBasisData;
+  /** \endcond */
+};
+
+/** \brief Create a FlatTriangleTestKernelTrialIntegrator if it can be used
+ *  to evaluate integrals over pairs of elements described by \p desc.
+
+    Return a null pointer if any of the following conditions does not hold:
+
+    - the elements are disjoint triangles and the quadrature rules have at
+      most FlatTriangleTestKernelTrialIntegrator::MAX_POINT_COUNT points,
+    - the kernel collection is a DefaultCollectionOfKernels wrapping the
+      (non-interpolated) single- or double-layer potential kernel functor of
+      the Laplace or modified Helmholtz equation,
+    - both shapeset transformations map functions to their values and the
+      integral is the product of test function, kernel and trial function,
+    - all test and trial shapesets consist of one or three functions,
+    - OpenCL is not in use.
+
+    The caller takes ownership of the returned object. */
+template <typename BasisFunctionType, typename KernelType, typename ResultType>
+TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType> *
+makeFlatTriangleTestKernelTrialIntegrator(
+    const DoubleQuadratureDescriptor &desc,
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTestQuadPoints,
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTrialQuadPoints,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        testQuadWeights,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        trialQuadWeights,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        testRawGeometry,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        trialRawGeometry,
+    const std::vector<const Shapeset<BasisFunctionType> *> &testShapesets,
+    const std::vector<const Shapeset<BasisFunctionType> *> &trialShapesets,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &testTransformations,
+    const CollectionOfKernels<KernelType> &kernels,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &trialTransformations,
+    const TestKernelTrialIntegral<BasisFunctionType, KernelType, ResultType> &
+        integral,
+    const OpenClHandler &openClHandler);
+
+} // namespace Fiber
+
+#include "flat_triangle_test_kernel_trial_integrator_imp.hpp"
+
+#endif
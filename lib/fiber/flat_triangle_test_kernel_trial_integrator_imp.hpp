@@ -0,0 +1,441 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_flat_triangle_test_kernel_trial_integrator_imp_hpp
+#define fiber_flat_triangle_test_kernel_trial_integrator_imp_hpp
+
+#include "flat_triangle_test_kernel_trial_integrator.hpp" // To keep IDEs happy
+
+#include "basis_data.hpp"
+#include "conjugate.hpp"
+#include "default_collection_of_kernels.hpp"
+#include "default_collection_of_shapeset_transformations.hpp"
+#include "default_test_kernel_trial_integral.hpp"
+#include "laplace_3d_double_layer_potential_kernel_functor.hpp"
+#include "laplace_3d_single_layer_potential_kernel_functor.hpp"
+#include "modified_helmholtz_3d_double_layer_potential_kernel_functor.hpp"
+#include "modified_helmholtz_3d_single_layer_potential_kernel_functor.hpp"
+#include "opencl_handler.hpp"
+#include "raw_grid_geometry.hpp"
+#include "scalar_function_value_functor.hpp"
+#include "shapeset.hpp"
+#include "simple_test_scalar_kernel_trial_integrand_functor.hpp"
+#include "typical_test_scalar_kernel_trial_integral.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace Fiber {
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+FlatTriangleTestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                      ResultType, KernelFunctor>::
+    FlatTriangleTestKernelTrialIntegrator(
+        const arma::Mat<CoordinateType> &localTestQuadPoints,
+        const arma::Mat<CoordinateType> &localTrialQuadPoints,
+        const std::vector<CoordinateType> &testQuadWeights,
+        const std::vector<CoordinateType> &trialQuadWeights,
+        const RawGridGeometry<CoordinateType> &testRawGeometry,
+        const RawGridGeometry<CoordinateType> &trialRawGeometry,
+        const CollectionOfShapesetTransformations<CoordinateType> &
+            testTransformations,
+        const KernelFunctor &kernelFunctor,
+        const CollectionOfShapesetTransformations<CoordinateType> &
+            trialTransformations)
+    : m_testPointCount(localTestQuadPoints.n_cols),
+      m_trialPointCount(localTrialQuadPoints.n_cols),
+      m_testRawGeometry(testRawGeometry), m_trialRawGeometry(trialRawGeometry),
+      m_kernelFunctor(kernelFunctor),
+      m_testBasisData(localTestQuadPoints, testTransformations),
+      m_trialBasisData(localTrialQuadPoints, trialTransformations) {
+  if (localTestQuadPoints.n_cols != testQuadWeights.size() ||
+      localTrialQuadPoints.n_cols != trialQuadWeights.size())
+    throw std::invalid_argument(
+        "FlatTriangleTestKernelTrialIntegrator::"
+        "FlatTriangleTestKernelTrialIntegrator(): "
+        "numbers of points and weights do not match");
+  if (m_testPointCount > MAX_POINT_COUNT ||
+      m_trialPointCount > MAX_POINT_COUNT)
+    throw std::invalid_argument(
+        "FlatTriangleTestKernelTrialIntegrator::"
+        "FlatTriangleTestKernelTrialIntegrator(): "
+        "too many quadrature points");
+  if (testRawGeometry.vertices().n_rows != 3 ||
+      trialRawGeometry.vertices().n_rows != 3)
+    throw std::invalid_argument(
+        "FlatTriangleTestKernelTrialIntegrator::"
+        "FlatTriangleTestKernelTrialIntegrator(): "
+        "the grids must be embedded in a 3D space");
+
+  for (int point = 0; point < m_testPointCount; ++point) {
+    m_localTestQuadPoints[0][point] = localTestQuadPoints(0, point);
+    m_localTestQuadPoints[1][point] = localTestQuadPoints(1, point);
+    m_testQuadWeights[point] = testQuadWeights[point];
+  }
+  for (int point = 0; point < m_trialPointCount; ++point) {
+    m_localTrialQuadPoints[0][point] = localTrialQuadPoints(0, point);
+    m_localTrialQuadPoints[1][point] = localTrialQuadPoints(1, point);
+    m_trialQuadWeights[point] = trialQuadWeights[point];
+  }
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+inline void FlatTriangleTestKernelTrialIntegrator<
+    BasisFunctionType, KernelType, ResultType,
+    KernelFunctor>::setUpTriangle(const RawGridGeometry<CoordinateType> &
+                                      rawGeometry,
+                                  int elementIndex, Triangle &triangle) {
+  const int coordCount = 3;
+  const arma::Mat<CoordinateType> &vertices = rawGeometry.vertices();
+  const arma::Mat<int> &cornerIndices = rawGeometry.elementCornerIndices();
+  const CoordinateType *v0 = vertices.colptr(cornerIndices(0, elementIndex));
+  const CoordinateType *v1 = vertices.colptr(cornerIndices(1, elementIndex));
+  const CoordinateType *v2 = vertices.colptr(cornerIndices(2, elementIndex));
+  for (int d = 0; d < coordCount; ++d) {
+    triangle.origin[d] = v0[d];
+    triangle.edge1[d] = v1[d] - v0[d];
+    triangle.edge2[d] = v2[d] - v0[d];
+  }
+  // Same orientation as the normals computed by ConcreteGeometry
+  const CoordinateType *a = triangle.edge1;
+  const CoordinateType *b = triangle.edge2;
+  CoordinateType *n = triangle.normal;
+  n[0] = a[1] * b[2] - a[2] * b[1];
+  n[1] = a[2] * b[0] - a[0] * b[2];
+  n[2] = a[0] * b[1] - a[1] * b[0];
+  triangle.integrationElement =
+      std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  for (int d = 0; d < coordCount; ++d)
+    n[d] /= triangle.integrationElement;
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+void FlatTriangleTestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                           ResultType, KernelFunctor>::
+    integrate(CallVariant callVariant, const std::vector<int> &elementIndicesA,
+              int elementIndexB, const Shapeset<BasisFunctionType> &basisA,
+              const Shapeset<BasisFunctionType> &basisB,
+              LocalDofIndex localDofIndexB,
+              const std::vector<arma::Mat<ResultType> *> &result) const {
+  if (result.size() != elementIndicesA.size())
+    throw std::invalid_argument(
+        "FlatTriangleTestKernelTrialIntegrator::integrate(): "
+        "arrays 'result' and 'elementIndicesA' must have the same number "
+        "of elements");
+  if (elementIndicesA.empty())
+    return;
+
+  std::vector<ElementIndexPair> elementIndexPairs(elementIndicesA.size());
+  for (size_t i = 0; i < elementIndicesA.size(); ++i)
+    elementIndexPairs[i] =
+        callVariant == TEST_TRIAL
+            ? ElementIndexPair(elementIndicesA[i], elementIndexB)
+            : ElementIndexPair(elementIndexB, elementIndicesA[i]);
+
+  if (callVariant == TEST_TRIAL)
+    dispatch(&elementIndexPairs[0], elementIndexPairs.size(),
+             m_testBasisData.get(basisA),
+             m_trialBasisData.get(basisB, localDofIndexB), &result[0]);
+  else
+    dispatch(&elementIndexPairs[0], elementIndexPairs.size(),
+             m_testBasisData.get(basisB, localDofIndexB),
+             m_trialBasisData.get(basisA), &result[0]);
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+void FlatTriangleTestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                           ResultType, KernelFunctor>::
+    integrate(const std::vector<ElementIndexPair> &elementIndexPairs,
+              const Shapeset<BasisFunctionType> &testShapeset,
+              const Shapeset<BasisFunctionType> &trialShapeset,
+              const std::vector<arma::Mat<ResultType> *> &result) const {
+  if (result.size() != elementIndexPairs.size())
+    throw std::invalid_argument(
+        "FlatTriangleTestKernelTrialIntegrator::integrate(): "
+        "arrays 'result' and 'elementIndexPairs' must have the same number "
+        "of elements");
+  if (elementIndexPairs.empty())
+    return;
+
+  dispatch(&elementIndexPairs[0], elementIndexPairs.size(),
+           m_testBasisData.get(testShapeset),
+           m_trialBasisData.get(trialShapeset), &result[0]);
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+void FlatTriangleTestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                           ResultType, KernelFunctor>::
+    dispatch(const ElementIndexPair *elementIndexPairs, size_t pairCount,
+             const BasisData<BasisFunctionType> &testBasisData,
+             const BasisData<BasisFunctionType> &trialBasisData,
+             arma::Mat<ResultType> *const *result) const {
+  const size_t testDofCount = testBasisData.values.extent(1);
+  const size_t trialDofCount = trialBasisData.values.extent(1);
+  if (testDofCount == 1 && trialDofCount == 1)
+    integratePairs<1, 1>(elementIndexPairs, pairCount, testBasisData,
+                         trialBasisData, result);
+  else if (testDofCount == 1 && trialDofCount == 3)
+    integratePairs<1, 3>(elementIndexPairs, pairCount, testBasisData,
+                         trialBasisData, result);
+  else if (testDofCount == 3 && trialDofCount == 1)
+    integratePairs<3, 1>(elementIndexPairs, pairCount, testBasisData,
+                         trialBasisData, result);
+  else if (testDofCount == 3 && trialDofCount == 3)
+    integratePairs<3, 3>(elementIndexPairs, pairCount, testBasisData,
+                         trialBasisData, result);
+  else
+    throw std::logic_error(
+        "FlatTriangleTestKernelTrialIntegrator::integrate(): "
+        "only shapesets consisting of one or three functions are supported");
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+template <int TestDofCount, int TrialDofCount>
+void FlatTriangleTestKernelTrialIntegrator<BasisFunctionType, KernelType,
+                                           ResultType, KernelFunctor>::
+    integratePairs(const ElementIndexPair *elementIndexPairs, size_t pairCount,
+                   const BasisData<BasisFunctionType> &testBasisData,
+                   const BasisData<BasisFunctionType> &trialBasisData,
+                   arma::Mat<ResultType> *const *result) const {
+  const int coordCount = 3;
+  const int testPointCount = m_testPointCount;
+  const int trialPointCount = m_trialPointCount;
+
+  // Shape function values multiplied by quadrature weights; the test values
+  // are conjugated
+  BasisFunctionType testValues[TestDofCount][MAX_POINT_COUNT];
+  BasisFunctionType trialValues[TrialDofCount][MAX_POINT_COUNT];
+  for (int dof = 0; dof < TestDofCount; ++dof)
+    for (int point = 0; point < testPointCount; ++point)
+      testValues[dof][point] =
+          conjugate(testBasisData.values(0, dof, point)) *
+          m_testQuadWeights[point];
+  for (int dof = 0; dof < TrialDofCount; ++dof)
+    for (int point = 0; point < trialPointCount; ++point)
+      trialValues[dof][point] =
+          trialBasisData.values(0, dof, point) * m_trialQuadWeights[point];
+
+  Triangle testTriangle, trialTriangle;
+  CoordinateType testGlobals[MAX_POINT_COUNT][coordCount];
+  CoordinateType trialGlobals[MAX_POINT_COUNT][coordCount];
+  KernelType kernelValues[MAX_POINT_COUNT];
+  int currentTestElement = -1, currentTrialElement = -1;
+
+  for (size_t pair = 0; pair < pairCount; ++pair) {
+    const int testElement = elementIndexPairs[pair].first;
+    const int trialElement = elementIndexPairs[pair].second;
+
+    // In calls made for a single row or column of the matrix one of the
+    // elements stays the same
+    if (testElement != currentTestElement) {
+      setUpTriangle(m_testRawGeometry, testElement, testTriangle);
+      for (int point = 0; point < testPointCount; ++point)
+        for (int d = 0; d < coordCount; ++d)
+          testGlobals[point][d] =
+              testTriangle.origin[d] +
+              m_localTestQuadPoints[0][point] * testTriangle.edge1[d] +
+              m_localTestQuadPoints[1][point] * testTriangle.edge2[d];
+      currentTestElement = testElement;
+    }
+    if (trialElement != currentTrialElement) {
+      setUpTriangle(m_trialRawGeometry, trialElement, trialTriangle);
+      for (int point = 0; point < trialPointCount; ++point)
+        for (int d = 0; d < coordCount; ++d)
+          trialGlobals[point][d] =
+              trialTriangle.origin[d] +
+              m_localTrialQuadPoints[0][point] * trialTriangle.edge1[d] +
+              m_localTrialQuadPoints[1][point] * trialTriangle.edge2[d];
+      currentTrialElement = trialElement;
+    }
+
+    ResultType sums[TestDofCount][TrialDofCount];
+    for (int testDof = 0; testDof < TestDofCount; ++testDof)
+      for (int trialDof = 0; trialDof < TrialDofCount; ++trialDof)
+        sums[testDof][trialDof] = 0.;
+
+    for (int trialPoint = 0; trialPoint < trialPointCount; ++trialPoint) {
+      for (int testPoint = 0; testPoint < testPointCount; ++testPoint)
+        kernelValues[testPoint] = m_kernelFunctor.evaluateAtPointPair(
+            testGlobals[testPoint], trialGlobals[trialPoint],
+            trialTriangle.normal);
+      for (int testDof = 0; testDof < TestDofCount; ++testDof) {
+        ResultType partialSum = 0.;
+        for (int testPoint = 0; testPoint < testPointCount; ++testPoint)
+          partialSum += testValues[testDof][testPoint] * kernelValues[testPoint];
+        for (int trialDof = 0; trialDof < TrialDofCount; ++trialDof)
+          sums[testDof][trialDof] +=
+              partialSum * trialValues[trialDof][trialPoint];
+      }
+    }
+
+    const CoordinateType integrationElements =
+        testTriangle.integrationElement * trialTriangle.integrationElement;
+    assert(result[pair]);
+    arma::Mat<ResultType> &localResult = *result[pair];
+    localResult.set_size(TestDofCount, TrialDofCount);
+    for (int trialDof = 0; trialDof < TrialDofCount; ++trialDof)
+      for (int testDof = 0; testDof < TestDofCount; ++testDof)
+        localResult(testDof, trialDof) =
+            sums[testDof][trialDof] * integrationElements;
+  }
+}
+
+namespace {
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename KernelFunctor>
+TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType> *
+makeFlatTriangleIntegratorForFunctor(
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTestQuadPoints,
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTrialQuadPoints,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        testQuadWeights,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        trialQuadWeights,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        testRawGeometry,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        trialRawGeometry,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &testTransformations,
+    const CollectionOfKernels<KernelType> &kernels,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &trialTransformations) {
+  typedef DefaultCollectionOfKernels<KernelFunctor> Kernels;
+  if (typeid(kernels) != typeid(Kernels))
+    return 0;
+  return new FlatTriangleTestKernelTrialIntegrator<
+      BasisFunctionType, KernelType, ResultType, KernelFunctor>(
+      localTestQuadPoints, localTrialQuadPoints, testQuadWeights,
+      trialQuadWeights, testRawGeometry, trialRawGeometry, testTransformations,
+      static_cast<const Kernels &>(kernels).functor(), trialTransformations);
+}
+
+template <typename BasisFunctionType>
+bool allShapesetsHaveOneOrThreeFunctions(
+    const std::vector<const Shapeset<BasisFunctionType> *> &shapesets) {
+  for (size_t i = 0; i < shapesets.size(); ++i)
+    if (shapesets[i]->size() != 1 && shapesets[i]->size() != 3)
+      return false;
+  return true;
+}
+
+} // namespace
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType>
+TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType> *
+makeFlatTriangleTestKernelTrialIntegrator(
+    const DoubleQuadratureDescriptor &desc,
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTestQuadPoints,
+    const arma::Mat<typename ScalarTraits<ResultType>::RealType> &
+        localTrialQuadPoints,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        testQuadWeights,
+    const std::vector<typename ScalarTraits<ResultType>::RealType> &
+        trialQuadWeights,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        testRawGeometry,
+    const RawGridGeometry<typename ScalarTraits<ResultType>::RealType> &
+        trialRawGeometry,
+    const std::vector<const Shapeset<BasisFunctionType> *> &testShapesets,
+    const std::vector<const Shapeset<BasisFunctionType> *> &trialShapesets,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &testTransformations,
+    const CollectionOfKernels<KernelType> &kernels,
+    const CollectionOfShapesetTransformations<
+        typename ScalarTraits<ResultType>::RealType> &trialTransformations,
+    const TestKernelTrialIntegral<BasisFunctionType, KernelType, ResultType> &
+        integral,
+    const OpenClHandler &openClHandler) {
+  typedef typename ScalarTraits<ResultType>::RealType CoordinateType;
+  typedef FlatTriangleTestKernelTrialIntegrator<
+      BasisFunctionType, KernelType, ResultType,
+      Laplace3dSingleLayerPotentialKernelFunctor<KernelType>> AnyIntegrator;
+
+  if (openClHandler.UseOpenCl())
+    return 0;
+  if (desc.topology.type != ElementPairTopology::Disjoint ||
+      desc.topology.testVertexCount != 3 ||
+      desc.topology.trialVertexCount != 3)
+    return 0;
+  if (localTestQuadPoints.n_cols > AnyIntegrator::MAX_POINT_COUNT ||
+      localTrialQuadPoints.n_cols > AnyIntegrator::MAX_POINT_COUNT)
+    return 0;
+  if (testRawGeometry.worldDimension() != 3 ||
+      trialRawGeometry.worldDimension() != 3)
+    return 0;
+
+  typedef DefaultCollectionOfShapesetTransformations<
+      ScalarFunctionValueFunctor<CoordinateType>> ValueTransformations;
+  if (typeid(testTransformations) != typeid(ValueTransformations) ||
+      typeid(trialTransformations) != typeid(ValueTransformations))
+    return 0;
+
+  typedef TypicalTestScalarKernelTrialIntegral<BasisFunctionType, KernelType,
+                                               ResultType> TypicalIntegral;
+  typedef DefaultTestKernelTrialIntegral<
+      SimpleTestScalarKernelTrialIntegrandFunctor<BasisFunctionType,
+                                                  KernelType, ResultType>>
+  SimpleIntegral;
+  typedef DefaultTestKernelTrialIntegral<
+      SimpleTestScalarKernelTrialIntegrandFunctorExt<
+          BasisFunctionType, KernelType, ResultType, 1>> SimpleIntegralExt;
+  if (typeid(integral) != typeid(TypicalIntegral) &&
+      typeid(integral) != typeid(SimpleIntegral) &&
+      typeid(integral) != typeid(SimpleIntegralExt))
+    return 0;
+
+  if (!allShapesetsHaveOneOrThreeFunctions(testShapesets) ||
+      !allShapesetsHaveOneOrThreeFunctions(trialShapesets))
+    return 0;
+
+  TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType>
+      *integrator = 0;
+#define FIBER_TRY_FLAT_TRIANGLE_FUNCTOR(FUNCTOR)                               \
+  if (!integrator)                                                             \
+    integrator = makeFlatTriangleIntegratorForFunctor<                         \
+        BasisFunctionType, KernelType, ResultType, FUNCTOR<KernelType>>(       \
+        localTestQuadPoints, localTrialQuadPoints, testQuadWeights,            \
+        trialQuadWeights, testRawGeometry, trialRawGeometry,                   \
+        testTransformations, kernels, trialTransformations)
+  FIBER_TRY_FLAT_TRIANGLE_FUNCTOR(Laplace3dSingleLayerPotentialKernelFunctor);
+  FIBER_TRY_FLAT_TRIANGLE_FUNCTOR(Laplace3dDoubleLayerPotentialKernelFunctor);
+  FIBER_TRY_FLAT_TRIANGLE_FUNCTOR(
+      ModifiedHelmholtz3dSingleLayerPotentialKernelFunctor);
+  FIBER_TRY_FLAT_TRIANGLE_FUNCTOR(
+      ModifiedHelmholtz3dDoubleLayerPotentialKernelFunctor);
+#undef FIBER_TRY_FLAT_TRIANGLE_FUNCTOR
+  return integrator;
+}
+
+} // namespace Fiber
+
+#endif
@@ -27,6 +27,9 @@
 
 #include "../common/armadillo_fwd.hpp"
 
+#include <stdexcept>
+#include <vector>
+
 namespace Fiber {
 
 /** \cond FORWARD_DECL */
@@ -86,6 +89,35 @@ public:
    */
   virtual void evaluate(const GeometricalData<CoordinateType> &geomData,
                         arma::Mat<ValueType> &result) const = 0;
+
+  /** \brief Return true if the function should preferably be evaluated on
+   *  the points of many elements at once by evaluateBatch().
+   *
+   *  The default implementation returns false. */
+  virtual bool supportsBatchEvaluation() const { return false; }
+
+  /** \brief Evaluate the function at points lying on several elements.
+   *
+   *  \param[in] geomData
+   *    Geometrical data related to \f$n \geq 0\f$ points, possibly lying on
+   *    different elements. Only the \c globals, \c normals and
+   *    \c integrationElements members are filled; \c domainIndex is unused.
+   *  \param[in] domainIndices
+   *    Vector of length \f$n\f$ whose <em>j</em>th element is the index of
+   *    the domain containing the <em>j</em>th point.
+   *  \param[out] result
+   *    A 2-dimensional array intended to store the function values, in the
+   *    same format as in evaluate().
+   *
+   *  This method is only called if supportsBatchEvaluation() returns true.
+   *  The default implementation throws an exception. */
+  virtual void evaluateBatch(const GeometricalData<CoordinateType> &geomData,
+                             const std::vector<int> &domainIndices,
+                             arma::Mat<ValueType> &result) const {
+    throw std::runtime_error("Function::evaluateBatch(): "
+                             "batch evaluation is not supported by this "
+                             "function");
+  }
 };
 
 } // namespace Fiber
@@ -63,16 +63,31 @@ public:
     assert(testGeomData.dimWorld() == coordCount);
     assert(result.size() == 1);
 
+    CoordinateType testGlobal[coordCount], trialGlobal[coordCount],
+        trialNormal[coordCount];
+    for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
+      testGlobal[coordIndex] = testGeomData.global(coordIndex);
+      trialGlobal[coordIndex] = trialGeomData.global(coordIndex);
+      trialNormal[coordIndex] = trialGeomData.normal(coordIndex);
+    }
+    result[0](0, 0) = evaluateAtPointPair(testGlobal, trialGlobal, trialNormal);
+  }
+
+  // Value of the kernel at a pair of points given by their global
+  // coordinates, with trialNormal the unit normal at the trial point.
+  ValueType evaluateAtPointPair(const CoordinateType *testGlobal,
+                                const CoordinateType *trialGlobal,
+                                const CoordinateType *trialNormal) const {
+    const int coordCount = 3;
     CoordinateType numeratorSum = 0., distanceSq = 0.;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
-      CoordinateType diff =
-          trialGeomData.global(coordIndex) - testGeomData.global(coordIndex);
+      CoordinateType diff = trialGlobal[coordIndex] - testGlobal[coordIndex];
       distanceSq += diff * diff;
-      numeratorSum += diff * trialGeomData.normal(coordIndex);
+      numeratorSum += diff * trialNormal[coordIndex];
     }
     CoordinateType distance = sqrt(distanceSq);
-    result[0](0, 0) = -numeratorSum / (static_cast<CoordinateType>(4. * M_PI) *
-                                       distance * distanceSq);
+    return -numeratorSum /
+           (static_cast<CoordinateType>(4. * M_PI) * distance * distanceSq);
   }
 };
 
@@ -63,13 +63,27 @@ public:
     assert(testGeomData.dimWorld() == coordCount);
     assert(result.size() == 1);
 
+    CoordinateType testGlobal[coordCount], trialGlobal[coordCount];
+    for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
+      testGlobal[coordIndex] = testGeomData.global(coordIndex);
+      trialGlobal[coordIndex] = trialGeomData.global(coordIndex);
+    }
+    result[0](0, 0) = evaluateAtPointPair(testGlobal, trialGlobal, 0);
+  }
+
+  // Value of the kernel at a pair of points given by their global
+  // coordinates. The trial normal is not used.
+  ValueType evaluateAtPointPair(const CoordinateType *testGlobal,
+                                const CoordinateType *trialGlobal,
+                                const CoordinateType * /* trialNormal */)
+      const {
+    const int coordCount = 3;
     ValueType sum = 0;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
-      ValueType diff =
-          testGeomData.global(coordIndex) - trialGeomData.global(coordIndex);
+      ValueType diff = testGlobal[coordIndex] - trialGlobal[coordIndex];
       sum += diff * diff;
     }
-    result[0](0, 0) = static_cast<CoordinateType>(1. / (4. * M_PI)) / sqrt(sum);
+    return static_cast<CoordinateType>(1. / (4. * M_PI)) / sqrt(sum);
   }
 };
 
@@ -111,6 +111,13 @@ public:
    *  with 0. */
   virtual CoordinateType
   estimateRelativeScale(CoordinateType minDist) const = 0;
+
+  /** \brief Add statistics about the local assembly performed so far to the
+   *  current AssemblyProfile, if there is one.
+   *
+   *  Called when the assembly of the weak form finishes. The default
+   *  implementation does nothing. */
+  virtual void reportStatistics() const {}
 };
 
 } // namespace Fiber
@@ -56,7 +56,10 @@ public:
     \param[out] result         Vector of weak forms of the operator on
                                element pairs
                                (\p element(\p i), \p element(\p i))
-                               for \p i in \p elementIndices. */
+                               for \p i in \p elementIndices.
+
+    Implementations must allow this function to be called concurrently
+    from several threads. */
   virtual void
   evaluateLocalWeakForms(const std::vector<int> &elementIndices,
                          std::vector<arma::Mat<ResultType>> &result) = 0;
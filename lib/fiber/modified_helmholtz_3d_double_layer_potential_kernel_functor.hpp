@@ -71,19 +71,33 @@ public:
                 CollectionOf2dSlicesOfNdArrays<ValueType> &result) const {
     const int coordCount = 3;
 
+    CoordinateType testGlobal[coordCount], trialGlobal[coordCount],
+        trialNormal[coordCount];
+    for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
+      testGlobal[coordIndex] = testGeomData.global(coordIndex);
+      trialGlobal[coordIndex] = trialGeomData.global(coordIndex);
+      trialNormal[coordIndex] = trialGeomData.normal(coordIndex);
+    }
+    result[0](0, 0) = evaluateAtPointPair(testGlobal, trialGlobal, trialNormal);
+  }
+
+  // Value of the kernel at a pair of points given by their global
+  // coordinates, with trialNormal the unit normal at the trial point.
+  ValueType evaluateAtPointPair(const CoordinateType *testGlobal,
+                                const CoordinateType *trialGlobal,
+                                const CoordinateType *trialNormal) const {
+    const int coordCount = 3;
     CoordinateType numeratorSum = 0., denominatorSum = 0.;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
-      CoordinateType diff =
-          trialGeomData.global(coordIndex) - testGeomData.global(coordIndex);
+      CoordinateType diff = trialGlobal[coordIndex] - testGlobal[coordIndex];
       denominatorSum += diff * diff;
-      numeratorSum += diff * trialGeomData.normal(coordIndex);
+      numeratorSum += diff * trialNormal[coordIndex];
     }
     CoordinateType distance = sqrt(denominatorSum);
-    result[0](0, 0) =
-        -numeratorSum /
-        (static_cast<CoordinateType>(4.0 * M_PI) * denominatorSum) *
-        (m_waveNumber + static_cast<CoordinateType>(1.0) / distance) *
-        exp(-m_waveNumber * distance);
+    return -numeratorSum /
+           (static_cast<CoordinateType>(4.0 * M_PI) * denominatorSum) *
+           (m_waveNumber + static_cast<CoordinateType>(1.0) / distance) *
+           exp(-m_waveNumber * distance);
   }
 
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
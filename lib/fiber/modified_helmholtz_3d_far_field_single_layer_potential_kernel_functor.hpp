@@ -72,8 +72,19 @@ public:
     CoordinateType x_y = 0;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex)
       x_y += testGeomData.global(coordIndex) * trialGeomData.global(coordIndex);
-    result[0](0, 0) =
-        static_cast<ValueType>(1.0 / (4.0 * M_PI)) * exp(m_waveNumber * x_y);
+    evaluateWithPhaseFactor(testGeomData, trialGeomData,
+                            exp(m_waveNumber * x_y), result);
+  }
+
+  /** \brief Evaluate the kernel given the value of
+   *  <tt>exp(waveNumber() * x.y)</tt>; used by FarFieldCollectionOfKernels. */
+  template <template <typename T> class CollectionOf2dSlicesOfNdArrays>
+  void evaluateWithPhaseFactor(
+      const ConstGeometricalDataSlice<CoordinateType> & /* testGeomData */,
+      const ConstGeometricalDataSlice<CoordinateType> & /* trialGeomData */,
+      ValueType phaseFactor,
+      CollectionOf2dSlicesOfNdArrays<ValueType> &result) const {
+    result[0](0, 0) = static_cast<ValueType>(1.0 / (4.0 * M_PI)) * phaseFactor;
   }
 
 private:
@@ -71,15 +71,29 @@ public:
                 CollectionOf2dSlicesOfNdArrays<ValueType> &result) const {
     const int coordCount = 3;
 
+    CoordinateType testGlobal[coordCount], trialGlobal[coordCount];
+    for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
+      testGlobal[coordIndex] = testGeomData.global(coordIndex);
+      trialGlobal[coordIndex] = trialGeomData.global(coordIndex);
+    }
+    result[0](0, 0) = evaluateAtPointPair(testGlobal, trialGlobal, 0);
+  }
+
+  // Value of the kernel at a pair of points given by their global
+  // coordinates. The trial normal is not used.
+  ValueType evaluateAtPointPair(const CoordinateType *testGlobal,
+                                const CoordinateType *trialGlobal,
+                                const CoordinateType * /* trialNormal */)
+      const {
+    const int coordCount = 3;
     CoordinateType sum = 0;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex) {
-      CoordinateType diff =
-          testGeomData.global(coordIndex) - trialGeomData.global(coordIndex);
+      CoordinateType diff = testGlobal[coordIndex] - trialGlobal[coordIndex];
       sum += diff * diff;
     }
     CoordinateType distance = sqrt(sum);
-    result[0](0, 0) = static_cast<CoordinateType>(1.0 / (4.0 * M_PI)) /
-                      distance * exp(-m_waveNumber * distance);
+    return static_cast<CoordinateType>(1.0 / (4.0 * M_PI)) / distance *
+           exp(-m_waveNumber * distance);
   }
 
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
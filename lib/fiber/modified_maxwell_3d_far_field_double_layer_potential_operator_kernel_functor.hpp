@@ -71,8 +71,22 @@ public:
     CoordinateType x_y = 0.;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex)
       x_y += testGeomData.global(coordIndex) * trialGeomData.global(coordIndex);
+    evaluateWithPhaseFactor(testGeomData, trialGeomData,
+                            exp(m_waveNumber * x_y), result);
+  }
+
+  /** \brief Evaluate the kernel given the value of
+   *  <tt>exp(waveNumber() * x.y)</tt>; used by FarFieldCollectionOfKernels. */
+  template <template <typename T> class CollectionOf2dSlicesOfNdArrays>
+  void evaluateWithPhaseFactor(
+      const ConstGeometricalDataSlice<CoordinateType> &testGeomData,
+      const ConstGeometricalDataSlice<CoordinateType> & /* trialGeomData */,
+      ValueType phaseFactor,
+      CollectionOf2dSlicesOfNdArrays<ValueType> &result) const {
+    const int coordCount = 3;
+
     const ValueType commonFactor = static_cast<ValueType>(-1.0 / (4.0 * M_PI)) *
-                                   m_waveNumber * exp(m_waveNumber * x_y);
+                                   m_waveNumber * phaseFactor;
     for (int coordIndex = 0; coordIndex < coordCount; ++coordIndex)
       result[0](coordIndex, 0) = testGeomData.global(coordIndex) * commonFactor;
   }
@@ -23,9 +23,9 @@
 
 #include "../common/common.hpp"
 
+#include "basis_data_cache.hpp"
 #include "test_kernel_trial_integrator.hpp"
 
-#include <tbb/concurrent_unordered_map.h>
 #include <tbb/enumerable_thread_specific.h>
 
 namespace Fiber {
@@ -110,11 +110,8 @@ private:
   const TestKernelTrialIntegral<BasisFunctionType, KernelType, ResultType> &
   m_integral;
 
-  typedef tbb::concurrent_unordered_map<const Shapeset<BasisFunctionType> *,
-                                        BasisData<BasisFunctionType> *>
-  BasisDataCache;
-  mutable BasisDataCache m_cachedTestBasisData;
-  mutable BasisDataCache m_cachedTrialBasisData;
+  BasisDataCache<BasisFunctionType> m_testBasisData;
+  BasisDataCache<BasisFunctionType> m_trialBasisData;
 
   const OpenClHandler &m_openClHandler;
   // thread-local static data for integrate() -- allocation and deallocation of
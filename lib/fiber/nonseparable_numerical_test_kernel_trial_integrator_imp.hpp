@@ -71,6 +71,8 @@ NonseparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
       m_testRawGeometry(testRawGeometry), m_trialRawGeometry(trialRawGeometry),
       m_testTransformations(testTransformations), m_kernels(kernels),
       m_trialTransformations(trialTransformations), m_integral(integral),
+      m_testBasisData(localTestQuadPoints, testTransformations),
+      m_trialBasisData(localTrialQuadPoints, trialTransformations),
       m_openClHandler(openClHandler) {
   const size_t pointCount = quadWeights.size();
   if (localTestQuadPoints.n_cols != pointCount ||
@@ -85,21 +87,7 @@ template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
 NonseparableNumericalTestKernelTrialIntegrator<
     BasisFunctionType, KernelType, ResultType,
-    GeometryFactory>::~NonseparableNumericalTestKernelTrialIntegrator() {
-  // Note: obviously the destructor is assumed to be called only after
-  // all threads have ceased using the integrator!
-
-  for (typename BasisDataCache::const_iterator it =
-           m_cachedTestBasisData.begin();
-       it != m_cachedTestBasisData.end(); ++it)
-    delete it->second;
-  m_cachedTestBasisData.clear();
-  for (typename BasisDataCache::const_iterator it =
-           m_cachedTrialBasisData.begin();
-       it != m_cachedTrialBasisData.end(); ++it)
-    delete it->second;
-  m_cachedTrialBasisData.clear();
-}
+    GeometryFactory>::~NonseparableNumericalTestKernelTrialIntegrator() {}
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
@@ -109,40 +97,8 @@ NonseparableNumericalTestKernelTrialIntegrator<
     GeometryFactory>::basisData(ElementType type,
                                 const Shapeset<BasisFunctionType> &shapeset)
     const {
-  BasisDataCache &cache =
-      type == TEST ? m_cachedTestBasisData : m_cachedTrialBasisData;
-  const CollectionOfShapesetTransformations<CoordinateType> &transformations =
-      type == TEST ? m_testTransformations : m_trialTransformations;
-  const arma::Mat<CoordinateType> &localQuadPoints =
-      type == TEST ? m_localTestQuadPoints : m_localTrialQuadPoints;
-
-  typename BasisDataCache::iterator it = cache.find(&shapeset);
-  if (it == cache.end()) {
-    // FIXME: At the beginning of each loop, all threads want to calculate
-    // these basis data. It would be good to do singular integral
-    // calculation in such a way that all types would be merged in a single
-    // parallel loop; this should solve this problem.
-
-    // Need to calculate basis data from scratch
-    std::unique_ptr<BasisData<BasisFunctionType>> basisData(
-        new BasisData<BasisFunctionType>);
-    size_t basisDeps = 0, geomDeps = 0;
-    transformations.addDependencies(basisDeps, geomDeps);
-    shapeset.evaluate(basisDeps, localQuadPoints, ALL_DOFS, *basisData);
-    // Release the newly created basis data object from the auto pointer and
-    // // try to insert it into the map. If the insertion succeeds, the map
-    // // takes ownership of the object, which will be deleted in the
-    // // destructor of the integrator. If the insertion fails, it means
-    // // another thread has already inserted the basis data for this shapeset,
-    // // so our basis data object is now redundant and should be released.
-    BasisData<BasisFunctionType> *ptrBasisData = basisData.release();
-    std::pair<typename BasisDataCache::iterator, bool> result =
-        cache.insert(std::make_pair(&shapeset, ptrBasisData));
-    it = result.first;  // this is the object that ended up into the cache
-    if (!result.second) // insertion failed
-      delete ptrBasisData;
-  }
-  return *it->second;
+  return type == TEST ? m_testBasisData.get(shapeset)
+                      : m_trialBasisData.get(shapeset);
 }
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
@@ -174,7 +130,7 @@ void NonseparableNumericalTestKernelTrialIntegrator<
   const int testDofCount = callVariant == TEST_TRIAL ? dofCountA : dofCountB;
   const int trialDofCount = callVariant == TEST_TRIAL ? dofCountB : dofCountA;
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
+  const BasisData<BasisFunctionType> *testBasisData = 0, *trialBasisData = 0;
   GeometricalData<CoordinateType> &testGeomData = m_testGeomData.local();
   GeometricalData<CoordinateType> &trialGeomData = m_trialGeomData.local();
 
@@ -212,23 +168,20 @@ void NonseparableNumericalTestKernelTrialIntegrator<
 
   rawGeometryB->setupGeometry(elementIndexB, *geometryB);
   if (callVariant == TEST_TRIAL) {
-    basisA.evaluate(testBasisDeps, m_localTestQuadPoints, ALL_DOFS,
-                    testBasisData);
-    basisB.evaluate(trialBasisDeps, m_localTrialQuadPoints, localDofIndexB,
-                    trialBasisData);
+    testBasisData = &m_testBasisData.get(basisA);
+    trialBasisData = &m_trialBasisData.get(basisB, localDofIndexB);
     geometryB->getData(trialGeomDeps, m_localTrialQuadPoints, trialGeomData);
     if (trialGeomDeps & DOMAIN_INDEX)
       trialGeomData.domainIndex = rawGeometryB->domainIndex(elementIndexB);
-    m_trialTransformations.evaluate(trialBasisData, trialGeomData, trialValues);
+    m_trialTransformations.evaluate(*trialBasisData, trialGeomData,
+                                    trialValues);
   } else {
-    basisA.evaluate(trialBasisDeps, m_localTrialQuadPoints, ALL_DOFS,
-                    trialBasisData);
-    basisB.evaluate(testBasisDeps, m_localTestQuadPoints, localDofIndexB,
-                    testBasisData);
+    trialBasisData = &m_trialBasisData.get(basisA);
+    testBasisData = &m_testBasisData.get(basisB, localDofIndexB);
     geometryB->getData(testGeomDeps, m_localTestQuadPoints, testGeomData);
     if (testGeomDeps & DOMAIN_INDEX)
       testGeomData.domainIndex = rawGeometryB->domainIndex(elementIndexB);
-    m_testTransformations.evaluate(testBasisData, testGeomData, testValues);
+    m_testTransformations.evaluate(*testBasisData, testGeomData, testValues);
   }
 
   // Iterate over the elements
@@ -239,12 +192,12 @@ void NonseparableNumericalTestKernelTrialIntegrator<
       geometryA->getData(testGeomDeps, m_localTestQuadPoints, testGeomData);
       if (testGeomDeps & DOMAIN_INDEX)
         testGeomData.domainIndex = rawGeometryA->domainIndex(elementIndexA);
-      m_testTransformations.evaluate(testBasisData, testGeomData, testValues);
+      m_testTransformations.evaluate(*testBasisData, testGeomData, testValues);
     } else {
       geometryA->getData(trialGeomDeps, m_localTrialQuadPoints, trialGeomData);
       if (trialGeomDeps & DOMAIN_INDEX)
         trialGeomData.domainIndex = rawGeometryA->domainIndex(elementIndexA);
-      m_trialTransformations.evaluate(trialBasisData, trialGeomData,
+      m_trialTransformations.evaluate(*trialBasisData, trialGeomData,
                                       trialValues);
     }
 
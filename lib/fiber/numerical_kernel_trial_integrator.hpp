@@ -23,6 +23,7 @@
 
 #include "../common/common.hpp"
 
+#include "basis_data_cache.hpp"
 #include "kernel_trial_integrator.hpp"
 
 namespace Fiber {
@@ -89,6 +90,7 @@ private:
   m_trialTransformations;
   const KernelTrialIntegral<BasisFunctionType, KernelType, ResultType> &
   m_integral;
+  BasisDataCache<BasisFunctionType> m_trialBasisData;
   /** \endcond */
 };
 
@@ -58,7 +58,8 @@ NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
     : m_localQuadPoints(localQuadPoints), m_quadWeights(quadWeights),
       m_points(points), m_geometryFactory(geometryFactory),
       m_rawGeometry(rawGeometry), m_kernels(kernels),
-      m_trialTransformations(trialTransformations), m_integral(integral) {
+      m_trialTransformations(trialTransformations), m_integral(integral),
+      m_trialBasisData(localQuadPoints, trialTransformations) {
   if (localQuadPoints.n_cols != quadWeights.size())
     throw std::invalid_argument("NumericalKernelTrialIntegrator::"
                                 "NumericalKernelTrialIntegrator(): "
@@ -90,7 +91,6 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
   // TODO: in the (pathological) case that quadPointCount == 0 but
   // geometryCount != 0, set elements of result to 0.
 
-  BasisData<BasisFunctionType> trialBasisData;
   GeometricalData<CoordinateType> pointGeomData, trialGeomData;
 
   size_t trialBasisDeps = 0;
@@ -112,8 +112,8 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
   }
 
   m_rawGeometry.setupGeometry(trialElementIndex, *trialGeometry);
-  trialShapeset.evaluate(trialBasisDeps, m_localQuadPoints, localTrialDofIndex,
-                         trialBasisData);
+  const BasisData<BasisFunctionType> &trialBasisData =
+      m_trialBasisData.get(trialShapeset, localTrialDofIndex);
   trialGeometry->getData(trialGeomDeps, m_localQuadPoints, trialGeomData);
   if (trialGeomDeps & DOMAIN_INDEX)
     trialGeomData.domainIndex = m_rawGeometry.domainIndex(trialElementIndex);
@@ -154,7 +154,6 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
   // TODO: in the (pathological) case that quadPointCount == 0 but
   // geometryCount != 0, set elements of result to 0.
 
-  BasisData<BasisFunctionType> trialBasisData;
   GeometricalData<CoordinateType> pointGeomData, trialGeomData;
 
   size_t trialBasisDeps = 0;
@@ -178,12 +177,13 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
 
   pointGeomData.globals = m_points.col(pointIndex);
 
+  const BasisData<BasisFunctionType> &trialBasisData =
+      m_trialBasisData.get(trialShapeset);
+
   // Iterate over the trial elements
   for (int i = 0; i < trialElementCount; ++i) {
     const int trialElementIndex = trialElementIndices[i];
     m_rawGeometry.setupGeometry(trialElementIndex, *trialGeometry);
-    trialShapeset.evaluate(trialBasisDeps, m_localQuadPoints, ALL_DOFS,
-                           trialBasisData);
     trialGeometry->getData(trialGeomDeps, m_localQuadPoints, trialGeomData);
     if (trialGeomDeps & DOMAIN_INDEX)
       trialGeomData.domainIndex = m_rawGeometry.domainIndex(trialElementIndex);
@@ -226,7 +226,6 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
   // TODO: in the (pathological) case that quadPointCount == 0 but
   // geometryCount != 0, set elements of result to 0.
 
-  BasisData<BasisFunctionType> trialBasisData;
   GeometricalData<CoordinateType> pointGeomData, trialGeomData;
 
   size_t trialBasisDeps = 0;
@@ -247,6 +246,9 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
     result[i]->set_size(componentCount, trialDofCount);
   }
 
+  const BasisData<BasisFunctionType> &trialBasisData =
+      m_trialBasisData.get(trialShapeset);
+
   // Iterate over the (point, trial element) pairs
   for (int i = 0; i < pairCount; ++i) {
     const int activePointIndex = pointElementIndexPairs[i].first;
@@ -254,8 +256,6 @@ void NumericalKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType,
 
     pointGeomData.globals = m_points.col(activePointIndex);
     m_rawGeometry.setupGeometry(activeTrialElementIndex, *trialGeometry);
-    trialShapeset.evaluate(trialBasisDeps, m_localQuadPoints, ALL_DOFS,
-                           trialBasisData);
     trialGeometry->getData(trialGeomDeps, m_localQuadPoints, trialGeomData);
     if (trialGeomDeps & DOMAIN_INDEX)
       trialGeomData.domainIndex =
@@ -23,12 +23,14 @@
 
 #include "numerical_quadrature_strategy.hpp"
 
+#include "collection_of_kernels.hpp"
 #include "default_local_assembler_for_grid_functions_on_surfaces.hpp"
 #include "default_local_assembler_for_integral_operators_on_surfaces.hpp"
 #include "default_local_assembler_for_local_operators_on_surfaces.hpp"
 #include "default_local_assembler_for_potential_operators_on_surfaces.hpp"
 #include "default_evaluator_for_integral_operators.hpp"
 #include "default_quadrature_descriptor_selector_factory.hpp"
+#include "quadrature_descriptor_selector_for_integral_operators.hpp"
 
 #include "default_double_quadrature_rule_family.hpp"
 #include "default_single_quadrature_rule_family.hpp"
@@ -38,10 +40,34 @@
 
 #include "../common/boost_make_shared_fwd.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
 namespace Fiber {
 
+namespace {
+
+template <typename CoordinateType, typename KernelType>
+shared_ptr<QuadratureDescriptorSelectorForIntegralOperators<CoordinateType>>
+passKernelPropertiesToSelector(
+    const shared_ptr<QuadratureDescriptorSelectorForIntegralOperators<
+        CoordinateType>> &selector,
+    const CollectionOfKernels<KernelType> &kernels) {
+  // Kernels defining estimateRelativeScale() decay like exp(-a r); recover a
+  // from the scale at unit distance
+  const CoordinateType scale = std::max(
+      kernels.estimateRelativeScale(1.),
+      std::numeric_limits<CoordinateType>::min());
+  const CoordinateType decayRate =
+      std::max(-std::log(scale), CoordinateType(0.));
+  selector->setKernelProperties(kernels.estimateOscillationRate(), decayRate);
+  return selector;
+}
+
+} // namespace
+
 template <typename BasisFunctionType, typename ResultType,
           typename GeometryFactory, typename Enable>
 NumericalQuadratureStrategyBase<BasisFunctionType, ResultType, GeometryFactory,
@@ -154,10 +180,12 @@ NumericalQuadratureStrategyBase<BasisFunctionType, ResultType, GeometryFactory,
           trialRawGeometry, testShapesets, trialShapesets, testTransformations,
           kernels, trialTransformations, integral, openClHandler,
           parallelizationOptions, verbosityLevel, cacheSingularIntegrals,
-          this->quadratureDescriptorSelectorFactory()
-              ->makeQuadratureDescriptorSelectorForIntegralOperators(
-                    testRawGeometry, trialRawGeometry, testShapesets,
-                    trialShapesets),
+          passKernelPropertiesToSelector(
+              this->quadratureDescriptorSelectorFactory()
+                  ->makeQuadratureDescriptorSelectorForIntegralOperators(
+                        testRawGeometry, trialRawGeometry, testShapesets,
+                        trialShapesets),
+              *kernels),
           this->doubleQuadratureRuleFamily()));
 }
 
@@ -380,10 +408,12 @@ NumericalQuadratureStrategy<BasisFunctionType, ResultType, GeometryFactory,
           trialRawGeometry, testShapesets, trialShapesets, testTransformations,
           kernels, trialTransformations, integral, openClHandler,
           parallelizationOptions, verbosityLevel, cacheSingularIntegrals,
-          this->quadratureDescriptorSelectorFactory()
-              ->makeQuadratureDescriptorSelectorForIntegralOperators(
-                    testRawGeometry, trialRawGeometry, testShapesets,
-                    trialShapesets),
+          passKernelPropertiesToSelector(
+              this->quadratureDescriptorSelectorFactory()
+                  ->makeQuadratureDescriptorSelectorForIntegralOperators(
+                        testRawGeometry, trialRawGeometry, testShapesets,
+                        trialShapesets),
+              *kernels),
           this->doubleQuadratureRuleFamily()));
 }
 
@@ -23,6 +23,7 @@
 
 #include "../common/common.hpp"
 
+#include "basis_data_cache.hpp"
 #include "test_function_integrator.hpp"
 
 namespace Fiber {
@@ -67,6 +68,8 @@ private:
   m_testTransformations;
   const Function<UserFunctionType> &m_function;
 
+  BasisDataCache<BasisFunctionType> m_testBasisData;
+
   const OpenClHandler &m_openClHandler;
 };
 
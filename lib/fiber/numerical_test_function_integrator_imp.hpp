@@ -32,6 +32,7 @@
 #include "raw_grid_geometry.hpp"
 #include "types.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <memory>
 
@@ -53,6 +54,7 @@ NumericalTestFunctionIntegrator<BasisFunctionType, UserFunctionType, ResultType,
     : m_localQuadPoints(localQuadPoints), m_quadWeights(quadWeights),
       m_geometryFactory(geometryFactory), m_rawGeometry(rawGeometry),
       m_testTransformations(testTransformations), m_function(function),
+      m_testBasisData(localQuadPoints, testTransformations),
       m_openClHandler(openClHandler) {
   if (localQuadPoints.n_cols != quadWeights.size())
     throw std::invalid_argument("NumericalTestTrialIntegrator::"
@@ -90,7 +92,8 @@ void NumericalTestFunctionIntegrator<
                              "test functions and the \"arbitrary\" function "
                              "must have the same number of components");
 
-  BasisData<BasisFunctionType> testBasisData;
+  const BasisData<BasisFunctionType> &testBasisData =
+      m_testBasisData.get(testShapeset);
   GeometricalData<CoordinateType> geomData;
 
   size_t testBasisDeps = 0;
@@ -107,8 +110,78 @@ void NumericalTestFunctionIntegrator<
 
   result.set_size(testDofCount, elementCount);
 
-  testShapeset.evaluate(testBasisDeps, m_localQuadPoints, ALL_DOFS,
-                        testBasisData);
+  if (m_function.supportsBatchEvaluation()) {
+    // Evaluate the function on the quadrature points of whole chunks of
+    // elements at once, so that expensive function calls (e.g. into an
+    // interpreter) are made once per chunk rather than once per element
+    if (pointCount == 0) {
+      // Integrals over an empty set of points; nothing to evaluate
+      result.fill(0.);
+      return;
+    }
+    const size_t maxChunkSize = 1024;
+    std::vector<GeometricalData<CoordinateType>> chunkGeomData(
+        std::min(maxChunkSize, elementCount));
+    GeometricalData<CoordinateType> batchGeomData;
+    std::vector<int> batchDomainIndices;
+
+    for (size_t chunkStart = 0; chunkStart < elementCount;
+         chunkStart += maxChunkSize) {
+      const size_t chunkSize =
+          std::min(maxChunkSize, elementCount - chunkStart);
+      const size_t batchPointCount = chunkSize * pointCount;
+      batchDomainIndices.resize(batchPointCount);
+
+      for (size_t e = 0; e < chunkSize; ++e) {
+        const int elementIndex = elementIndices[chunkStart + e];
+        GeometricalData<CoordinateType> &elementGeomData = chunkGeomData[e];
+        m_rawGeometry.setupGeometry(elementIndex, *geometry);
+        geometry->getData(geomDeps, m_localQuadPoints, elementGeomData);
+        const int domainIndex = m_rawGeometry.domainIndex(elementIndex);
+        elementGeomData.domainIndex = domainIndex;
+
+        if (e == 0) {
+          batchGeomData.globals.set_size(elementGeomData.globals.n_rows,
+                                         batchPointCount);
+          batchGeomData.normals.set_size(elementGeomData.normals.n_rows,
+                                         batchPointCount);
+          batchGeomData.integrationElements.set_size(batchPointCount);
+        }
+        const size_t first = e * pointCount, last = first + pointCount - 1;
+        if (!elementGeomData.globals.is_empty())
+          batchGeomData.globals.cols(first, last) = elementGeomData.globals;
+        if (!elementGeomData.normals.is_empty())
+          batchGeomData.normals.cols(first, last) = elementGeomData.normals;
+        batchGeomData.integrationElements.cols(first, last) =
+            elementGeomData.integrationElements;
+        std::fill(batchDomainIndices.begin() + first,
+                  batchDomainIndices.begin() + last + 1, domainIndex);
+      }
+
+      m_function.evaluateBatch(batchGeomData, batchDomainIndices,
+                               functionValues);
+
+      for (size_t e = 0; e < chunkSize; ++e) {
+        const GeometricalData<CoordinateType> &elementGeomData =
+            chunkGeomData[e];
+        const size_t first = e * pointCount;
+        m_testTransformations.evaluate(testBasisData, elementGeomData,
+                                       testValues);
+
+        for (int testDof = 0; testDof < testDofCount; ++testDof) {
+          ResultType sum = 0.;
+          for (size_t point = 0; point < pointCount; ++point)
+            for (int dim = 0; dim < componentCount; ++dim)
+              sum += m_quadWeights[point] *
+                     elementGeomData.integrationElements(point) *
+                     conjugate(testValues[0](dim, testDof, point)) *
+                     functionValues(dim, first + point);
+          result(testDof, chunkStart + e) = sum;
+        }
+      }
+    }
+    return;
+  }
 
   // Iterate over the elements
   for (size_t e = 0; e < elementCount; ++e) {
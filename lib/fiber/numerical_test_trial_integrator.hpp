@@ -23,6 +23,7 @@
 
 #include "../common/common.hpp"
 
+#include "basis_data_cache.hpp"
 #include "test_trial_integrator.hpp"
 
 namespace Fiber {
@@ -73,6 +74,9 @@ private:
   m_trialTransformations;
   const TestTrialIntegral<BasisFunctionType, ResultType> &m_integral;
 
+  BasisDataCache<BasisFunctionType> m_testBasisData;
+  BasisDataCache<BasisFunctionType> m_trialBasisData;
+
   const OpenClHandler &m_openClHandler;
 };
 
@@ -54,6 +54,8 @@ NumericalTestTrialIntegrator<BasisFunctionType, ResultType, GeometryFactory>::
       m_geometryFactory(geometryFactory), m_rawGeometry(rawGeometry),
       m_testTransformations(testTransformations),
       m_trialTransformations(trialTransformations), m_integral(integral),
+      m_testBasisData(localQuadPoints, testTransformations),
+      m_trialBasisData(localQuadPoints, trialTransformations),
       m_openClHandler(openClHandler) {
   if (localQuadPoints.n_cols != quadWeights.size())
     throw std::invalid_argument("NumericalTestTrialIntegrator::"
@@ -81,7 +83,10 @@ NumericalTestTrialIntegrator<BasisFunctionType, ResultType, GeometryFactory>::
   const int testDofCount = testShapeset.size();
   const int trialDofCount = trialShapeset.size();
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
+  const BasisData<BasisFunctionType> &testBasisData =
+      m_testBasisData.get(testShapeset);
+  const BasisData<BasisFunctionType> &trialBasisData =
+      m_trialBasisData.get(trialShapeset);
   GeometricalData<CoordinateType> geomData;
 
   size_t testBasisDeps = 0, trialBasisDeps = 0;
@@ -98,11 +103,6 @@ NumericalTestTrialIntegrator<BasisFunctionType, ResultType, GeometryFactory>::
 
   result.set_size(testDofCount, trialDofCount, elementCount);
 
-  testShapeset.evaluate(testBasisDeps, m_localQuadPoints, ALL_DOFS,
-                        testBasisData);
-  trialShapeset.evaluate(trialBasisDeps, m_localQuadPoints, ALL_DOFS,
-                         trialBasisData);
-
   // Iterate over the elements
   for (size_t e = 0; e < elementCount; ++e) {
     const int elementIndex = elementIndices[e];
@@ -53,6 +53,29 @@ public:
   virtual DoubleQuadratureDescriptor
   quadratureDescriptor(int testElementIndex, int trialElementIndex,
                        CoordinateType nominalDistance) const = 0;
+
+  /** \brief Provide estimates of the behaviour of the kernels to be
+   *  integrated.
+   *
+   *  \param[in] oscillationRate
+   *    Rate of oscillation of the kernels, as returned by
+   *    CollectionOfKernels::estimateOscillationRate().
+   *  \param[in] decayRate
+   *    Rate \f$a\f$ of the exponential decay of the kernels, i.e. their
+   *    magnitude at distance \f$r\f$ is assumed to scale like
+   *    \f$\exp(-ar)\f$.
+   *
+   *  Selectors choosing quadrature orders from an error estimate may use
+   *  these values; the default implementation ignores them. */
+  virtual void setKernelProperties(CoordinateType oscillationRate,
+                                   CoordinateType decayRate) {}
+
+  /** \brief Add statistics about the quadrature rules selected since the
+   *  previous call to the current AssemblyProfile, if there is one.
+   *
+   *  Called when the assembly of a weak form finishes; the default
+   *  implementation does nothing. */
+  virtual void reportStatistics() const {}
 };
 
 } // namespace Fiber
@@ -25,6 +25,7 @@
 
 #include "bempp/common/config_opencl.hpp"
 
+#include "basis_data_cache.hpp"
 #include "test_kernel_trial_integrator.hpp"
 
 #include <tbb/enumerable_thread_specific.h>
@@ -141,6 +142,9 @@ private:
   const TestKernelTrialIntegral<BasisFunctionType, KernelType, ResultType> &
   m_integral;
 
+  BasisDataCache<BasisFunctionType> m_testBasisData;
+  BasisDataCache<BasisFunctionType> m_trialBasisData;
+
   const OpenClHandler &m_openClHandler;
   bool m_cacheGeometricalData;
 
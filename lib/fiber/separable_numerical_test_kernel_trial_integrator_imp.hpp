@@ -76,6 +76,8 @@ SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
       m_testRawGeometry(testRawGeometry), m_trialRawGeometry(trialRawGeometry),
       m_testTransformations(testTransformations), m_kernels(kernels),
       m_trialTransformations(trialTransformations), m_integral(integral),
+      m_testBasisData(localTestQuadPoints, testTransformations),
+      m_trialBasisData(localTrialQuadPoints, trialTransformations),
       m_openClHandler(openClHandler),
       m_cacheGeometricalData(cacheGeometricalData) {
   if (localTestQuadPoints.n_cols != testQuadWeights.size())
@@ -213,7 +215,7 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   const int testDofCount = callVariant == TEST_TRIAL ? dofCountA : dofCountB;
   const int trialDofCount = callVariant == TEST_TRIAL ? dofCountB : dofCountA;
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
+  const BasisData<BasisFunctionType> *testBasisData = 0, *trialBasisData = 0;
   GeometricalData<CoordinateType> *testGeomData = &m_testGeomData.local();
   GeometricalData<CoordinateType> *trialGeomData = &m_trialGeomData.local();
   const GeometricalData<CoordinateType> *constTestGeomData = testGeomData;
@@ -255,10 +257,8 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   if (!m_cacheGeometricalData)
     rawGeometryB->setupGeometry(elementIndexB, *geometryB);
   if (callVariant == TEST_TRIAL) {
-    basisA.evaluate(testBasisDeps, m_localTestQuadPoints, ALL_DOFS,
-                    testBasisData);
-    basisB.evaluate(trialBasisDeps, m_localTrialQuadPoints, localDofIndexB,
-                    trialBasisData);
+    testBasisData = &m_testBasisData.get(basisA);
+    trialBasisData = &m_trialBasisData.get(basisB, localDofIndexB);
     if (m_cacheGeometricalData)
       constTrialGeomData = &m_cachedTrialGeomData[elementIndexB];
     else {
@@ -266,13 +266,11 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
       if (trialGeomDeps & DOMAIN_INDEX)
         trialGeomData->domainIndex = rawGeometryB->domainIndex(elementIndexB);
     }
-    m_trialTransformations.evaluate(trialBasisData, *constTrialGeomData,
+    m_trialTransformations.evaluate(*trialBasisData, *constTrialGeomData,
                                     trialValues);
   } else {
-    basisA.evaluate(trialBasisDeps, m_localTrialQuadPoints, ALL_DOFS,
-                    trialBasisData);
-    basisB.evaluate(testBasisDeps, m_localTestQuadPoints, localDofIndexB,
-                    testBasisData);
+    trialBasisData = &m_trialBasisData.get(basisA);
+    testBasisData = &m_testBasisData.get(basisB, localDofIndexB);
     if (m_cacheGeometricalData)
       constTestGeomData = &m_cachedTestGeomData[elementIndexB];
     else {
@@ -280,7 +278,7 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
       if (testGeomDeps & DOMAIN_INDEX)
         testGeomData->domainIndex = rawGeometryB->domainIndex(elementIndexB);
     }
-    m_testTransformations.evaluate(testBasisData, *constTestGeomData,
+    m_testTransformations.evaluate(*testBasisData, *constTestGeomData,
                                    testValues);
   }
 
@@ -297,7 +295,7 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
         if (testGeomDeps & DOMAIN_INDEX)
           testGeomData->domainIndex = rawGeometryA->domainIndex(elementIndexA);
       }
-      m_testTransformations.evaluate(testBasisData, *constTestGeomData,
+      m_testTransformations.evaluate(*testBasisData, *constTestGeomData,
                                      testValues);
     } else {
       if (m_cacheGeometricalData)
@@ -308,7 +306,7 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
         if (trialGeomDeps & DOMAIN_INDEX)
           trialGeomData->domainIndex = rawGeometryA->domainIndex(elementIndexA);
       }
-      m_trialTransformations.evaluate(trialBasisData, *constTrialGeomData,
+      m_trialTransformations.evaluate(*trialBasisData, *constTrialGeomData,
                                       trialValues);
     }
 
@@ -716,7 +714,10 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   const int testDofCount = testShapeset.size();
   const int trialDofCount = trialShapeset.size();
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
+  const BasisData<BasisFunctionType> &testBasisData =
+      m_testBasisData.get(testShapeset);
+  const BasisData<BasisFunctionType> &trialBasisData =
+      m_trialBasisData.get(trialShapeset);
   GeometricalData<CoordinateType> *testGeomData = &m_testGeomData.local();
   GeometricalData<CoordinateType> *trialGeomData = &m_trialGeomData.local();
   const GeometricalData<CoordinateType> *constTestGeomData = testGeomData;
@@ -746,11 +747,6 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
     result[i]->set_size(testDofCount, trialDofCount);
   }
 
-  testShapeset.evaluate(testBasisDeps, m_localTestQuadPoints, ALL_DOFS,
-                        testBasisData);
-  trialShapeset.evaluate(trialBasisDeps, m_localTrialQuadPoints, ALL_DOFS,
-                         trialBasisData);
-
   // Iterate over the elements
   for (int pairIndex = 0; pairIndex < geometryPairCount; ++pairIndex) {
     const int testElementIndex = elementIndexPairs[pairIndex].first;
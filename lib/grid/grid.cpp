@@ -24,34 +24,16 @@
 #include "entity_iterator.hpp"
 #include "geometry.hpp"
 #include "grid_view.hpp"
-#include "ray_triangle_intersection.hpp"
+#include "surface_triangle_bvh.hpp"
 
 #include "../common/not_implemented_error.hpp"
 
-namespace Bempp {
-
-namespace {
-
-double min3(double x, double y, double z) {
-  return std::min(x, std::min(y, z));
-}
+#include <algorithm>
 
-double max3(double x, double y, double z) {
-  return std::max(x, std::max(y, z));
-}
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
-bool isNew(const arma::Col<double> &intersection,
-           const std::vector<arma::Col<double>> &intersections) {
-  const double EPSILON = 1e-10;
-  for (size_t i = 0; i < intersections.size(); ++i)
-    if (fabs(intersections[i](0) - intersection(0)) < EPSILON &&
-        fabs(intersections[i](1) - intersection(1)) < EPSILON &&
-        fabs(intersections[i](2) - intersection(2)) < EPSILON)
-      return false;
-  return true;
-}
-
-} // namespace
+namespace Bempp {
 
 bool Grid::isBarycentricRepresentationOf(const Grid &other) const {
   if (!other.hasBarycentricGrid())
@@ -60,6 +42,13 @@ bool Grid::isBarycentricRepresentationOf(const Grid &other) const {
     return (this == other.barycentricGrid().get());
 }
 
+shared_ptr<const SurfaceTriangleBvh> Grid::surfaceTriangleBvh() const {
+  tbb::mutex::scoped_lock lock(m_surfaceTriangleBvhMutex);
+  if (!m_surfaceTriangleBvh)
+    m_surfaceTriangleBvh.reset(new SurfaceTriangleBvh(*this));
+  return m_surfaceTriangleBvh;
+}
+
 void Grid::getBoundingBox(arma::Col<double> &lowerBound,
                           arma::Col<double> &upperBound) const {
   // In this simple implementation we assume that all elements are flat.
@@ -82,86 +71,48 @@ void Grid::getBoundingBox(arma::Col<double> &lowerBound,
       arma::max(vertices, 1); // 1 -> max. value in each row
 }
 
-std::vector<bool> areInside(const Grid &grid, const arma::Mat<double> &points) {
+std::vector<std::uint64_t> areInsideBitmask(const Grid &grid,
+                                            const arma::Mat<double> &points) {
   if (grid.dim() != 2 || grid.dimWorld() != 3)
     throw NotImplementedError("areInside(): currently implemented only for"
                               "2D grids embedded in 3D spaces");
 
-  std::unique_ptr<GridView> view = grid.leafView();
-  std::unique_ptr<EntityIterator<0>> it = view->entityIterator<0>();
-
-  std::vector<arma::Mat<double>> triangles;
-  triangles.reserve(view->entityCount(0));
-
-  {
-    arma::Mat<double> triangle(grid.dimWorld(), 3);
-    arma::Mat<double> corners;
-    while (!it->finished()) {
-      const Entity<0> &element = it->entity();
-      element.geometry().getCorners(corners);
-      if (corners.n_cols == 3) // triangle
-        triangles.push_back(corners);
-      else if (corners.n_cols == 4) { // quadrilateral, split into 2 triangles
-        // NOTE: this won't work for concave quads,
-        triangle.col(0) = corners.col(0);
-        triangle.col(1) = corners.col(1);
-        triangle.col(2) = corners.col(2);
-        triangles.push_back(triangle);
-        triangle.col(0) = corners.col(2);
-        triangle.col(1) = corners.col(3);
-        triangle.col(2) = corners.col(0);
-        triangles.push_back(triangle);
-      } else
-        throw std::runtime_error("areInside(): unknown element type");
-      it->next();
-    }
-  }
+  shared_ptr<const SurfaceTriangleBvh> bvh = grid.surfaceTriangleBvh();
 
-  const size_t triangleCount = triangles.size();
-  arma::Row<double> xMins(triangleCount);
-  arma::Row<double> xMaxs(triangleCount);
-  arma::Row<double> yMins(triangleCount);
-  arma::Row<double> yMaxs(triangleCount);
-  arma::Row<double> zMins(triangleCount);
-  arma::Row<double> zMaxs(triangleCount);
-  for (size_t i = 0; i < triangleCount; ++i) {
-    const arma::Mat<double> &triangle = triangles[i];
-    xMins(i) = min3(triangle(0, 0), triangle(0, 1), triangle(0, 2));
-    xMaxs(i) = max3(triangle(0, 0), triangle(0, 1), triangle(0, 2));
-    yMins(i) = min3(triangle(1, 0), triangle(1, 1), triangle(1, 2));
-    yMaxs(i) = max3(triangle(1, 0), triangle(1, 1), triangle(1, 2));
-    zMins(i) = min3(triangle(2, 0), triangle(2, 1), triangle(2, 2));
-    zMaxs(i) = max3(triangle(2, 0), triangle(2, 1), triangle(2, 2));
-  }
-
-  const double gridXMin = arma::min(xMins);
-  const double gridXMax = arma::max(xMaxs);
-  const double gridYMin = arma::min(yMins);
-  const double gridYMax = arma::max(yMaxs);
-  const double gridZMin = arma::min(zMins);
-  const double gridZMax = arma::max(zMaxs);
+  arma::Col<double> gridLowerBound, gridUpperBound;
+  grid.getBoundingBox(gridLowerBound, gridUpperBound);
 
   const size_t pointCount = points.n_cols;
-  std::vector<bool> result(pointCount, false);
-  std::vector<arma::Col<double>> intersections;
-  arma::Col<double> intersection(3);
-  for (size_t pt = 0; pt < pointCount; ++pt) {
-    if (points(0, pt) < gridXMin || points(0, pt) > gridXMax ||
-        points(1, pt) < gridYMin || points(1, pt) > gridYMax ||
-        points(2, pt) < gridZMin || points(2, pt) > gridZMax)
-      continue; // point outside grid's bounding box
-    intersections.clear();
-    for (size_t tri = 0; tri < triangleCount; ++tri)
-      if (points(0, pt) >= xMins(tri) && points(0, pt) <= xMaxs(tri) &&
-          points(1, pt) >= yMins(tri) && points(1, pt) <= yMaxs(tri))
-        if (zRayIntersectsTriangle(points.colptr(pt), triangles[tri].colptr(0),
-                                   triangles[tri].colptr(1),
-                                   triangles[tri].colptr(2),
-                                   intersection.colptr(0)) > 0.)
-          if (isNew(intersection, intersections))
-            intersections.push_back(intersection);
-    result[pt] = intersections.size();
-  }
+  const size_t wordCount = (pointCount + 63) / 64;
+  std::vector<std::uint64_t> result(wordCount, 0);
+
+  // Each task owns whole words of the bitmask, so no synchronisation is
+  // needed when setting bits.
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, wordCount),
+                    [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t word = r.begin(); word != r.end(); ++word) {
+      std::uint64_t bits = 0;
+      const size_t end = std::min(pointCount, 64 * (word + 1));
+      for (size_t pt = 64 * word; pt < end; ++pt) {
+        const double *point = points.colptr(pt);
+        if (point[0] < gridLowerBound(0) || point[0] > gridUpperBound(0) ||
+            point[1] < gridLowerBound(1) || point[1] > gridUpperBound(1) ||
+            point[2] < gridLowerBound(2) || point[2] > gridUpperBound(2))
+          continue; // point outside grid's bounding box
+        if (bvh->zRayIntersectionCount(point) % 2)
+          bits |= std::uint64_t(1) << (pt % 64);
+      }
+      result[word] = bits;
+    }
+  });
+  return result;
+}
+
+std::vector<bool> areInside(const Grid &grid, const arma::Mat<double> &points) {
+  const std::vector<std::uint64_t> bitmask = areInsideBitmask(grid, points);
+  std::vector<bool> result(points.n_cols);
+  for (size_t pt = 0; pt < result.size(); ++pt)
+    result[pt] = (bitmask[pt / 64] >> (pt % 64)) & 1;
   return result;
 }
 
@@ -29,6 +29,7 @@
 
 #include "../common/armadillo_fwd.hpp"
 #include <cstddef> // size_t
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <tbb/mutex.h>
@@ -40,6 +41,7 @@ template <int codim> class Entity;
 class GeometryFactory;
 class GridView;
 class IdSet;
+class SurfaceTriangleBvh;
 /** \endcond */
 
 /** \ingroup grid
@@ -113,9 +115,19 @@ public:
   void getBoundingBox(arma::Col<double> &lowerBound,
                       arma::Col<double> &upperBound) const;
 
+  /** \brief Bounding-volume hierarchy of the leaf elements.
+   *
+   *  The hierarchy is built on first use and kept for the lifetime of the
+   *  grid.
+   *
+   *  \note For internal use by areInside(). */
+  shared_ptr<const SurfaceTriangleBvh> surfaceTriangleBvh() const;
+
 private:
   /** \cond PRIVATE */
   mutable arma::Col<double> m_lowerBound, m_upperBound;
+  mutable shared_ptr<const SurfaceTriangleBvh> m_surfaceTriangleBvh;
+  mutable tbb::mutex m_surfaceTriangleBvhMutex;
   /** \endcond */
 };
 
@@ -141,6 +153,19 @@ private:
 std::vector<bool> areInside(const Grid &grid, const arma::Mat<double> &points);
 std::vector<bool> areInside(const Grid &grid, const arma::Mat<float> &points);
 
+/** \relates Grid
+ *  \brief Check whether points are inside or outside a closed grid.
+ *
+ *  Same as areInside(), but the result is returned as a bitmask: the \c j'th
+ *  point lies inside \c grid if and only if bit <tt>j % 64</tt> of the
+ *  element <tt>j / 64</tt> of the returned vector is set.
+ *
+ *  The points are processed in parallel. The bounding-volume hierarchy used
+ *  to find the elements crossed by a ray is built on the first call and
+ *  reused by subsequent calls for the same grid. */
+std::vector<std::uint64_t> areInsideBitmask(const Grid &grid,
+                                            const arma::Mat<double> &points);
+
 } // namespace Bempp
 
 #endif
@@ -0,0 +1,186 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "surface_triangle_bvh.hpp"
+
+#include "entity.hpp"
+#include "entity_iterator.hpp"
+#include "geometry.hpp"
+#include "grid.hpp"
+#include "grid_view.hpp"
+#include "ray_triangle_intersection.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace Bempp {
+
+namespace {
+
+const int LEAF_SIZE = 4;
+const int MAX_DEPTH = 64;
+
+void appendTriangle(const arma::Mat<double> &corners, int i0, int i1, int i2,
+                    std::vector<double> &vertices) {
+  const int indices[3] = {i0, i1, i2};
+  for (int c = 0; c < 3; ++c)
+    for (int d = 0; d < 3; ++d)
+      vertices.push_back(corners(d, indices[c]));
+}
+
+bool isNew(const double *intersection,
+           const std::vector<double> &intersections) {
+  const double EPSILON = 1e-10;
+  for (size_t i = 0; i < intersections.size(); i += 3)
+    if (fabs(intersections[i] - intersection[0]) < EPSILON &&
+        fabs(intersections[i + 1] - intersection[1]) < EPSILON &&
+        fabs(intersections[i + 2] - intersection[2]) < EPSILON)
+      return false;
+  return true;
+}
+
+} // namespace
+
+SurfaceTriangleBvh::SurfaceTriangleBvh(const Grid &grid) {
+  std::unique_ptr<GridView> view = grid.leafView();
+  std::unique_ptr<EntityIterator<0>> it = view->entityIterator<0>();
+
+  std::vector<double> vertices;
+  vertices.reserve(9 * view->entityCount(0));
+  arma::Mat<double> corners;
+  while (!it->finished()) {
+    const Entity<0> &element = it->entity();
+    element.geometry().getCorners(corners);
+    if (corners.n_cols == 3) // triangle
+      appendTriangle(corners, 0, 1, 2, vertices);
+    else if (corners.n_cols == 4) { // quadrilateral, split into 2 triangles
+      // NOTE: this won't work for concave quads,
+      appendTriangle(corners, 0, 1, 2, vertices);
+      appendTriangle(corners, 2, 3, 0, vertices);
+    } else
+      throw std::runtime_error("SurfaceTriangleBvh::SurfaceTriangleBvh(): "
+                               "unknown element type");
+    it->next();
+  }
+
+  const int triangleCount = vertices.size() / 9;
+  if (triangleCount == 0)
+    return;
+
+  std::vector<int> order(triangleCount);
+  std::vector<double> centroids(2 * triangleCount);
+  for (int i = 0; i < triangleCount; ++i) {
+    order[i] = i;
+    const double *v = &vertices[9 * i];
+    centroids[2 * i] = (v[0] + v[3] + v[6]) / 3.;
+    centroids[2 * i + 1] = (v[1] + v[4] + v[7]) / 3.;
+  }
+
+  m_nodes.reserve(2 * (triangleCount / LEAF_SIZE + 1));
+  build(order, centroids, vertices, 0, triangleCount);
+
+  // Store the triangles in the order in which the leaves refer to them
+  m_vertices.resize(vertices.size());
+  for (int i = 0; i < triangleCount; ++i)
+    std::copy(&vertices[9 * order[i]], &vertices[9 * order[i]] + 9,
+              &m_vertices[9 * i]);
+}
+
+int SurfaceTriangleBvh::build(std::vector<int> &order,
+                              std::vector<double> &centroids,
+                              const std::vector<double> &vertices, int begin,
+                              int end) {
+  const double inf = std::numeric_limits<double>::infinity();
+  Node node = {inf, -inf, inf, -inf, -inf, begin, end - begin};
+  double cMin[2] = {inf, inf};
+  double cMax[2] = {-inf, -inf};
+  for (int i = begin; i < end; ++i) {
+    const double *v = &vertices[9 * order[i]];
+    for (int c = 0; c < 3; ++c) {
+      node.xMin = std::min(node.xMin, v[3 * c]);
+      node.xMax = std::max(node.xMax, v[3 * c]);
+      node.yMin = std::min(node.yMin, v[3 * c + 1]);
+      node.yMax = std::max(node.yMax, v[3 * c + 1]);
+      node.zMax = std::max(node.zMax, v[3 * c + 2]);
+    }
+    for (int d = 0; d < 2; ++d) {
+      cMin[d] = std::min(cMin[d], centroids[2 * order[i] + d]);
+      cMax[d] = std::max(cMax[d], centroids[2 * order[i] + d]);
+    }
+  }
+
+  const int index = m_nodes.size();
+  m_nodes.push_back(node);
+  if (end - begin <= LEAF_SIZE)
+    return index;
+
+  // Median split along the direction of the larger centroid extent
+  const int axis = (cMax[0] - cMin[0] >= cMax[1] - cMin[1]) ? 0 : 1;
+  const int mid = begin + (end - begin) / 2;
+  std::nth_element(order.begin() + begin, order.begin() + mid,
+                   order.begin() + end, [&centroids, axis](int a, int b) {
+    return centroids[2 * a + axis] < centroids[2 * b + axis];
+  });
+
+  build(order, centroids, vertices, begin, mid);
+  const int right = build(order, centroids, vertices, mid, end);
+  m_nodes[index].start = right;
+  m_nodes[index].count = 0;
+  return index;
+}
+
+int SurfaceTriangleBvh::zRayIntersectionCount(const double *point) const {
+  if (m_nodes.empty())
+    return 0;
+
+  std::vector<double> intersections;
+  double intersection[3];
+
+  int stack[MAX_DEPTH];
+  int stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0) {
+    const Node &node = m_nodes[stack[--stackSize]];
+    if (point[0] < node.xMin || point[0] > node.xMax || point[1] < node.yMin ||
+        point[1] > node.yMax || point[2] > node.zMax)
+      continue;
+    if (node.count == 0) {
+      const int self = &node - &m_nodes[0];
+      stack[stackSize++] = node.start;
+      stack[stackSize++] = self + 1;
+      continue;
+    }
+    for (int tri = node.start; tri < node.start + node.count; ++tri) {
+      const double *v = &m_vertices[9 * tri];
+      if (zRayIntersectsTriangle(point, v, v + 3, v + 6, intersection) > 0. &&
+          isNew(intersection, intersections))
+        intersections.insert(intersections.end(), intersection,
+                             intersection + 3);
+    }
+  }
+  return intersections.size() / 3;
+}
+
+} // namespace Bempp
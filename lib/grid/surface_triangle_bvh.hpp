@@ -0,0 +1,80 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_surface_triangle_bvh_hpp
+#define bempp_surface_triangle_bvh_hpp
+
+#include "../common/common.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace Bempp {
+
+/** \cond FORWARD_DECL */
+class Grid;
+/** \endcond */
+
+/** \ingroup grid_internal
+ *  \brief Bounding-volume hierarchy of the leaf elements of a surface grid,
+ *  specialised for rays parallel to the z axis.
+ *
+ *  Quadrilaterals are split into two triangles. Since all query rays point
+ *  in the +z direction, the boxes of the hierarchy are built on the x and y
+ *  coordinates only and store the largest z coordinate of their triangles,
+ *  which suffices to discard subtrees lying below a query point.
+ *
+ *  \note For internal use by areInside(). */
+class SurfaceTriangleBvh {
+public:
+  /** \brief Build the hierarchy of the leaf elements of \p grid.
+   *
+   *  \p grid must be a 2D grid embedded in a 3D space. */
+  explicit SurfaceTriangleBvh(const Grid &grid);
+
+  /** \brief Number of triangles stored in the hierarchy. */
+  size_t triangleCount() const { return m_vertices.size() / 9; }
+
+  /** \brief Return the number of distinct points at which the ray
+   *  <tt>point + alpha (0, 0, 1)</tt>, <tt>alpha > 0</tt>, crosses the
+   *  surface. */
+  int zRayIntersectionCount(const double *point) const;
+
+private:
+  /** \cond PRIVATE */
+  struct Node {
+    double xMin, xMax, yMin, yMax, zMax;
+    // Leaves: triangles [start, start + count). Inner nodes: count == 0,
+    // the left child follows the node, the right child is at index start.
+    int start, count;
+  };
+
+  int build(std::vector<int> &order, std::vector<double> &centroids,
+            const std::vector<double> &vertices, int begin, int end);
+
+  std::vector<Node> m_nodes;
+  // Corners of triangle i are stored at [9 * i, 9 * i + 9).
+  std::vector<double> m_vertices;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
@@ -4,37 +4,69 @@
 #define HMAT_BLOCK_CLUSTER_TREE_HPP
 
 #include "common.hpp"
-#include "simple_tree_node.hpp"
 #include "bounding_box.hpp"
 #include "geometry.hpp"
 #include "cluster_tree.hpp"
 
+#include <functional>
+#include <vector>
+
 namespace hmat {
 
 typedef std::function<bool(const BoundingBox &, const BoundingBox &)>
 AdmissibilityFunction;
 
+template <int N> class BlockClusterTree;
+
 template <int N> struct BlockClusterTreeNodeData {
 
-  BlockClusterTreeNodeData(
-      const shared_ptr<const ClusterTreeNode<N>> &rowClusterTreeNode,
-      const shared_ptr<const ClusterTreeNode<N>> &columnClusterTreeNode,
-      bool admissible);
+  BlockClusterTreeNodeData(const ClusterTreeNode<N> *rowClusterTreeNode,
+                           const ClusterTreeNode<N> *columnClusterTreeNode,
+                           bool admissible);
 
-  shared_ptr<const ClusterTreeNode<N>> rowClusterTreeNode;
-  shared_ptr<const ClusterTreeNode<N>> columnClusterTreeNode;
+  // The cluster trees are owned by the block cluster tree.
+  const ClusterTreeNode<N> *rowClusterTreeNode;
+  const ClusterTreeNode<N> *columnClusterTreeNode;
 
   bool admissible;
 };
 
-template <int N >
-using BlockClusterTreeNode = SimpleTreeNode<BlockClusterTreeNodeData<N>, N *N>;
+/** \brief Node of a BlockClusterTree.
+ *
+ *  Nodes are stored contiguously in an array owned by the tree, the N * N
+ *  sons of a node being adjacent. Nodes are only created by the tree and
+ *  remain valid as long as the tree exists. */
+template <int N> class BlockClusterTreeNode {
+public:
+  const BlockClusterTreeNodeData<N> &data() const;
+
+  /** \brief Son \p i, stored in row-major order of the (row cluster,
+   *  column cluster) pairs. */
+  const BlockClusterTreeNode<N> &child(int i) const;
+
+  bool isLeaf() const;
+
+  /** \brief Position of this node in BlockClusterTree::leafNodes(), or
+   *  BlockClusterTree::NOT_A_LEAF for inner nodes. */
+  std::size_t leafIndex() const;
+
+private:
+  friend class BlockClusterTree<N>;
+
+  BlockClusterTreeNode(const BlockClusterTreeNodeData<N> &data);
+
+  BlockClusterTreeNodeData<N> m_data;
+  const BlockClusterTreeNode<N> *m_children;
+  std::size_t m_leafIndex;
+};
 
 typedef BlockClusterTreeNode<2> DefaultBlockClusterTreeNodeType;
 
 template <int N > class BlockClusterTree {
 
 public:
+  static const std::size_t NOT_A_LEAF = static_cast<std::size_t>(-1);
+
   BlockClusterTree(const shared_ptr<const ClusterTree<N>> &rowClusterTree,
                    const shared_ptr<const ClusterTree<N>> &columnClusterTree,
                    int maxBlockSize,
@@ -46,23 +78,30 @@ public:
   std::size_t rows() const;
   std::size_t columns() const;
 
-  shared_ptr<const BlockClusterTreeNode<N>> root() const;
-  shared_ptr<BlockClusterTreeNode<N>> root();
+  const BlockClusterTreeNode<N> &root() const;
 
   shared_ptr<const ClusterTree<N>> rowClusterTree() const;
   shared_ptr<const ClusterTree<N>> columnClusterTree() const;
 
-  std::vector<shared_ptr<const BlockClusterTreeNode<N>>> leafNodes() const;
-  std::vector<shared_ptr<BlockClusterTreeNode<N>>> leafNodes();
+  std::size_t numberOfNodes() const;
+
+  /** \brief Leaves in depth-first order. The list is built once, together
+   *  with the tree. */
+  const std::vector<const BlockClusterTreeNode<N> *> &leafNodes() const;
+  std::size_t numberOfLeaves() const;
 
 private:
+  BlockClusterTree(const BlockClusterTree &);
+  BlockClusterTree &operator=(const BlockClusterTree &);
+
   void initializeBlockClusterTree(
       const AdmissibilityFunction &admissibilityFunction, int maxBlockSize);
 
   shared_ptr<const ClusterTree<N>> m_rowClusterTree;
   shared_ptr<const ClusterTree<N>> m_columnClusterTree;
 
-  shared_ptr<BlockClusterTreeNode<N>> m_root;
+  std::vector<BlockClusterTreeNode<N>> m_nodes;
+  std::vector<const BlockClusterTreeNode<N> *> m_leafNodes;
 };
 
 template <int N>
@@ -4,6 +4,7 @@
 #define HMAT_BLOCK_CLUSTER_TREE_IMPL_HPP
 
 #include "block_cluster_tree.hpp"
+#include <cassert>
 //#include "cairo/cairo.h"
 //#include "cairo/cairo-pdf.h"
 
@@ -11,12 +12,40 @@ namespace hmat {
 
 template <int N>
 BlockClusterTreeNodeData<N>::BlockClusterTreeNodeData(
-    const shared_ptr<const ClusterTreeNode<N>> &rowClusterTreeNode,
-    const shared_ptr<const ClusterTreeNode<N>> &columnClusterTreeNode,
-    bool admissible)
+    const ClusterTreeNode<N> *rowClusterTreeNode,
+    const ClusterTreeNode<N> *columnClusterTreeNode, bool admissible)
     : rowClusterTreeNode(rowClusterTreeNode),
       columnClusterTreeNode(columnClusterTreeNode), admissible(admissible) {}
 
+template <int N>
+BlockClusterTreeNode<N>::BlockClusterTreeNode(
+    const BlockClusterTreeNodeData<N> &data)
+    : m_data(data), m_children(nullptr),
+      m_leafIndex(BlockClusterTree<N>::NOT_A_LEAF) {}
+
+template <int N>
+const BlockClusterTreeNodeData<N> &BlockClusterTreeNode<N>::data() const {
+  return m_data;
+}
+
+template <int N>
+const BlockClusterTreeNode<N> &BlockClusterTreeNode<N>::child(int i) const {
+  assert(i < N * N);
+  assert(m_children);
+
+  return m_children[i];
+}
+
+template <int N> bool BlockClusterTreeNode<N>::isLeaf() const {
+  return m_children == nullptr;
+}
+
+template <int N> std::size_t BlockClusterTreeNode<N>::leafIndex() const {
+  return m_leafIndex;
+}
+
+template <int N> const std::size_t BlockClusterTree<N>::NOT_A_LEAF;
+
 template <int N>
 BlockClusterTree<N>::BlockClusterTree(
     const shared_ptr<const ClusterTree<N>> &rowClusterTree,
@@ -88,13 +117,8 @@ template <int N> std::size_t BlockClusterTree<N>::columns() const {
 }
 
 template <int N>
-shared_ptr<const BlockClusterTreeNode<N>> BlockClusterTree<N>::root() const {
-  return m_root;
-}
-
-template <int N>
-shared_ptr<BlockClusterTreeNode<N>> BlockClusterTree<N>::root() {
-  return m_root;
+const BlockClusterTreeNode<N> &BlockClusterTree<N>::root() const {
+  return m_nodes.front();
 }
 
 template <int N>
@@ -109,38 +133,53 @@ BlockClusterTree<N>::columnClusterTree() const {
   return m_columnClusterTree;
 }
 
+template <int N> std::size_t BlockClusterTree<N>::numberOfNodes() const {
+  return m_nodes.size();
+}
+
 template <int N>
-std::vector<shared_ptr<const BlockClusterTreeNode<N>>>
+const std::vector<const BlockClusterTreeNode<N> *> &
 BlockClusterTree<N>::leafNodes() const {
-  return m_root->leafNodes();
+  return m_leafNodes;
 }
 
-template <int N>
-std::vector<shared_ptr<BlockClusterTreeNode<N>>>
-BlockClusterTree<N>::leafNodes() {
-  return m_root->leafNodes();
+template <int N> std::size_t BlockClusterTree<N>::numberOfLeaves() const {
+  return m_leafNodes.size();
 }
 
 template <int N>
 void BlockClusterTree<N>::initializeBlockClusterTree(
     const AdmissibilityFunction &admissibilityFunction, int maxBlockSize) {
 
-  std::function<void(const shared_ptr<BlockClusterTreeNode<N>> &)>
-  splittingFunction;
+  // The nodes are appended to m_nodes, so while the tree grows they are
+  // referred to by their positions; pointers are only set up at the end.
+
+  std::vector<std::size_t> firstChildIndices;
 
-  splittingFunction =
-      [this, &admissibilityFunction, &splittingFunction, &maxBlockSize](
-          const shared_ptr<BlockClusterTreeNode<N>> &node) {
+  const ClusterTreeNode<N> *rowRoot = m_rowClusterTree->root().get();
+  const ClusterTreeNode<N> *columnRoot = m_columnClusterTree->root().get();
+  bool admissible = admissibilityFunction(rowRoot->data().boundingBox,
+                                          columnRoot->data().boundingBox);
+  m_nodes.push_back(BlockClusterTreeNode<N>(
+      BlockClusterTreeNodeData<N>(rowRoot, columnRoot, admissible)));
+  firstChildIndices.push_back(0);
 
-    auto nodeData = node->data();
+  std::vector<std::size_t> stack(1, 0);
+  while (!stack.empty()) {
+    std::size_t index = stack.back();
+    stack.pop_back();
+
+    BlockClusterTreeNodeData<N> &nodeData = m_nodes[index].m_data;
+    const ClusterTreeNode<N> *rowClusterTreeNode = nodeData.rowClusterTreeNode;
+    const ClusterTreeNode<N> *columnClusterTreeNode =
+        nodeData.columnClusterTreeNode;
 
     // Adjust admissibility condition to only accept blocks smaller than
     // maxBlockSize
 
-    auto rowClusterTreeNodeIndexRange =
-        nodeData.rowClusterTreeNode->data().indexRange;
+    auto rowClusterTreeNodeIndexRange = rowClusterTreeNode->data().indexRange;
     auto columnClusterTreeNodeIndexRange =
-        nodeData.columnClusterTreeNode->data().indexRange;
+        columnClusterTreeNode->data().indexRange;
     auto rowBlockSize =
         rowClusterTreeNodeIndexRange[1] - rowClusterTreeNodeIndexRange[0];
     auto columnBlockSize =
@@ -152,42 +191,53 @@ void BlockClusterTree<N>::initializeBlockClusterTree(
     // If admissible do not refine further
 
     if (nodeData.admissible)
-      return;
-
-    auto rowClusterData = nodeData.rowClusterTreeNode->data();
-    auto columnClusterData = nodeData.columnClusterTreeNode->data();
+      continue;
 
     // If row or column cluster is leaf do not refine further
 
-    if (nodeData.rowClusterTreeNode->isLeaf() ||
-        nodeData.columnClusterTreeNode->isLeaf())
-      return;
+    if (rowClusterTreeNode->isLeaf() || columnClusterTreeNode->isLeaf())
+      continue;
 
-    // Create the block clusters
+    // Create the block clusters (this invalidates nodeData)
 
+    const BoundingBox &rowBoundingBox = rowClusterTreeNode->data().boundingBox;
+    const BoundingBox &columnBoundingBox =
+        columnClusterTreeNode->data().boundingBox;
+    std::size_t firstChildIndex = m_nodes.size();
+    firstChildIndices[index] = firstChildIndex;
     for (int rowCount = 0; rowCount < N; ++rowCount) {
-      auto rowChild = nodeData.rowClusterTreeNode->child(rowCount);
+      auto rowChild = rowClusterTreeNode->child(rowCount).get();
       for (int columnCount = 0; columnCount < N; ++columnCount) {
-        auto columnChild = nodeData.columnClusterTreeNode->child(columnCount);
-        auto rowBoundingBox = rowClusterData.boundingBox;
-        auto columnBoundingBox = columnClusterData.boundingBox;
-        node->addChild(
-            BlockClusterTreeNodeData<N>(
-                rowChild, columnChild,
-                admissibilityFunction(rowBoundingBox, columnBoundingBox)),
-            N * rowCount + columnCount);
-        splittingFunction(node->child(N * rowCount + columnCount));
+        auto columnChild = columnClusterTreeNode->child(columnCount).get();
+        m_nodes.push_back(BlockClusterTreeNode<N>(BlockClusterTreeNodeData<N>(
+            rowChild, columnChild,
+            admissibilityFunction(rowBoundingBox, columnBoundingBox))));
+        firstChildIndices.push_back(0);
       }
     }
-  };
-
-  bool admissible =
-      admissibilityFunction(m_rowClusterTree->root()->data().boundingBox,
-                            m_columnClusterTree->root()->data().boundingBox);
-  m_root = shared_ptr<BlockClusterTreeNode<N>>(
-      new BlockClusterTreeNode<N>(BlockClusterTreeNodeData<N>(
-          m_rowClusterTree->root(), m_columnClusterTree->root(), admissible)));
-  splittingFunction(m_root);
+    for (int i = N * N - 1; i >= 0; --i)
+      stack.push_back(firstChildIndex + i);
+  }
+
+  for (std::size_t index = 0; index < m_nodes.size(); ++index)
+    if (firstChildIndices[index] != 0)
+      m_nodes[index].m_children = &m_nodes[firstChildIndices[index]];
+
+  // Cache the leaves in depth-first order
+
+  std::vector<BlockClusterTreeNode<N> *> nodeStack(1, &m_nodes.front());
+  while (!nodeStack.empty()) {
+    BlockClusterTreeNode<N> *node = nodeStack.back();
+    nodeStack.pop_back();
+    if (node->isLeaf()) {
+      node->m_leafIndex = m_leafNodes.size();
+      m_leafNodes.push_back(node);
+    } else {
+      std::size_t firstChildIndex = node->m_children - &m_nodes.front();
+      for (int i = N * N - 1; i >= 0; --i)
+        nodeStack.push_back(&m_nodes[firstChildIndex + i]);
+    }
+  }
 }
 
 template <int N>
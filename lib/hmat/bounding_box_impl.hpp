@@ -6,16 +6,17 @@
 #include "bounding_box.hpp"
 #include <cmath>
 #include <cassert>
+#include <limits>
 
 namespace hmat {
 
 inline BoundingBox::BoundingBox()
     : BoundingBox(std::numeric_limits<double>::max(),
-                  std::numeric_limits<double>::min(),
+                  std::numeric_limits<double>::lowest(),
                   std::numeric_limits<double>::max(),
-                  std::numeric_limits<double>::min(),
+                  std::numeric_limits<double>::lowest(),
                   std::numeric_limits<double>::max(),
-                  std::numeric_limits<double>::min()) {}
+                  std::numeric_limits<double>::lowest()) {}
 
 inline BoundingBox::BoundingBox(double xmin_, double xmax_, double ymin_,
                                 double ymax_, double zmin_, double zmax_)
@@ -24,10 +24,36 @@ template <int N> using ClusterTreeNode = SimpleTreeNode<ClusterTreeNodeData, N>;
 
 typedef ClusterTreeNode<2> DefaultClusterTreeNodeType;
 
+/** \brief Rule used to split a cluster into two sons. */
+enum ClusterSplittingStrategy {
+  /** \brief Bisect the bounding box of the cluster along its longest side. */
+  GEOMETRIC_BISECTION,
+  /** \brief Split at the median of the element centers along the longest
+   *  side of their bounding box, so that both sons have the same number of
+   *  indices up to one. */
+  MEDIAN_SPLIT,
+  /** \brief Split at the median of the element centers projected onto the
+   *  principal axis (largest-variance direction) of the cluster. */
+  PRINCIPAL_AXIS_SPLIT
+};
+
+/** \brief Shape of a cluster tree. */
+struct ClusterTreeStatistics {
+  /** \brief Largest distance from the root to a leaf. */
+  std::size_t depth;
+  /** \brief Number of leaves. */
+  std::size_t numberOfLeaves;
+  /** \brief Element \p i is the number of leaves with \p i indices. */
+  std::vector<std::size_t> leafSizeHistogram;
+  /** \brief Element \p i is the number of leaves at depth \p i. */
+  std::vector<std::size_t> leafDepthHistogram;
+};
+
 template <int N> class ClusterTree {
 
 public:
-  ClusterTree(const Geometry &geometry, int minBlockSize);
+  ClusterTree(const Geometry &geometry, int minBlockSize,
+              ClusterSplittingStrategy strategy = GEOMETRIC_BISECTION);
 
   const shared_ptr<const ClusterTreeNode<N>> root() const;
   const shared_ptr<ClusterTreeNode<N>> root();
@@ -43,12 +69,19 @@ public:
 
   std::size_t numberOfDofs() const;
 
+  ClusterTreeStatistics statistics() const;
+
 private:
   shared_ptr<ClusterTreeNode<N>>
   initializeClusterTree(const Geometry &geometry);
   void splitClusterTreeByGeometry(const Geometry &geometry,
                                   DofPermutation &dofPermutation,
-                                  int minBlockSize);
+                                  int minBlockSize,
+                                  ClusterSplittingStrategy strategy);
+  static void splitClusterTreeNode(
+      const shared_ptr<ClusterTreeNode<N>> &clusterTreeNode,
+      const Geometry &geometry, IndexSetType &indexSet, int minBlockSize,
+      ClusterSplittingStrategy strategy);
 
   shared_ptr<ClusterTreeNode<N>> m_root;
   DofPermutation m_dofPermutation;
@@ -11,6 +11,9 @@
 
 #include "cluster_tree.hpp"
 
+#include <tbb/task_group.h>
+#include <armadillo>
+#include <algorithm>
 #include <functional>
 #include <cassert>
 
@@ -21,11 +24,13 @@ inline ClusterTreeNodeData::ClusterTreeNodeData(
     : indexRange(indexRange), boundingBox(boundingBox) {}
 
 template <int N>
-ClusterTree<N>::ClusterTree(const Geometry &geometry, int minBlockSize)
+ClusterTree<N>::ClusterTree(const Geometry &geometry, int minBlockSize,
+                            ClusterSplittingStrategy strategy)
     : m_root(initializeClusterTree(geometry)),
       m_dofPermutation(geometry.size()) {
 
-  splitClusterTreeByGeometry(geometry, m_dofPermutation, minBlockSize);
+  splitClusterTreeByGeometry(geometry, m_dofPermutation, minBlockSize,
+                             strategy);
 }
 
 template <int N> std::size_t ClusterTree<N>::numberOfDofs() const {
@@ -67,96 +72,225 @@ ClusterTree<N>::originalDofToHMatDofMap() const {
   return m_dofPermutation.originalDofToHMatDofMap();
 }
 
-template <>
-inline void
-ClusterTree<2>::splitClusterTreeByGeometry(const Geometry &geometry,
-                                           DofPermutation &dofPermutation,
-                                           int minBlockSize) {
-
-  std::function<void(const shared_ptr<ClusterTreeNode<2>> & clusterTreeNode,
-                     const IndexSetType & indexSet)> splittingFun;
-
-  splittingFun = [&dofPermutation, &geometry, minBlockSize, &splittingFun](
-      const shared_ptr<ClusterTreeNode<2>> &clusterTreeNode,
-      const IndexSetType &indexSet) {
-
-    std::size_t indexSetSize = indexSet.size();
-
-    assert(indexSetSize == clusterTreeNode->data().indexRange[1] -
-                               clusterTreeNode->data().indexRange[0]);
-
-    if (indexSetSize > minBlockSize) {
+// Clusters with more indices than this are split in a separate TBB task.
+const std::size_t PARALLEL_SPLITTING_THRESHOLD = 4096;
 
-      IndexSetType firstIndexSet;
-      IndexSetType secondIndexSet;
+// Number of times the bounding box of a cluster is halved in search of a
+// plane with element centers on both sides before GEOMETRIC_BISECTION falls
+// back to a median split.
+const int MAX_BISECTION_ATTEMPTS = 64;
 
-      // Figure out the right dim
-
-      assert(clusterTreeNode->data().boundingBox.diameter() != 0);
-
-      auto dim = clusterTreeNode->data().boundingBox.maxDimension();
-
-      auto bounds = clusterTreeNode->data().boundingBox.bounds();
-      auto boxes = clusterTreeNode->data().boundingBox.divide(dim, .5);
-
-      auto firstBoundingBox = boxes.first;
-      auto secondBoundingBox = boxes.second;
-
-      auto ubound = firstBoundingBox.bounds()[2 * dim + 1];
+inline BoundingBox centerBoundingBox(IndexSetType::const_iterator begin,
+                                     IndexSetType::const_iterator end,
+                                     const Geometry &geometry) {
+  BoundingBox b;
+  for (auto it = begin; it != end; ++it) {
+    const auto &center = geometry[*it]->center;
+    b.merge(BoundingBox(center[0], center[0], center[1], center[1], center[2],
+                        center[2]));
+  }
+  return b;
+}
 
-      for (auto index : indexSet) {
-        auto centerValue = geometry[index]->center[dim];
-        if (centerValue < ubound)
-          firstIndexSet.push_back(index);
-        else
-          secondIndexSet.push_back(index);
-      }
+// Partition [begin, end) by the plane bisecting boundingBox along its
+// longest side. If all centers lie on one side, continue with that half of
+// the box. Returns end if no separating plane was found.
+inline IndexSetType::iterator
+bisectIndexSet(IndexSetType::iterator begin, IndexSetType::iterator end,
+               const Geometry &geometry, BoundingBox boundingBox,
+               BoundingBox &firstBoundingBox, BoundingBox &secondBoundingBox) {
+
+  for (int attempt = 0; attempt < MAX_BISECTION_ATTEMPTS; ++attempt) {
+    auto dim = boundingBox.maxDimension();
+    auto boxes = boundingBox.divide(dim, .5);
+    auto ubound = boxes.first.bounds()[2 * dim + 1];
+
+    auto pivot = std::partition(begin, end, [&geometry, dim, ubound](
+        std::size_t index) { return geometry[index]->center[dim] < ubound; });
+
+    if (pivot == begin)
+      boundingBox = boxes.second;
+    else if (pivot == end)
+      boundingBox = boxes.first;
+    else {
+      firstBoundingBox = boxes.first;
+      secondBoundingBox = boxes.second;
+      return pivot;
+    }
+  }
+  return end;
+}
 
-      if (secondIndexSet.size() == 0) {
-        clusterTreeNode->data().boundingBox = firstBoundingBox;
-        splittingFun(clusterTreeNode, indexSet);
-        return;
-      }
-      if (firstIndexSet.size() == 0) {
-        clusterTreeNode->data().boundingBox = secondBoundingBox;
-        splittingFun(clusterTreeNode, indexSet);
-        return;
-      }
+// Move the lower half of the indices in [begin, end), ordered by the
+// projection of the element centers onto direction, to the front.
+inline IndexSetType::iterator
+medianSplitIndexSet(IndexSetType::iterator begin, IndexSetType::iterator end,
+                    const Geometry &geometry,
+                    const std::array<double, 3> &direction) {
+
+  auto projection = [&geometry, &direction](std::size_t index) {
+    const auto &center = geometry[index]->center;
+    return center[0] * direction[0] + center[1] * direction[1] +
+           center[2] * direction[2];
+  };
+  auto pivot = begin + (end - begin) / 2;
+  std::nth_element(begin, pivot, end,
+                   [&projection](std::size_t first, std::size_t second) {
+    return projection(first) < projection(second);
+  });
+  return pivot;
+}
 
-      auto pivot = firstIndexSet.size();
+inline std::array<double, 3>
+longestSideDirection(IndexSetType::const_iterator begin,
+                     IndexSetType::const_iterator end,
+                     const Geometry &geometry) {
+  std::array<double, 3> direction{{0, 0, 0}};
+  direction[centerBoundingBox(begin, end, geometry).maxDimension()] = 1;
+  return direction;
+}
 
-      IndexRangeType newRangeFirst = clusterTreeNode->data().indexRange;
-      IndexRangeType newRangeSecond = clusterTreeNode->data().indexRange;
+// Eigenvector of the covariance matrix of the element centers belonging to
+// its largest eigenvalue.
+inline std::array<double, 3>
+principalAxisDirection(IndexSetType::const_iterator begin,
+                       IndexSetType::const_iterator end,
+                       const Geometry &geometry) {
+  arma::Col<double> mean(3, arma::fill::zeros);
+  for (auto it = begin; it != end; ++it)
+    for (int i = 0; i < 3; ++i)
+      mean(i) += geometry[*it]->center[i];
+  mean /= static_cast<double>(end - begin);
+
+  arma::Mat<double> covariance(3, 3, arma::fill::zeros);
+  for (auto it = begin; it != end; ++it) {
+    arma::Col<double> d(3);
+    for (int i = 0; i < 3; ++i)
+      d(i) = geometry[*it]->center[i] - mean(i);
+    covariance += d * d.t();
+  }
+
+  arma::Col<double> eigenvalues;
+  arma::Mat<double> eigenvectors;
+  if (!arma::eig_sym(eigenvalues, eigenvectors, covariance))
+    return longestSideDirection(begin, end, geometry);
+  // Eigenvalues are returned in ascending order
+  return std::array<double, 3>{
+      {eigenvectors(0, 2), eigenvectors(1, 2), eigenvectors(2, 2)}};
+}
 
-      newRangeFirst[1] = newRangeSecond[0] = newRangeFirst[0] + pivot;
+template <>
+inline void ClusterTree<2>::splitClusterTreeNode(
+    const shared_ptr<ClusterTreeNode<2>> &clusterTreeNode,
+    const Geometry &geometry, IndexSetType &indexSet, int minBlockSize,
+    ClusterSplittingStrategy strategy) {
+
+  const IndexRangeType indexRange = clusterTreeNode->data().indexRange;
+  auto begin = indexSet.begin() + indexRange[0];
+  auto end = indexSet.begin() + indexRange[1];
+  std::size_t indexSetSize = indexRange[1] - indexRange[0];
+
+  if (indexSetSize <= minBlockSize) {
+    BoundingBox b;
+    for (auto it = begin; it != end; ++it)
+      b.merge(geometry[*it]->boundingBox);
+    clusterTreeNode->data().boundingBox = b;
+    return;
+  }
+
+  // The bounding boxes of the sons only matter for geometric bisection;
+  // all boxes are recomputed from the leaves upwards below.
+  BoundingBox firstBoundingBox;
+  BoundingBox secondBoundingBox;
+  auto pivot = end;
+
+  if (strategy == GEOMETRIC_BISECTION)
+    pivot = bisectIndexSet(begin, end, geometry,
+                           clusterTreeNode->data().boundingBox,
+                           firstBoundingBox, secondBoundingBox);
+  if (strategy == PRINCIPAL_AXIS_SPLIT)
+    pivot = medianSplitIndexSet(begin, end, geometry,
+                                principalAxisDirection(begin, end, geometry));
+  // Also used if no bisecting plane was found (e.g. coincident centers)
+  if (pivot == begin || pivot == end)
+    pivot = medianSplitIndexSet(begin, end, geometry,
+                                longestSideDirection(begin, end, geometry));
+
+  IndexRangeType newRangeFirst = indexRange;
+  IndexRangeType newRangeSecond = indexRange;
+
+  newRangeFirst[1] = newRangeSecond[0] = indexRange[0] + (pivot - begin);
+
+  clusterTreeNode->addChild(
+      ClusterTreeNodeData(newRangeFirst, firstBoundingBox), 0);
+  clusterTreeNode->addChild(
+      ClusterTreeNodeData(newRangeSecond, secondBoundingBox), 1);
+
+  // The sons work on disjoint parts of indexSet
+  if (indexSetSize > PARALLEL_SPLITTING_THRESHOLD) {
+    tbb::task_group group;
+    group.run([&]() {
+      splitClusterTreeNode(clusterTreeNode->child(0), geometry, indexSet,
+                           minBlockSize, strategy);
+    });
+    splitClusterTreeNode(clusterTreeNode->child(1), geometry, indexSet,
+                         minBlockSize, strategy);
+    group.wait();
+  } else {
+    splitClusterTreeNode(clusterTreeNode->child(0), geometry, indexSet,
+                         minBlockSize, strategy);
+    splitClusterTreeNode(clusterTreeNode->child(1), geometry, indexSet,
+                         minBlockSize, strategy);
+  }
+
+  clusterTreeNode->data().boundingBox =
+      clusterTreeNode->child(0)->data().boundingBox;
+  clusterTreeNode->data().boundingBox.merge(
+      clusterTreeNode->child(1)->data().boundingBox);
+}
 
-      clusterTreeNode->addChild(
-          ClusterTreeNodeData(newRangeFirst, firstBoundingBox), 0);
-      clusterTreeNode->addChild(
-          ClusterTreeNodeData(newRangeSecond, secondBoundingBox), 1);
-      splittingFun(clusterTreeNode->child(0), firstIndexSet);
-      splittingFun(clusterTreeNode->child(1), secondIndexSet);
+template <>
+inline void ClusterTree<2>::splitClusterTreeByGeometry(
+    const Geometry &geometry, DofPermutation &dofPermutation, int minBlockSize,
+    ClusterSplittingStrategy strategy) {
 
-      clusterTreeNode->data().boundingBox =
-          clusterTreeNode->child(0)->data().boundingBox;
-      clusterTreeNode->data().boundingBox.merge(
-          clusterTreeNode->child(1)->data().boundingBox);
-    } else {
+  // Each cluster reorders its own range of indexSet in place, so that
+  // afterwards position i holds the original index of H-matrix dof i.
+  IndexSetType indexSet = fillIndexRange(0, geometry.size());
+  splitClusterTreeNode(m_root, geometry, indexSet, minBlockSize, strategy);
 
-      BoundingBox b;
-      for (const auto &elem : indexSet)
-        b.merge(geometry[elem]->boundingBox);
+  for (std::size_t hMatDof = 0; hMatDof < indexSet.size(); ++hMatDof)
+    dofPermutation.addDofIndexPair(indexSet[hMatDof], hMatDof);
+}
 
-      clusterTreeNode->data().boundingBox = b;
-      int originalIndexCount = 0;
-      const auto &indexRange = clusterTreeNode->data().indexRange;
-      for (int hMatDof = indexRange[0]; hMatDof < indexRange[1]; ++hMatDof) {
-        dofPermutation.addDofIndexPair(indexSet[originalIndexCount], hMatDof);
-        ++originalIndexCount;
-      }
+template <int N>
+ClusterTreeStatistics ClusterTree<N>::statistics() const {
+
+  ClusterTreeStatistics result;
+  result.depth = 0;
+  result.numberOfLeaves = 0;
+
+  std::function<void(const ClusterTreeNode<N> &, std::size_t)> visit;
+  visit = [&result, &visit](const ClusterTreeNode<N> &node,
+                            std::size_t depth) {
+    if (!node.isLeaf()) {
+      for (int i = 0; i < N; ++i)
+        visit(*node.child(i), depth + 1);
+      return;
     }
+    const auto &indexRange = node.data().indexRange;
+    std::size_t size = indexRange[1] - indexRange[0];
+    ++result.numberOfLeaves;
+    result.depth = std::max(result.depth, depth);
+    if (result.leafSizeHistogram.size() <= size)
+      result.leafSizeHistogram.resize(size + 1, 0);
+    ++result.leafSizeHistogram[size];
+    if (result.leafDepthHistogram.size() <= depth)
+      result.leafDepthHistogram.resize(depth + 1, 0);
+    ++result.leafDepthHistogram[depth];
   };
-  splittingFun(m_root, fillIndexRange(0, geometry.size()));
+  visit(*m_root, 0);
+  return result;
 }
 
 template <int N>
@@ -175,7 +309,8 @@ template <int N>
 std::vector<shared_ptr<const ClusterTreeNode<N>>>
 ClusterTree<N>::leafNodes() const {
 
-  return m_root->leafNodes;
+  const ClusterTreeNode<N> &root = *m_root;
+  return root.leafNodes();
 }
 
 template <int N>
@@ -4,6 +4,7 @@
 #define HMAT_COMPRESSED_MATRIX_HPP
 
 #include "common.hpp"
+#include "hmatrix_statistics.hpp"
 #include <armadillo>
 
 namespace hmat {
@@ -24,6 +25,14 @@ public:
   virtual void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
                      TransposeMode trans, ValueType alpha,
                      ValueType beta) const = 0;
+
+  /** \brief Memory taken by the compressed matrix. */
+  virtual double memSizeKb() const = 0;
+
+  /** \brief Memory and compression statistics of the matrix, listing its
+   *  \p numberOfLargestBlocks largest blocks. */
+  virtual HMatrixStatistics
+  statistics(std::size_t numberOfLargestBlocks) const = 0;
 };
 }
 
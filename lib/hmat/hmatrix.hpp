@@ -9,7 +9,7 @@
 #include "data_accessor.hpp"
 #include "compressed_matrix.hpp"
 #include <armadillo>
-#include <unordered_map>
+#include <vector>
 
 namespace hmat {
 
@@ -32,6 +32,26 @@ public:
   bool isInitialized() const;
   void reset();
 
+  shared_ptr<const BlockClusterTree<N>> blockClusterTree() const;
+  /** \brief Data of leaf \p leafIndex of the block cluster tree. */
+  shared_ptr<const HMatrixData<ValueType>>
+  leafData(std::size_t leafIndex) const;
+
+  double memSizeKb() const override;
+  HMatrixStatistics statistics(std::size_t numberOfLargestBlocks) const
+      override;
+  /** \brief Statistics of all leaf blocks, ordered by leaf index. */
+  std::vector<HMatrixBlockStatistics> blockStatistics() const;
+
+  /** \brief Estimate the relative error of each low-rank block.
+   *
+   *  \p sampleCount columns of each low-rank block are evaluated exactly
+   *  by \p dataAccessor and compared with the stored approximation. The
+   *  estimates are reported by blockStatistics() and statistics(); they are
+   *  discarded by initialize() and reset(). */
+  void estimateBlockErrors(const DataAccessor<ValueType, N> &dataAccessor,
+                           std::size_t sampleCount = 4);
+
   void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
@@ -45,8 +65,10 @@ public:
 
 private:
   shared_ptr<BlockClusterTree<N>> m_blockClusterTree;
-  std::unordered_map<shared_ptr<BlockClusterTreeNode<N>>,
-                     shared_ptr<HMatrixData<ValueType>>> m_hMatrixData;
+  // Element i holds the data of leaf i of the block cluster tree.
+  std::vector<shared_ptr<HMatrixData<ValueType>>> m_hMatrixData;
+  // Element i holds the estimated error of leaf i; empty if not estimated.
+  std::vector<double> m_blockErrorEstimates;
 };
 }
 
@@ -7,16 +7,41 @@
 #include "hmatrix_compressor.hpp"
 #include "hmatrix_dense_compressor.hpp"
 #include "data_accessor.hpp"
+#include <mutex>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace hmat {
 
+/** \brief Row pivots chosen by ACA for the admissible blocks of a block
+ *  cluster tree.
+ *
+ *  The pivots are keyed by the leaf index of the block, so a pivot memory may
+ *  only be reused together with the tree for which it was filled. Reusing it
+ *  for a matrix with similar structure (e.g. the same operator at a nearby
+ *  wavenumber) lets ACA start from rows that are known to be good pivots
+ *  instead of from random rows. */
+template <int N> class AcaPivotMemory {
+public:
+  bool rowPivots(const BlockClusterTreeNode<N> &blockClusterTreeNode,
+                 std::vector<std::size_t> &rows) const;
+  void storeRowPivots(const BlockClusterTreeNode<N> &blockClusterTreeNode,
+                      const std::vector<std::size_t> &rows);
+  void clear();
+
+private:
+  mutable std::mutex m_mutex;
+  std::unordered_map<std::size_t, std::vector<std::size_t>> m_rowPivots;
+};
+
 template <typename ValueType, int N>
 class HMatrixAcaCompressor : public HMatrixCompressor<ValueType, N> {
 public:
   HMatrixAcaCompressor(const DataAccessor<ValueType, N> &dataAccessor,
                        double eps, unsigned int maxRank,
-                       unsigned int resizeThreshold = 10);
+                       unsigned int resizeThreshold = 10,
+                       AcaPivotMemory<N> *pivotMemory = nullptr);
 
   void compressBlock(const BlockClusterTreeNode<N> &blockClusterTreeNode,
                      shared_ptr<HMatrixData<ValueType>> &hMatrixData) const
@@ -36,6 +61,7 @@ private:
   double m_eps;
   unsigned int m_maxRank;
   unsigned int m_resizeThreshold;
+  AcaPivotMemory<N> *m_pivotMemory;
   HMatrixDenseCompressor<ValueType, N> m_hMatrixDenseCompressor;
 };
 }
@@ -13,6 +13,31 @@
 
 namespace hmat {
 
+template <int N>
+bool AcaPivotMemory<N>::rowPivots(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode,
+    std::vector<std::size_t> &rows) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_rowPivots.find(blockClusterTreeNode.leafIndex());
+  if (it == m_rowPivots.end())
+    return false;
+  rows = it->second;
+  return true;
+}
+
+template <int N>
+void AcaPivotMemory<N>::storeRowPivots(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode,
+    const std::vector<std::size_t> &rows) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rowPivots[blockClusterTreeNode.leafIndex()] = rows;
+}
+
+template <int N> void AcaPivotMemory<N>::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rowPivots.clear();
+}
+
 template <typename ValueType, int N>
 void HMatrixAcaCompressor<ValueType, N>::compressBlock(
     const BlockClusterTreeNode<N> &blockClusterTreeNode,
@@ -54,9 +79,31 @@ void HMatrixAcaCompressor<ValueType, N>::compressBlock(
 
   std::size_t sizeMultiplier = 0;
 
+  // Rows that served as pivots in a previous compression of this block are
+  // tried first; random rows are only drawn once they are used up.
+  // The cursor only advances past rows that were accepted as pivots or can
+  // no longer be used, so rejected (zero) rows do not shift the list.
+  std::vector<std::size_t> warmStartRows;
+  std::vector<std::size_t> pivotRows;
+  std::size_t warmStartCursor = 0;
+  if (m_pivotMemory)
+    m_pivotMemory->rowPivots(blockClusterTreeNode, warmStartRows);
+
   for (int i = 0; i < iterationLimit; ++i) {
 
-    std::size_t row = randomIndex(rowClusterRange, previousRowIndices);
+    while (warmStartCursor < warmStartRows.size() &&
+           (warmStartRows[warmStartCursor] < rowClusterRange[0] ||
+            warmStartRows[warmStartCursor] >= rowClusterRange[1] ||
+            previousRowIndices.count(warmStartRows[warmStartCursor])))
+      ++warmStartCursor;
+
+    std::size_t row;
+    const bool warmStart = warmStartCursor < warmStartRows.size();
+    if (warmStart) {
+      row = warmStartRows[warmStartCursor];
+      previousRowIndices.insert(row);
+    } else
+      row = randomIndex(rowClusterRange, previousRowIndices);
 
     // Compute complete row
 
@@ -101,6 +148,9 @@ void HMatrixAcaCompressor<ValueType, N>::compressBlock(
 
     A.col(rankCount) = newCol;
     B.row(rankCount) = newRow;
+    pivotRows.push_back(row);
+    if (warmStart)
+      ++warmStartCursor;
 
     rankCount++;
 
@@ -111,14 +161,17 @@ void HMatrixAcaCompressor<ValueType, N>::compressBlock(
     A.shed_cols(rankCount, A.n_cols - 1);
     B.shed_rows(rankCount, B.n_rows - 1);
   }
+  if (m_pivotMemory)
+    m_pivotMemory->storeRowPivots(blockClusterTreeNode, pivotRows);
 }
 
 template <typename ValueType, int N>
 HMatrixAcaCompressor<ValueType, N>::HMatrixAcaCompressor(
     const DataAccessor<ValueType, N> &dataAccessor, double eps,
-    unsigned int maxRank, unsigned int resizeThreshold)
+    unsigned int maxRank, unsigned int resizeThreshold,
+    AcaPivotMemory<N> *pivotMemory)
     : m_dataAccessor(dataAccessor), m_eps(eps), m_maxRank(maxRank),
-      m_resizeThreshold(resizeThreshold),
+      m_resizeThreshold(resizeThreshold), m_pivotMemory(pivotMemory),
       m_hMatrixDenseCompressor(dataAccessor) {}
 
 template <typename ValueType, int N>
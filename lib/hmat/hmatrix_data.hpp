@@ -9,6 +9,11 @@
 
 namespace hmat {
 
+enum DataBlockType {
+  DENSE,
+  LOW_RANK_AB
+};
+
 template <typename ValueType> class HMatrixData {
 public:
   virtual void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
@@ -26,6 +31,8 @@ public:
   virtual typename ScalarTraits<ValueType>::RealType frobeniusNorm() const = 0;
 
   virtual double memSizeKb() const = 0;
+
+  virtual DataBlockType type() const = 0;
 };
 }
 
@@ -31,6 +31,8 @@ public:
 
   double memSizeKb() const override;
 
+  DataBlockType type() const override;
+
 private:
   arma::Mat<ValueType> m_A;
 };
@@ -76,5 +76,10 @@ template <typename ValueType>
 double HMatrixDenseData<ValueType>::memSizeKb() const {
   return sizeof(ValueType) * (this->rows()) * (this->cols()) / (1.0 * 1024);
 }
+
+template <typename ValueType>
+DataBlockType HMatrixDenseData<ValueType>::type() const {
+  return DENSE;
+}
 }
 #endif
@@ -8,6 +8,7 @@
 #include "hmatrix_dense_data.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 namespace hmat {
 
@@ -40,14 +41,14 @@ void HMatrix<ValueType, N>::initialize(
 
   reset();
 
-  for (auto node : m_blockClusterTree->leafNodes()) {
-    shared_ptr<HMatrixData<ValueType>> nodeData;
-    hMatrixCompressor.compressBlock(*node, nodeData);
-    m_hMatrixData[node] = nodeData;
-  }
+  const auto &leafNodes = m_blockClusterTree->leafNodes();
+  m_hMatrixData.resize(leafNodes.size());
+  for (std::size_t i = 0; i < leafNodes.size(); ++i)
+    hMatrixCompressor.compressBlock(*leafNodes[i], m_hMatrixData[i]);
 }
 template <typename ValueType, int N> void HMatrix<ValueType, N>::reset() {
   m_hMatrixData.clear();
+  m_blockErrorEstimates.clear();
 }
 
 template <typename ValueType, int N>
@@ -55,6 +56,131 @@ bool HMatrix<ValueType, N>::isInitialized() const {
   return (!m_hMatrixData.empty());
 }
 
+template <typename ValueType, int N>
+shared_ptr<const BlockClusterTree<N>>
+HMatrix<ValueType, N>::blockClusterTree() const {
+  return m_blockClusterTree;
+}
+
+template <typename ValueType, int N>
+shared_ptr<const HMatrixData<ValueType>>
+HMatrix<ValueType, N>::leafData(std::size_t leafIndex) const {
+  return m_hMatrixData.at(leafIndex);
+}
+
+template <typename ValueType, int N>
+double HMatrix<ValueType, N>::memSizeKb() const {
+  double result = 0;
+  for (std::size_t i = 0; i < m_hMatrixData.size(); ++i)
+    result += m_hMatrixData[i]->memSizeKb();
+  return result;
+}
+
+template <typename ValueType, int N>
+std::vector<HMatrixBlockStatistics>
+HMatrix<ValueType, N>::blockStatistics() const {
+  const auto &leafNodes = m_blockClusterTree->leafNodes();
+  std::vector<HMatrixBlockStatistics> result(m_hMatrixData.size());
+  for (std::size_t i = 0; i < m_hMatrixData.size(); ++i) {
+    const HMatrixData<ValueType> &data = *m_hMatrixData[i];
+    HMatrixBlockStatistics &block = result[i];
+    block.rowStart =
+        leafNodes[i]->data().rowClusterTreeNode->data().indexRange[0];
+    block.columnStart =
+        leafNodes[i]->data().columnClusterTreeNode->data().indexRange[0];
+    block.rows = data.rows();
+    block.columns = data.cols();
+    block.rank = (data.type() == DENSE) ? -1 : data.rank();
+    block.memSizeKb = data.memSizeKb();
+    block.errorEstimate =
+        m_blockErrorEstimates.empty() ? -1 : m_blockErrorEstimates[i];
+  }
+  return result;
+}
+
+template <typename ValueType, int N>
+HMatrixStatistics
+HMatrix<ValueType, N>::statistics(std::size_t numberOfLargestBlocks) const {
+  std::vector<HMatrixBlockStatistics> blocks = blockStatistics();
+
+  HMatrixStatistics result;
+  result.rows = rows();
+  result.columns = columns();
+  result.memSizeKb = 0;
+  result.denseMemSizeKb =
+      sizeof(ValueType) * (1.0 * result.rows) * result.columns / 1024;
+  result.numberOfDenseBlocks = 0;
+  result.numberOfLowRankBlocks = 0;
+  result.maxErrorEstimate = -1;
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    result.memSizeKb += blocks[i].memSizeKb;
+    if (blocks[i].rank < 0)
+      ++result.numberOfDenseBlocks;
+    else {
+      ++result.numberOfLowRankBlocks;
+      ++result.rankHistogram[blocks[i].rank];
+    }
+    result.maxErrorEstimate =
+        std::max(result.maxErrorEstimate, blocks[i].errorEstimate);
+  }
+  result.compressionRatio = (result.denseMemSizeKb > 0)
+                                ? result.memSizeKb / result.denseMemSizeKb
+                                : -1;
+
+  const std::size_t count = std::min(numberOfLargestBlocks, blocks.size());
+  std::partial_sort(blocks.begin(), blocks.begin() + count, blocks.end(),
+                    [](const HMatrixBlockStatistics &a,
+                       const HMatrixBlockStatistics &b) {
+    return a.memSizeKb > b.memSizeKb;
+  });
+  result.largestBlocks.assign(blocks.begin(), blocks.begin() + count);
+  return result;
+}
+
+template <typename ValueType, int N>
+void HMatrix<ValueType, N>::estimateBlockErrors(
+    const DataAccessor<ValueType, N> &dataAccessor, std::size_t sampleCount) {
+
+  const auto &leafNodes = m_blockClusterTree->leafNodes();
+  m_blockErrorEstimates.assign(m_hMatrixData.size(), 0.);
+
+  for (std::size_t i = 0; i < m_hMatrixData.size(); ++i) {
+    const HMatrixData<ValueType> &data = *m_hMatrixData[i];
+    if (data.type() == DENSE || data.cols() == 0)
+      continue;
+
+    const IndexRangeType &rowRange =
+        leafNodes[i]->data().rowClusterTreeNode->data().indexRange;
+    const IndexRangeType &columnRange =
+        leafNodes[i]->data().columnClusterTreeNode->data().indexRange;
+    const std::size_t columns = data.cols();
+    const std::size_t samples = std::min(sampleCount, columns);
+
+    // Evaluate evenly spaced columns of the approximation by applying it
+    // to unit vectors
+    arma::Mat<ValueType> unitVectors(columns, samples, arma::fill::zeros);
+    for (std::size_t k = 0; k < samples; ++k)
+      unitVectors(k * columns / samples, k) = 1;
+    arma::Mat<ValueType> approximation(data.rows(), samples);
+    data.apply(unitVectors, approximation, NOTRANS, 1, 0);
+
+    double squaredError = 0;
+    double squaredNorm = 0;
+    arma::Mat<ValueType> exact;
+    for (std::size_t k = 0; k < samples; ++k) {
+      const std::size_t column = columnRange[0] + k * columns / samples;
+      dataAccessor.computeMatrixBlock(rowRange, {{column, column + 1}},
+                                      *leafNodes[i], exact);
+      const double error = arma::norm(exact - approximation.col(k), 2);
+      const double norm = arma::norm(exact, 2);
+      squaredError += error * error;
+      squaredNorm += norm * norm;
+    }
+    m_blockErrorEstimates[i] =
+        (squaredNorm > 0) ? std::sqrt(squaredError / squaredNorm) : 0.;
+  }
+}
+
 template <typename ValueType, int N>
 arma::Mat<ValueType>
 HMatrix<ValueType, N>::permuteMatToHMatDofs(const arma::Mat<ValueType> &mat,
@@ -130,28 +256,26 @@ void HMatrix<ValueType, N>::apply(const arma::Mat<ValueType> &X,
     yPermuted = permuteMatToHMatDofs(Y, COL);
   }
 
-  std::for_each(begin(m_hMatrixData), end(m_hMatrixData),
-                [trans, alpha, beta, &xPermuted, &yPermuted, this](
-                    const std::pair<shared_ptr<BlockClusterTreeNode<N>>,
-                                    shared_ptr<HMatrixData<ValueType>>>
-                        elem) {
+  const auto &leafNodes = m_blockClusterTree->leafNodes();
+  for (std::size_t i = 0; i < m_hMatrixData.size(); ++i) {
+    const BlockClusterTreeNodeData<N> &nodeData = leafNodes[i]->data();
 
     IndexRangeType inputRange;
     IndexRangeType outputRange;
     if (trans == TransposeMode::NOTRANS) {
-      inputRange = elem.first->data().columnClusterTreeNode->data().indexRange;
-      outputRange = elem.first->data().rowClusterTreeNode->data().indexRange;
+      inputRange = nodeData.columnClusterTreeNode->data().indexRange;
+      outputRange = nodeData.rowClusterTreeNode->data().indexRange;
     } else {
-      inputRange = elem.first->data().rowClusterTreeNode->data().indexRange;
-      outputRange = elem.first->data().columnClusterTreeNode->data().indexRange;
+      inputRange = nodeData.rowClusterTreeNode->data().indexRange;
+      outputRange = nodeData.columnClusterTreeNode->data().indexRange;
     }
 
     arma::subview<ValueType> xData =
         xPermuted.rows(inputRange[0], inputRange[1] - 1);
     arma::subview<ValueType> yData =
         yPermuted.rows(outputRange[0], outputRange[1] - 1);
-    elem.second->apply(xData, yData, trans, alpha, 1);
-  });
+    m_hMatrixData[i]->apply(xData, yData, trans, alpha, 1);
+  }
 
   Y = this->permuteMatToOriginalDofs(yPermuted, ROW);
 }
@@ -35,6 +35,8 @@ public:
 
   double memSizeKb() const override;
 
+  DataBlockType type() const override;
+
 private:
   arma::Mat<ValueType> m_A;
   arma::Mat<ValueType> m_B;
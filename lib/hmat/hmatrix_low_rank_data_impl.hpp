@@ -64,6 +64,11 @@ double HMatrixLowRankData<ValueType>::memSizeKb() const {
          (1.0 * 1024);
 }
 
+template <typename ValueType>
+DataBlockType HMatrixLowRankData<ValueType>::type() const {
+  return LOW_RANK_AB;
+}
+
 template <typename ValueType>
 void HMatrixLowRankData<ValueType>::apply(const arma::Mat<ValueType> &X,
                                           arma::Mat<ValueType> &Y,
@@ -0,0 +1,56 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_LOW_RANK_SINGLE_PRECISION_DATA_HPP
+#define HMAT_HMATRIX_LOW_RANK_SINGLE_PRECISION_DATA_HPP
+
+#include "common.hpp"
+#include "hmatrix_data.hpp"
+#include "hmatrix_low_rank_data.hpp"
+#include <armadillo>
+
+namespace hmat {
+
+/** \brief Low-rank block whose factors are stored in single precision.
+ *
+ *  The block acts on and accumulates into vectors of type ValueType; only
+ *  the factors and the (rank-sized) intermediate product use the
+ *  single-precision type. */
+template <typename ValueType>
+class HMatrixLowRankSinglePrecisionData : public HMatrixData<ValueType> {
+
+public:
+  typedef typename ScalarTraits<ValueType>::SinglePrecisionType StorageType;
+
+  explicit HMatrixLowRankSinglePrecisionData(
+      const HMatrixLowRankData<ValueType> &data);
+
+  void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
+             TransposeMode trans, ValueType alpha, ValueType beta) const
+      override;
+
+  void apply(const arma::subview<ValueType> &X, arma::subview<ValueType> &Y,
+             TransposeMode trans, ValueType alpha, ValueType beta) const
+      override;
+
+  const arma::Mat<StorageType> &A() const;
+  const arma::Mat<StorageType> &B() const;
+
+  int rows() const override;
+  int cols() const override;
+  int rank() const override;
+
+  typename ScalarTraits<ValueType>::RealType frobeniusNorm() const override;
+
+  double memSizeKb() const override;
+
+  DataBlockType type() const override;
+
+private:
+  arma::Mat<StorageType> m_A;
+  arma::Mat<StorageType> m_B;
+};
+}
+
+#include "hmatrix_low_rank_single_precision_data_impl.hpp"
+
+#endif
@@ -0,0 +1,113 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_LOW_RANK_SINGLE_PRECISION_DATA_IMPL_HPP
+#define HMAT_HMATRIX_LOW_RANK_SINGLE_PRECISION_DATA_IMPL_HPP
+
+#include "hmatrix_low_rank_single_precision_data.hpp"
+
+#include <cmath>
+
+namespace hmat {
+
+template <typename ValueType>
+HMatrixLowRankSinglePrecisionData<ValueType>::HMatrixLowRankSinglePrecisionData(
+    const HMatrixLowRankData<ValueType> &data)
+    : m_A(arma::conv_to<arma::Mat<StorageType>>::from(data.A())),
+      m_B(arma::conv_to<arma::Mat<StorageType>>::from(data.B())) {}
+
+template <typename ValueType>
+const arma::Mat<typename HMatrixLowRankSinglePrecisionData<
+    ValueType>::StorageType> &
+HMatrixLowRankSinglePrecisionData<ValueType>::A() const {
+  return m_A;
+}
+
+template <typename ValueType>
+const arma::Mat<typename HMatrixLowRankSinglePrecisionData<
+    ValueType>::StorageType> &
+HMatrixLowRankSinglePrecisionData<ValueType>::B() const {
+  return m_B;
+}
+
+template <typename ValueType>
+int HMatrixLowRankSinglePrecisionData<ValueType>::rows() const {
+  return m_A.n_rows;
+}
+
+template <typename ValueType>
+int HMatrixLowRankSinglePrecisionData<ValueType>::cols() const {
+  return m_B.n_cols;
+}
+
+template <typename ValueType>
+int HMatrixLowRankSinglePrecisionData<ValueType>::rank() const {
+  return m_A.n_cols;
+}
+
+template <typename ValueType>
+typename ScalarTraits<ValueType>::RealType
+HMatrixLowRankSinglePrecisionData<ValueType>::frobeniusNorm() const {
+
+  // ||AB||_F^2 = trace((A^H A) (B B^H)), evaluated in full precision
+  arma::Mat<ValueType> A = arma::conv_to<arma::Mat<ValueType>>::from(m_A);
+  arma::Mat<ValueType> B = arma::conv_to<arma::Mat<ValueType>>::from(m_B);
+  arma::Mat<ValueType> aHa = A.t() * A;
+  arma::Mat<ValueType> bbH = B * B.t();
+
+  return std::sqrt(std::abs(std::real(arma::accu(aHa % bbH.st()))));
+}
+
+template <typename ValueType>
+double HMatrixLowRankSinglePrecisionData<ValueType>::memSizeKb() const {
+
+  return sizeof(StorageType) * (this->rows() + this->cols()) * this->rank() /
+         (1.0 * 1024);
+}
+
+template <typename ValueType>
+DataBlockType HMatrixLowRankSinglePrecisionData<ValueType>::type() const {
+  return LOW_RANK_AB;
+}
+
+template <typename ValueType>
+void HMatrixLowRankSinglePrecisionData<ValueType>::apply(
+    const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
+    TransposeMode trans, ValueType alpha, ValueType beta) const {
+
+  arma::subview<ValueType> xsub = X.submat(arma::span::all, arma::span::all);
+  arma::subview<ValueType> ysub = Y.submat(arma::span::all, arma::span::all);
+
+  this->apply(xsub, ysub, trans, alpha, beta);
+}
+
+template <typename ValueType>
+void HMatrixLowRankSinglePrecisionData<ValueType>::apply(
+    const arma::subview<ValueType> &X, arma::subview<ValueType> &Y,
+    TransposeMode trans, ValueType alpha, ValueType beta) const {
+  if (beta == ValueType(0))
+    Y.zeros();
+  if (alpha == ValueType(0)) {
+    Y = beta * Y;
+    return;
+  }
+
+  // The block product is formed in single precision; the result is added
+  // to Y, and hence accumulated over blocks, in full precision.
+  const arma::Mat<StorageType> x =
+      arma::conv_to<arma::Mat<StorageType>>::from(X);
+  arma::Mat<StorageType> z;
+
+  if (trans == TransposeMode::NOTRANS)
+    z = m_A * (m_B * x);
+  else if (trans == TransposeMode::TRANS)
+    z = m_B.st() * (m_A.st() * x);
+  else if (trans == TransposeMode::CONJ)
+    z = arma::conj(m_A) * (arma::conj(m_B) * x);
+  else
+    z = m_B.t() * (m_A.t() * x);
+
+  Y = alpha * arma::conv_to<arma::Mat<ValueType>>::from(z) + beta * Y;
+}
+}
+
+#endif
@@ -0,0 +1,61 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_MIXED_PRECISION_COMPRESSOR_HPP
+#define HMAT_HMATRIX_MIXED_PRECISION_COMPRESSOR_HPP
+
+#include "common.hpp"
+#include "hmatrix_compressor.hpp"
+#include <mutex>
+
+namespace hmat {
+
+/** \brief Summary of the blocks converted by an
+ *  HMatrixMixedPrecisionCompressor. */
+struct MixedPrecisionStatistics {
+  /** \brief Number of low-rank blocks stored in single precision. */
+  std::size_t numberOfBlocks;
+  /** \brief Memory the converted blocks would take in full precision. */
+  double fullPrecisionMemSizeKb;
+  /** \brief Memory actually taken by the converted blocks. */
+  double storedMemSizeKb;
+  /** \brief Relative Frobenius-norm error introduced by rounding the
+   *  converted blocks to single precision, measured over all of them
+   *  together.
+   *
+   *  This is the difference between the low-rank blocks before and after
+   *  the conversion; it does not include the error of the compression
+   *  itself with respect to the underlying operator. */
+  double roundingRelativeError;
+};
+
+/** \brief Compressor storing the low-rank blocks produced by another
+ *  compressor in single precision.
+ *
+ *  Dense (inadmissible) blocks are kept in full precision. */
+template <typename ValueType, int N>
+class HMatrixMixedPrecisionCompressor : public HMatrixCompressor<ValueType, N> {
+public:
+  HMatrixMixedPrecisionCompressor(
+      const HMatrixCompressor<ValueType, N> &compressor);
+
+  void compressBlock(const BlockClusterTreeNode<N> &blockClusterTreeNode,
+                     shared_ptr<HMatrixData<ValueType>> &hMatrixData) const
+      override;
+
+  MixedPrecisionStatistics statistics() const;
+
+private:
+  const HMatrixCompressor<ValueType, N> &m_compressor;
+
+  mutable std::mutex m_mutex;
+  mutable std::size_t m_numberOfBlocks;
+  mutable double m_fullPrecisionMemSizeKb;
+  mutable double m_storedMemSizeKb;
+  mutable double m_squaredError;
+  mutable double m_squaredNorm;
+};
+}
+
+#include "hmatrix_mixed_precision_compressor_impl.hpp"
+
+#endif
@@ -0,0 +1,77 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_MIXED_PRECISION_COMPRESSOR_IMPL_HPP
+#define HMAT_HMATRIX_MIXED_PRECISION_COMPRESSOR_IMPL_HPP
+
+#include "hmatrix_mixed_precision_compressor.hpp"
+#include "hmatrix_low_rank_data.hpp"
+#include "hmatrix_low_rank_single_precision_data.hpp"
+#include "scalar_traits.hpp"
+
+#include <cmath>
+
+namespace hmat {
+
+template <typename ValueType, int N>
+HMatrixMixedPrecisionCompressor<ValueType, N>::HMatrixMixedPrecisionCompressor(
+    const HMatrixCompressor<ValueType, N> &compressor)
+    : m_compressor(compressor), m_numberOfBlocks(0),
+      m_fullPrecisionMemSizeKb(0), m_storedMemSizeKb(0), m_squaredError(0),
+      m_squaredNorm(0) {}
+
+template <typename ValueType, int N>
+void HMatrixMixedPrecisionCompressor<ValueType, N>::compressBlock(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode,
+    shared_ptr<HMatrixData<ValueType>> &hMatrixData) const {
+
+  m_compressor.compressBlock(blockClusterTreeNode, hMatrixData);
+
+  auto lowRankData =
+      boost::dynamic_pointer_cast<HMatrixLowRankData<ValueType>>(hMatrixData);
+  if (!lowRankData || lowRankData->rank() == 0)
+    return;
+
+  shared_ptr<HMatrixLowRankSinglePrecisionData<ValueType>> singlePrecisionData(
+      new HMatrixLowRankSinglePrecisionData<ValueType>(*lowRankData));
+
+  // Rounding error ||AB - A'B'||_F of the block, written as the product
+  // [A, -A'] [B; B'] and evaluated as in frobeniusNorm().
+  const arma::Mat<ValueType> &A = lowRankData->A();
+  const arma::Mat<ValueType> &B = lowRankData->B();
+  arma::Mat<ValueType> D = arma::join_rows(
+      A, -arma::conv_to<arma::Mat<ValueType>>::from(singlePrecisionData->A()));
+  arma::Mat<ValueType> E = arma::join_cols(
+      B, arma::conv_to<arma::Mat<ValueType>>::from(singlePrecisionData->B()));
+  arma::Mat<ValueType> dHd = D.t() * D;
+  arma::Mat<ValueType> eeH = E * E.t();
+  const double squaredError =
+      std::abs(std::real(arma::accu(dHd % eeH.st())));
+  const double norm = lowRankData->frobeniusNorm();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_numberOfBlocks;
+    m_fullPrecisionMemSizeKb += lowRankData->memSizeKb();
+    m_storedMemSizeKb += singlePrecisionData->memSizeKb();
+    m_squaredError += squaredError;
+    m_squaredNorm += norm * norm;
+  }
+
+  hMatrixData = singlePrecisionData;
+}
+
+template <typename ValueType, int N>
+MixedPrecisionStatistics
+HMatrixMixedPrecisionCompressor<ValueType, N>::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  MixedPrecisionStatistics result;
+  result.numberOfBlocks = m_numberOfBlocks;
+  result.fullPrecisionMemSizeKb = m_fullPrecisionMemSizeKb;
+  result.storedMemSizeKb = m_storedMemSizeKb;
+  result.roundingRelativeError =
+      (m_squaredNorm > 0) ? std::sqrt(m_squaredError / m_squaredNorm) : 0.;
+  return result;
+}
+}
+
+#endif
@@ -0,0 +1,55 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_STATISTICS_HPP
+#define HMAT_HMATRIX_STATISTICS_HPP
+
+#include "common.hpp"
+#include <map>
+#include <vector>
+
+namespace hmat {
+
+/** \brief Description of a single leaf block of an H-matrix. */
+struct HMatrixBlockStatistics {
+  /** \brief First row of the block (in H-matrix dof ordering). */
+  std::size_t rowStart;
+  /** \brief First column of the block (in H-matrix dof ordering). */
+  std::size_t columnStart;
+  std::size_t rows;
+  std::size_t columns;
+  /** \brief Rank of a low-rank block, -1 for a dense block. */
+  int rank;
+  double memSizeKb;
+  /** \brief Estimated relative Frobenius-norm error of the block, or -1 if
+   *  no estimate has been computed.
+   *
+   *  \see HMatrix::estimateBlockErrors() */
+  double errorEstimate;
+};
+
+/** \brief Aggregate memory and compression statistics of an H-matrix. */
+struct HMatrixStatistics {
+  std::size_t rows;
+  std::size_t columns;
+  /** \brief Memory taken by the blocks of the H-matrix. */
+  double memSizeKb;
+  /** \brief Memory a dense matrix of the same size would take.
+   *
+   *  Always available; zero only if the matrix has no rows or columns. */
+  double denseMemSizeKb;
+  /** \brief Ratio memSizeKb / denseMemSizeKb, or -1 if denseMemSizeKb is
+   *  zero. */
+  double compressionRatio;
+  std::size_t numberOfDenseBlocks;
+  std::size_t numberOfLowRankBlocks;
+  /** \brief Number of low-rank blocks of each rank. */
+  std::map<int, std::size_t> rankHistogram;
+  /** \brief Blocks taking the most memory, in decreasing order of memory. */
+  std::vector<HMatrixBlockStatistics> largestBlocks;
+  /** \brief Largest estimated relative error of a block, or -1 if no
+   *  estimates have been computed. */
+  double maxErrorEstimate;
+};
+}
+
+#endif
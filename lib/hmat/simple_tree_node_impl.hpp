@@ -80,20 +80,22 @@ template <typename T, int N>
 const std::vector<shared_ptr<const SimpleTreeNode<T, N>>>
 SimpleTreeNode<T, N>::leafNodes() const {
 
-  std::function<void(SimpleTreeNode<T, N> &)> getLeafsImpl;
+  std::function<void(const SimpleTreeNode<T, N> &)> getLeafsImpl;
 
   std::vector<shared_ptr<const SimpleTreeNode<T, N>>> leafVector;
 
-  getLeafsImpl = [&leafVector, &getLeafsImpl](SimpleTreeNode<T, N> &node) {
+  getLeafsImpl = [&leafVector,
+                  &getLeafsImpl](const SimpleTreeNode<T, N> &node) {
 
     if (node.isLeaf())
-      leafVector.push_back(node);
+      leafVector.push_back(node.shared_from_this());
     else
       for (int i = 0; i < N; ++i)
         getLeafsImpl(*(node.child(i)));
   };
 
   getLeafsImpl(*this);
+  return leafVector;
 }
 
 template <typename T, int N>
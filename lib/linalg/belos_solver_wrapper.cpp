@@ -41,6 +41,9 @@
 #include <boost/type_traits/is_same.hpp>
 #include <boost/utility/enable_if.hpp>
 
+#include <stdexcept>
+#include <string>
+
 namespace Bempp {
 
 // Overloaded template helper functions
@@ -204,6 +207,18 @@ reallySolve(const Thyra::LinearOpWithSolveBase<
   return op.solve(trans, *realRhs, realSol.ptr());
 }
 
+// Return the Block GMRES sublist of paramList, or NULL if another solver is
+// selected
+Teuchos::ParameterList *
+blockGmresParameterList(Teuchos::ParameterList &paramList) {
+  if (!paramList.isParameter("Solver Type") ||
+      paramList.get<std::string>("Solver Type") != "Block GMRES" ||
+      !paramList.isSublist("Solver Types") ||
+      !paramList.sublist("Solver Types").isSublist("Block GMRES"))
+    return 0;
+  return &paramList.sublist("Solver Types").sublist("Block GMRES");
+}
+
 } // namespace
 
 // BelosSolverWrapper member functions
@@ -211,7 +226,7 @@ reallySolve(const Thyra::LinearOpWithSolveBase<
 template <typename ValueType>
 BelosSolverWrapper<ValueType>::BelosSolverWrapper(
     const Teuchos::RCP<const Thyra::LinearOpBase<ValueType>> &linOp)
-    : m_linOp(linOp) {}
+    : m_linOp(linOp), m_automaticBlockSize(false) {}
 
 template <typename ValueType>
 BelosSolverWrapper<ValueType>::~BelosSolverWrapper() {}
@@ -225,8 +240,32 @@ void BelosSolverWrapper<ValueType>::setPreconditioner(const Teuchos::RCP<
 template <typename ValueType>
 void BelosSolverWrapper<ValueType>::initializeSolver(
     const Teuchos::RCP<Teuchos::ParameterList> &paramList) {
+  m_paramList = paramList;
+  m_automaticBlockSize = false;
+  Teuchos::ParameterList *blockGmresList =
+      paramList.is_null() ? 0 : blockGmresParameterList(*paramList);
+  if (blockGmresList && blockGmresList->isParameter("Block Size") &&
+      blockGmresList->get<int>("Block Size") == 0) {
+    // Block size to be chosen by setRhsCount(); Belos requires a positive
+    // one. The caller's list is left untouched so that it can be reused.
+    m_automaticBlockSize = true;
+    m_paramList = Teuchos::rcp(new Teuchos::ParameterList(*paramList));
+    blockGmresParameterList(*m_paramList)->set("Block Size", 1);
+  }
   m_linOpWithSolve =
-      makeOperatorWithSolve(paramList, m_linOp, m_preconditioner);
+      makeOperatorWithSolve(m_paramList, m_linOp, m_preconditioner);
+}
+
+template <typename ValueType>
+void BelosSolverWrapper<ValueType>::setRhsCount(int rhsCount) {
+  if (!m_automaticBlockSize || rhsCount < 1)
+    return;
+  Teuchos::ParameterList *blockGmresList = blockGmresParameterList(*m_paramList);
+  if (blockGmresList->get<int>("Block Size") == rhsCount)
+    return;
+  blockGmresList->set("Block Size", rhsCount);
+  m_linOpWithSolve =
+      makeOperatorWithSolve(m_paramList, m_linOp, m_preconditioner);
 }
 
 template <typename ValueType>
@@ -244,6 +283,15 @@ BelosSolverWrapper<ValueType>::solve(
 
 namespace {
 
+// Measure residuals relative to the right-hand side rather than to the
+// initial residual, so that a solve started from a good initial guess stops
+// as soon as the guess is accurate enough. For a zero initial guess both
+// scalings coincide.
+inline void setRhsResidualScaling(Teuchos::ParameterList &solverList) {
+  solverList.set("Implicit Residual Scaling", "Norm of RHS");
+  solverList.set("Explicit Residual Scaling", "Norm of RHS");
+}
+
 template <typename MagnitudeType>
 Teuchos::RCP<Teuchos::ParameterList> inline defaultGmresParameterListInternal(
     MagnitudeType tol, int maxIterationCount) {
@@ -255,6 +303,7 @@ Teuchos::RCP<Teuchos::ParameterList> inline defaultGmresParameterListInternal(
       solverTypesList.sublist("Pseudo Block GMRES");
   pseudoBlockGmresList.set("Convergence Tolerance", tol);
   pseudoBlockGmresList.set("Maximum Iterations", maxIterationCount);
+  setRhsResidualScaling(pseudoBlockGmresList);
   return paramList;
 }
 
@@ -272,6 +321,45 @@ Teuchos::RCP<Teuchos::ParameterList> inline defaultCgParameterListInternal(
   return paramList;
 }
 
+template <typename MagnitudeType>
+Teuchos::RCP<Teuchos::ParameterList> inline defaultGcrodrParameterListInternal(
+    MagnitudeType tol, int maxIterationCount, int blockCount,
+    int recycledBlockCount) {
+  if (recycledBlockCount < 1 || recycledBlockCount >= blockCount)
+    throw std::invalid_argument("defaultGcrodrParameterList(): "
+                                "recycledBlockCount must be positive and "
+                                "smaller than blockCount");
+  Teuchos::RCP<Teuchos::ParameterList> paramList(
+      new Teuchos::ParameterList("DefaultParameters"));
+  paramList->set("Solver Type", "GCRODR");
+  Teuchos::ParameterList &solverTypesList = paramList->sublist("Solver Types");
+  Teuchos::ParameterList &gcrodrList = solverTypesList.sublist("GCRODR");
+  gcrodrList.set("Convergence Tolerance", tol);
+  gcrodrList.set("Maximum Iterations", maxIterationCount);
+  gcrodrList.set("Num Blocks", blockCount);
+  gcrodrList.set("Num Recycled Blocks", recycledBlockCount);
+  setRhsResidualScaling(gcrodrList);
+  return paramList;
+}
+
+template <typename MagnitudeType>
+Teuchos::RCP<Teuchos::ParameterList> inline defaultBlockGmresParameterListInternal(
+    MagnitudeType tol, int maxIterationCount, int blockSize) {
+  if (blockSize < 0)
+    throw std::invalid_argument("defaultBlockGmresParameterList(): "
+                                "blockSize must not be negative");
+  Teuchos::RCP<Teuchos::ParameterList> paramList(
+      new Teuchos::ParameterList("DefaultParameters"));
+  paramList->set("Solver Type", "Block GMRES");
+  Teuchos::ParameterList &solverTypesList = paramList->sublist("Solver Types");
+  Teuchos::ParameterList &blockGmresList =
+      solverTypesList.sublist("Block GMRES");
+  blockGmresList.set("Convergence Tolerance", tol);
+  blockGmresList.set("Maximum Iterations", maxIterationCount);
+  blockGmresList.set("Block Size", blockSize);
+  return paramList;
+}
+
 } // namespace
 
 Teuchos::RCP<Teuchos::ParameterList>
@@ -294,6 +382,34 @@ defaultCgParameterList(float tol, int maxIterationCount) {
   return defaultCgParameterListInternal(tol, maxIterationCount);
 }
 
+Teuchos::RCP<Teuchos::ParameterList>
+defaultGcrodrParameterList(double tol, int maxIterationCount, int blockCount,
+                           int recycledBlockCount) {
+  return defaultGcrodrParameterListInternal(tol, maxIterationCount, blockCount,
+                                            recycledBlockCount);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultGcrodrParameterList(float tol, int maxIterationCount, int blockCount,
+                           int recycledBlockCount) {
+  return defaultGcrodrParameterListInternal(tol, maxIterationCount, blockCount,
+                                            recycledBlockCount);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(double tol, int maxIterationCount,
+                               int blockSize) {
+  return defaultBlockGmresParameterListInternal(tol, maxIterationCount,
+                                                blockSize);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(float tol, int maxIterationCount,
+                               int blockSize) {
+  return defaultBlockGmresParameterListInternal(tol, maxIterationCount,
+                                                blockSize);
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(BelosSolverWrapper);
 
 } // namespace Bempp
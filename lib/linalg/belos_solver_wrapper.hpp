@@ -49,6 +49,13 @@ public:
 
   void initializeSolver(const Teuchos::RCP<Teuchos::ParameterList> &paramList);
 
+  /** \brief Adapt the solver to \p rhsCount right-hand sides.
+   *
+   *  If the solver was initialized with a Block GMRES parameter list of
+   *  block size 0, set the block size to \p rhsCount, rebuilding the solver
+   *  if necessary. Otherwise do nothing. */
+  void setRhsCount(int rhsCount);
+
   Thyra::SolveStatus<MagnitudeType>
   solve(const Thyra::EOpTransp trans,
         const Thyra::MultiVectorBase<ValueType> &rhs,
@@ -57,6 +64,8 @@ public:
 private:
   Teuchos::RCP<const Thyra::LinearOpBase<ValueType>> m_linOp;
   Teuchos::RCP<const Thyra::PreconditionerBase<ValueType>> m_preconditioner;
+  Teuchos::RCP<Teuchos::ParameterList> m_paramList;
+  bool m_automaticBlockSize;
   Teuchos::RCP<const Thyra::LinearOpWithSolveBase<MagnitudeType>>
   m_linOpWithSolve;
 };
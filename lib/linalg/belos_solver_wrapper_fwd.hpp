@@ -23,6 +23,35 @@ defaultGmresParameterList(float tol, int maxIterationCount = 1000);
 Teuchos::RCP<Teuchos::ParameterList>
 defaultCgParameterList(float tol, int maxIterationCount = 1000);
 
+/** \brief Parameter list selecting the GCRO-DR solver of Belos.
+ *
+ *  GCRO-DR is a restarted GMRES variant that keeps a subspace of
+ *  approximate eigenvectors (\p recycledBlockCount vectors) across restarts
+ *  and across consecutive solves with the same operator, which typically
+ *  reduces the iteration counts of sequences of related right-hand sides.
+ *  \p blockCount is the maximum dimension of the Krylov subspace before a
+ *  restart. */
+Teuchos::RCP<Teuchos::ParameterList>
+defaultGcrodrParameterList(double tol, int maxIterationCount = 1000,
+                           int blockCount = 50, int recycledBlockCount = 10);
+Teuchos::RCP<Teuchos::ParameterList>
+defaultGcrodrParameterList(float tol, int maxIterationCount = 1000,
+                           int blockCount = 50, int recycledBlockCount = 10);
+
+/** \brief Parameter list selecting the Block GMRES solver of Belos.
+ *
+ *  Block GMRES builds a single Krylov subspace for \p blockSize right-hand
+ *  sides at a time and applies the operator to all of them at once; it is
+ *  intended for use with Solver::solveMultipleRhs(). If \p blockSize is 0
+ *  (default), DefaultIterativeSolver::solveMultipleRhs() sets it to the
+ *  number of right-hand sides. */
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(double tol, int maxIterationCount = 1000,
+                               int blockSize = 0);
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(float tol, int maxIterationCount = 1000,
+                               int blockSize = 0);
+
 } // namespace Bempp
 
 #endif // WITH_TRILINOS
@@ -28,8 +28,8 @@ template <typename BasisFunctionType, typename ResultType>
 BlockedSolution<BasisFunctionType, ResultType>::BlockedSolution(
     const std::vector<GridFunction<BasisFunctionType, ResultType>> &
         gridFunctions,
-    const Thyra::SolveStatus<MagnitudeType> status)
-    : Base(status), m_gridFunctions(gridFunctions) {}
+    const Thyra::SolveStatus<MagnitudeType> status, double solveTime)
+    : Base(status, solveTime), m_gridFunctions(gridFunctions) {}
 #endif // WITH_TRILINOS
 
 template <typename BasisFunctionType, typename ResultType>
@@ -47,7 +47,8 @@ public:
   BlockedSolution(
       const std::vector<GridFunction<BasisFunctionType, ResultType>> &
           gridFunctions,
-      const Thyra::SolveStatus<MagnitudeType> status);
+      const Thyra::SolveStatus<MagnitudeType> status,
+      double solveTime = -1.);
 #endif // WITH_TRILINOS
   /** \brief Constructor */
   BlockedSolution(
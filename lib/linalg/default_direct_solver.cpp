@@ -133,6 +133,43 @@ DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplBlocked(
       "Solver finished");
 }
 
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType>>
+DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplMultipleRhs(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+  typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+
+  const BoundaryOp *boundaryOp = boost::get<BoundaryOp>(&m_impl->op);
+  if (!boundaryOp)
+    throw std::logic_error(
+        "DefaultDirectSolver::solveMultipleRhs(): not supported for solvers "
+        "constructed from a BlockedBoundaryOperator");
+  for (size_t i = 0; i < rhs.size(); ++i)
+    Solver<BasisFunctionType, ResultType>::checkConsistency(
+        *boundaryOp, rhs[i],
+        ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+
+  // Solve for all right-hand sides with a single factorisation
+  arma::Mat<ResultType> armaRhs(boundaryOp->dualToRange()->globalDofCount(),
+                                rhs.size());
+  for (size_t i = 0; i < rhs.size(); ++i)
+    armaRhs.col(i) = rhs[i].projections(boundaryOp->dualToRange());
+  arma::Mat<ResultType> armaSolution =
+      arma::solve(boundaryOp->weakForm()->asMatrix(), armaRhs);
+
+  std::vector<Solution<BasisFunctionType, ResultType>> result;
+  result.reserve(rhs.size());
+  for (size_t i = 0; i < rhs.size(); ++i)
+    result.push_back(Solution<BasisFunctionType, ResultType>(
+        GridFunction<BasisFunctionType, ResultType>(
+            boundaryOp->context(), boundaryOp->domain(),
+            arma::Col<ResultType>(armaSolution.col(i))),
+        SolutionStatus::CONVERGED,
+        SolutionBase<BasisFunctionType, ResultType>::unknownTolerance(),
+        "Solver finished"));
+  return result;
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DefaultDirectSolver);
 
 } // namespace Bempp
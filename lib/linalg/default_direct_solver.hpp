@@ -52,6 +52,10 @@ private:
   virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
       const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
       const;
+  virtual std::vector<Solution<BasisFunctionType, ResultType>>
+  solveImplMultipleRhs(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const;
 
 private:
   struct Impl;
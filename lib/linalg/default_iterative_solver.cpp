@@ -36,16 +36,19 @@
 #include "../assembly/discrete_boundary_operator_composition.hpp"
 #include "../assembly/identity_operator.hpp"
 #include "../assembly/vector.hpp"
+#include "../common/to_string.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../space/space.hpp"
 
 #include <Teuchos_RCPBoostSharedPtrConversions.hpp>
 #include <Thyra_DefaultSpmdVectorSpace.hpp>
+#include <Thyra_VectorSpaceBase.hpp>
 
 #include <boost/make_shared.hpp>
 #include <boost/variant.hpp>
 
 #include <tbb/task_scheduler_init.h>
+#include <tbb/tick_count.h>
 
 namespace Bempp {
 
@@ -61,6 +64,19 @@ wrapInTrilinosVector(arma::Col<ValueType> &col) {
                          trilinosArray, 1 /* stride */));
 }
 
+template <typename ValueType>
+Teuchos::RCP<Thyra::MultiVectorBase<ValueType>>
+wrapInTrilinosMultiVector(arma::Mat<ValueType> &mat) {
+  Teuchos::ArrayRCP<ValueType> trilinosArray =
+      Teuchos::arcp(mat.memptr(), 0 /* lowerOffset */, mat.n_elem,
+                    false /* doesn't own memory */);
+  RTOpPack::SubMultiVectorView<ValueType> view(
+      0 /* globalOffset */, mat.n_rows, 0 /* colOffset */, mat.n_cols,
+      trilinosArray, mat.n_rows /* leadingDim */);
+  return Thyra::createMembersView(
+      Thyra::defaultSpmdVectorSpace<ValueType>(mat.n_rows), view);
+}
+
 /** \cond HIDDEN_INTERNAL */
 
 template <typename BasisFunctionType, typename ResultType>
@@ -212,10 +228,127 @@ void DefaultIterativeSolver<BasisFunctionType, ResultType>::initializeSolver(
   m_impl->solverWrapper->initializeSolver(paramList);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+Solution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solve(
+    const GridFunction<BasisFunctionType, ResultType> &rhs,
+    const GridFunction<BasisFunctionType, ResultType> &initialGuess) const {
+  return solveNonblocked(rhs, &initialGuess);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solve(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs,
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &
+        initialGuess) const {
+  return solveBlocked(rhs, &initialGuess);
+}
+
 template <typename BasisFunctionType, typename ResultType>
 Solution<BasisFunctionType, ResultType>
 DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
     const GridFunction<BasisFunctionType, ResultType> &rhs) const {
+  return solveNonblocked(rhs, 0);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+  return solveBlocked(rhs, 0);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType>>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplMultipleRhs(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+  typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+  typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
+  typedef Thyra::MultiVectorBase<ResultType> TrilinosMultiVector;
+
+  const BoundaryOp *boundaryOp = boost::get<BoundaryOp>(&m_impl->op);
+  if (!boundaryOp)
+    throw std::logic_error(
+        "DefaultIterativeSolver::solveMultipleRhs(): not supported for "
+        "solvers constructed from a BlockedBoundaryOperator");
+  for (size_t i = 0; i < rhs.size(); ++i)
+    Solver<BasisFunctionType, ResultType>::checkConsistency(*boundaryOp, rhs[i],
+                                                            m_impl->mode);
+  std::vector<Solution<BasisFunctionType, ResultType>> result;
+  if (rhs.empty())
+    return result;
+
+  // Let a Block GMRES solver of automatic block size treat all right-hand
+  // sides as one block
+  const size_t rhsCount = rhs.size();
+  m_impl->solverWrapper->setRhsCount(rhsCount);
+
+  // Pack the right-hand sides into the columns of a contiguous multivector,
+  // so that the Belos solver works on all of them at once and the operator
+  // is applied to all columns in a single call
+  arma::Mat<ResultType> armaProjections(
+      boundaryOp->dualToRange()->globalDofCount(), rhsCount);
+  for (size_t i = 0; i < rhsCount; ++i)
+    armaProjections.col(i) = rhs[i].projections(boundaryOp->dualToRange());
+  arma::Mat<ResultType> armaRhs;
+  if (m_impl->mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE)
+    armaRhs.swap(armaProjections);
+  else {
+    armaRhs.set_size(boundaryOp->range()->globalDofCount(), rhsCount);
+    boost::get<BoundaryOp>(m_impl->pinvId).weakForm()->apply(
+        NO_TRANSPOSE, armaProjections, armaRhs, 1., 0.);
+  }
+  Teuchos::RCP<TrilinosMultiVector> rhsVectors =
+      wrapInTrilinosMultiVector(armaRhs);
+
+  arma::Mat<ResultType> armaSolution(boundaryOp->domain()->globalDofCount(),
+                                     rhsCount);
+  armaSolution.fill(static_cast<ResultType>(0.));
+  Teuchos::RCP<TrilinosMultiVector> solutionVectors =
+      wrapInTrilinosMultiVector(armaSolution);
+
+  // Get number of threads
+  Fiber::ParallelizationOptions parallelOptions =
+      boundaryOp->context()->assemblyOptions().parallelizationOptions();
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+
+  // Solve
+  Thyra::SolveStatus<MagnitudeType> status;
+  double solveTime;
+  {
+    // Initialize TBB threads here (to prevent their construction and
+    // destruction on every matrix-vector multiplication)
+    tbb::task_scheduler_init scheduler(maxThreadCount);
+    const tbb::tick_count start = tbb::tick_count::now();
+    status = m_impl->solverWrapper->solve(Thyra::NOTRANS, *rhsVectors,
+                                          solutionVectors.ptr());
+    solveTime = (tbb::tick_count::now() - start).seconds();
+  }
+
+  // Construct grid functions and return; the status, iteration count and
+  // time refer to the solve for all right-hand sides together
+  result.reserve(rhsCount);
+  for (size_t i = 0; i < rhsCount; ++i)
+    result.push_back(Solution<BasisFunctionType, ResultType>(
+        GridFunction<BasisFunctionType, ResultType>(
+            boundaryOp->context(), boundaryOp->domain(),
+            arma::Col<ResultType>(armaSolution.col(i))),
+        status, solveTime));
+  return result;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+Solution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveNonblocked(
+    const GridFunction<BasisFunctionType, ResultType> &rhs,
+    const GridFunction<BasisFunctionType, ResultType> *initialGuess) const {
   typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
   typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
   typedef Thyra::MultiVectorBase<ResultType> TrilinosVector;
@@ -242,9 +375,17 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
         Thyra::NOTRANS, projectionsVector, rhsVector.ptr(), 1., 0.);
   }
 
-  // Construct solution vector
+  // Construct solution vector, starting from the initial guess if given
   arma::Col<ResultType> armaSolution(rhsVector->range()->dim());
-  armaSolution.fill(static_cast<ResultType>(0.));
+  if (initialGuess) {
+    if (!initialGuess->isInitialized() ||
+        !initialGuess->space()->spaceIsCompatible(*boundaryOp->domain()))
+      throw std::invalid_argument(
+          "DefaultIterativeSolver::solve(): initial guess must be "
+          "expanded in the domain of the boundary operator");
+    armaSolution = initialGuess->coefficients();
+  } else
+    armaSolution.fill(static_cast<ResultType>(0.));
   Teuchos::RCP<TrilinosVector> solutionVector =
       wrapInTrilinosVector(armaSolution);
 
@@ -261,25 +402,30 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
 
   // Solve
   Thyra::SolveStatus<MagnitudeType> status;
+  double solveTime;
   {
     // Initialize TBB threads here (to prevent their construction and
     // destruction on every matrix-vector multiplication)
     tbb::task_scheduler_init scheduler(maxThreadCount);
+    const tbb::tick_count start = tbb::tick_count::now();
     status = m_impl->solverWrapper->solve(Thyra::NOTRANS, *rhsVector,
                                           solutionVector.ptr());
+    solveTime = (tbb::tick_count::now() - start).seconds();
   }
 
   // Construct grid function and return
   return Solution<BasisFunctionType, ResultType>(
       GridFunction<BasisFunctionType, ResultType>(
           boundaryOp->context(), boundaryOp->domain(), armaSolution),
-      status);
+      status, solveTime);
 }
 
 template <typename BasisFunctionType, typename ResultType>
 BlockedSolution<BasisFunctionType, ResultType>
-DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
-    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveBlocked(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs,
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> *
+        initialGuess) const {
   typedef BlockedBoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
   typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
   typedef Thyra::MultiVectorBase<ResultType> TrilinosVector;
@@ -321,12 +467,34 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
         Thyra::NOTRANS, projectionsVector, rhsVector.ptr(), 1., 0.);
   }
 
-  // Initialize the solution vector
+  // Initialize the solution vector, starting from the initial guess if given
+  const size_t columnCount = boundaryOp->columnCount();
   size_t solutionSize = 0;
-  for (size_t i = 0; i < canonicalRhs.size(); ++i)
+  for (size_t i = 0; i < columnCount; ++i)
     solutionSize += boundaryOp->domain(i)->globalDofCount();
   arma::Col<ResultType> armaSolution(solutionSize);
   armaSolution.fill(static_cast<ResultType>(0.));
+  if (initialGuess) {
+    if (initialGuess->size() != columnCount)
+      throw std::invalid_argument(
+          "DefaultIterativeSolver::solve(): incorrect number of grid "
+          "functions in the initial guess");
+    for (size_t i = 0, start = 0; i < columnCount; ++i) {
+      const size_t chunkSize = boundaryOp->domain(i)->globalDofCount();
+      const GridFunction<BasisFunctionType, ResultType> &chunk =
+          (*initialGuess)[i];
+      if (chunk.isInitialized()) {
+        if (!chunk.space()->spaceIsCompatible(*boundaryOp->domain(i)))
+          throw std::invalid_argument(
+              "DefaultIterativeSolver::solve(): grid function #" +
+              toString(i) + " of the initial guess is not expanded in the "
+                            "domain of the corresponding column of the "
+                            "blocked boundary operator");
+        armaSolution.rows(start, start + chunkSize - 1) = chunk.coefficients();
+      }
+      start += chunkSize;
+    }
+  }
   Teuchos::RCP<TrilinosVector> solutionVector =
       wrapInTrilinosVector(armaSolution);
 
@@ -353,12 +521,15 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
 
   // Solve
   Thyra::SolveStatus<MagnitudeType> status;
+  double solveTime;
   {
     // Initialize TBB threads here (to prevent their construction and
     // destruction on every matrix-vector multiplication)
     tbb::task_scheduler_init scheduler(maxThreadCount);
+    const tbb::tick_count start = tbb::tick_count::now();
     status = m_impl->solverWrapper->solve(Thyra::NOTRANS, *rhsVector,
                                           solutionVector.ptr());
+    solveTime = (tbb::tick_count::now() - start).seconds();
   }
 
   // Convert chunks of the solution vector into grid functions
@@ -368,7 +539,7 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
 
   // Return solution
   return BlockedSolution<BasisFunctionType, ResultType>(solutionFunctions,
-                                                        status);
+                                                        status, solveTime);
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DefaultIterativeSolver);
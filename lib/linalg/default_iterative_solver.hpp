@@ -128,12 +128,58 @@ public:
   void initializeSolver(const Teuchos::RCP<Teuchos::ParameterList> &paramList,
                         const Preconditioner<ResultType> &preconditioner);
 
+  using Base::solve;
+
+  /** \brief Solve a standard (non-blocked) boundary integral equation,
+    * starting from an initial guess.
+    *
+    * \param[in] rhs
+    *   Right-hand side of the equation.
+    * \param[in] initialGuess
+    *   Initial approximation of the solution, expanded in the domain of the
+    *   boundary operator; typically the solution of a closely related
+    *   system, e.g. <tt>previousSolution.gridFunction()</tt>.
+    *
+    * The parameter lists returned by defaultGmresParameterList() and
+    * defaultGcrodrParameterList() measure residuals relative to the
+    * right-hand side, so an initial guess that already satisfies the
+    * convergence criterion is returned without iterating.
+    *
+    * The Belos solver is reused between calls to solve(). Solvers that
+    * recycle Krylov subspaces (see defaultGcrodrParameterList()) therefore
+    * carry their deflation subspace over from one call to the next. */
+  Solution<BasisFunctionType, ResultType>
+  solve(const GridFunction<BasisFunctionType, ResultType> &rhs,
+        const GridFunction<BasisFunctionType, ResultType> &initialGuess) const;
+
+  /** \brief Solve a block-operator system of boundary integral equations,
+    * starting from an initial guess.
+    *
+    * \p initialGuess must contain one grid function per column of the
+    * blocked operator. Uninitialized grid functions stand for zero. */
+  BlockedSolution<BasisFunctionType, ResultType>
+  solve(const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs,
+        const std::vector<GridFunction<BasisFunctionType, ResultType>> &
+            initialGuess) const;
+
 private:
   virtual Solution<BasisFunctionType, ResultType> solveImplNonblocked(
       const GridFunction<BasisFunctionType, ResultType> &rhs) const;
   virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
       const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
       const;
+  virtual std::vector<Solution<BasisFunctionType, ResultType>>
+  solveImplMultipleRhs(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const;
+
+  Solution<BasisFunctionType, ResultType> solveNonblocked(
+      const GridFunction<BasisFunctionType, ResultType> &rhs,
+      const GridFunction<BasisFunctionType, ResultType> *initialGuess) const;
+  BlockedSolution<BasisFunctionType, ResultType> solveBlocked(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs,
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> *
+          initialGuess) const;
 
 private:
   struct Impl;
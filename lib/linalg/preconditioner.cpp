@@ -27,21 +27,427 @@
 
 #include "../assembly/discrete_blocked_boundary_operator.hpp"
 #include "../assembly/discrete_boundary_operator.hpp"
+#include "../assembly/discrete_hmat_boundary_operator.hpp"
+#include "../common/boost_make_shared_fwd.hpp"
 #include "../fiber/_2d_array.hpp"
+#include "../fiber/conjugate.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/scalar_traits.hpp"
+#include "../hmat/hmatrix.hpp"
+#include "../hmat/hmatrix_data.hpp"
+#include "../hmat/hmatrix_dense_data.hpp"
 
 #include <Teuchos_RCP.hpp>
 #include <Teuchos_RCPBoostSharedPtrConversions.hpp>
+#include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 #include <Thyra_LinearOpBase.hpp>
 #include <Thyra_PreconditionerBase.hpp>
 #include <Thyra_DefaultPreconditioner.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/tick_count.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 namespace Bempp {
 
+namespace {
+
+// Base of the square operators built by the preconditioner factories below
+template <typename ValueType>
+class SquarePreconditionerOperator
+    : public DiscreteBoundaryOperator<ValueType> {
+public:
+  explicit SquarePreconditionerOperator(unsigned int size)
+      : m_size(size), m_space(Thyra::defaultSpmdVectorSpace<ValueType>(size)) {
+  }
+
+  virtual unsigned int rowCount() const { return m_size; }
+  virtual unsigned int columnCount() const { return m_size; }
+
+  virtual void addBlock(const std::vector<int> &rows,
+                        const std::vector<int> &cols, const ValueType alpha,
+                        arma::Mat<ValueType> &block) const {
+    throw std::runtime_error("SquarePreconditionerOperator::addBlock(): "
+                             "not implemented");
+  }
+
+  virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+  domain() const {
+    return m_space;
+  }
+
+  virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> range() const {
+    return m_space;
+  }
+
+  virtual double memSizeKb() const = 0;
+
+protected:
+  virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const {
+    return (M_trans == Thyra::NOTRANS || M_trans == Thyra::TRANS ||
+            M_trans == Thyra::CONJ || M_trans == Thyra::CONJTRANS);
+  }
+
+private:
+  unsigned int m_size;
+  Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> m_space;
+};
+
+// Block-diagonal operator whose blocks are stored as dense matrices. Block
+// b maps the entries blocks[b].inputDofs of the input vector to the entries
+// blocks[b].outputDofs of the output vector; the output dofs of different
+// blocks are disjoint.
+template <typename ValueType>
+class BlockDiagonalOperator : public SquarePreconditionerOperator<ValueType> {
+public:
+  struct Block {
+    std::vector<unsigned int> inputDofs;
+    std::vector<unsigned int> outputDofs;
+    arma::Mat<ValueType> mat;
+  };
+
+  BlockDiagonalOperator(unsigned int size, std::vector<Block> &blocks)
+      : SquarePreconditionerOperator<ValueType>(size) {
+    m_blocks.swap(blocks);
+  }
+
+  virtual double memSizeKb() const {
+    double result = 0.;
+    for (size_t b = 0; b < m_blocks.size(); ++b)
+      result += m_blocks[b].mat.n_elem * sizeof(ValueType) +
+                (m_blocks[b].inputDofs.size() + m_blocks[b].outputDofs.size()) *
+                    sizeof(unsigned int);
+    return result / 1024.;
+  }
+
+private:
+  virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                const arma::Col<ValueType> &x_in,
+                                arma::Col<ValueType> &y_inout,
+                                const ValueType alpha,
+                                const ValueType beta) const {
+    if (beta == static_cast<ValueType>(0.))
+      y_inout.fill(static_cast<ValueType>(0.));
+    else
+      y_inout *= beta;
+
+    const bool transposed =
+        (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    arma::Col<ValueType> xBlock, yBlock;
+    for (size_t b = 0; b < m_blocks.size(); ++b) {
+      const Block &block = m_blocks[b];
+      const std::vector<unsigned int> &inputDofs =
+          transposed ? block.outputDofs : block.inputDofs;
+      const std::vector<unsigned int> &outputDofs =
+          transposed ? block.inputDofs : block.outputDofs;
+      xBlock.set_size(inputDofs.size());
+      for (size_t i = 0; i < inputDofs.size(); ++i)
+        xBlock(i) = x_in(inputDofs[i]);
+      switch (trans) {
+      case NO_TRANSPOSE:
+        yBlock = block.mat * xBlock;
+        break;
+      case CONJUGATE:
+        yBlock = arma::conj(block.mat) * xBlock;
+        break;
+      case TRANSPOSE:
+        yBlock = block.mat.st() * xBlock;
+        break;
+      case CONJUGATE_TRANSPOSE:
+        yBlock = block.mat.t() * xBlock;
+        break;
+      default:
+        throw std::invalid_argument(
+            "BlockDiagonalOperator::applyBuiltInImpl(): "
+            "invalid transposition mode");
+      }
+      for (size_t i = 0; i < outputDofs.size(); ++i)
+        y_inout(outputDofs[i]) += alpha * yBlock(i);
+    }
+  }
+
+  std::vector<Block> m_blocks;
+};
+
+// Sparse operator stored in the compressed-column format
+template <typename ValueType>
+class CompressedColumnOperator
+    : public SquarePreconditionerOperator<ValueType> {
+public:
+  CompressedColumnOperator(unsigned int size,
+                           std::vector<size_t> &columnStarts,
+                           std::vector<unsigned int> &rowIndices,
+                           std::vector<ValueType> &values)
+      : SquarePreconditionerOperator<ValueType>(size) {
+    m_columnStarts.swap(columnStarts);
+    m_rowIndices.swap(rowIndices);
+    m_values.swap(values);
+  }
+
+  virtual double memSizeKb() const {
+    return (m_columnStarts.size() * sizeof(size_t) +
+            m_rowIndices.size() * sizeof(unsigned int) +
+            m_values.size() * sizeof(ValueType)) /
+           1024.;
+  }
+
+private:
+  virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                const arma::Col<ValueType> &x_in,
+                                arma::Col<ValueType> &y_inout,
+                                const ValueType alpha,
+                                const ValueType beta) const {
+    if (beta == static_cast<ValueType>(0.))
+      y_inout.fill(static_cast<ValueType>(0.));
+    else
+      y_inout *= beta;
+
+    const size_t columnCount = m_columnStarts.size() - 1;
+    switch (trans) {
+    case NO_TRANSPOSE:
+    case CONJUGATE:
+      for (size_t col = 0; col < columnCount; ++col) {
+        const ValueType x = alpha * x_in(col);
+        for (size_t k = m_columnStarts[col]; k < m_columnStarts[col + 1]; ++k)
+          y_inout(m_rowIndices[k]) +=
+              (trans == CONJUGATE ? Fiber::conjugate(m_values[k])
+                                  : m_values[k]) *
+              x;
+      }
+      break;
+    case TRANSPOSE:
+    case CONJUGATE_TRANSPOSE:
+      for (size_t col = 0; col < columnCount; ++col) {
+        ValueType sum = 0.;
+        for (size_t k = m_columnStarts[col]; k < m_columnStarts[col + 1]; ++k)
+          sum += (trans == CONJUGATE_TRANSPOSE ? Fiber::conjugate(m_values[k])
+                                               : m_values[k]) *
+                 x_in(m_rowIndices[k]);
+        y_inout(col) += alpha * sum;
+      }
+      break;
+    default:
+      throw std::invalid_argument(
+          "CompressedColumnOperator::applyBuiltInImpl(): "
+          "invalid transposition mode");
+    }
+  }
+
+  std::vector<size_t> m_columnStarts;
+  std::vector<unsigned int> m_rowIndices;
+  std::vector<ValueType> m_values;
+};
+
+template <typename ValueType>
+shared_ptr<const hmat::DefaultHMatrixType<ValueType>>
+squareHMatrix(const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+                  discreteOperator,
+              const char *caller) {
+  shared_ptr<const DiscreteHMatBoundaryOperator<ValueType>> hMatOperator =
+      boost::dynamic_pointer_cast<
+          const DiscreteHMatBoundaryOperator<ValueType>>(discreteOperator);
+  shared_ptr<const hmat::DefaultHMatrixType<ValueType>> hMatrix;
+  if (hMatOperator)
+    hMatrix = boost::dynamic_pointer_cast<
+        const hmat::DefaultHMatrixType<ValueType>>(
+        hMatOperator->compressedMatrix());
+  if (!hMatrix)
+    throw std::invalid_argument(std::string(caller) +
+                                ": operator must be assembled in HMat mode");
+  if (hMatrix->rows() != hMatrix->columns())
+    throw std::invalid_argument(std::string(caller) +
+                                ": operator must be square");
+  return hMatrix;
+}
+
+// Add the values of all leaves of the subtree rooted at 'node' to 'mat',
+// whose first row and column correspond to the H-matrix dof 'offset'
+template <typename ValueType>
+void addSubtreeToMatrix(const hmat::DefaultHMatrixType<ValueType> &hMatrix,
+                        const hmat::DefaultBlockClusterTreeNodeType &node,
+                        size_t offset, arma::Mat<ValueType> &mat) {
+  if (!node.isLeaf()) {
+    for (int i = 0; i < 4; ++i)
+      addSubtreeToMatrix(hMatrix, node.child(i), offset, mat);
+    return;
+  }
+  const hmat::IndexRangeType &rowRange =
+      node.data().rowClusterTreeNode->data().indexRange;
+  const hmat::IndexRangeType &columnRange =
+      node.data().columnClusterTreeNode->data().indexRange;
+  const size_t rowCount = rowRange[1] - rowRange[0];
+  const size_t columnCount = columnRange[1] - columnRange[0];
+
+  const hmat::HMatrixData<ValueType> &data = *hMatrix.leafData(node.leafIndex());
+  arma::Mat<ValueType> values(rowCount, columnCount);
+  arma::Mat<ValueType> identity =
+      arma::eye<arma::Mat<ValueType>>(columnCount, columnCount);
+  data.apply(identity, values, hmat::NOTRANS, 1., 0.);
+  mat.submat(rowRange[0] - offset, columnRange[0] - offset,
+             rowRange[1] - offset - 1, columnRange[1] - offset - 1) += values;
+}
+
+// Collect the nodes forming the diagonal blocks of the block-Jacobi
+// preconditioner
+void collectDiagonalNodes(
+    const hmat::DefaultBlockClusterTreeNodeType &node, int maxBlockSize,
+    std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &nodes) {
+  const hmat::IndexRangeType &rowRange =
+      node.data().rowClusterTreeNode->data().indexRange;
+  if (node.isLeaf() || rowRange[1] - rowRange[0] <= size_t(maxBlockSize)) {
+    nodes.push_back(&node);
+    return;
+  }
+  for (int i = 0; i < 4; ++i) {
+    const hmat::DefaultBlockClusterTreeNodeType &child = node.child(i);
+    if (child.data().rowClusterTreeNode->data().indexRange ==
+        child.data().columnClusterTreeNode->data().indexRange)
+      collectDiagonalNodes(child, maxBlockSize, nodes);
+  }
+}
+
+// Body of the parallel loop assembling and inverting the diagonal blocks of
+// the block-Jacobi preconditioner
+template <typename ValueType> class BlockJacobiLoopBody {
+public:
+  typedef typename BlockDiagonalOperator<ValueType>::Block Block;
+
+  BlockJacobiLoopBody(
+      const hmat::DefaultHMatrixType<ValueType> &hMatrix,
+      const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &nodes,
+      const std::vector<std::size_t> &rowDofs,
+      const std::vector<std::size_t> &columnDofs, std::vector<Block> &blocks)
+      : m_hMatrix(hMatrix), m_nodes(nodes), m_rowDofs(rowDofs),
+        m_columnDofs(columnDofs), m_blocks(blocks) {}
+
+  void operator()(const tbb::blocked_range<size_t> &r) const {
+    for (size_t b = r.begin(); b != r.end(); ++b) {
+      const hmat::IndexRangeType &range =
+          m_nodes[b]->data().rowClusterTreeNode->data().indexRange;
+      const size_t size = range[1] - range[0];
+      arma::Mat<ValueType> mat(size, size);
+      mat.fill(static_cast<ValueType>(0.));
+      addSubtreeToMatrix(m_hMatrix, *m_nodes[b], range[0], mat);
+
+      Block &block = m_blocks[b];
+      if (!arma::inv(block.mat, mat))
+        throw std::runtime_error(
+            "hMatBlockJacobiPreconditioner(): singular diagonal block");
+      block.inputDofs.resize(size);
+      block.outputDofs.resize(size);
+      for (size_t i = 0; i < size; ++i) {
+        block.inputDofs[i] = m_rowDofs[range[0] + i];
+        block.outputDofs[i] = m_columnDofs[range[0] + i];
+      }
+    }
+  }
+
+private:
+  const hmat::DefaultHMatrixType<ValueType> &m_hMatrix;
+  const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &m_nodes;
+  const std::vector<std::size_t> &m_rowDofs;
+  const std::vector<std::size_t> &m_columnDofs;
+  std::vector<Block> &m_blocks;
+};
+
+// Orders entries of a sparse vector by decreasing magnitude
+template <typename ValueType> struct HasLargerMagnitude {
+  typedef std::pair<unsigned int, ValueType> Entry;
+
+  bool operator()(const Entry &a, const Entry &b) const {
+    return std::abs(a.second) > std::abs(b.second);
+  }
+};
+
+// Body of the parallel loop computing the columns of the sparse approximate
+// inverse
+template <typename ValueType> class SparseApproximateInverseLoopBody {
+public:
+  typedef std::pair<unsigned int, ValueType> Entry;
+
+  SparseApproximateInverseLoopBody(
+      const std::vector<std::vector<Entry>> &nearFieldRows,
+      const std::vector<std::vector<Entry>> &nearFieldColumns,
+      int maxNonzerosPerColumn, std::vector<std::vector<Entry>> &columns)
+      : m_nearFieldRows(nearFieldRows), m_nearFieldColumns(nearFieldColumns),
+        m_maxNonzerosPerColumn(maxNonzerosPerColumn), m_columns(columns) {}
+
+  void operator()(const tbb::blocked_range<size_t> &r) const {
+    std::vector<Entry> candidates;
+    std::vector<unsigned int> pattern, rows;
+    arma::Mat<ValueType> localMat;
+    arma::Col<ValueType> rhs, solution;
+    for (size_t j = r.begin(); j != r.end(); ++j) {
+      // Sparsity pattern: the largest near-field entries of row j
+      candidates = m_nearFieldRows[j];
+      if (candidates.empty())
+        continue;
+      const size_t patternSize =
+          std::min(candidates.size(), size_t(m_maxNonzerosPerColumn));
+      std::partial_sort(candidates.begin(), candidates.begin() + patternSize,
+                        candidates.end(), HasLargerMagnitude<ValueType>());
+      const Entry largest = candidates[0];
+      pattern.resize(patternSize);
+      for (size_t k = 0; k < patternSize; ++k)
+        pattern[k] = candidates[k].first;
+
+      // Rows of the near field touched by the columns in the pattern
+      rows.clear();
+      for (size_t k = 0; k < patternSize; ++k) {
+        const std::vector<Entry> &column = m_nearFieldColumns[pattern[k]];
+        for (size_t e = 0; e < column.size(); ++e)
+          rows.push_back(column[e].first);
+      }
+      std::sort(rows.begin(), rows.end());
+      rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+      localMat.zeros(rows.size(), patternSize);
+      for (size_t k = 0; k < patternSize; ++k) {
+        const std::vector<Entry> &column = m_nearFieldColumns[pattern[k]];
+        for (size_t e = 0; e < column.size(); ++e)
+          localMat(std::lower_bound(rows.begin(), rows.end(),
+                                    column[e].first) -
+                       rows.begin(),
+                   k) = column[e].second;
+      }
+      rhs.zeros(rows.size());
+      rhs(std::lower_bound(rows.begin(), rows.end(), j) - rows.begin()) = 1.;
+
+      std::vector<Entry> &result = m_columns[j];
+      if (arma::solve(solution, localMat, rhs)) {
+        result.resize(patternSize);
+        for (size_t k = 0; k < patternSize; ++k)
+          result[k] = Entry(pattern[k], solution(k));
+      } else
+        // Rank-deficient local problem; fall back to a scaling
+        result.assign(1, Entry(largest.first,
+                               static_cast<ValueType>(1.) / largest.second));
+    }
+  }
+
+private:
+  const std::vector<std::vector<Entry>> &m_nearFieldRows;
+  const std::vector<std::vector<Entry>> &m_nearFieldColumns;
+  int m_maxNonzerosPerColumn;
+  std::vector<std::vector<Entry>> &m_columns;
+};
+
+} // namespace
+
 template <typename ValueType>
 Preconditioner<ValueType>::Preconditioner(TeuchosPreconditionerPtr precPtr)
-    : m_precPtr(precPtr) {}
+    : m_precPtr(precPtr), m_setupTime(0.), m_memSizeKb(0.) {}
+
+template <typename ValueType>
+Preconditioner<ValueType>::Preconditioner(TeuchosPreconditionerPtr precPtr,
+                                          double setupTime, double memSizeKb)
+    : m_precPtr(precPtr), m_setupTime(setupTime), m_memSizeKb(memSizeKb) {}
 
 template <typename ValueType> Preconditioner<ValueType>::~Preconditioner() {}
 
@@ -89,13 +495,155 @@ Preconditioner<ValueType> discreteBlockDiagonalPreconditioner(const std::vector<
   return Preconditioner<ValueType>(precOp);
 }
 
+template <typename ValueType>
+Preconditioner<ValueType> hMatBlockJacobiPreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    int maxBlockSize) {
+  tbb::tick_count start = tbb::tick_count::now();
+  shared_ptr<const hmat::DefaultHMatrixType<ValueType>> hMatrix =
+      squareHMatrix(discreteOperator, "hMatBlockJacobiPreconditioner()");
+  shared_ptr<const hmat::DefaultBlockClusterTreeType> blockClusterTree =
+      hMatrix->blockClusterTree();
+  const std::vector<std::size_t> &rowDofs =
+      blockClusterTree->rowClusterTree()->hMatDofToOriginalDofMap();
+  const std::vector<std::size_t> &columnDofs =
+      blockClusterTree->columnClusterTree()->hMatDofToOriginalDofMap();
+
+  std::vector<const hmat::DefaultBlockClusterTreeNodeType *> nodes;
+  collectDiagonalNodes(blockClusterTree->root(), std::max(maxBlockSize, 0),
+                       nodes);
+  size_t coveredDofCount = 0;
+  for (size_t b = 0; b < nodes.size(); ++b) {
+    const hmat::IndexRangeType &range =
+        nodes[b]->data().rowClusterTreeNode->data().indexRange;
+    coveredDofCount += range[1] - range[0];
+  }
+  if (coveredDofCount != hMatrix->rows())
+    throw std::invalid_argument(
+        "hMatBlockJacobiPreconditioner(): the diagonal blocks of the "
+        "H-matrix do not cover all its rows; the row and column cluster "
+        "trees must coincide");
+
+  // The preconditioner maps vectors from the range of the operator (indexed
+  // by its row dofs) to its domain (indexed by its column dofs)
+  typedef typename BlockDiagonalOperator<ValueType>::Block Block;
+  std::vector<Block> blocks(nodes.size());
+  typedef BlockJacobiLoopBody<ValueType> Body;
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nodes.size()),
+                    Body(*hMatrix, nodes, rowDofs, columnDofs, blocks));
+
+  shared_ptr<BlockDiagonalOperator<ValueType>> op =
+      boost::make_shared<BlockDiagonalOperator<ValueType>>(hMatrix->rows(),
+                                                           blocks);
+  typename Preconditioner<ValueType>::TeuchosPreconditionerPtr precOp =
+      Teuchos::rcp_static_cast<const Thyra::PreconditionerBase<ValueType>>(
+          Thyra::unspecifiedPrec(
+              Teuchos::rcp_static_cast<const Thyra::LinearOpBase<ValueType>>(
+                  Teuchos::rcp(op))));
+  tbb::tick_count end = tbb::tick_count::now();
+  return Preconditioner<ValueType>(precOp, (end - start).seconds(),
+                                   op->memSizeKb());
+}
+
+template <typename ValueType>
+Preconditioner<ValueType> hMatSparseApproximateInversePreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    int maxNonzerosPerColumn) {
+  typedef typename SparseApproximateInverseLoopBody<ValueType>::Entry Entry;
+
+  if (maxNonzerosPerColumn < 1)
+    throw std::invalid_argument(
+        "hMatSparseApproximateInversePreconditioner(): "
+        "maxNonzerosPerColumn must be positive");
+
+  tbb::tick_count start = tbb::tick_count::now();
+  shared_ptr<const hmat::DefaultHMatrixType<ValueType>> hMatrix =
+      squareHMatrix(discreteOperator,
+                    "hMatSparseApproximateInversePreconditioner()");
+  shared_ptr<const hmat::DefaultBlockClusterTreeType> blockClusterTree =
+      hMatrix->blockClusterTree();
+  const std::vector<std::size_t> &rowDofs =
+      blockClusterTree->rowClusterTree()->hMatDofToOriginalDofMap();
+  const std::vector<std::size_t> &columnDofs =
+      blockClusterTree->columnClusterTree()->hMatDofToOriginalDofMap();
+  const size_t size = hMatrix->rows();
+
+  // Near field of the operator in the original dof numbering, stored both
+  // by rows (column index, value) and by columns (row index, value)
+  std::vector<std::vector<Entry>> nearFieldRows(size), nearFieldColumns(size);
+  const std::vector<const hmat::DefaultBlockClusterTreeNodeType *> &leaves =
+      blockClusterTree->leafNodes();
+  for (size_t l = 0; l < leaves.size(); ++l) {
+    shared_ptr<const hmat::HMatrixData<ValueType>> data =
+        hMatrix->leafData(l);
+    if (data->type() != hmat::DENSE)
+      continue;
+    const arma::Mat<ValueType> &mat =
+        static_cast<const hmat::HMatrixDenseData<ValueType> &>(*data).A();
+    const size_t rowStart =
+        leaves[l]->data().rowClusterTreeNode->data().indexRange[0];
+    const size_t columnStart =
+        leaves[l]->data().columnClusterTreeNode->data().indexRange[0];
+    for (size_t c = 0; c < mat.n_cols; ++c)
+      for (size_t r = 0; r < mat.n_rows; ++r) {
+        if (mat(r, c) == static_cast<ValueType>(0.))
+          continue;
+        const unsigned int row = rowDofs[rowStart + r];
+        const unsigned int col = columnDofs[columnStart + c];
+        nearFieldRows[row].push_back(Entry(col, mat(r, c)));
+        nearFieldColumns[col].push_back(Entry(row, mat(r, c)));
+      }
+  }
+
+  // Column j of the approximate inverse M maps the j'th row dof of the
+  // operator to its column dofs
+  std::vector<std::vector<Entry>> columns(size);
+  typedef SparseApproximateInverseLoopBody<ValueType> Body;
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, size, 64),
+                    Body(nearFieldRows, nearFieldColumns, maxNonzerosPerColumn,
+                         columns));
+
+  std::vector<size_t> columnStarts(size + 1, 0);
+  for (size_t j = 0; j < size; ++j)
+    columnStarts[j + 1] = columnStarts[j] + columns[j].size();
+  std::vector<unsigned int> rowIndices(columnStarts[size]);
+  std::vector<ValueType> values(columnStarts[size]);
+  for (size_t j = 0; j < size; ++j)
+    for (size_t k = 0; k < columns[j].size(); ++k) {
+      rowIndices[columnStarts[j] + k] = columns[j][k].first;
+      values[columnStarts[j] + k] = columns[j][k].second;
+    }
+
+  shared_ptr<CompressedColumnOperator<ValueType>> op =
+      boost::make_shared<CompressedColumnOperator<ValueType>>(
+          size, columnStarts, rowIndices, values);
+  typename Preconditioner<ValueType>::TeuchosPreconditionerPtr precOp =
+      Teuchos::rcp_static_cast<const Thyra::PreconditionerBase<ValueType>>(
+          Thyra::unspecifiedPrec(
+              Teuchos::rcp_static_cast<const Thyra::LinearOpBase<ValueType>>(
+                  Teuchos::rcp(op))));
+  tbb::tick_count end = tbb::tick_count::now();
+  return Preconditioner<ValueType>(precOp, (end - start).seconds(),
+                                   op->memSizeKb());
+}
+
 #define INSTANTIATE_FREE_FUNCTIONS(VALUE)                                      \
   template Preconditioner<VALUE> discreteOperatorToPreconditioner(             \
       const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &                \
           discreteOperator);                                                   \
   template Preconditioner<VALUE> discreteBlockDiagonalPreconditioner(          \
       const std::vector<shared_ptr<const DiscreteBoundaryOperator<VALUE>>> &   \
-          opVector);
+          opVector);                                                           \
+  template Preconditioner<VALUE> hMatBlockJacobiPreconditioner(                \
+      const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &                \
+          discreteOperator,                                                    \
+      int maxBlockSize);                                                       \
+  template Preconditioner<VALUE> hMatSparseApproximateInversePreconditioner(   \
+      const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &                \
+          discreteOperator,                                                    \
+      int maxNonzerosPerColumn);
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(Preconditioner);
 FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
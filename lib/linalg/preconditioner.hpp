@@ -53,13 +53,32 @@ public:
 
   explicit Preconditioner(TeuchosPreconditionerPtr precPtr);
 
+  /** \brief Constructor.
+   *
+   *  \p setupTime is the time (in seconds) taken to build the
+   *  preconditioner and \p memSizeKb the memory taken by its data. */
+  Preconditioner(TeuchosPreconditionerPtr precPtr, double setupTime,
+                 double memSizeKb);
+
   virtual ~Preconditioner();
 
   /* \brief Return pointer to the actual preconditoner */
   inline const TeuchosPreconditionerPtr &get() const { return m_precPtr; }
 
+  /** \brief Time in seconds taken to build the preconditioner.
+   *
+   *  Zero for preconditioners wrapping operators built elsewhere. */
+  double setupTime() const { return m_setupTime; }
+
+  /** \brief Memory taken by the data of the preconditioner.
+   *
+   *  Zero for preconditioners wrapping operators built elsewhere. */
+  double memSizeKb() const { return m_memSizeKb; }
+
 private:
   TeuchosPreconditionerPtr m_precPtr;
+  double m_setupTime;
+  double m_memSizeKb;
 };
 
 /** \brief Create a preconditioner from a discrete operator.
@@ -72,6 +91,48 @@ template <typename ValueType>
 Preconditioner<ValueType> discreteBlockDiagonalPreconditioner(const std::vector<
     shared_ptr<const DiscreteBoundaryOperator<ValueType>>> &opVector);
 
+/** \brief Create a block-Jacobi preconditioner from an operator assembled
+ *  in HMat mode.
+
+    The diagonal blocks of the H-matrix representing \p discreteOperator,
+    i.e. the blocks whose row and column clusters cover the same range of
+    H-matrix degrees of freedom, are assembled as dense matrices and
+    inverted. Starting from the root of the block cluster tree, a diagonal
+    block is split into its diagonal sons as long as it has more than
+    \p maxBlockSize rows and is not a leaf; the default value of 0 hence
+    selects the leaf clusters of the cluster tree. Larger values give fewer,
+    larger blocks, which capture more of the near-field interactions at a
+    higher setup cost.
+
+    \p discreteOperator must be square and its row and column cluster trees
+    must induce the same block structure on the diagonal, which is the case
+    if the test and trial spaces coincide. Otherwise
+    <tt>std::invalid_argument</tt> is thrown. */
+template <typename ValueType>
+Preconditioner<ValueType> hMatBlockJacobiPreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    int maxBlockSize = 0);
+
+/** \brief Create a sparse approximate inverse preconditioner from an
+ *  operator assembled in HMat mode.
+
+    Only the near field of \p discreteOperator, i.e. the entries stored in
+    the dense (inadmissible) blocks of its H-matrix, is used. Column \f$j\f$
+    of the approximate inverse \f$M\f$ may have nonzero entries in the rows
+    corresponding to the \p maxNonzerosPerColumn near-field entries of row
+    \f$j\f$ of the operator largest in magnitude; their values minimise
+    \f$\lVert A m_j - e_j \rVert_2\f$, where \f$A\f$ is the near field,
+    and are found by solving a small least-squares problem for each column.
+
+    \p discreteOperator must be square; otherwise
+    <tt>std::invalid_argument</tt> is thrown. */
+template <typename ValueType>
+Preconditioner<ValueType> hMatSparseApproximateInversePreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    int maxNonzerosPerColumn = 16);
+
 } // namespace Bempp
 
 #endif /* WITH_TRILINOS */
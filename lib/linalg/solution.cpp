@@ -31,8 +31,8 @@ Solution<BasisFunctionType, ResultType>::Solution()
 template <typename BasisFunctionType, typename ResultType>
 Solution<BasisFunctionType, ResultType>::Solution(
     const GridFunction<BasisFunctionType, ResultType> &gridFunction,
-    const Thyra::SolveStatus<MagnitudeType> status)
-    : Base(status), m_gridFunction(gridFunction) {}
+    const Thyra::SolveStatus<MagnitudeType> status, double solveTime)
+    : Base(status, solveTime), m_gridFunction(gridFunction) {}
 #endif // WITH_TRILINOS
 
 template <typename BasisFunctionType, typename ResultType>
@@ -45,7 +45,8 @@ public:
 #ifdef WITH_TRILINOS
   /** \brief Constructor */
   Solution(const GridFunction<BasisFunctionType, ResultType> &gridFunction,
-           const Thyra::SolveStatus<MagnitudeType> status);
+           const Thyra::SolveStatus<MagnitudeType> status,
+           double solveTime = -1.);
 #endif // WITH_TRILINOS
   /** \brief Constructor */
   Solution(const GridFunction<BasisFunctionType, ResultType> &gridFunction,
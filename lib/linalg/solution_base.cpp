@@ -28,9 +28,10 @@ namespace Bempp {
 #ifdef WITH_TRILINOS
 template <typename BasisFunctionType, typename ResultType>
 SolutionBase<BasisFunctionType, ResultType>::SolutionBase(
-    const Thyra::SolveStatus<MagnitudeType> status)
+    const Thyra::SolveStatus<MagnitudeType> status, double solveTime)
     : m_achievedTolerance(status.achievedTol), m_message(status.message),
-      m_iterationCount(-1), m_extraParameters(status.extraParameters) {
+      m_iterationCount(-1), m_solveTime(solveTime),
+      m_extraParameters(status.extraParameters) {
   switch (status.solveStatus) {
   case Thyra::SOLVE_STATUS_CONVERGED:
     m_status = SolutionStatus::CONVERGED;
@@ -51,7 +52,7 @@ SolutionBase<BasisFunctionType, ResultType>::SolutionBase(
     SolutionStatus::Status status, MagnitudeType achievedTolerance,
     std::string message)
     : m_status(status), m_achievedTolerance(achievedTolerance),
-      m_message(message), m_iterationCount(-1) {}
+      m_message(message), m_iterationCount(-1), m_solveTime(-1.) {}
 
 template <typename BasisFunctionType, typename ResultType>
 SolutionStatus::Status
@@ -75,6 +76,11 @@ std::string SolutionBase<BasisFunctionType, ResultType>::solverMessage() const {
   return m_message;
 }
 
+template <typename BasisFunctionType, typename ResultType>
+double SolutionBase<BasisFunctionType, ResultType>::solveTime() const {
+  return m_solveTime;
+}
+
 #ifdef WITH_TRILINOS
 template <typename BasisFunctionType, typename ResultType>
 Thyra::RCP<Teuchos::ParameterList>
@@ -63,8 +63,12 @@ public:
   typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
 
 #ifdef WITH_TRILINOS
-  /** \brief Constructor */
-  explicit SolutionBase(const Thyra::SolveStatus<MagnitudeType> status);
+  /** \brief Constructor
+   *
+   *  \p solveTime is the wall-clock time of the solve in seconds, or a
+   *  negative number if unknown. */
+  explicit SolutionBase(const Thyra::SolveStatus<MagnitudeType> status,
+                        double solveTime = -1.);
 #endif // WITH_TRILINOS
   /** \brief Constructor */
   explicit SolutionBase(SolutionStatus::Status status,
@@ -91,6 +95,11 @@ public:
   /** \brief Message returned by the solver. */
   std::string solverMessage() const;
 
+  /** \brief Wall-clock time taken by the linear solve, in seconds.
+   *
+   *  A negative value means that the time was not measured. */
+  double solveTime() const;
+
 #ifdef WITH_TRILINOS
   /** \brief Extra status parameter returned by the solver.
    *
@@ -103,6 +112,7 @@ private:
   MagnitudeType m_achievedTolerance;
   std::string m_message;
   int m_iterationCount;
+  double m_solveTime;
 #ifdef WITH_TRILINOS
   Teuchos::RCP<Teuchos::ParameterList> m_extraParameters;
 #endif // WITH_TRILINOS
@@ -151,6 +151,18 @@ void Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
   }
 }
 
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType>>
+Solver<BasisFunctionType, ResultType>::solveImplMultipleRhs(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+    const {
+  std::vector<Solution<BasisFunctionType, ResultType>> result;
+  result.reserve(rhs.size());
+  for (size_t i = 0; i < rhs.size(); ++i)
+    result.push_back(solveImplNonblocked(rhs[i]));
+  return result;
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(Solver);
 
 } // namespace Bempp
@@ -92,6 +92,25 @@ public:
     return solveImplBlocked(rhs);
   }
 
+  /** \brief Solve a standard (non-blocked) boundary integral equation for
+    * several right-hand sides.
+    *
+    * The equation is solved for all the grid functions in <tt>rhs</tt>
+    * together. Derived classes may use this to share the factorisation or the
+    * operator applications between the right-hand sides; the default
+    * implementation solves for each of them in turn.
+    *
+    * \param[in] rhs
+    * <tt>vector</tt> of right-hand sides of the boundary integral equation.
+    *
+    * \return A <tt>vector</tt> of Solution objects, one per right-hand side.
+    */
+  std::vector<Solution<BasisFunctionType, ResultType>> solveMultipleRhs(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const {
+    return solveImplMultipleRhs(rhs);
+  }
+
 protected:
   static void checkConsistency(
       const BoundaryOperator<BasisFunctionType, ResultType> &boundaryOp,
@@ -119,6 +138,10 @@ private:
   virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
       const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
       const = 0;
+  virtual std::vector<Solution<BasisFunctionType, ResultType>>
+  solveImplMultipleRhs(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const;
 };
 
 } // namespace Bempp
@@ -42,7 +42,7 @@ cdef extern from "bempp/assembly/py_boundary_operator_variants.hpp" namespace "B
         SpaceVariants domain() except+catch_exception
         string label() const
 
-    cdef shared_ptr[c_DiscreteBoundaryOperator[ResultType]] _boundary_operator_variant_weak_form "Bempp::boundary_op_variant_weak_form" [BasisFunctionType,ResultType] (const BoundaryOpVariants& variant)
+    cdef shared_ptr[const c_DiscreteBoundaryOperator[ResultType]] _boundary_operator_variant_weak_form "Bempp::boundary_op_variant_weak_form" [BasisFunctionType,ResultType] (const BoundaryOpVariants& variant) nogil except +
 
 cdef class BoundaryOperatorBase:
     cdef object _basis_type
@@ -6,6 +6,8 @@ from data_types import scalar_cython_type
 from bempp.space.space cimport Space
 from discrete_boundary_operator cimport DiscreteBoundaryOperator
 from discrete_boundary_operator cimport DiscreteBoundaryOperatorBase
+from discrete_boundary_operator cimport c_DiscreteBoundaryOperator
+from bempp.utils cimport shared_ptr
 from bempp.utils.byte_conversion import convert_to_bytes
 from bempp.assembly.grid_function cimport GridFunction
 
@@ -123,13 +125,20 @@ cdef class DenseBoundaryOperator(BoundaryOperatorBase):
 
     cpdef DiscreteBoundaryOperatorBase weak_form(self):
         cdef DiscreteBoundaryOperator dbop = DiscreteBoundaryOperator()
-        
+% for pyresult,cyresult in dtypes.items():
+        cdef shared_ptr[const c_DiscreteBoundaryOperator[${cyresult}]] weak_form_${pyresult}
+% endfor
+
+        # The assembly runs without the GIL, so that operators can be
+        # assembled concurrently from several Python threads.
 % for pybasis,cybasis in dtypes.items():
 %     for pyresult,cyresult in dtypes.items():
 %         if pyresult in compatible_dtypes[pybasis]:
 
         if self.basis_type=="${pybasis}" and self.result_type=="${pyresult}":
-            dbop._impl_${pyresult}_.assign(_boundary_operator_variant_weak_form[${cybasis},${cyresult}](self.impl_))
+            with nogil:
+                weak_form_${pyresult} = _boundary_operator_variant_weak_form[${cybasis},${cyresult}](self.impl_)
+            dbop._impl_${pyresult}_.assign(weak_form_${pyresult})
             dbop._value_type = self.result_type
             return dbop
 %          endif
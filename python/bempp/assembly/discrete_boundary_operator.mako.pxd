@@ -6,9 +6,15 @@ from bempp.utils.armadillo cimport Mat
 from bempp.utils.enum_types cimport TranspositionMode
 from bempp.utils cimport shared_ptr
 from bempp.utils cimport complex_float,complex_double
+from libcpp.string cimport string
 cimport numpy as np
 
 
+cdef extern from "bempp/common/assembly_profile.hpp" namespace "Bempp":
+    cdef cppclass c_AssemblyProfile "Bempp::AssemblyProfile":
+        string toJson() const
+
+
 cdef extern from "bempp/assembly/discrete_boundary_operator.hpp" namespace "Bempp":
     cdef cppclass c_DiscreteBoundaryOperator "Bempp::DiscreteBoundaryOperator"[ValueType]:
         
@@ -19,6 +25,14 @@ cdef extern from "bempp/assembly/discrete_boundary_operator.hpp" namespace "Bemp
         Mat[ValueType] asMatrix() const
         unsigned int rowCount() const
         unsigned int columnCount() const
+        shared_ptr[const c_AssemblyProfile] assemblyProfile() const
+
+cdef extern from "bempp/assembly/py_discrete_boundary_operator_support.hpp" namespace "Bempp":
+    void _py_apply_discrete_operator "Bempp::py_apply_discrete_operator"[ValueType](
+            const c_DiscreteBoundaryOperator[ValueType]& op,
+            TranspositionMode trans, const ValueType* x, int x_rows, int x_cols,
+            ValueType* y, int y_rows, int y_cols,
+            ValueType alpha, ValueType beta) nogil except +
 
 cdef class DiscreteBoundaryOperatorBase:
     cdef object _value_type
@@ -29,12 +43,14 @@ cdef class DiscreteBoundaryOperatorBase:
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta)
+            ${scalar_cython_type(cyvalue)} beta) except *
     cpdef np.ndarray as_matrix(self)
 % endfor
     cpdef np.ndarray _as_matrix(self)
 
     cpdef object apply(self,np.ndarray x,np.ndarray y,object transpose,object alpha, object beta)
+    cdef np.ndarray _column_major(self, object x)
+    cdef np.ndarray _output_buffer(self, np.ndarray x_in, object out, object transpose)
     
 
 cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
@@ -49,7 +65,7 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta)
+            ${scalar_cython_type(cyvalue)} beta) except *
     cdef np.ndarray _as_matrix_${pyvalue}(self)
 % endfor
     cpdef np.ndarray _as_matrix(self)    
@@ -3,6 +3,9 @@ from data_types import dtypes, scalar_cython_type
 %>
 
 from bempp.utils.armadillo cimport Mat
+from bempp.assembly.discrete_boundary_operator cimport c_DiscreteBoundaryOperator
+from bempp.assembly.discrete_boundary_operator cimport c_AssemblyProfile
+from bempp.assembly.discrete_boundary_operator cimport _py_apply_discrete_operator
 from bempp.utils.enum_types cimport transposition_mode
 from bempp.utils cimport complex_float,complex_double
 from cython.operator cimport dereference as deref
@@ -29,7 +32,7 @@ cdef class DiscreteBoundaryOperatorBase:
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta):
+            ${scalar_cython_type(cyvalue)} beta) except *:
 
         raise NotImplementedError("Method _apply_${pyvalue} is not implemented.")
 % endfor
@@ -60,37 +63,123 @@ cdef class DiscreteBoundaryOperatorBase:
 % endfor
 
 
-    def matvec(self,np.ndarray x):
+    cdef np.ndarray _column_major(self, object x):
+        """Return x as a 2D column-major array of the operator's dtype.
 
-        cdef np.ndarray x_in
-        cdef np.ndarray y_inout
+        One-dimensional arrays, Fortran-ordered arrays and single-column
+        C-ordered arrays are returned as views; a copy is only made if
+        the dtype has to be converted or the data is laid out row-major.
+        """
 
-        cdef int rows = self.shape[0]
-        cdef int cols = self.shape[1]
+        cdef np.ndarray x_in = np.asarray(x)
 
-        if (x.ndim==1):
-            x_in = x.reshape((-1,1),order='F').astype(self.dtype,
-                    order='F',casting='safe',copy=False)
-        elif (x.ndim==2):
-            x_in = x.astype(self.dtype,order='F',casting='safe',copy=False)
-        else:
+        if not np.can_cast(x_in.dtype,self.dtype,casting='safe'):
+            raise TypeError("Cannot safely cast input of dtype "+
+                    str(x_in.dtype)+" to "+str(self.dtype))
+
+        if (x_in.ndim==1):
+            x_in = x_in.reshape((-1,1),order='F')
+        elif (x_in.ndim!=2):
             raise ValueError('x must have at most two dimensions')
 
-        y = np.zeros((rows,x_in.shape[1]),dtype=self.dtype,order='F')
+        return np.require(x_in,dtype=self.dtype,requirements='F')
+
+    cdef np.ndarray _output_buffer(self, np.ndarray x_in, object out, object transpose):
+        """Return the Fortran-ordered array the result is written to."""
 
-        self.apply(x_in,y,'no_transpose',1.0,0.0)
-        if (x.ndim==1):
-            y = y.ravel()
+        cdef int rows = self.shape[0]
+        cdef np.ndarray y
+
+        if transpose=='transpose' or transpose=='conjugate_transpose':
+            rows = self.shape[1]
+
+        if out is None:
+            # y may be left uninitialized since the operator is applied
+            # with beta == 0
+            return np.empty((rows,x_in.shape[1]),dtype=self.dtype,order='F')
+
+        if not isinstance(out,np.ndarray):
+            raise TypeError("out must be a NumPy array")
+        y = out
+        if not y.dtype==self.dtype:
+            raise ValueError("out must have dtype "+str(self.dtype))
+        if (y.ndim==1):
+            y = y.reshape((-1,1),order='F')
+        if not (y.ndim==2 and y.shape[0]==rows and y.shape[1]==x_in.shape[1]):
+            raise ValueError("out has wrong shape")
+        if not y.flags['F_CONTIGUOUS']:
+            raise ValueError("out must be a Fortran-contiguous array")
         return y
 
-    def matmat(self,np.ndarray x):
+    def _matvec_impl(self,object x,object out,object transpose):
 
-        return self.matvec(x)
+        cdef np.ndarray x_in = self._column_major(x)
+        cdef np.ndarray y = self._output_buffer(x_in,out,transpose)
+
+        self.apply(x_in,y,transpose,1.0,0.0)
+
+        if out is not None:
+            return out
+        if (np.ndim(x)==1):
+            return y.ravel(order='F')
+        return y
+
+    def matvec(self,object x,object out=None):
+        """Apply the operator to a vector or to the columns of a matrix.
+
+        Parameters
+        ----------
+        x : array_like
+            One- or two-dimensional array. C- and Fortran-contiguous
+            vectors as well as Fortran-ordered matrices are used
+            without copying.
+        out : numpy.ndarray, optional
+            Fortran-contiguous array of the result's shape and of the
+            operator's dtype into which the result is written.
+
+        Notes
+        -----
+        The Python global interpreter lock is released while the
+        operator is applied, so concurrent applications from several
+        threads run in parallel.
+
+        """
+
+        return self._matvec_impl(x,out,'no_transpose')
+
+    def rmatvec(self,object x,object out=None):
+        """Apply the conjugate transpose of the operator.
+
+        Takes the same arguments as `matvec`.
+
+        """
+
+        return self._matvec_impl(x,out,'conjugate_transpose')
+
+    def matmat(self,object x,object out=None):
 
-    def __call__(self,np.ndarray x):
+        return self.matvec(x,out)
+
+    def rmatmat(self,object x,object out=None):
+
+        return self.rmatvec(x,out)
+
+    def __call__(self,object x):
 
         return self.matvec(x)
 
+    def aslinearoperator(self):
+        """Return a scipy.sparse.linalg.LinearOperator wrapping this operator.
+
+        The LinearOperator shares the operator; matvecs performed through
+        it release the global interpreter lock like `matvec`.
+
+        """
+
+        from scipy.sparse.linalg import LinearOperator
+        return LinearOperator(self.shape,matvec=self.matvec,
+                rmatvec=self.rmatvec,matmat=self.matmat,dtype=self.dtype)
+
     def __mul__(self,object x):
 
         if not isinstance(self,DiscreteBoundaryOperatorBase):
@@ -146,6 +235,36 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
                 return (rows,cols)
 % endfor
             raise ValueError("Unknown value type")
+
+    def assembly_profile_json(self):
+        """Return the profile of the assembly of this operator as a JSON string.
+
+        The profile lists the time spent in the individual assembly phases,
+        event counters, the ranks and memory of the matrix blocks and
+        the thread utilization of parallel loops. None is returned if
+        the operator was not produced by the assembly of a boundary operator.
+
+        """
+        cdef shared_ptr[const c_AssemblyProfile] profile
+% for pyvalue,cyvalue in dtypes.items():
+        if self._value_type=="${pyvalue}":
+            profile = deref(self._impl_${pyvalue}_).assemblyProfile()
+% endfor
+        if not profile.get():
+            return None
+        return deref(profile).toJson().decode("UTF-8")
+
+    def assembly_profile(self):
+        """Return the profile of the assembly of this operator as a dictionary.
+
+        See assembly_profile_json() for a description of its contents.
+
+        """
+        import json
+        profile = self.assembly_profile_json()
+        if profile is None:
+            return None
+        return json.loads(profile)
     
     cpdef np.ndarray _as_matrix(self):
 
@@ -177,7 +296,7 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta):
+            ${scalar_cython_type(cyvalue)} beta) except *:
 
 
         cdef int rows = self.shape[0]
@@ -187,9 +306,6 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
         cdef int yrows = y_inout.shape[0]
         cdef int ycols = y_inout.shape[1]
 
-        cdef Mat[${cyvalue}]* arma_${pyvalue}_buff_x
-        cdef Mat[${cyvalue}]* arma_${pyvalue}_buff_y
-
         if (trans==enums.no_transpose or trans==enums.conjugate):
 
             if not (rows==yrows and cols ==xrows):
@@ -219,16 +335,14 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
         cdef ${cyvalue} cpp_beta = beta
 % endif
 
-        arma_${pyvalue}_buff_x = new Mat[${cyvalue}](<${cyvalue}*>&x_in[0,0],xrows,xcols,False,True)
-        arma_${pyvalue}_buff_y = new Mat[${cyvalue}](<${cyvalue}*>&y_inout[0,0],yrows,ycols,False,True)
-
-        deref(self._impl_${pyvalue}_).apply(trans,
-                deref(arma_${pyvalue}_buff_x),
-                deref(arma_${pyvalue}_buff_y),
-                cpp_alpha,cpp_beta)
+        cdef const c_DiscreteBoundaryOperator[${cyvalue}]* op = self._impl_${pyvalue}_.get()
+        cdef const ${cyvalue}* x_data = <const ${cyvalue}*>np.PyArray_DATA(x_in)
+        cdef ${cyvalue}* y_data = <${cyvalue}*>np.PyArray_DATA(y_inout)
 
-        del arma_${pyvalue}_buff_y
-        del arma_${pyvalue}_buff_x
+        with nogil:
+            _py_apply_discrete_operator[${cyvalue}](deref(op),trans,
+                    x_data,xrows,xcols,y_data,yrows,ycols,
+                    cpp_alpha,cpp_beta)
 % endfor
 
 
@@ -272,7 +386,7 @@ cdef class _ScaledDiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta):
+            ${scalar_cython_type(cyvalue)} beta) except *:
 
 
         self.op._apply_${pyvalue}(trans,x_in,y_inout,self.alpha_${pyvalue}*alpha,beta)
@@ -317,7 +431,7 @@ cdef class _SumDiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta):
+            ${scalar_cython_type(cyvalue)} beta) except *:
 
 
         self.op1._apply_${pyvalue}(trans,x_in,y_inout,alpha,beta)
@@ -358,16 +472,16 @@ cdef class _ProductDiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
     cdef void _apply_${pyvalue}(self, TranspositionMode trans,
   np.ndarray[${scalar_cython_type(cyvalue)}, ndim = 2, mode = 'fortran' ] x_in,
   np.ndarray[${scalar_cython_type(cyvalue)}, ndim = 2, mode = 'fortran' ] y_inout,
-  ${scalar_cython_type(cyvalue)} alpha,${scalar_cython_type(cyvalue)} beta):
+  ${scalar_cython_type(cyvalue)} alpha,${scalar_cython_type(cyvalue)} beta) except *:
 
       cdef np.ndarray[${scalar_cython_type(cyvalue)}, ndim = 2, mode = 'fortran' ] tmp
 
       if (trans == enums.no_transpose or trans == enums.conjugate): 
-          tmp = np.zeros((self.op2.shape[0], x_in.shape[1]), dtype = "${pyvalue}",order = 'F') 
+          tmp = np.empty((self.op2.shape[0], x_in.shape[1]), dtype = "${pyvalue}",order = 'F') 
           self.op2._apply_${pyvalue}(trans, x_in, tmp, 1.0, 0.0)
           self.op1._apply_${pyvalue}(trans, tmp, y_inout, alpha, beta)
       elif( trans == enums.transpose or trans == enums.conjugate_transpose): 
-          tmp = np.zeros((self.op1.shape[1], x_in.shape[1]), dtype = "${pyvalue}",order = 'F') 
+          tmp = np.empty((self.op1.shape[1], x_in.shape[1]), dtype = "${pyvalue}",order = 'F') 
           self.op1._apply_${pyvalue}(trans, x_in, tmp, 1.0, 0.0)
           self.op2._apply_${pyvalue}(trans, tmp, y_inout, alpha, beta)
       else:
@@ -52,8 +52,23 @@ cdef extern from "bempp/assembly/grid_function.hpp" namespace "Bempp":
 cdef extern from "bempp/assembly/py_functors.hpp" namespace "Bempp":
 % for pyvalue,cyvalue in dtypes.items():
     cdef shared_ptr[c_Function[${cyvalue}]] _py_surface_normal_dependent_function_${pyvalue} "Bempp::_py_surface_normal_dependent_function<${ctypes(cyvalue)}>"(
-            void (*callable)(object,object,int, object, object),object,
+            void (*callable)(object,object,int, object, object) except *,object,
             int argumentDimension, int resultDimension) except+catch_exception
+    cdef shared_ptr[c_Function[${cyvalue}]] _py_batched_surface_normal_dependent_function_${pyvalue} "Bempp::_py_batched_surface_normal_dependent_function<${ctypes(cyvalue)}>"(
+            void (*callable)(object,object,object,object,object) except *,object,
+            int argumentDimension, int resultDimension) except+catch_exception
+% endfor
+% for pybasis,cybasis in dtypes.items():
+%     for pyresult,cyresult in dtypes.items():
+%         if pyresult in compatible_dtypes[pybasis]:
+    cdef c_GridFunction[${cybasis},${cyresult}]* _py_grid_function_from_function_${pybasis}_${pyresult} "Bempp::_py_grid_function_from_function<${ctypes(cybasis)},${ctypes(cyresult)}>"(
+            const c_ParameterList& parameterList,
+            const shared_ptr[c_Space[${cybasis}]]& space,
+            const shared_ptr[c_Space[${cybasis}]]& dualSpace,
+            const c_Function[${cyresult}]& function,
+            ConstructionMode mode) except+catch_exception
+%         endif
+%     endfor
 % endfor
 
 cdef class GridFunction:
@@ -12,6 +12,7 @@ from bempp.utils cimport shared_ptr
 from bempp.space.space cimport c_Space, _py_get_space_ptr 
 from bempp.utils.parameter_list cimport ParameterList, c_ParameterList 
 from bempp.utils.armadillo cimport Mat
+from bempp.assembly.grid_function cimport c_Function
 from bempp.utils cimport catch_exception
 from bempp.utils cimport complex_float,complex_double
 from bempp.utils.enum_types cimport construction_mode
@@ -22,10 +23,14 @@ cimport numpy as np
 
 np.import_array()
 
-cdef void _fun_interface(object x, object normal, int domain_index, object res, object call_fun):
+cdef void _fun_interface(object x, object normal, int domain_index, object res, object call_fun) except *:
 
     call_fun(x,normal,domain_index,res) 
 
+cdef void _batched_fun_interface(object x, object normals, object domain_indices, object res, object call_fun) except *:
+
+    call_fun(x,normals,domain_indices,res)
+
 
 cdef class GridFunction:
     """
@@ -50,6 +55,16 @@ cdef class GridFunction:
             fun(x,n,domain_index,result):
                 result[0] =  np.dot(x,n)
 
+       If vectorized=True is passed, the callable is instead invoked once for
+       a whole chunk of elements. In that case x and n are (3 x npoints)
+       arrays, domain_index is a vector of npoints domain indices and result
+       is a (m x npoints) array, where m is the codomain dimension of the
+       space. The arrays are only valid during the call. The example above
+       becomes::
+
+            fun(x,n,domain_index,result):
+                result[0,:] = np.sum(x*n,axis=0)
+
     2. By providing a vector of coefficients at the nodes. This is preferable if
        the coefficients of the data are coming from an external code.
 
@@ -68,6 +83,10 @@ cdef class GridFunction:
     fun : callable
         A Python function from which the GridFunction is constructed
         (optional).
+    vectorized : bool
+        If True, fun is called with all quadrature points of a chunk of
+        elements at once instead of once per point (optional, default
+        False).
     coefficients : np.ndarray
         A 1-dimensional array with the coefficients of the GridFunction
         at the interpolatoin points of the space (optional).
@@ -127,6 +146,7 @@ cdef class GridFunction:
 % for pyvalue,cyvalue in dtypes.items():
         cdef Col[${cyvalue}]* arma_data_${pyvalue}
         cdef ${scalar_cython_type(cyvalue)} [:] data_view_${pyvalue}
+        cdef shared_ptr[c_Function[${cyvalue}]] function_${pyvalue}
 % endfor
 
         if 'parameter_list' in kwargs:
@@ -154,16 +174,23 @@ cdef class GridFunction:
             if 'approximation_mode' in kwargs:
                 approx_mode = kwargs['approximation_mode'].encode("UTF-8")
 
+            vectorized = kwargs.get('vectorized',False)
+
 % for pybasis,cybasis in dtypes.items():
 %     for pyresult,cyresult in dtypes.items():
 %         if pyresult in compatible_dtypes[pybasis]:
             if (self._basis_type=="${pybasis}") and (self._result_type=="${pyresult}"):
+                if vectorized:
+                    function_${pyresult} = _py_batched_surface_normal_dependent_function_${pyresult}(
+                            _batched_fun_interface,kwargs['fun'],3,self._space.codomain_dimension)
+                else:
+                    function_${pyresult} = _py_surface_normal_dependent_function_${pyresult}(
+                            _fun_interface,kwargs['fun'],3,self._space.codomain_dimension)
                 self._impl_${pybasis}_${pyresult}.reset(
-                        new c_GridFunction[${cybasis},${cyresult}](deref((<ParameterList>self.parameter_list).impl_),
+                        _py_grid_function_from_function_${pybasis}_${pyresult}(deref((<ParameterList>self.parameter_list).impl_),
                         _py_get_space_ptr[${cybasis}](self._space.impl_),
                         _py_get_space_ptr[${cybasis}]((<Space>kwargs['dual_space']).impl_),
-                        deref(_py_surface_normal_dependent_function_${pyresult}(_fun_interface,kwargs['fun'],3,
-                            self._space.codomain_dimension)),
+                        deref(function_${pyresult}),
                         construction_mode(approx_mode)))
 %         endif
 %     endfor
@@ -0,0 +1,27 @@
+#ifndef BEMPP_PYTHON_DISCRETE_BOUNDARY_OPERATOR_SUPPORT_HPP
+#define BEMPP_PYTHON_DISCRETE_BOUNDARY_OPERATOR_SUPPORT_HPP
+
+#include "bempp/assembly/discrete_boundary_operator.hpp"
+#include "bempp/assembly/transposition_mode.hpp"
+#include <armadillo>
+
+namespace Bempp {
+
+//! Apply a discrete operator to raw column-major buffers.
+/** The buffers are wrapped in non-owning Armadillo matrices living on the
+ *  stack, so no data is copied. The function does not touch any Python
+ *  object and is therefore safe to call with the GIL released. */
+template <typename ValueType>
+void py_apply_discrete_operator(const DiscreteBoundaryOperator<ValueType> &op,
+                                TranspositionMode trans, const ValueType *x,
+                                int xRows, int xCols, ValueType *y, int yRows,
+                                int yCols, ValueType alpha, ValueType beta) {
+  const arma::Mat<ValueType> xMat(const_cast<ValueType *>(x), xRows, xCols,
+                                  false /* copy_aux_mem */, true /* strict */);
+  arma::Mat<ValueType> yMat(y, yRows, yCols, false, true);
+  op.apply(trans, xMat, yMat, alpha, beta);
+}
+
+} // namespace Bempp
+
+#endif
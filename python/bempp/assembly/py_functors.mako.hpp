@@ -2,8 +2,13 @@
 #define PY_FUNCTORS_HPP
 
 #include "bempp/fiber/surface_normal_and_domain_index_dependent_function.hpp"
+#include "bempp/fiber/batched_surface_normal_and_domain_index_dependent_function.hpp"
 #include "bempp/fiber/scalar_traits.hpp"
+#include "bempp/assembly/grid_function.hpp"
+#include <exception>
 #include <vector>
+#include <stdexcept>
+#include <tbb/enumerable_thread_specific.h>
 #include <armadillo>
 #include <Python.h>
 #include <numpy/arrayobject.h>
@@ -31,6 +36,67 @@ namespace Bempp
     };
 
 
+//! Holds the GIL for the lifetime of the object.
+/** Safe to use on threads that have never run Python code and on threads
+ *  that already hold the GIL. */
+class PyGILGuard
+{
+public:
+    PyGILGuard() : m_state(PyGILState_Ensure()) {}
+    ~PyGILGuard() { PyGILState_Release(m_state); }
+
+private:
+    PyGILGuard(const PyGILGuard&);
+    PyGILGuard& operator=(const PyGILGuard&);
+
+    PyGILState_STATE m_state;
+};
+
+//! C++ exception carrying a Python exception out of a worker thread.
+/** Python exceptions are stored in the state of the thread that raised
+ *  them, so an exception raised by a callable evaluated on a TBB worker
+ *  would not be seen by the thread that started the computation. The
+ *  constructor takes over the current Python exception of the calling
+ *  thread; restore() makes it the current exception of another thread. */
+class PythonError : public std::runtime_error
+{
+public:
+    /** The GIL must be held by the calling thread. */
+    explicit PythonError(const char* message) :
+        std::runtime_error(message), m_state(new State)
+    {
+        PyErr_Fetch(&m_state->type, &m_state->value, &m_state->traceback);
+    }
+
+    /** The GIL must be held by the calling thread. */
+    void restore() const
+    {
+        Py_XINCREF(m_state->type);
+        Py_XINCREF(m_state->value);
+        Py_XINCREF(m_state->traceback);
+        PyErr_Restore(m_state->type, m_state->value, m_state->traceback);
+    }
+
+private:
+    struct State
+    {
+        State() : type(NULL), value(NULL), traceback(NULL) {}
+        ~State()
+        {
+            PyGILGuard gil;
+            Py_XDECREF(type);
+            Py_XDECREF(value);
+            Py_XDECREF(traceback);
+        }
+
+        PyObject* type;
+        PyObject* value;
+        PyObject* traceback;
+    };
+
+    shared_ptr<State> m_state;
+};
+
 template <typename ValueType_>
 class PythonFunctor
 {
@@ -39,46 +105,92 @@ public:
     typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
     typedef void (*pyFunc_t)(PyObject* x, PyObject* normal, int domainIndex, PyObject* result, PyObject* callable);
 
+private:
+    // NumPy arrays passed to the callable. The callable may release the GIL
+    // (the interpreter does so periodically), so each thread needs its own.
+    struct ArgumentBuffers
+    {
+        // The constructors are called by ArgumentBufferFactory and
+        // enumerable_thread_specific::local() with the GIL held
+        ArgumentBuffers(int argumentDimension, int resultDimension)
+        {
+            npy_intp pyArgumentDimension = argumentDimension;
+            npy_intp pyResultDimension = resultDimension;
+            x = PyArray_ZEROS(1,&pyArgumentDimension,NumpyType<CoordinateType>::value,1);
+            normal = PyArray_ZEROS(1,&pyArgumentDimension,NumpyType<CoordinateType>::value,1);
+            result = PyArray_ZEROS(1,&pyResultDimension,NumpyType<ValueType>::value,1);
+        }
+
+        ArgumentBuffers(const ArgumentBuffers& other) :
+            x(other.x), normal(other.normal), result(other.result)
+        {
+            Py_XINCREF(x);
+            Py_XINCREF(normal);
+            Py_XINCREF(result);
+        }
+
+        ~ArgumentBuffers()
+        {
+            PyGILGuard gil;
+            Py_XDECREF(x);
+            Py_XDECREF(normal);
+            Py_XDECREF(result);
+        }
+
+        PyObject* x;
+        PyObject* normal;
+        PyObject* result;
+
+    private:
+        ArgumentBuffers& operator=(const ArgumentBuffers&);
+    };
+
+    struct ArgumentBufferFactory
+    {
+        ArgumentBufferFactory(int argumentDimension, int resultDimension) :
+            argumentDimension(argumentDimension), resultDimension(resultDimension) {}
+
+        ArgumentBuffers operator()() const {
+            return ArgumentBuffers(argumentDimension, resultDimension);
+        }
+
+        int argumentDimension;
+        int resultDimension;
+    };
 
+    typedef tbb::enumerable_thread_specific<ArgumentBuffers> ThreadArgumentBuffers;
 
+public:
     PythonFunctor(
         pyFunc_t pyFunc, PyObject* callable,
         int argumentDimension, int resultDimension) :
             m_pyFunc(pyFunc),
-            m_callable(callable),
             m_argumentDimension(argumentDimension),
-            m_resultDimension(resultDimension)
+            m_resultDimension(resultDimension),
+            m_buffers(new ThreadArgumentBuffers(
+                ArgumentBufferFactory(argumentDimension, resultDimension))),
+            m_callable(callable)
             {
 
+            PyGILGuard gil;
             Py_INCREF(m_callable);
 
-            npy_intp pyArgumentDimension = m_argumentDimension;
-            npy_intp pyResultDimension = m_resultDimension;
-
-            m_x = PyArray_ZEROS(1,&pyArgumentDimension,NumpyType<CoordinateType>::value,1);
-            m_normal = PyArray_ZEROS(1,&pyArgumentDimension,NumpyType<CoordinateType>::value,1);
-            m_result = PyArray_ZEROS(1,&pyResultDimension,NumpyType<ValueType>::value,1);
-
             } 
 
+    // Copies share the per-thread buffers
     PythonFunctor(const PythonFunctor<ValueType>& other):
         m_pyFunc(other.m_pyFunc), m_argumentDimension(other.m_argumentDimension),
-        m_resultDimension(other.m_resultDimension),m_x(other.m_x),m_normal(other.m_normal),
-        m_result(other.m_result),m_callable(other.m_callable) {
+        m_resultDimension(other.m_resultDimension),m_buffers(other.m_buffers),
+        m_callable(other.m_callable) {
 
+            PyGILGuard gil;
             Py_INCREF(m_callable);
-            Py_INCREF(m_x);
-            Py_INCREF(m_normal);
-            Py_INCREF(m_result);
-            
 
         }
 
     ~PythonFunctor(){
 
-        Py_DECREF(m_x);
-        Py_DECREF(m_normal);
-        Py_DECREF(m_result);
+        PyGILGuard gil;
         Py_DECREF(m_callable);
 
     }
@@ -96,15 +208,22 @@ public:
                   int domainIndex, arma::Col<ValueType>& result_) const
     {
 
-        CoordinateType* xPtr = (CoordinateType*)PyArray_DATA(m_x);
+        // May be called from TBB worker threads
+        PyGILGuard gil;
+        const ArgumentBuffers& buffers = m_buffers->local();
+
+        CoordinateType* xPtr = (CoordinateType*)PyArray_DATA(buffers.x);
         for (int i = 0; i< m_argumentDimension;++i) xPtr[i] = point.at(i);
 
-        CoordinateType* normalPtr = (CoordinateType*)PyArray_DATA(m_normal);
+        CoordinateType* normalPtr = (CoordinateType*)PyArray_DATA(buffers.normal);
         for (int i = 0; i< m_argumentDimension;++i) normalPtr[i] = normal.at(i);
 
-        m_pyFunc(m_x,m_normal,domainIndex,m_result,m_callable);
+        m_pyFunc(buffers.x,buffers.normal,domainIndex,buffers.result,m_callable);
+        if (PyErr_Occurred())
+            throw PythonError("PythonFunctor::evaluate(): "
+                              "Python callable raised an exception");
 
-        ValueType* resPtr = (ValueType*)PyArray_DATA(m_result);
+        ValueType* resPtr = (ValueType*)PyArray_DATA(buffers.result);
         for (int i = 0; i< m_resultDimension;++i) result_.at(i) = resPtr[i];
     }
 
@@ -112,9 +231,7 @@ private:
     pyFunc_t m_pyFunc;
     int m_argumentDimension;
     int m_resultDimension;
-    PyObject* m_x;
-    PyObject* m_normal;
-    PyObject* m_result;
+    shared_ptr<ThreadArgumentBuffers> m_buffers;
     PyObject* m_callable;
 
 };
@@ -129,6 +246,166 @@ shared_ptr<Fiber::Function<ValueType>> _py_surface_normal_dependent_function(
         new Fiber::SurfaceNormalAndDomainIndexDependentFunction<PythonFunctor<ValueType>>(
             PythonFunctor<ValueType>(pyFunc,callable,argumentDimension,resultDimension)));
 }
+
+//! Functor passing whole batches of points to a vectorized Python callable.
+/** The callable receives (3 x n) arrays of points and normals, a vector of
+ *  n domain indices and an (m x n) array to be filled with the results. The
+ *  arrays are Fortran-ordered views of the C++ buffers and must not be used
+ *  after the callable returns. */
+template <typename ValueType_>
+class PythonBatchedFunctor
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef void (*pyFunc_t)(PyObject* x, PyObject* normals, PyObject* domainIndices, PyObject* result, PyObject* callable);
+
+    PythonBatchedFunctor(
+        pyFunc_t pyFunc, PyObject* callable,
+        int argumentDimension, int resultDimension) :
+            m_pyFunc(pyFunc),
+            m_argumentDimension(argumentDimension),
+            m_resultDimension(resultDimension),
+            m_callable(callable)
+            {
+
+            PyGILGuard gil;
+            Py_INCREF(m_callable);
+
+            }
+
+    PythonBatchedFunctor(const PythonBatchedFunctor<ValueType>& other):
+        m_pyFunc(other.m_pyFunc), m_argumentDimension(other.m_argumentDimension),
+        m_resultDimension(other.m_resultDimension),m_callable(other.m_callable) {
+
+            PyGILGuard gil;
+            Py_INCREF(m_callable);
+
+        }
+
+    ~PythonBatchedFunctor(){
+
+        PyGILGuard gil;
+        Py_DECREF(m_callable);
+
+    }
+
+    int argumentDimension() const {
+        return m_argumentDimension;
+    }
+
+    int resultDimension() const {
+        return m_resultDimension;
+    }
+
+    void evaluate(const arma::Mat<CoordinateType>& points, const arma::Mat<CoordinateType>& normals,
+                  const std::vector<int>& domainIndices, arma::Mat<ValueType>& result_) const
+    {
+
+        // May be called from TBB worker threads. The arrays wrap this
+        // call's buffers, so concurrent calls do not interfere.
+        PyGILGuard gil;
+
+        npy_intp pointCount = points.n_cols;
+        npy_intp argumentDims[2] = {m_argumentDimension, pointCount};
+        npy_intp resultDims[2] = {m_resultDimension, pointCount};
+
+        PyObject* x = PyArray_New(&PyArray_Type, 2, argumentDims,
+                NumpyType<CoordinateType>::value, NULL,
+                const_cast<CoordinateType*>(points.memptr()), 0,
+                NPY_ARRAY_FARRAY_RO, NULL);
+        PyObject* normal = PyArray_New(&PyArray_Type, 2, argumentDims,
+                NumpyType<CoordinateType>::value, NULL,
+                const_cast<CoordinateType*>(normals.memptr()), 0,
+                NPY_ARRAY_FARRAY_RO, NULL);
+        PyObject* domainIndex = PyArray_New(&PyArray_Type, 1, &pointCount,
+                NPY_INT, NULL, const_cast<int*>(domainIndices.data()), 0,
+                NPY_ARRAY_CARRAY_RO, NULL);
+        PyObject* result = PyArray_New(&PyArray_Type, 2, resultDims,
+                NumpyType<ValueType>::value, NULL, result_.memptr(), 0,
+                NPY_ARRAY_FARRAY, NULL);
+
+        if (x && normal && domainIndex && result)
+            m_pyFunc(x,normal,domainIndex,result,m_callable);
+
+        Py_XDECREF(x);
+        Py_XDECREF(normal);
+        Py_XDECREF(domainIndex);
+        Py_XDECREF(result);
+
+        if (PyErr_Occurred())
+            throw PythonError("PythonBatchedFunctor::evaluate(): "
+                              "Python callable raised an exception");
+    }
+
+private:
+    pyFunc_t m_pyFunc;
+    int m_argumentDimension;
+    int m_resultDimension;
+    PyObject* m_callable;
+
+};
+
+
+template <typename ValueType>
+shared_ptr<Fiber::Function<ValueType>> _py_batched_surface_normal_dependent_function(
+        typename PythonBatchedFunctor<ValueType>::pyFunc_t pyFunc,PyObject* callable,
+        int argumentDimension, int resultDimension)
+{
+    return shared_ptr<Fiber::Function<ValueType>>(
+        new Fiber::BatchedSurfaceNormalAndDomainIndexDependentFunction<PythonBatchedFunctor<ValueType>>(
+            PythonBatchedFunctor<ValueType>(pyFunc,callable,argumentDimension,resultDimension)));
+}
+//! Releases the GIL for the lifetime of the object.
+class PyAllowThreads
+{
+public:
+    PyAllowThreads() : m_state(PyEval_SaveThread()) {}
+    ~PyAllowThreads() { PyEval_RestoreThread(m_state); }
+
+private:
+    PyAllowThreads(const PyAllowThreads&);
+    PyAllowThreads& operator=(const PyAllowThreads&);
+
+    PyThreadState* m_state;
+};
+
+//! Construct a GridFunction from a function with the GIL released.
+/** Projections are computed in parallel, and the Python functors above
+ *  acquire the GIL on the worker threads that evaluate them. If a callable
+ *  raises, its Python exception is restored on the calling thread, where
+ *  catch_exception() lets it pass through. */
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType>* _py_grid_function_from_function(
+        const ParameterList& parameterList,
+        const shared_ptr<const Space<BasisFunctionType>>& space,
+        const shared_ptr<const Space<BasisFunctionType>>& dualSpace,
+        const Fiber::Function<ResultType>& function,
+        ConstructionMode mode)
+{
+    GridFunction<BasisFunctionType, ResultType>* result = 0;
+    std::exception_ptr error;
+    {
+        PyAllowThreads allowThreads;
+        try {
+            result = new GridFunction<BasisFunctionType, ResultType>(
+                parameterList, space, dualSpace, function, mode);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        }
+        catch (const PythonError& pythonError) {
+            pythonError.restore();
+            throw;
+        }
+    }
+    return result;
+}
 } // namespace Bempp
 
 
@@ -25,3 +25,6 @@ cdef extern from "bempp/grid/grid.hpp" namespace "Bempp" nogil:
 cdef class Grid:
     ## Holds pointer to C++ implementation
     cdef shared_ptr[const c_Grid] impl_
+    ## Leaf view caching the bulk element data
+    cdef GridView _leaf_view
+    cdef GridView _cached_leaf_view(self)
@@ -124,6 +124,38 @@ cdef class Grid:
             cdef unique_ptr[c_GridView] view = deref(self.impl_).leafView()
             return _grid_view_from_unique_ptr(view)
 
+    cdef GridView _cached_leaf_view(self):
+        cdef unique_ptr[c_GridView] view
+        if self._leaf_view is None:
+            view = deref(self.impl_).leafView()
+            self._leaf_view = _grid_view_from_unique_ptr(view)
+        return self._leaf_view
+
+    property vertices:
+        """ (3xN) array of the vertices of the leaf view. """
+        def __get__(self):
+            return self._cached_leaf_view().vertices
+
+    property elements:
+        """ (3xN) array of the vertex indices of the leaf elements. """
+        def __get__(self):
+            return self._cached_leaf_view().elements
+
+    property domain_indices:
+        """ Array of the domain indices of the leaf elements. """
+        def __get__(self):
+            return self._cached_leaf_view().domain_indices
+
+    property normals:
+        """ (3xN) array of the unit normals of the leaf elements. """
+        def __get__(self):
+            return self._cached_leaf_view().normals
+
+    property integration_elements:
+        """ Array of the integration elements of the leaf elements. """
+        def __get__(self):
+            return self._cached_leaf_view().integration_elements
+
 
 def grid_from_element_data(vertices, elements, domain_indices=[]):
     """
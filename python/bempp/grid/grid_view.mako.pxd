@@ -3,6 +3,7 @@ codims = [('0','codim_zero'),('1','codim_one'),('2','codim_two')]
 %>
 
 from bempp.utils cimport unique_ptr
+from bempp.utils cimport catch_exception
 from bempp.grid.codim_template cimport codim_zero,codim_one,codim_two
 
 
@@ -27,8 +28,7 @@ cdef extern from "bempp/grid/grid_view.hpp" namespace "Bempp":
         void getRawElementData(Mat[double]& vertices,
                                Mat[int]& elementCorners,
                                Mat[char]& auxData,
-                               vector[int]& domainIndices)
-                                    
+                               vector[int]& domainIndices) except +catch_exception
 
 % for (codim,codim_template) in codims:
         unique_ptr[c_EntityIterator[${codim_template}]]\
@@ -38,12 +38,16 @@ cdef extern from "bempp/grid/grid_view.hpp" namespace "Bempp":
 
 cdef class GridView:
     cdef cbool _raw_data_is_computed 
+    cdef cbool _is_triangular
     cdef np.ndarray _vertices
     cdef np.ndarray _elements
-    cdef vector[int] _domain_indices
+    cdef np.ndarray _domain_indices
+    cdef np.ndarray _normals
+    cdef np.ndarray _integration_elements
     cdef unique_ptr[c_GridView] impl_ 
     cpdef size_t entity_count(self,int codim)
-    cdef void _compute_raw_element_data(self)
+    cdef void _compute_raw_element_data(self) except *
+    cdef void _compute_element_geometry(self) except *
  
 % for (codim,codim_template) in codims:
     cpdef EntityIterator${codim} _entity_iterator${codim}(self)
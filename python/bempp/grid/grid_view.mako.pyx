@@ -13,7 +13,6 @@ from bempp.grid.entity_iterator cimport c_EntityIterator
 from bempp.grid.entity_iterator cimport EntityIterator${codim}
 % endfor
 
-from bempp.utils.armadillo cimport armadillo_to_np_float64, armadillo_to_np_int
 from bempp.utils.armadillo cimport Mat
 from libcpp.vector cimport vector
 
@@ -48,20 +47,71 @@ cdef class GridView:
         return it
 % endfor
 
-    cdef void _compute_raw_element_data(self):
+    cdef void _compute_raw_element_data(self) except *:
         if self._raw_data_is_computed: return
 
+        # The arrays are allocated by NumPy and filled in place by the C++
+        # code, which avoids an intermediate copy of the mesh data
         cdef:
-            Mat[double] vertices
-            Mat[int] elements
+            int dim_world = deref(self.impl_).dimWorld()
+            int max_corner_count = 2 if dim_world == 2 else 4
+            np.ndarray vertices = np.empty(
+                (dim_world, deref(self.impl_).entityCount(self.dim)),
+                dtype='float64', order='F')
+            np.ndarray elements = np.empty(
+                (max_corner_count, deref(self.impl_).entityCount(0)),
+                dtype='intc', order='F')
+            double[::1,:] vertices_view = vertices
+            int[::1,:] elements_view = elements
+            Mat[double]* c_vertices = new Mat[double](&vertices_view[0,0],
+                vertices.shape[0], vertices.shape[1], False, True)
+            Mat[int]* c_elements = new Mat[int](&elements_view[0,0],
+                elements.shape[0], elements.shape[1], False, True)
             Mat[char] aux_data
-
-        deref(self.impl_).getRawElementData(vertices,elements,aux_data,self._domain_indices)
-
-        self._vertices = armadillo_to_np_float64(vertices)
-        self._elements = armadillo_to_np_int(elements)[:-1,:] # Last row not needed for triangular grids
-
-        return
+            vector[int] c_domain_indices
+            np.ndarray domain_indices
+            np.int32_t[::1] domain_indices_view
+            size_t i
+
+        try:
+            deref(self.impl_).getRawElementData(deref(c_vertices),
+                    deref(c_elements), aux_data, c_domain_indices)
+        finally:
+            del c_vertices
+            del c_elements
+
+        domain_indices = np.empty(c_domain_indices.size(), dtype='int32')
+        domain_indices_view = domain_indices
+        for i in range(c_domain_indices.size()):
+            domain_indices_view[i] = c_domain_indices[i]
+
+        # Triangles are stored with -1 in the fourth row; this must be
+        # checked before that row is dropped
+        self._is_triangular = (max_corner_count == 4 and
+                               bool(np.all(elements[3,:] == -1)))
+        self._vertices = vertices
+        self._elements = elements[:-1,:] # Last row not needed for triangular grids
+        self._domain_indices = domain_indices
+        self._raw_data_is_computed = True
+
+    cdef void _compute_element_geometry(self) except *:
+        if self._normals is not None: return
+        self._compute_raw_element_data()
+
+        if self.dim != 2 or self.dim_world != 3:
+            raise ValueError(
+                "Element normals and integration elements are only "
+                "available for surface grids embedded in 3D space")
+        if not self._is_triangular:
+            raise ValueError(
+                "Element normals and integration elements are only "
+                "available for triangular grids")
+        corners = self._vertices[:, self._elements]
+        cross = np.cross(corners[:, 1, :] - corners[:, 0, :],
+                         corners[:, 2, :] - corners[:, 0, :], axis=0)
+        integration_elements = np.sqrt(np.sum(cross * cross, axis=0))
+        self._normals = np.asfortranarray(cross / integration_elements)
+        self._integration_elements = integration_elements
 
 
     def entity_iterator(self,codim):
@@ -100,12 +150,33 @@ cdef class GridView:
             return self._elements
 
     property domain_indices:
-        """ Return the domain indices of the elements. """
+        """ Return an array of the domain indices of the elements. """
 
         def __get__(self):
             self._compute_raw_element_data()
             return self._domain_indices
 
+    property normals:
+        """ Return a (3xN) array of the unit normals of the elements.
+
+            Only available for triangular surface grids.
+        """
+
+        def __get__(self):
+            self._compute_element_geometry()
+            return self._normals
+
+    property integration_elements:
+        """ Return the integration elements of the elements.
+
+            For the flat triangles of a surface grid these are twice the
+            element areas. Only available for triangular surface grids.
+        """
+
+        def __get__(self):
+            self._compute_element_geometry()
+            return self._integration_elements
+
 
 
 cdef GridView _grid_view_from_unique_ptr(unique_ptr[c_GridView]& c_view):
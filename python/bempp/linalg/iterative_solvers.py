@@ -1,7 +1,17 @@
 import scipy.sparse.linalg
 from bempp.assembly import BoundaryOperatorBase, GridFunction
 
-def gmres(A, b, tol=1E-5, restart=None, maxiter=None, M=None, callback=None):
+def _initial_guess(A, x0):
+
+    if x0 is None:
+        return None
+    if not isinstance(x0,GridFunction):
+        raise ValueError("x0 must be of type GridFunction")
+    if x0.coefficients.shape[0] != A.domain.global_dof_count:
+        raise ValueError("x0 must be expanded in the domain of A")
+    return x0.coefficients
+
+def gmres(A, b, tol=1E-5, restart=None, maxiter=None, M=None, callback=None, x0=None):
 
     if not isinstance(A,BoundaryOperatorBase):
         raise ValueError("A must be of type BoundaryOperatorBase")
@@ -10,14 +20,14 @@ def gmres(A, b, tol=1E-5, restart=None, maxiter=None, M=None, callback=None):
         raise ValueError("b must be of type GridFunction")
 
     x, info = scipy.sparse.linalg.gmres(A.weak_form(), b.projections(A.dual_to_range), 
-            tol=tol, restart=restart, maxiter=maxiter, M=M, callback=callback)
+            x0=_initial_guess(A,x0), tol=tol, restart=restart, maxiter=maxiter, M=M, callback=callback)
 
     return (GridFunction(A.domain, result_type=b.result_type,coefficients = x.ravel()),
             info)
 
 
 
-def cg(A, b, tol=1E-5, maxiter=None, M=None, callback=None):
+def cg(A, b, tol=1E-5, maxiter=None, M=None, callback=None, x0=None):
 
     if not isinstance(A,BoundaryOperatorBase):
         raise ValueError("A must be of type BoundaryOperatorBase")
@@ -26,7 +36,7 @@ def cg(A, b, tol=1E-5, maxiter=None, M=None, callback=None):
         raise ValueError("b must be of type GridFunction")
 
     x, info = scipy.sparse.linalg.cg(A.weak_form(), b.projections(A.dual_to_range), 
-            tol=tol, maxiter=maxiter, M=M, callback=callback)
+            x0=_initial_guess(A,x0), tol=tol, maxiter=maxiter, M=M, callback=callback)
 
     return (GridFunction(A.domain, result_type=b.result_type,coefficients = x.ravel()),
             info)
@@ -25,3 +25,49 @@ class TestConnectivityGrid(object):
                 self.vertices,self.corners
         )
 
+
+
+class TestGridGeometry(object):
+    """ Element data and geometry of a grid of two triangles """
+
+    # Unit square in the plane z = 0, both triangles oriented along +z
+    vertices = [[0, 1, 1, 0], [0, 0, 1, 1], [0, 0, 0, 0]]
+    corners = [[0, 1], [1, 2], [3, 3], [-1, -1]]
+    domain_indices = [4, 7]
+
+    @fixture
+    def grid(self):
+        from bempp.grid import grid_from_element_data
+        return grid_from_element_data(
+                self.vertices, self.corners, self.domain_indices)
+
+    def test_elements(self, grid):
+        elements = grid.elements
+        assert elements.shape == (3, 2)
+        assert (elements >= 0).all()
+
+    def test_domain_indices(self, grid):
+        domain_indices = grid.domain_indices
+        from numpy import int32, ndarray
+        assert isinstance(domain_indices, ndarray)
+        assert domain_indices.dtype == int32
+        assert sorted(domain_indices) == self.domain_indices
+
+    def test_normals(self, grid):
+        from numpy import allclose
+        normals = grid.normals
+        assert normals.shape == (3, 2)
+        assert allclose(normals, [[0, 0], [0, 0], [1, 1]])
+
+    def test_integration_elements(self, grid):
+        from numpy import allclose
+        # Twice the areas of the triangles
+        assert allclose(grid.integration_elements, [1, 1])
+
+    def test_structured_grid_geometry(self):
+        from numpy import allclose, abs
+        from bempp.grid import structured_grid
+        grid = structured_grid((0., 0.), (1., 2.), (3, 4))
+        # Flat triangles in the plane z = 0 with a total area of 2
+        assert allclose(abs(grid.normals[2, :]), 1)
+        assert allclose(grid.integration_elements.sum(), 4)
@@ -0,0 +1,44 @@
+from py.test import fixture, mark, raises
+
+
+@fixture
+def space():
+    from os.path import join, exists
+    from bempp.config import paths
+    from bempp.grid import Grid
+    from bempp.space.space import PiecewiseConstantScalarSpace
+    # Large enough for the projection to be split between several threads
+    filename = join(paths.meshes, "sphere-h-0.2.msh")
+    if not exists(filename):
+        raise IOError("Mesh %s does not exist" % filename)
+    grid = Grid(topology="triangular", filename=filename)
+    return PiecewiseConstantScalarSpace(grid, 'float64')
+
+
+def fun(x, normal, domain_index, res):
+    res[0] = x[0] * x[1] + 2 * x[2]
+
+
+def batched_fun(x, normals, domain_indices, res):
+    res[0, :] = x[0, :] * x[1, :] + 2 * x[2, :]
+
+
+def test_pointwise_and_batched_projections_agree(space):
+    from numpy import allclose
+    from bempp.assembly import GridFunction
+    pointwise = GridFunction(space, dual_space=space, fun=fun)
+    batched = GridFunction(space, dual_space=space, fun=batched_fun,
+                           vectorized=True)
+    assert allclose(pointwise.projections(space), batched.projections(space))
+
+
+@mark.parametrize("vectorized", [False, True])
+def test_exception_raised_by_callable_propagates(space, vectorized):
+    from bempp.assembly import GridFunction
+
+    def failing_fun(*args):
+        raise ZeroDivisionError("raised by callable")
+
+    with raises(ZeroDivisionError):
+        GridFunction(space, dual_space=space, fun=failing_fun,
+                     vectorized=vectorized)
@@ -0,0 +1,211 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+#include "../type_template.hpp"
+
+#include "assembly/assembled_potential_operator.hpp"
+#include "assembly/context.hpp"
+#include "assembly/evaluation_options.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/laplace_3d_double_layer_potential_operator.hpp"
+#include "assembly/laplace_3d_single_layer_potential_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+
+#include "common/global_parameters.hpp"
+#include "common/shared_ptr.hpp"
+#include "fiber/scalar_traits.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Tests
+
+using namespace Bempp;
+
+namespace
+{
+
+template <typename BFT, typename RT>
+struct PotentialFixture
+{
+    typedef typename ScalarTraits<RT>::RealType CoordinateType;
+
+    PotentialFixture()
+    {
+        GridParameters params;
+        params.topology = GridParameters::TRIANGULAR;
+        shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+            params, "../../meshes/sphere-h-0.4.msh", false /* verbose */);
+        space.reset(new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+        ParameterList parameters = GlobalParameters::parameterList();
+        parameters.set("verbosityLevel", -5);
+        context.reset(new Context<BFT, RT>(parameters));
+
+        // Points on a sphere of radius 2 around the unit sphere, more than
+        // fit in one tile of the dense assembler
+        const int pointCount = 100;
+        shared_ptr<arma::Mat<CoordinateType> > pointsPtr(
+            new arma::Mat<CoordinateType>(3, pointCount));
+        for (int i = 0; i < pointCount; ++i) {
+            const CoordinateType theta = M_PI * (i + 0.5) / pointCount;
+            const CoordinateType phi = 2. * M_PI * 7. * i / pointCount;
+            (*pointsPtr)(0, i) = 2. * std::sin(theta) * std::cos(phi);
+            (*pointsPtr)(1, i) = 2. * std::sin(theta) * std::sin(phi);
+            (*pointsPtr)(2, i) = 2. * std::cos(theta);
+        }
+        points = pointsPtr;
+
+        evaluationOptions.switchToDenseMode();
+    }
+
+    GridFunction<BFT, RT> randomGridFunction() const
+    {
+        return GridFunction<BFT, RT>(
+            context, space, generateRandomVector<RT>(space->globalDofCount()));
+    }
+
+    shared_ptr<Space<BFT> > space;
+    shared_ptr<const Context<BFT, RT> > context;
+    shared_ptr<const arma::Mat<CoordinateType> > points;
+    NumericalQuadratureStrategy<BFT, RT> quadStrategy;
+    EvaluationOptions evaluationOptions;
+};
+
+template <typename RealType>
+RealType potentialTolerance()
+{
+    return 1000. * std::numeric_limits<RealType>::epsilon();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AssembledPotentialOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(dense_single_layer_potential_agrees_with_evaluateAtPoints,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    PotentialFixture<BFT, RT> fixture;
+    GridFunction<BFT, RT> density = fixture.randomGridFunction();
+    Laplace3dSingleLayerPotentialOperator<BFT, RT> op;
+
+    arma::Mat<RT> expected = op.evaluateAtPoints(
+        density, *fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions);
+    Bempp::AssembledPotentialOperator<BFT, RT> assembled = op.assemble(
+        fixture.space, fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions);
+    arma::Mat<RT> actual = assembled.apply(density);
+
+    BOOST_CHECK_EQUAL(assembled.discreteOperator()->rowCount(),
+                      fixture.points->n_cols);
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    actual, expected, potentialTolerance<RealType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(dense_double_layer_potential_agrees_with_evaluateAtPoints,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    PotentialFixture<BFT, RT> fixture;
+    GridFunction<BFT, RT> density = fixture.randomGridFunction();
+    Laplace3dDoubleLayerPotentialOperator<BFT, RT> op;
+
+    arma::Mat<RT> expected = op.evaluateAtPoints(
+        density, *fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions);
+    arma::Mat<RT> actual = op.assemble(
+        fixture.space, fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions).apply(density);
+
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    actual, expected, potentialTolerance<RealType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched_apply_agrees_with_separate_applies,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    PotentialFixture<BFT, RT> fixture;
+    Laplace3dSingleLayerPotentialOperator<BFT, RT> op;
+    Bempp::AssembledPotentialOperator<BFT, RT> assembled = op.assemble(
+        fixture.space, fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions);
+
+    const int densityCount = 3;
+    const int dofCount = fixture.space->globalDofCount();
+    arma::Mat<RT> coefficients =
+        generateRandomMatrix<RT>(dofCount, densityCount);
+    arma::Mat<RT> batched = assembled.apply(coefficients);
+
+    BOOST_REQUIRE_EQUAL(batched.n_rows, fixture.points->n_cols);
+    BOOST_REQUIRE_EQUAL(batched.n_cols, densityCount);
+    for (int k = 0; k < densityCount; ++k) {
+        GridFunction<BFT, RT> density(
+            fixture.context, fixture.space,
+            arma::Col<RT>(coefficients.col(k)));
+        // apply(GridFunction) returns one row per component and one column
+        // per point; for a scalar potential the data are in the same order
+        arma::Mat<RT> separate = assembled.apply(density);
+        separate.reshape(separate.n_elem, 1);
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        arma::Mat<RT>(batched.col(k)), separate,
+                        potentialTolerance<RealType>()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched_apply_rejects_wrong_coefficient_count,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    PotentialFixture<BFT, RT> fixture;
+    Laplace3dSingleLayerPotentialOperator<BFT, RT> op;
+    Bempp::AssembledPotentialOperator<BFT, RT> assembled = op.assemble(
+        fixture.space, fixture.points, fixture.quadStrategy,
+        fixture.evaluationOptions);
+
+    arma::Mat<RT> coefficients = generateRandomMatrix<RT>(
+        fixture.space->globalDofCount() + 1, 2);
+    BOOST_CHECK_THROW(assembled.apply(coefficients), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../type_template.hpp"
+#include "../random_arrays.hpp"
+
+#include "assembly/discrete_blocked_boundary_operator.hpp"
+#include "assembly/discrete_dense_boundary_operator.hpp"
+#include "fiber/_2d_array.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <vector>
+
+// Tests
+
+using namespace Bempp;
+
+namespace
+{
+
+// 3 x 2 blocked operator with a missing block. The same dense block
+// appears twice, so concurrent block rows share an operator.
+template <typename RT>
+struct DiscreteBlockedBoundaryOperatorFixture
+{
+    DiscreteBlockedBoundaryOperatorFixture() :
+        rowCounts(3), columnCounts(2), blocks(3, 2)
+    {
+        rowCounts[0] = 5; rowCounts[1] = 7; rowCounts[2] = 4;
+        columnCounts[0] = 6; columnCounts[1] = 3;
+
+        matrix.zeros(16, 9);
+        shared_ptr<const DiscreteBoundaryOperator<RT> > shared;
+        for (size_t row = 0, rowStart = 0; row < 3; rowStart += rowCounts[row++])
+            for (size_t col = 0, colStart = 0; col < 2;
+                 colStart += columnCounts[col++]) {
+                if (row == 1 && col == 1)
+                    continue; // null block
+                arma::Mat<RT> mat;
+                if (row == 2 && col == 0)
+                    mat = blocks(0, 0)->asMatrix().rows(0, 3);
+                else
+                    mat = generateRandomMatrix<RT>(rowCounts[row],
+                                                   columnCounts[col]);
+                blocks(row, col) = discreteDenseBoundaryOperator(mat);
+                matrix.submat(rowStart, colStart,
+                              rowStart + rowCounts[row] - 1,
+                              colStart + columnCounts[col] - 1) = mat;
+            }
+        op.reset(new DiscreteBlockedBoundaryOperator<RT>(
+                     blocks, rowCounts, columnCounts));
+    }
+
+    std::vector<size_t> rowCounts, columnCounts;
+    Fiber::_2dArray<shared_ptr<const DiscreteBoundaryOperator<RT> > > blocks;
+    arma::Mat<RT> matrix;
+    shared_ptr<const DiscreteBlockedBoundaryOperator<RT> > op;
+};
+
+// Applies the same operator to several vectors from concurrent tasks
+template <typename RT>
+class ConcurrentApplyLoopBody
+{
+public:
+    ConcurrentApplyLoopBody(const DiscreteBoundaryOperator<RT>& op,
+                            const std::vector<arma::Col<RT> >& x,
+                            std::vector<arma::Col<RT> >& y) :
+        m_op(op), m_x(x), m_y(y)
+    {}
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i)
+            m_op.apply(NO_TRANSPOSE, m_x[i], m_y[i], RT(1.), RT(0.));
+    }
+
+private:
+    const DiscreteBoundaryOperator<RT>& m_op;
+    const std::vector<arma::Col<RT> >& m_x;
+    std::vector<arma::Col<RT> >& m_y;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(DiscreteBlockedBoundaryOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(builtin_apply_agrees_with_assembled_matrix,
+                              ResultType, result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    DiscreteBlockedBoundaryOperatorFixture<RT> fixture;
+    const RT alpha(2.), beta(0.5);
+    const CT tolerance = 100. * std::numeric_limits<CT>::epsilon();
+
+    arma::Col<RT> x = generateRandomVector<RT>(9);
+    arma::Col<RT> y = generateRandomVector<RT>(16);
+    arma::Col<RT> expected = alpha * fixture.matrix * x + beta * y;
+    fixture.op->apply(NO_TRANSPOSE, x, y, alpha, beta);
+    BOOST_CHECK(check_arrays_are_close<RT>(y, expected, tolerance));
+
+    arma::Col<RT> xt = generateRandomVector<RT>(16);
+    arma::Col<RT> yt = generateRandomVector<RT>(9);
+    arma::Col<RT> expectedT = alpha * fixture.matrix.t() * xt + beta * yt;
+    fixture.op->apply(CONJUGATE_TRANSPOSE, xt, yt, alpha, beta);
+    BOOST_CHECK(check_arrays_are_close<RT>(yt, expectedT, tolerance));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(concurrent_apply_gives_same_results_as_serial_apply,
+                              ResultType, result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+
+    DiscreteBlockedBoundaryOperatorFixture<RT> fixture;
+    const size_t vectorCount = 32;
+    std::vector<arma::Col<RT> > x(vectorCount), ySerial(vectorCount),
+            yConcurrent(vectorCount);
+    for (size_t i = 0; i < vectorCount; ++i) {
+        x[i] = generateRandomVector<RT>(9);
+        ySerial[i].set_size(16);
+        yConcurrent[i].set_size(16);
+        fixture.op->apply(NO_TRANSPOSE, x[i], ySerial[i], RT(1.), RT(0.));
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, vectorCount),
+                      ConcurrentApplyLoopBody<RT>(*fixture.op, x, yConcurrent));
+
+    for (size_t i = 0; i < vectorCount; ++i)
+        BOOST_CHECK(check_arrays_are_close<RT>(yConcurrent[i], ySerial[i],
+                                               0. /* identical */));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+#include "../type_template.hpp"
+
+#include "assembly/boundary_operator.hpp"
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_matrix_free_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+
+#include "common/global_parameters.hpp"
+#include "common/shared_ptr.hpp"
+#include "fiber/scalar_traits.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <string>
+
+// Tests
+
+using namespace Bempp;
+
+namespace
+{
+
+// Weak form of the single-layer operator on a sphere with about 700
+// elements, large enough for the block cluster tree to contain admissible
+// blocks, assembled in the given mode
+template <typename BFT, typename RT>
+shared_ptr<const DiscreteBoundaryOperator<RT> > singleLayerWeakForm(
+    const std::string& assemblyType)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.2.msh", false /* verbose */);
+    shared_ptr<Space<BFT> > pwiseConstants(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    ParameterList parameters = GlobalParameters::parameterList();
+    parameters.set("boundaryOperatorAssemblyType", assemblyType);
+    parameters.set("verbosityLevel", -5);
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>(parameters));
+
+    return laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+        context, pwiseConstants, pwiseConstants, pwiseConstants).weakForm();
+}
+
+template <typename RT>
+arma::Mat<RT> applied(const DiscreteBoundaryOperator<RT>& op,
+                      TranspositionMode trans, const arma::Mat<RT>& x,
+                      const arma::Mat<RT>& y, RT alpha, RT beta)
+{
+    arma::Mat<RT> result = y;
+    op.apply(trans, x, result, alpha, beta);
+    return result;
+}
+
+const TranspositionMode transpositionModes[] = {
+    NO_TRANSPOSE, TRANSPOSE, CONJUGATE, CONJUGATE_TRANSPOSE};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(DiscreteMatrixFreeBoundaryOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(apply_agrees_with_dense_and_hmat_apply,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    shared_ptr<const DiscreteBoundaryOperator<RT> > matrixFree =
+            singleLayerWeakForm<BFT, RT>("matrix_free");
+    shared_ptr<const DiscreteBoundaryOperator<RT> > hMat =
+            singleLayerWeakForm<BFT, RT>("hmat");
+    shared_ptr<const DiscreteBoundaryOperator<RT> > dense =
+            singleLayerWeakForm<BFT, RT>("dense");
+
+    shared_ptr<const Bempp::DiscreteMatrixFreeBoundaryOperator<RT> >
+            matrixFreeOp = boost::dynamic_pointer_cast<
+                const Bempp::DiscreteMatrixFreeBoundaryOperator<RT> >(
+                    matrixFree);
+    BOOST_REQUIRE(matrixFreeOp);
+    BOOST_REQUIRE_GT(matrixFreeOp->farFieldBlockCount(), 0u);
+    BOOST_REQUIRE_EQUAL(matrixFree->rowCount(), dense->rowCount());
+    BOOST_REQUIRE_EQUAL(matrixFree->columnCount(), dense->columnCount());
+
+    // The operator is square, so x and y serve for all transposition modes
+    const RT alpha = generateRandomVector<RT>(1)(0);
+    const RT beta = generateRandomVector<RT>(1)(0);
+    const arma::Mat<RT> x = generateRandomMatrix<RT>(dense->columnCount(), 3);
+    const arma::Mat<RT> y = generateRandomMatrix<RT>(dense->rowCount(), 3);
+    for (size_t m = 0; m < sizeof(transpositionModes) /
+                               sizeof(transpositionModes[0]); ++m) {
+        const TranspositionMode trans = transpositionModes[m];
+        const arma::Mat<RT> matrixFreeResult =
+                applied(*matrixFree, trans, x, y, alpha, beta);
+
+        // The far field is evaluated with the quadrature rules of dense
+        // assembly, so the results agree up to rounding
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        matrixFreeResult,
+                        applied(*dense, trans, x, y, alpha, beta),
+                        1000 * std::numeric_limits<RealType>::epsilon()));
+
+        // The H-matrix approximates the far field by ACA with a relative
+        // tolerance of 1e-3
+        const arma::Mat<RT> hMatResult =
+                applied(*hMat, trans, x, y, alpha, beta);
+        BOOST_CHECK_LT(arma::norm(matrixFreeResult - hMatResult, "fro") /
+                       arma::norm(hMatResult, "fro"), RealType(1e-2));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
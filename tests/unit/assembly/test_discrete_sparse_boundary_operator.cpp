@@ -26,10 +26,12 @@
 
 #include "assembly/assembly_options.hpp"
 #include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_sparse_boundary_operator.hpp"
 #include "assembly/boundary_operator.hpp"
 #include "assembly/context.hpp"
 #include "assembly/identity_operator.hpp"
 #include "assembly/numerical_quadrature_strategy.hpp"
+#include "assembly/sparse_inverse.hpp"
 
 #include "bempp/common/config_ahmed.hpp"
 
@@ -45,6 +47,8 @@
 #include <boost/version.hpp>
 #include <complex>
 
+#include <Epetra_CrsMatrix.h>
+
 // Tests
 
 using namespace Bempp;
@@ -243,6 +247,94 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(builtin_apply_works_correctly_for_alpha_equal_to_2
                                            10. * std::numeric_limits<CT>::epsilon()));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(operator_with_imaginary_part_agrees_with_its_matrix, ResultType, complex_result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType BFT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    DiscreteSparseBoundaryOperatorFixture<BFT, RT> fixture;
+    shared_ptr<const Bempp::DiscreteSparseBoundaryOperator<RT> > realOp =
+            Bempp::DiscreteSparseBoundaryOperator<RT>::castToSparse(
+                fixture.op.weakForm());
+
+    // (1 + 2i) M, with M the real matrix of the fixture
+    shared_ptr<Epetra_CrsMatrix> imagMat(
+            new Epetra_CrsMatrix(*realOp->epetraMatrix()));
+    imagMat->Scale(2.);
+    Bempp::DiscreteSparseBoundaryOperator<RT> dop(realOp->epetraMatrix(), imagMat);
+    const arma::Mat<RT> expected = RT(1., 2.) * realOp->asMatrix();
+    BOOST_CHECK(check_arrays_are_close<RT>(dop.asMatrix(), expected,
+                                           10. * std::numeric_limits<CT>::epsilon()));
+
+    RT alpha(2., 3.);
+    RT beta(4., -5.);
+
+    arma::Col<RT> x = generateRandomVector<RT>(dop.columnCount());
+    arma::Col<RT> y = generateRandomVector<RT>(dop.rowCount());
+    arma::Col<RT> expectedY = alpha * expected * x + beta * y;
+    dop.apply(NO_TRANSPOSE, x, y, alpha, beta);
+    BOOST_CHECK(check_arrays_are_close<RT>(y, expectedY,
+                                           10. * std::numeric_limits<CT>::epsilon()));
+
+    arma::Col<RT> xt = generateRandomVector<RT>(dop.rowCount());
+    arma::Col<RT> yt = generateRandomVector<RT>(dop.columnCount());
+    arma::Col<RT> expectedYt = alpha * expected.t() * xt + beta * yt;
+    dop.apply(CONJUGATE_TRANSPOSE, xt, yt, alpha, beta);
+    BOOST_CHECK(check_arrays_are_close<RT>(yt, expectedYt,
+                                           10. * std::numeric_limits<CT>::epsilon()));
+
+    // The same operator stored as the conjugate transpose of its adjoint
+    Bempp::DiscreteSparseBoundaryOperator<RT> adjointOfAdjoint(
+                realOp->epetraMatrix(), imagMat, NO_SYMMETRY,
+                CONJUGATE_TRANSPOSE);
+    BOOST_CHECK(check_arrays_are_close<RT>(adjointOfAdjoint.asMatrix(),
+                                           arma::Mat<RT>(expected.t()),
+                                           10. * std::numeric_limits<CT>::epsilon()));
+    arma::Col<RT> z = generateRandomVector<RT>(adjointOfAdjoint.columnCount());
+    arma::Col<RT> w(adjointOfAdjoint.rowCount());
+    adjointOfAdjoint.apply(NO_TRANSPOSE, z, w, RT(1.), RT(0.));
+    BOOST_CHECK(check_arrays_are_close<RT>(w, arma::Col<RT>(expected.t() * z),
+                                           10. * std::numeric_limits<CT>::epsilon()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(complex_basis_identity_is_a_sparse_operator_with_sparse_inverse, BasisFunctionType, complex_basis_function_types)
+{
+    typedef BasisFunctionType BFT;
+    typedef BasisFunctionType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    shared_ptr<Grid> grid = createRegularTriangularGrid(3, 4);
+    shared_ptr<Space<BFT> > pwiseConstants(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+        new NumericalQuadratureStrategy<BFT, RT>);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+    BoundaryOperator<BFT, RT> op = identityOperator<BFT, RT>(
+        context, pwiseConstants, pwiseConstants, pwiseConstants);
+
+    shared_ptr<const Bempp::DiscreteSparseBoundaryOperator<RT> > sparseOp;
+    BOOST_REQUIRE_NO_THROW(
+        sparseOp = Bempp::DiscreteSparseBoundaryOperator<RT>::castToSparse(
+            op.weakForm()));
+    BOOST_REQUIRE(sparseOp);
+
+    shared_ptr<Epetra_CrsMatrix> inverse =
+            sparseInverse(*sparseOp->epetraMatrix());
+    Bempp::DiscreteSparseBoundaryOperator<RT> inverseOp(inverse);
+    const arma::Mat<RT> product = inverseOp.asMatrix() * sparseOp->asMatrix();
+    const arma::Mat<RT> identity =
+            arma::eye<arma::Mat<RT> >(product.n_rows, product.n_cols);
+    BOOST_CHECK(check_arrays_are_close<RT>(product, identity,
+                                           100. * std::numeric_limits<CT>::epsilon()));
+}
+
 #ifdef WITH_AHMED
 BOOST_AUTO_TEST_CASE_TEMPLATE(asDiscreteAcaBoundaryOperator_works_correctly, ResultType, result_types)
 {
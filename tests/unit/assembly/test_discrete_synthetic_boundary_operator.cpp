@@ -0,0 +1,177 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+#include "../type_template.hpp"
+
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_dense_boundary_operator.hpp"
+#include "assembly/discrete_synthetic_boundary_operator.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include "common/boost_make_shared_fwd.hpp"
+#include "fiber/scalar_traits.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <vector>
+
+// Tests
+
+using namespace Bempp;
+
+namespace
+{
+
+// Random operators U_a (7 x 5), K (5 x 6) and V_a (6 x 4) and weights w_a
+// of a three-term synthetic operator, together with the unfused sum of
+// compositions sum_a w_a U_a K V_a built from the same operators
+template <typename RT>
+struct SyntheticOperatorFixture
+{
+    typedef DiscreteBoundaryOperator<RT> Op;
+    typedef shared_ptr<const Op> ConstOpPtr;
+
+    SyntheticOperatorFixture()
+    {
+        const int termCount = 3;
+        integralOp = boost::make_shared<DiscreteDenseBoundaryOperator<RT> >(
+            generateRandomMatrix<RT>(5, 6));
+        for (int i = 0; i < termCount; ++i) {
+            testOps.push_back(
+                boost::make_shared<DiscreteDenseBoundaryOperator<RT> >(
+                    generateRandomMatrix<RT>(7, 5)));
+            trialOps.push_back(
+                boost::make_shared<DiscreteDenseBoundaryOperator<RT> >(
+                    generateRandomMatrix<RT>(6, 4)));
+        }
+        const arma::Col<RT> w = generateRandomVector<RT>(termCount);
+        weights.assign(w.begin(), w.end());
+    }
+
+    ConstOpPtr unfused(bool withTestOps, bool withTrialOps) const
+    {
+        ConstOpPtr result;
+        for (size_t i = 0; i < weights.size(); ++i) {
+            ConstOpPtr term = integralOp;
+            if (withTrialOps)
+                term = term * trialOps[i];
+            if (withTestOps)
+                term = testOps[i] * term;
+            term = weights[i] * term;
+            result = result ? ConstOpPtr(result + term) : term;
+        }
+        return result;
+    }
+
+    ConstOpPtr fused(bool withTestOps, bool withTrialOps) const
+    {
+        return boost::make_shared<DiscreteSyntheticBoundaryOperator<RT> >(
+            withTestOps ? testOps : std::vector<ConstOpPtr>(), integralOp,
+            withTrialOps ? trialOps : std::vector<ConstOpPtr>(), weights);
+    }
+
+    ConstOpPtr integralOp;
+    std::vector<ConstOpPtr> testOps, trialOps;
+    std::vector<RT> weights;
+};
+
+template <typename RT>
+typename Fiber::ScalarTraits<RT>::RealType tolerance()
+{
+    return 100 * std::numeric_limits<
+        typename Fiber::ScalarTraits<RT>::RealType>::epsilon();
+}
+
+// Checks asMatrix(), which applies the operators to single vectors, and
+// apply() on a multivector in all transposition modes
+template <typename RT>
+void checkFusedAgreesWithUnfused(
+    const shared_ptr<const DiscreteBoundaryOperator<RT> >& fused,
+    const shared_ptr<const DiscreteBoundaryOperator<RT> >& unfused)
+{
+    BOOST_REQUIRE_EQUAL(fused->rowCount(), unfused->rowCount());
+    BOOST_REQUIRE_EQUAL(fused->columnCount(), unfused->columnCount());
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    fused->asMatrix(), unfused->asMatrix(), tolerance<RT>()));
+
+    const TranspositionMode modes[] = {
+        NO_TRANSPOSE, TRANSPOSE, CONJUGATE, CONJUGATE_TRANSPOSE};
+    const RT alpha = generateRandomVector<RT>(1)(0);
+    const RT beta = generateRandomVector<RT>(1)(0);
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        const bool transposed =
+                modes[m] == TRANSPOSE || modes[m] == CONJUGATE_TRANSPOSE;
+        const int inputSize =
+                transposed ? fused->rowCount() : fused->columnCount();
+        const int outputSize =
+                transposed ? fused->columnCount() : fused->rowCount();
+        const arma::Mat<RT> x = generateRandomMatrix<RT>(inputSize, 3);
+        const arma::Mat<RT> y = generateRandomMatrix<RT>(outputSize, 3);
+
+        arma::Mat<RT> fusedResult = y;
+        fused->apply(modes[m], x, fusedResult, alpha, beta);
+        arma::Mat<RT> unfusedResult = y;
+        unfused->apply(modes[m], x, unfusedResult, alpha, beta);
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        fusedResult, unfusedResult, tolerance<RT>()));
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(DiscreteSyntheticBoundaryOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(fused_operator_agrees_with_sum_of_compositions,
+                              RT, result_types)
+{
+    SyntheticOperatorFixture<RT> f;
+    checkFusedAgreesWithUnfused<RT>(f.fused(true, true),
+                                    f.unfused(true, true));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(fused_operator_without_trial_operators_agrees_with_sum_of_compositions,
+                              RT, result_types)
+{
+    SyntheticOperatorFixture<RT> f;
+    checkFusedAgreesWithUnfused<RT>(f.fused(true, false),
+                                    f.unfused(true, false));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(fused_operator_without_test_operators_agrees_with_sum_of_compositions,
+                              RT, result_types)
+{
+    SyntheticOperatorFixture<RT> f;
+    checkFusedAgreesWithUnfused<RT>(f.fused(false, true),
+                                    f.unfused(false, true));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(mismatched_weights_are_rejected,
+                              RT, result_types)
+{
+    SyntheticOperatorFixture<RT> f;
+    std::vector<RT> weights(f.weights.begin(), f.weights.end() - 1);
+    BOOST_CHECK_THROW(Bempp::DiscreteSyntheticBoundaryOperator<RT>(
+                          f.testOps, f.integralOp, f.trialOps, weights),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,11 +22,13 @@
 #include "../type_template.hpp"
 
 #include "assembly/assembly_options.hpp"
+#include "assembly/batched_surface_normal_and_domain_index_dependent_function.hpp"
 #include "assembly/boundary_operator.hpp"
 #include "assembly/context.hpp"
 #include "assembly/grid_function.hpp"
 #include "assembly/identity_operator.hpp"
 #include "assembly/numerical_quadrature_strategy.hpp"
+#include "assembly/surface_normal_and_domain_index_dependent_function.hpp"
 #include "assembly/surface_normal_independent_function.hpp"
 
 #include "common/scalar_traits.hpp"
@@ -38,6 +40,8 @@
 #include "space/piecewise_constant_scalar_space.hpp"
 
 #include <boost/test/floating_point_comparison.hpp>
+#include <limits>
+#include <vector>
 
 using namespace Bempp;
 
@@ -89,6 +93,45 @@ public:
     }
 };
 
+template <typename ValueType_>
+class NormalDependentFunction
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    inline void evaluate(const arma::Col<CoordinateType>& point,
+                         const arma::Col<CoordinateType>& normal,
+                         int domainIndex,
+                         arma::Col<ValueType>& result) const {
+        result(0) = point(0) * normal(2) + point(1) + domainIndex;
+    }
+};
+
+// Same function evaluated on many points at once
+template <typename ValueType_>
+class BatchedNormalDependentFunction
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    void evaluate(const arma::Mat<CoordinateType>& points,
+                  const arma::Mat<CoordinateType>& normals,
+                  const std::vector<int>& domainIndices,
+                  arma::Mat<ValueType>& result) const {
+        for (size_t i = 0; i < points.n_cols; ++i)
+            result(0, i) = points(0, i) * normals(2, i) + points(1, i) +
+                    domainIndices[i];
+    }
+};
+
 // Tests
 
 BOOST_AUTO_TEST_SUITE(GridFunction)
@@ -187,4 +230,40 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(L2Norm_works_for_exponential_function_and_piecewis
     BOOST_CHECK_CLOSE(norm, expectedNorm, 1 /* percent */);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched_function_gives_same_projections_as_pointwise_function, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    Bempp::GridFunction<BFT, RT> pointwise(context, space, space,
+                surfaceNormalAndDomainIndexDependentFunction(
+                    NormalDependentFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> batched(context, space, space,
+                batchedSurfaceNormalAndDomainIndexDependentFunction(
+                    BatchedNormalDependentFunction<RT>()));
+
+    arma::Col<RT> expected = pointwise.projections(*space);
+    arma::Col<RT> actual = batched.projections(*space);
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    actual, expected,
+                    100. * std::numeric_limits<CT>::epsilon()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,226 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_ahmed.hpp"
+
+#include "../check_arrays_are_close.hpp"
+
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+#include "assembly/symmetry.hpp"
+#include "assembly/synthetic_internal_operator_cache.hpp"
+
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+typedef double BFT;
+typedef double RT;
+
+shared_ptr<Grid> loadSphere()
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    return GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.4.msh", false /* verbose */);
+}
+
+// Constructs internal single-layer operators and counts the calls
+struct SingleLayerFactory
+{
+    SingleLayerFactory(const shared_ptr<const Context<BFT, RT> >& context_,
+                       const shared_ptr<const Space<BFT> >& trialSpace_,
+                       const shared_ptr<const Space<BFT> >& testSpace_,
+                       int& callCount_) :
+        context(context_), trialSpace(trialSpace_), testSpace(testSpace_),
+        callCount(callCount_)
+    {}
+
+    BoundaryOperator<BFT, RT> operator()() const {
+        ++callCount;
+        return laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+            context, trialSpace, testSpace, testSpace);
+    }
+
+    shared_ptr<const Context<BFT, RT> > context;
+    shared_ptr<const Space<BFT> > trialSpace;
+    shared_ptr<const Space<BFT> > testSpace;
+    int& callCount;
+};
+
+std::string singleLayerKey()
+{
+    BoundaryOperator<BFT, RT>(*constructor)(
+        const shared_ptr<const Context<BFT, RT> >&,
+        const shared_ptr<const Space<BFT> >&,
+        const shared_ptr<const Space<BFT> >&,
+        const shared_ptr<const Space<BFT> >&,
+        const std::string&, int) =
+        &laplace3dSingleLayerBoundaryOperator<BFT, RT>;
+    return Bempp::SyntheticInternalOperatorCache<BFT, RT>::kernelKey(
+        constructor);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SyntheticInternalOperatorCache)
+
+BOOST_AUTO_TEST_CASE(discontinuous_spaces_of_distinct_spaces_share_one_weak_form)
+{
+    shared_ptr<Grid> grid = loadSphere();
+    shared_ptr<const Space<BFT> > primal(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > other(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > primalDiscontinuous =
+            primal->discontinuousSpace(primal);
+    shared_ptr<const Space<BFT> > otherDiscontinuous =
+            other->discontinuousSpace(other);
+    BOOST_REQUIRE(primalDiscontinuous != otherDiscontinuous);
+
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>());
+    Bempp::SyntheticInternalOperatorCache<BFT, RT>& cache =
+            *context->syntheticInternalOperatorCache();
+    int callCount = 0;
+    BoundaryOperator<BFT, RT> first = cache.internalOperator(
+        singleLayerKey(), primalDiscontinuous, primalDiscontinuous,
+        NO_SYMMETRY, SingleLayerFactory(context, primalDiscontinuous,
+                                        primalDiscontinuous, callCount));
+    BoundaryOperator<BFT, RT> second = cache.internalOperator(
+        singleLayerKey(), otherDiscontinuous, otherDiscontinuous,
+        NO_SYMMETRY, SingleLayerFactory(context, otherDiscontinuous,
+                                        otherDiscontinuous, callCount));
+
+    BOOST_CHECK_EQUAL(callCount, 1);
+    BOOST_CHECK_EQUAL(cache.entryCount(), 1u);
+    BOOST_CHECK(second.domain() == primalDiscontinuous);
+    BOOST_CHECK(first.weakForm() == second.weakForm());
+}
+
+BOOST_AUTO_TEST_CASE(different_kernels_and_symmetries_are_not_shared)
+{
+    shared_ptr<Grid> grid = loadSphere();
+    shared_ptr<const Space<BFT> > primal(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > discontinuous =
+            primal->discontinuousSpace(primal);
+
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>());
+    Bempp::SyntheticInternalOperatorCache<BFT, RT>& cache =
+            *context->syntheticInternalOperatorCache();
+    int callCount = 0;
+    SingleLayerFactory factory(context, discontinuous, discontinuous,
+                               callCount);
+    cache.internalOperator(singleLayerKey(), discontinuous, discontinuous,
+                           NO_SYMMETRY, factory);
+    cache.internalOperator(singleLayerKey(), discontinuous, discontinuous,
+                           SYMMETRIC, factory);
+    cache.internalOperator(singleLayerKey() + " 1", discontinuous,
+                           discontinuous, NO_SYMMETRY, factory);
+
+    BOOST_CHECK_EQUAL(callCount, 3);
+    BOOST_CHECK_EQUAL(cache.entryCount(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_operators_are_discarded)
+{
+    shared_ptr<Grid> grid = loadSphere();
+    shared_ptr<const Space<BFT> > primal(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > discontinuous =
+            primal->discontinuousSpace(primal);
+
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>());
+    Bempp::SyntheticInternalOperatorCache<BFT, RT> cache(2);
+    int callCount = 0;
+    SingleLayerFactory factory(context, discontinuous, discontinuous,
+                               callCount);
+    const std::string key = singleLayerKey();
+    cache.internalOperator(key + " 1", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory);
+    cache.internalOperator(key + " 2", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory);
+    cache.internalOperator(key + " 1", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory); // hit, now most recent
+    cache.internalOperator(key + " 3", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory); // discards key 2
+    BOOST_CHECK_EQUAL(callCount, 3);
+    BOOST_CHECK_EQUAL(cache.entryCount(), 2u);
+
+    cache.internalOperator(key + " 1", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory);
+    BOOST_CHECK_EQUAL(callCount, 3);
+    cache.internalOperator(key + " 2", discontinuous, discontinuous,
+                           NO_SYMMETRY, factory);
+    BOOST_CHECK_EQUAL(callCount, 4);
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.entryCount(), 0u);
+}
+
+#ifdef WITH_AHMED
+
+BOOST_AUTO_TEST_CASE(synthetic_operators_on_distinct_spaces_share_one_internal_operator)
+{
+    shared_ptr<Grid> grid = loadSphere();
+    shared_ptr<const Space<BFT> > primal(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > other(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    accuracyOptions.doubleRegular.setRelativeQuadratureOrder(2);
+    accuracyOptions.singleRegular.setRelativeQuadratureOrder(2);
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    AcaOptions acaOptions;
+    acaOptions.mode = AcaOptions::LOCAL_ASSEMBLY;
+    assemblyOptions.switchToAcaMode(acaOptions);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    BoundaryOperator<BFT, RT> primalOp =
+            laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+                context, primal, primal, primal);
+    BoundaryOperator<BFT, RT> otherOp =
+            laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+                context, other, other, other);
+    BOOST_CHECK_EQUAL(context->syntheticInternalOperatorCache()->entryCount(),
+                      1u);
+
+    arma::Mat<RT> primalMatrix = primalOp.weakForm()->asMatrix();
+    arma::Mat<RT> otherMatrix = otherOp.weakForm()->asMatrix();
+    BOOST_CHECK(check_arrays_are_close<RT>(primalMatrix, otherMatrix, 1e-12));
+}
+
+#endif // WITH_AHMED
+
+BOOST_AUTO_TEST_SUITE_END()
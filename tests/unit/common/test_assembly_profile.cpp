@@ -0,0 +1,123 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "common/assembly_profile.hpp"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/test/unit_test.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+boost::property_tree::ptree parseJson(const std::string& json)
+{
+    std::istringstream in(json);
+    boost::property_tree::ptree result;
+    boost::property_tree::read_json(in, result);
+    return result;
+}
+
+// Loop body recording into the profile current on the thread that created
+// it, in the way the assembly loops do
+class CountingLoopBody
+{
+public:
+    CountingLoopBody() : m_profile(Bempp::AssemblyProfile::current())
+    {}
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        Bempp::AssemblyProfile::Activation activation(m_profile);
+        for (size_t i = r.begin(); i != r.end(); ++i)
+            if (Bempp::AssemblyProfile* profile =
+                    Bempp::AssemblyProfile::current())
+                profile->addCount("iterations", 1);
+    }
+
+private:
+    Bempp::AssemblyProfile* m_profile;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AssemblyProfile)
+
+BOOST_AUTO_TEST_CASE(json_output_is_valid_and_escapes_strings)
+{
+    Bempp::AssemblyProfile profile;
+    const std::string label = "op \"A\"\\B\n\tC\r\x01";
+    profile.setLabel(label);
+    profile.setAssemblyMode("dense");
+    profile.addPhaseTime("phase \"1\"", 0.5);
+    profile.addPhaseTime("phase \"1\"", 0.25);
+    profile.addPhaseTime("unfinished", std::numeric_limits<double>::quiet_NaN());
+    profile.addCount("entries", 7);
+    profile.addCount("entries", 3);
+    profile.addBlock(10, 20, -1, 1.5);
+    profile.addBlock(30, 40, 5, 2.5);
+    profile.addParallelLoop("loop", 4, 2., 6.);
+
+    boost::property_tree::ptree tree;
+    BOOST_REQUIRE_NO_THROW(tree = parseJson(profile.toJson()));
+
+    BOOST_CHECK_EQUAL(tree.get<std::string>("label"), label);
+    BOOST_CHECK_EQUAL(tree.get<std::string>("assemblyMode"), "dense");
+    const boost::property_tree::ptree& phases = tree.get_child("phases");
+    BOOST_CHECK_EQUAL(phases.size(), 2u);
+    BOOST_CHECK_CLOSE(phases.front().second.get_value<double>(), 0.75, 1e-10);
+    BOOST_CHECK_EQUAL(phases.back().second.get_value<std::string>(), "null");
+    BOOST_CHECK_EQUAL(tree.get<size_t>("counters.entries"), 10u);
+    BOOST_CHECK_EQUAL(tree.get<size_t>("blocks.count"), 2u);
+    BOOST_CHECK_EQUAL(tree.get<size_t>("blocks.denseCount"), 1u);
+    BOOST_CHECK_EQUAL(tree.get<size_t>("blocks.lowRankCount"), 1u);
+    BOOST_CHECK_CLOSE(tree.get<double>("blocks.memSizeKb"), 4., 1e-10);
+    BOOST_CHECK_EQUAL(tree.get<size_t>("blocks.rankHistogram.5"), 1u);
+    const boost::property_tree::ptree& loop =
+            tree.get_child("parallelLoops").front().second;
+    BOOST_CHECK_EQUAL(loop.get<std::string>("name"), "loop");
+    BOOST_CHECK_EQUAL(loop.get<int>("threadCount"), 4);
+    BOOST_CHECK_CLOSE(loop.get<double>("utilization"), 0.75, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(counts_recorded_on_worker_threads_are_aggregated)
+{
+    const size_t iterationCount = 100000;
+    Bempp::AssemblyProfile profile;
+    {
+        Bempp::AssemblyProfile::Activation activation(profile);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, iterationCount, 100),
+                          CountingLoopBody());
+        // The calling thread's profile is left in place
+        BOOST_CHECK_EQUAL(Bempp::AssemblyProfile::current(), &profile);
+    }
+    BOOST_CHECK(Bempp::AssemblyProfile::current() == 0);
+
+    BOOST_CHECK_EQUAL(profile.count("iterations"), iterationCount);
+    BOOST_CHECK_EQUAL(parseJson(profile.toJson()).get<size_t>(
+                          "counters.iterations"), iterationCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
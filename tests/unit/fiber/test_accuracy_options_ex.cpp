@@ -22,6 +22,7 @@
 #include "fiber/quadrature_options.hpp"
 
 #include <boost/test/unit_test.hpp>
+#include <stdexcept>
 
 // Tests
 
@@ -232,4 +233,32 @@ BOOST_AUTO_TEST_CASE(quadratureOrder_agrees_with_setDoubleRegular_for_three_rela
     BOOST_CHECK_EQUAL(orderFar, defaultOrder + order3);
 }
 
+BOOST_AUTO_TEST_CASE(setDoubleRegularAdaptive_switches_adaptive_mode_on)
+{
+    Fiber::AccuracyOptionsEx opts;
+    BOOST_CHECK(!opts.doubleRegularIsAdaptive());
+    opts.setDoubleRegularAdaptive(1e-6, 12);
+
+    BOOST_CHECK(opts.doubleRegularIsAdaptive());
+    BOOST_CHECK_EQUAL(opts.doubleRegularTolerance(), 1e-6);
+    BOOST_CHECK_EQUAL(opts.doubleRegularMaxOrder(), 12);
+}
+
+BOOST_AUTO_TEST_CASE(setDoubleRegular_switches_adaptive_mode_off)
+{
+    Fiber::AccuracyOptionsEx opts;
+    opts.setDoubleRegularAdaptive(1e-6);
+    opts.setDoubleRegular(2);
+
+    BOOST_CHECK(!opts.doubleRegularIsAdaptive());
+}
+
+BOOST_AUTO_TEST_CASE(setDoubleRegularAdaptive_rejects_invalid_arguments)
+{
+    Fiber::AccuracyOptionsEx opts;
+    BOOST_CHECK_THROW(opts.setDoubleRegularAdaptive(0.), std::invalid_argument);
+    BOOST_CHECK_THROW(opts.setDoubleRegularAdaptive(1e-6, 21),
+                      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
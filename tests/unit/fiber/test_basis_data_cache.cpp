@@ -0,0 +1,206 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/basis_data.hpp"
+#include "fiber/basis_data_cache.hpp"
+#include "fiber/constant_scalar_shapeset.hpp"
+#include "fiber/linear_scalar_shapeset.hpp"
+#include "fiber/scalar_traits.hpp"
+#include "fiber/shapeset.hpp"
+#include "../type_template.hpp"
+#include "../check_arrays_are_close.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <tbb/atomic.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <vector>
+
+namespace
+{
+
+// Shapeset counting the calls to evaluate() of the shapeset it wraps
+template <typename ValueType>
+class CountingShapeset : public Fiber::Shapeset<ValueType>
+{
+public:
+    typedef typename Fiber::Shapeset<ValueType>::CoordinateType
+    CoordinateType;
+
+    explicit CountingShapeset(const Fiber::Shapeset<ValueType>& shapeset) :
+        m_shapeset(shapeset) {
+        m_evaluationCount = 0;
+    }
+
+    int size() const { return m_shapeset.size(); }
+    int order() const { return m_shapeset.order(); }
+
+    void evaluate(size_t what, const arma::Mat<CoordinateType>& points,
+                  Fiber::LocalDofIndex localDofIndex,
+                  Fiber::BasisData<ValueType>& data) const {
+        ++m_evaluationCount;
+        m_shapeset.evaluate(what, points, localDofIndex, data);
+    }
+
+    int evaluationCount() const { return m_evaluationCount; }
+
+private:
+    const Fiber::Shapeset<ValueType>& m_shapeset;
+    mutable tbb::atomic<int> m_evaluationCount;
+};
+
+// Points on the reference triangle
+template <typename CoordinateType>
+arma::Mat<CoordinateType> referencePoints()
+{
+    arma::Mat<CoordinateType> points(2, 4);
+    points(0, 0) = 0.1; points(1, 0) = 0.2;
+    points(0, 1) = 0.5; points(1, 1) = 0.3;
+    points(0, 2) = 0.0; points(1, 2) = 1.0;
+    points(0, 3) = 0.25; points(1, 3) = 0.7;
+    return points;
+}
+
+template <typename ValueType>
+class GetLoopBody
+{
+public:
+    typedef Fiber::BasisDataCache<ValueType> Cache;
+
+    GetLoopBody(const Cache& cache, const Fiber::Shapeset<ValueType>& shapeset,
+                std::vector<const Fiber::BasisData<ValueType>*>& results) :
+        m_cache(cache), m_shapeset(shapeset), m_results(results)
+    {}
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i)
+            m_results[i] = &m_cache.get(m_shapeset);
+    }
+
+private:
+    const Cache& m_cache;
+    const Fiber::Shapeset<ValueType>& m_shapeset;
+    std::vector<const Fiber::BasisData<ValueType>*>& m_results;
+};
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(BasisDataCache)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(first_get_evaluates_and_later_gets_hit,
+                              ValueType, basis_function_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    Fiber::LinearScalarShapeset<3, ValueType> linear;
+    CountingShapeset<ValueType> shapeset(linear);
+    Fiber::BasisDataCache<ValueType> cache(
+        referencePoints<CoordinateType>(), Fiber::VALUES);
+
+    // A miss evaluates all shape functions at once and one by one
+    const Fiber::BasisData<ValueType>& first = cache.get(shapeset);
+    BOOST_CHECK_EQUAL(shapeset.evaluationCount(), 1 + shapeset.size());
+
+    const Fiber::BasisData<ValueType>& second = cache.get(shapeset);
+    cache.get(shapeset, 1);
+    BOOST_CHECK_EQUAL(shapeset.evaluationCount(), 1 + shapeset.size());
+    BOOST_CHECK_EQUAL(&first, &second);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(different_shapesets_miss,
+                              ValueType, basis_function_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    Fiber::LinearScalarShapeset<3, ValueType> linear;
+    Fiber::ConstantScalarShapeset<ValueType> constant;
+    CountingShapeset<ValueType> linearShapeset(linear);
+    CountingShapeset<ValueType> constantShapeset(constant);
+    Fiber::BasisDataCache<ValueType> cache(
+        referencePoints<CoordinateType>(), Fiber::VALUES);
+
+    const Fiber::BasisData<ValueType>& linearData =
+            cache.get(linearShapeset);
+    const Fiber::BasisData<ValueType>& constantData =
+            cache.get(constantShapeset);
+    BOOST_CHECK_EQUAL(linearShapeset.evaluationCount(),
+                      1 + linearShapeset.size());
+    BOOST_CHECK_EQUAL(constantShapeset.evaluationCount(),
+                      1 + constantShapeset.size());
+    BOOST_CHECK(&linearData != &constantData);
+    BOOST_CHECK_EQUAL(linearData.functionCount(), 3);
+    BOOST_CHECK_EQUAL(constantData.functionCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(cached_data_agree_with_direct_evaluation,
+                              ValueType, basis_function_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    const arma::Mat<CoordinateType> points = referencePoints<CoordinateType>();
+    Fiber::LinearScalarShapeset<3, ValueType> shapeset;
+    const size_t what = Fiber::VALUES | Fiber::DERIVATIVES;
+    Fiber::BasisDataCache<ValueType> cache(points, what);
+
+    Fiber::BasisData<ValueType> expected;
+    shapeset.evaluate(what, points, Fiber::ALL_DOFS, expected);
+    const Fiber::BasisData<ValueType>& cached = cache.get(shapeset);
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    cached.values, expected.values, 0. /* identical */));
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    cached.derivatives, expected.derivatives, 0.));
+
+    for (int dof = 0; dof < shapeset.size(); ++dof) {
+        shapeset.evaluate(what, points, dof, expected);
+        const Fiber::BasisData<ValueType>& cachedDof =
+                cache.get(shapeset, dof);
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        cachedDof.values, expected.values, 0.));
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        cachedDof.derivatives, expected.derivatives, 0.));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(concurrent_gets_return_one_entry,
+                              ValueType, basis_function_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    Fiber::LinearScalarShapeset<3, ValueType> linear;
+    CountingShapeset<ValueType> shapeset(linear);
+    Fiber::BasisDataCache<ValueType> cache(
+        referencePoints<CoordinateType>(), Fiber::VALUES);
+
+    const size_t getCount = 1000;
+    std::vector<const Fiber::BasisData<ValueType>*> results(getCount);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, getCount),
+                      GetLoopBody<ValueType>(cache, shapeset, results));
+
+    // Threads racing on the first get may all evaluate the shapeset, but
+    // only one entry is kept and later gets hit
+    const int evaluationCount = shapeset.evaluationCount();
+    BOOST_CHECK_EQUAL(evaluationCount % (1 + shapeset.size()), 0);
+    for (size_t i = 0; i < getCount; ++i)
+        BOOST_CHECK_EQUAL(results[i], results[0]);
+    BOOST_CHECK_EQUAL(&cache.get(shapeset), results[0]);
+    BOOST_CHECK_EQUAL(shapeset.evaluationCount(), evaluationCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,288 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../type_template.hpp"
+
+#include "assembly/assembly_options.hpp"
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+#include "common/assembly_profile.hpp"
+#include "common/shared_ptr.hpp"
+#include "common/to_string.hpp"
+#include "fiber/accuracy_options.hpp"
+#include "fiber/constant_scalar_shapeset.hpp"
+#include "fiber/default_quadrature_descriptor_selector_for_integral_operators.hpp"
+#include "fiber/numerical_quadrature.hpp"
+#include "fiber/raw_grid_geometry.hpp"
+#include "fiber/scalar_traits.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Distances between the element centres, relative to the element size
+const double NORMALISED_DISTANCES[] = {1.5, 2., 3., 5., 8., 13., 21.};
+const int DISTANCE_COUNT =
+        sizeof(NORMALISED_DISTANCES) / sizeof(NORMALISED_DISTANCES[0]);
+const double ELEMENT_SIZE = std::sqrt(2.); // longest edge
+
+/** \brief Fixture class.
+ *
+ *  Element 0 is the reference triangle; element i > 0 is its copy
+ *  translated along the z axis by NORMALISED_DISTANCES[i - 1] * ELEMENT_SIZE,
+ *  so that no two elements share a vertex. All elements carry the constant
+ *  shapeset, so the selected orders equal the increases chosen by the error
+ *  model. */
+template <typename BFT>
+struct SelectorFixture
+{
+    typedef typename Fiber::ScalarTraits<BFT>::RealType CT;
+    typedef Fiber::DefaultQuadratureDescriptorSelectorForIntegralOperators<BFT>
+    Selector;
+    typedef std::vector<const Fiber::Shapeset<BFT>*> ShapesetPtrVector;
+
+    SelectorFixture()
+    {
+        const int elementCount = DISTANCE_COUNT + 1;
+        rawGeometry = boost::make_shared<Fiber::RawGridGeometry<CT> >(2, 3);
+        arma::Mat<CT>& vertices = rawGeometry->vertices();
+        arma::Mat<int>& corners = rawGeometry->elementCornerIndices();
+        vertices.set_size(3, 3 * elementCount);
+        corners.set_size(4, elementCount);
+        for (int e = 0; e < elementCount; ++e) {
+            const double z =
+                    (e == 0) ? 0. : NORMALISED_DISTANCES[e - 1] * ELEMENT_SIZE;
+            const double x[3] = {0., 1., 0.};
+            const double y[3] = {0., 0., 1.};
+            for (int v = 0; v < 3; ++v) {
+                vertices(0, 3 * e + v) = x[v];
+                vertices(1, 3 * e + v) = y[v];
+                vertices(2, 3 * e + v) = z;
+                corners(v, e) = 3 * e + v;
+            }
+            corners(3, e) = -1;
+        }
+        rawGeometry->domainIndices().assign(elementCount, 0);
+
+        shapesets = boost::make_shared<ShapesetPtrVector>(
+                    elementCount, &shapeset);
+    }
+
+    shared_ptr<Selector> makeSelector(double tolerance, int maxOrder) const
+    {
+        Fiber::AccuracyOptionsEx options;
+        options.setDoubleRegularAdaptive(tolerance, maxOrder);
+        return boost::make_shared<Selector>(
+                    rawGeometry, rawGeometry, shapesets, shapesets, options);
+    }
+
+    Fiber::ConstantScalarShapeset<BFT> shapeset;
+    shared_ptr<Fiber::RawGridGeometry<CT> > rawGeometry;
+    shared_ptr<ShapesetPtrVector> shapesets;
+};
+
+// Integral of 1 / |x - y| over the reference triangle (x) and its copy
+// translated by height along the z axis (y)
+double integrateInverseDistance(double height, int testOrder, int trialOrder)
+{
+    arma::Mat<double> testPoints, trialPoints;
+    std::vector<double> testWeights, trialWeights;
+    Fiber::fillSingleQuadraturePointsAndWeights(
+                3, testOrder, testPoints, testWeights);
+    Fiber::fillSingleQuadraturePointsAndWeights(
+                3, trialOrder, trialPoints, trialWeights);
+    double result = 0.;
+    for (size_t i = 0; i < testWeights.size(); ++i)
+        for (size_t j = 0; j < trialWeights.size(); ++j) {
+            const double dx = testPoints(0, i) - trialPoints(0, j);
+            const double dy = testPoints(1, i) - trialPoints(1, j);
+            result += testWeights[i] * trialWeights[j] /
+                    std::sqrt(dx * dx + dy * dy + height * height);
+        }
+    return result;
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(DefaultQuadratureDescriptorSelectorForIntegralOperators)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(adaptive_orders_do_not_grow_with_distance,
+                              BFT, basis_function_types)
+{
+    SelectorFixture<BFT> fixture;
+    shared_ptr<typename SelectorFixture<BFT>::Selector> selector =
+            fixture.makeSelector(1e-6, 20);
+
+    // Actual distances between element centres
+    int previousOrder = 21;
+    for (int e = 1; e <= DISTANCE_COUNT; ++e) {
+        Fiber::DoubleQuadratureDescriptor desc =
+                selector->quadratureDescriptor(0, e, -1.);
+        BOOST_CHECK(desc.topology.type == Fiber::ElementPairTopology::Disjoint);
+        BOOST_CHECK_EQUAL(desc.testOrder, desc.trialOrder);
+        BOOST_CHECK_LE(desc.testOrder, previousOrder);
+        previousOrder = desc.testOrder;
+    }
+    // The nearest pair needs more than the exact order of the basis
+    BOOST_CHECK_GT(selector->quadratureDescriptor(0, 1, -1.).testOrder, 0);
+
+    // Nominal distances
+    previousOrder = 21;
+    for (double distance = 0.5; distance < 100.; distance *= 1.5) {
+        Fiber::DoubleQuadratureDescriptor desc =
+                selector->quadratureDescriptor(0, 1, distance);
+        BOOST_CHECK_LE(desc.testOrder, previousOrder);
+        previousOrder = desc.testOrder;
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(adaptive_orders_do_not_drop_with_tolerance,
+                              BFT, basis_function_types)
+{
+    SelectorFixture<BFT> fixture;
+    const double tolerances[] = {1e-2, 1e-4, 1e-6, 1e-8};
+    const int toleranceCount = sizeof(tolerances) / sizeof(tolerances[0]);
+    const int maxOrder = 12;
+
+    for (int e = 1; e <= DISTANCE_COUNT; ++e) {
+        int previousOrder = 0;
+        for (int t = 0; t < toleranceCount; ++t) {
+            const int order = fixture.makeSelector(tolerances[t], maxOrder)
+                    ->quadratureDescriptor(0, e, -1.).testOrder;
+            BOOST_CHECK_GE(order, previousOrder);
+            BOOST_CHECK_LE(order, maxOrder);
+            previousOrder = order;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(adaptive_orders_meet_tolerance,
+                              BFT, basis_function_types)
+{
+    SelectorFixture<BFT> fixture;
+    const double tolerances[] = {1e-3, 1e-6};
+    const int toleranceCount = sizeof(tolerances) / sizeof(tolerances[0]);
+    const int maxOrder = 20;
+
+    for (int t = 0; t < toleranceCount; ++t) {
+        shared_ptr<typename SelectorFixture<BFT>::Selector> selector =
+                fixture.makeSelector(tolerances[t], maxOrder);
+        for (int e = 1; e <= DISTANCE_COUNT; ++e) {
+            Fiber::DoubleQuadratureDescriptor desc =
+                    selector->quadratureDescriptor(0, e, -1.);
+            BOOST_REQUIRE_LT(desc.testOrder, maxOrder);
+            const double height = NORMALISED_DISTANCES[e - 1] * ELEMENT_SIZE;
+            const double reference =
+                    integrateInverseDistance(height, maxOrder, maxOrder);
+            const double error = std::abs(
+                        integrateInverseDistance(
+                            height, desc.testOrder, desc.trialOrder) -
+                        reference) / reference;
+            // The error model is calibrated for a single rule; the test and
+            // trial rules each contribute at most the tolerance
+            BOOST_CHECK_LE(error, 2. * tolerances[t]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(report_statistics_flushes_histogram_to_profile,
+                              BFT, basis_function_types)
+{
+    SelectorFixture<BFT> fixture;
+    shared_ptr<typename SelectorFixture<BFT>::Selector> selector =
+            fixture.makeSelector(1e-6, 20);
+    for (int e = 1; e <= DISTANCE_COUNT; ++e)
+        selector->quadratureDescriptor(0, e, -1.);
+
+    std::vector<size_t> histogram = selector->regularOrderHistogram();
+    size_t total = 0;
+    for (size_t order = 0; order < histogram.size(); ++order)
+        total += histogram[order];
+    BOOST_CHECK_EQUAL(total, size_t(DISTANCE_COUNT));
+
+    Bempp::AssemblyProfile profile;
+    {
+        Bempp::AssemblyProfile::Activation activation(profile);
+        selector->reportStatistics();
+    }
+    for (size_t order = 0; order < histogram.size(); ++order)
+        BOOST_CHECK_EQUAL(
+                    profile.count("regularQuadratureOrder" + toString(order)),
+                    histogram[order]);
+
+    // The histogram is reset, so that nothing is reported twice
+    histogram = selector->regularOrderHistogram();
+    for (size_t order = 0; order < histogram.size(); ++order)
+        BOOST_CHECK_EQUAL(histogram[order], 0u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(weak_form_profile_contains_quadrature_orders,
+                              ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, "../../meshes/sphere-h-0.4.msh", false /* verbose */);
+    shared_ptr<Space<BFT> > space(
+                new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    Fiber::AccuracyOptionsEx accuracyOptions;
+    accuracyOptions.setDoubleRegularAdaptive(1e-4);
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+                new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    BoundaryOperator<BFT, RT> op =
+            laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+                context, space, space, space);
+    shared_ptr<const Bempp::AssemblyProfile> profile =
+            op.weakForm()->assemblyProfile();
+    BOOST_REQUIRE(profile);
+
+    // The orders are recorded once the assembly has finished, while the
+    // local assembler still exists
+    size_t total = 0;
+    for (int order = 0; order <= 20; ++order)
+        total += profile->count("regularQuadratureOrder" + toString(order));
+    BOOST_CHECK_GT(total, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
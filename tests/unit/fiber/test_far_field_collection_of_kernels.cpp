@@ -0,0 +1,155 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/collection_of_4d_arrays.hpp"
+#include "fiber/default_collection_of_kernels.hpp"
+#include "fiber/far_field_collection_of_kernels.hpp"
+#include "fiber/geometrical_data.hpp"
+#include "fiber/modified_helmholtz_3d_far_field_double_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_far_field_single_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_maxwell_3d_far_field_double_layer_potential_operator_kernel_functor.hpp"
+#include "fiber/modified_maxwell_3d_far_field_single_layer_potential_operator_kernel_functor.hpp"
+#include "fiber/scalar_traits.hpp"
+
+#include "../type_template.hpp"
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <complex>
+#include <limits>
+
+namespace
+{
+
+// Compare the far-field collection of kernels built from the given functor
+// with the default one, which evaluates the phase factor pair by pair
+template <typename Functor>
+void checkAgreesWithDefaultCollectionOfKernels(const Functor& functor)
+{
+    typedef typename Functor::ValueType ValueType;
+    typedef typename Functor::CoordinateType CoordinateType;
+
+    Fiber::GeometricalData<CoordinateType> testGeomData, trialGeomData;
+    const int worldDim = 3;
+    // Different counts, so that swapped test and trial indices are detected
+    const int testPointCount = 5, trialPointCount = 7;
+
+    // Far-field directions are unit vectors
+    testGeomData.globals =
+        generateRandomMatrix<CoordinateType>(worldDim, testPointCount);
+    for (int i = 0; i < testPointCount; ++i)
+        testGeomData.globals.col(i) /= arma::norm(testGeomData.globals.col(i), 2);
+    trialGeomData.globals =
+        generateRandomMatrix<CoordinateType>(worldDim, trialPointCount);
+    trialGeomData.normals =
+        generateRandomMatrix<CoordinateType>(worldDim, trialPointCount);
+    for (int i = 0; i < trialPointCount; ++i)
+        trialGeomData.normals.col(i) /=
+                arma::norm(trialGeomData.normals.col(i), 2);
+
+    Fiber::CollectionOf4dArrays<ValueType> expected, actual;
+    Fiber::DefaultCollectionOfKernels<Functor>(functor).evaluateOnGrid(
+        testGeomData, trialGeomData, expected);
+    Fiber::FarFieldCollectionOfKernels<Functor>(functor).evaluateOnGrid(
+        testGeomData, trialGeomData, actual);
+
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    const CoordinateType tolerance =
+            100. * std::numeric_limits<CoordinateType>::epsilon();
+    for (size_t k = 0; k < expected.size(); ++k)
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        actual[k], expected[k], tolerance));
+}
+
+// Purely imaginary wave numbers take the separate cosine/sine path
+template <typename ValueType>
+ValueType oscillatoryWaveNumber()
+{
+    return ValueType(0., 3.);
+}
+
+template <typename ValueType>
+ValueType dampedWaveNumber()
+{
+    return ValueType(0.5, 2.);
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(FarFieldCollectionOfKernels)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(helmholtz_single_layer_agrees_with_default_collection,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dFarFieldSingleLayerPotentialKernelFunctor<
+            ValueType> Functor;
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(oscillatoryWaveNumber<ValueType>()));
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(dampedWaveNumber<ValueType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(helmholtz_double_layer_agrees_with_default_collection,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dFarFieldDoubleLayerPotentialKernelFunctor<
+            ValueType> Functor;
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(oscillatoryWaveNumber<ValueType>()));
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(dampedWaveNumber<ValueType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(maxwell_single_layer_agrees_with_default_collection,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedMaxwell3dFarFieldSingleLayerPotentialOperatorKernelFunctor<
+            ValueType> Functor;
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(oscillatoryWaveNumber<ValueType>()));
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(dampedWaveNumber<ValueType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(maxwell_double_layer_agrees_with_default_collection,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedMaxwell3dFarFieldDoubleLayerPotentialOperatorKernelFunctor<
+            ValueType> Functor;
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(oscillatoryWaveNumber<ValueType>()));
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(dampedWaveNumber<ValueType>()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(helmholtz_single_layer_agrees_with_default_collection_for_real_wave_number,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dFarFieldSingleLayerPotentialKernelFunctor<
+            ValueType> Functor;
+    checkAgreesWithDefaultCollectionOfKernels(
+        Functor(static_cast<ValueType>(1.5)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
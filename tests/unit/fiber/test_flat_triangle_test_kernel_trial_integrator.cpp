@@ -0,0 +1,248 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../type_template.hpp"
+
+#include "assembly/local_assembler_construction_helper.hpp"
+#include "common/shared_ptr.hpp"
+#include "fiber/default_collection_of_kernels.hpp"
+#include "fiber/default_collection_of_shapeset_transformations.hpp"
+#include "fiber/flat_triangle_test_kernel_trial_integrator.hpp"
+#include "fiber/laplace_3d_double_layer_potential_kernel_functor.hpp"
+#include "fiber/laplace_3d_single_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_double_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_single_layer_potential_kernel_functor.hpp"
+#include "fiber/numerical_quadrature.hpp"
+#include "fiber/opencl_handler.hpp"
+#include "fiber/raw_grid_geometry.hpp"
+#include "fiber/scalar_function_value_functor.hpp"
+#include "fiber/scalar_traits.hpp"
+#include "fiber/separable_numerical_test_kernel_trial_integrator.hpp"
+#include "fiber/typical_test_scalar_kernel_trial_integral.hpp"
+#include "grid/geometry_factory.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "space/piecewise_constant_scalar_space.hpp"
+#include "space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <complex>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace Bempp;
+
+namespace
+{
+
+/** \brief Fixture class.
+ *
+ *  Raw geometry, geometry factory and shapesets of piecewise constant and
+ *  piecewise linear spaces on a sphere, together with a list of pairs of
+ *  elements sharing no vertex. */
+template <typename BFT>
+struct FlatTriangleFixture
+{
+    typedef typename Fiber::ScalarTraits<BFT>::RealType CT;
+    typedef std::vector<const Fiber::Shapeset<BFT>*> ShapesetPtrVector;
+
+    FlatTriangleFixture() :
+        openClHandler(Fiber::OpenClOptions())
+    {
+        GridParameters params;
+        params.topology = GridParameters::TRIANGULAR;
+        shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                    params, "../../meshes/sphere-h-0.4.msh",
+                    false /* verbose */);
+        pwiseConstants.reset(new PiecewiseConstantScalarSpace<BFT>(grid));
+        pwiseLinears.reset(new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+        LocalAssemblerConstructionHelper::collectGridData(
+                    *pwiseLinears, rawGeometry, geometryFactory);
+        LocalAssemblerConstructionHelper::collectShapesets(
+                    *pwiseConstants, constantShapesets);
+        LocalAssemblerConstructionHelper::collectShapesets(
+                    *pwiseLinears, linearShapesets);
+
+        const arma::Mat<int>& corners = rawGeometry->elementCornerIndices();
+        const int elementCount = rawGeometry->elementCount();
+        const size_t maxPairCount = 200;
+        for (int test = 0; test < elementCount; test += 7)
+            for (int trial = 0; trial < elementCount; trial += 5) {
+                bool disjoint = true;
+                for (int i = 0; i < 3; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        if (corners(i, test) == corners(j, trial))
+                            disjoint = false;
+                if (disjoint && pairs.size() < maxPairCount)
+                    pairs.push_back(std::make_pair(test, trial));
+            }
+    }
+
+    shared_ptr<Space<BFT> > pwiseConstants;
+    shared_ptr<Space<BFT> > pwiseLinears;
+    shared_ptr<Fiber::RawGridGeometry<CT> > rawGeometry;
+    shared_ptr<GeometryFactory> geometryFactory;
+    shared_ptr<ShapesetPtrVector> constantShapesets;
+    shared_ptr<ShapesetPtrVector> linearShapesets;
+    std::vector<std::pair<int, int> > pairs;
+    Fiber::OpenClHandler openClHandler;
+};
+
+// Check that FlatTriangleTestKernelTrialIntegrator reproduces the results of
+// SeparableNumericalTestKernelTrialIntegrator for the kernel functor and all
+// combinations of piecewise constant and linear shapesets
+template <typename BFT, typename KT, typename RT, typename KernelFunctor>
+void checkAgainstSeparableIntegrator(const KernelFunctor& functor)
+{
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+    typedef Fiber::FlatTriangleTestKernelTrialIntegrator<
+            BFT, KT, RT, KernelFunctor> FlatIntegrator;
+    typedef Fiber::SeparableNumericalTestKernelTrialIntegrator<
+            BFT, KT, RT, GeometryFactory> SeparableIntegrator;
+    typedef typename FlatIntegrator::ElementIndexPair ElementIndexPair;
+
+    FlatTriangleFixture<BFT> fixture;
+    Fiber::DefaultCollectionOfShapesetTransformations<
+            Fiber::ScalarFunctionValueFunctor<CT> > transformations(
+                (Fiber::ScalarFunctionValueFunctor<CT>()));
+    Fiber::DefaultCollectionOfKernels<KernelFunctor> kernels(functor);
+    Fiber::TypicalTestScalarKernelTrialIntegral<BFT, KT, RT> integral;
+
+    const CT tolerance = 100 * std::numeric_limits<CT>::epsilon();
+    const int orders[][2] = {{2, 2}, {4, 1}, {5, 6}};
+    const int orderCount = sizeof(orders) / sizeof(orders[0]);
+    const Fiber::Shapeset<BFT>* shapesets[] = {
+        (*fixture.constantShapesets)[0], (*fixture.linearShapesets)[0]};
+
+    for (int o = 0; o < orderCount; ++o) {
+        arma::Mat<CT> testPoints, trialPoints;
+        std::vector<CT> testWeights, trialWeights;
+        Fiber::fillSingleQuadraturePointsAndWeights(
+                    3, orders[o][0], testPoints, testWeights);
+        Fiber::fillSingleQuadraturePointsAndWeights(
+                    3, orders[o][1], trialPoints, trialWeights);
+        BOOST_REQUIRE_LE(testPoints.n_cols,
+                         size_t(FlatIntegrator::MAX_POINT_COUNT));
+        BOOST_REQUIRE_LE(trialPoints.n_cols,
+                         size_t(FlatIntegrator::MAX_POINT_COUNT));
+
+        FlatIntegrator flat(
+                    testPoints, trialPoints, testWeights, trialWeights,
+                    *fixture.rawGeometry, *fixture.rawGeometry,
+                    transformations, functor, transformations);
+        SeparableIntegrator separable(
+                    testPoints, trialPoints, testWeights, trialWeights,
+                    *fixture.geometryFactory, *fixture.geometryFactory,
+                    *fixture.rawGeometry, *fixture.rawGeometry,
+                    transformations, kernels, transformations, integral,
+                    fixture.openClHandler);
+
+        for (int t = 0; t < 2; ++t)
+            for (int s = 0; s < 2; ++s) {
+                const Fiber::Shapeset<BFT>& testShapeset = *shapesets[t];
+                const Fiber::Shapeset<BFT>& trialShapeset = *shapesets[s];
+
+                // Variant taking a list of pairs
+                const std::vector<ElementIndexPair>& pairs = fixture.pairs;
+                std::vector<arma::Mat<RT> > expected(pairs.size());
+                std::vector<arma::Mat<RT> > actual(pairs.size());
+                std::vector<arma::Mat<RT>*> expectedPtrs(pairs.size());
+                std::vector<arma::Mat<RT>*> actualPtrs(pairs.size());
+                for (size_t i = 0; i < pairs.size(); ++i) {
+                    expectedPtrs[i] = &expected[i];
+                    actualPtrs[i] = &actual[i];
+                }
+                separable.integrate(pairs, testShapeset, trialShapeset,
+                                    expectedPtrs);
+                flat.integrate(pairs, testShapeset, trialShapeset,
+                               actualPtrs);
+                BOOST_CHECK(check_arrays_are_close<RT>(
+                                actual, expected, tolerance));
+
+                // Variant taking a column of test elements
+                const int trialElement = pairs[0].second;
+                std::vector<int> testElements;
+                for (size_t i = 0; i < pairs.size(); ++i)
+                    if (pairs[i].second == trialElement)
+                        testElements.push_back(pairs[i].first);
+                expected.resize(testElements.size());
+                actual.resize(testElements.size());
+                expectedPtrs.resize(testElements.size());
+                actualPtrs.resize(testElements.size());
+                for (size_t i = 0; i < testElements.size(); ++i) {
+                    expectedPtrs[i] = &expected[i];
+                    actualPtrs[i] = &actual[i];
+                }
+                separable.integrate(Fiber::TEST_TRIAL, testElements,
+                                    trialElement, testShapeset, trialShapeset,
+                                    Fiber::ALL_DOFS, expectedPtrs);
+                flat.integrate(Fiber::TEST_TRIAL, testElements,
+                               trialElement, testShapeset, trialShapeset,
+                               Fiber::ALL_DOFS, actualPtrs);
+                BOOST_CHECK(check_arrays_are_close<RT>(
+                                actual, expected, tolerance));
+            }
+    }
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(FlatTriangleTestKernelTrialIntegrator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(laplace_single_layer_agrees_with_separable_integrator,
+                              CT, real_numeric_types)
+{
+    checkAgainstSeparableIntegrator<CT, CT, CT>(
+                Fiber::Laplace3dSingleLayerPotentialKernelFunctor<CT>());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(laplace_double_layer_agrees_with_separable_integrator,
+                              CT, real_numeric_types)
+{
+    checkAgainstSeparableIntegrator<CT, CT, CT>(
+                Fiber::Laplace3dDoubleLayerPotentialKernelFunctor<CT>());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_single_layer_agrees_with_separable_integrator,
+                              KT, complex_kernel_types)
+{
+    typedef typename Fiber::ScalarTraits<KT>::RealType CT;
+    checkAgainstSeparableIntegrator<CT, KT, KT>(
+                Fiber::ModifiedHelmholtz3dSingleLayerPotentialKernelFunctor<KT>(
+                    KT(0.5, 2.)));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_double_layer_agrees_with_separable_integrator,
+                              KT, complex_kernel_types)
+{
+    typedef typename Fiber::ScalarTraits<KT>::RealType CT;
+    checkAgainstSeparableIntegrator<CT, KT, KT>(
+                Fiber::ModifiedHelmholtz3dDoubleLayerPotentialKernelFunctor<KT>(
+                    KT(0.5, 2.)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+BOOST_AUTO_TEST_SUITE(AreInside)
+
+BOOST_AUTO_TEST_CASE(agrees_with_unit_cube)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, "meshes/cube-12-reoriented.msh",
+                false /* verbose */);
+
+    // 1000 points in [-0.5, 1.5]^3; the cube occupies [0, 1]^3
+    srand(1);
+    arma::Mat<double> points(3, 1000);
+    points.randu();
+    points = 2. * points - 0.5;
+
+    std::vector<bool> inside = areInside(*grid, points);
+    BOOST_REQUIRE_EQUAL(inside.size(), points.n_cols);
+    for (size_t i = 0; i < points.n_cols; ++i) {
+        const bool expected =
+                points(0, i) > 0. && points(0, i) < 1. &&
+                points(1, i) > 0. && points(1, i) < 1. &&
+                points(2, i) > 0. && points(2, i) < 1.;
+        BOOST_CHECK_EQUAL(inside[i], expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bitmask_agrees_with_vector)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, "meshes/cube-12-reoriented.msh",
+                false /* verbose */);
+
+    srand(2);
+    arma::Mat<double> points(3, 130);
+    points.randu();
+    points = 2. * points - 0.5;
+
+    std::vector<bool> inside = areInside(*grid, points);
+    std::vector<std::uint64_t> bitmask = areInsideBitmask(*grid, points);
+    BOOST_REQUIRE_EQUAL(bitmask.size(), 3u);
+    for (size_t i = 0; i < points.n_cols; ++i)
+        BOOST_CHECK_EQUAL(bool((bitmask[i / 64] >> (i % 64)) & 1), inside[i]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
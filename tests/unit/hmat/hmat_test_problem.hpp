@@ -0,0 +1,182 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_hmat_test_problem_hpp
+#define bempp_hmat_test_problem_hpp
+
+#include "hmat/block_cluster_tree.hpp"
+#include "hmat/cluster_tree.hpp"
+#include "hmat/data_accessor.hpp"
+#include "hmat/geometry.hpp"
+#include "hmat/geometry_data_type.hpp"
+#include "hmat/geometry_interface.hpp"
+#include "hmat/hmatrix.hpp"
+
+#include <armadillo>
+#include <cmath>
+
+// Small H-matrix problems for the tests of the hmat library: the matrix
+// cos(k r) / (r + delta) of the pairwise distances r of points spread
+// evenly over the unit sphere.
+
+namespace HMatTestProblem
+{
+
+// Points on the unit sphere (Fibonacci lattice), stored in columns
+inline arma::Mat<double> spherePoints(int pointCount)
+{
+    arma::Mat<double> points(3, pointCount);
+    const double goldenAngle = M_PI * (3. - std::sqrt(5.));
+    for (int i = 0; i < pointCount; ++i) {
+        const double z = 1. - (2. * i + 1.) / pointCount;
+        const double radius = std::sqrt(1. - z * z);
+        points(0, i) = radius * std::cos(goldenAngle * i);
+        points(1, i) = radius * std::sin(goldenAngle * i);
+        points(2, i) = z;
+    }
+    return points;
+}
+
+class PointGeometryInterface : public hmat::GeometryInterface
+{
+public:
+    explicit PointGeometryInterface(const arma::Mat<double>& points) :
+        m_points(points), m_index(0)
+    {}
+
+    hmat::shared_ptr<const hmat::GeometryDataType> next() {
+        if (m_index == m_points.n_cols)
+            return hmat::shared_ptr<const hmat::GeometryDataType>();
+        const double x = m_points(0, m_index), y = m_points(1, m_index),
+                z = m_points(2, m_index);
+        ++m_index;
+        std::array<double, 3> center = {{x, y, z}};
+        return hmat::shared_ptr<const hmat::GeometryDataType>(
+                    new hmat::GeometryDataType(
+                        hmat::BoundingBox(x, x, y, y, z, z), center));
+    }
+
+    std::size_t numberOfEntities() const { return m_points.n_cols; }
+    void reset() { m_index = 0; }
+
+private:
+    const arma::Mat<double>& m_points;
+    std::size_t m_index;
+};
+
+inline hmat::shared_ptr<hmat::DefaultClusterTreeType> clusterTree(
+        const arma::Mat<double>& points, int minBlockSize,
+        hmat::ClusterSplittingStrategy strategy = hmat::GEOMETRIC_BISECTION)
+{
+    PointGeometryInterface geometryInterface(points);
+    hmat::Geometry geometry;
+    hmat::fillGeometry(geometry, geometryInterface);
+    return hmat::shared_ptr<hmat::DefaultClusterTreeType>(
+                new hmat::DefaultClusterTreeType(geometry, minBlockSize,
+                                                 strategy));
+}
+
+inline hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockClusterTree(
+        const hmat::shared_ptr<hmat::DefaultClusterTreeType>& tree,
+        int maxBlockSize = 2048, double eta = 1.2)
+{
+    return hmat::shared_ptr<hmat::DefaultBlockClusterTreeType>(
+                new hmat::DefaultBlockClusterTreeType(
+                    tree, tree, maxBlockSize,
+                    hmat::StandardAdmissibility(eta)));
+}
+
+inline double kernel(const arma::Mat<double>& points, std::size_t i,
+                     std::size_t j, double waveNumber)
+{
+    const double r = arma::norm(points.col(i) - points.col(j), 2);
+    return std::cos(waveNumber * r) / (r + 0.05);
+}
+
+// Entries of the matrix in the original numbering of the points
+inline arma::Mat<double> denseMatrix(const arma::Mat<double>& points,
+                                     double waveNumber)
+{
+    arma::Mat<double> result(points.n_cols, points.n_cols);
+    for (std::size_t j = 0; j < points.n_cols; ++j)
+        for (std::size_t i = 0; i < points.n_cols; ++i)
+            result(i, j) = kernel(points, i, j, waveNumber);
+    return result;
+}
+
+class KernelDataAccessor : public hmat::DataAccessor<double, 2>
+{
+public:
+    KernelDataAccessor(const arma::Mat<double>& points,
+                       const hmat::DefaultClusterTreeType& tree,
+                       double waveNumber) :
+        m_points(points), m_tree(tree), m_waveNumber(waveNumber)
+    {}
+
+    void computeMatrixBlock(
+            const hmat::IndexRangeType& rowIndexRange,
+            const hmat::IndexRangeType& columnIndexRange,
+            const hmat::DefaultBlockClusterTreeNodeType& blockClusterTreeNode,
+            arma::Mat<double>& data) const {
+        data.set_size(rowIndexRange[1] - rowIndexRange[0],
+                      columnIndexRange[1] - columnIndexRange[0]);
+        for (std::size_t c = 0; c < data.n_cols; ++c)
+            for (std::size_t r = 0; r < data.n_rows; ++r)
+                data(r, c) = kernel(
+                            m_points,
+                            m_tree.mapHMatDofToOriginalDof(rowIndexRange[0] + r),
+                            m_tree.mapHMatDofToOriginalDof(columnIndexRange[0] + c),
+                            m_waveNumber);
+    }
+
+private:
+    const arma::Mat<double>& m_points;
+    const hmat::DefaultClusterTreeType& m_tree;
+    double m_waveNumber;
+};
+
+// Entries of an H-matrix in the original numbering of the points
+template <typename ValueType>
+arma::Mat<ValueType> expand(const hmat::DefaultHMatrixType<ValueType>& hMatrix)
+{
+    arma::Mat<ValueType> identity =
+            arma::eye<arma::Mat<ValueType> >(hMatrix.columns(),
+                                             hMatrix.columns());
+    arma::Mat<ValueType> result(hMatrix.rows(), hMatrix.columns());
+    hMatrix.apply(identity, result, hmat::NOTRANS, 1., 0.);
+    return result;
+}
+
+// Sum of the ranks of the low-rank blocks of an H-matrix
+template <typename ValueType>
+std::size_t totalRank(const hmat::DefaultHMatrixType<ValueType>& hMatrix)
+{
+    std::size_t result = 0;
+    const std::size_t leafCount =
+            hMatrix.blockClusterTree()->numberOfLeaves();
+    for (std::size_t i = 0; i < leafCount; ++i)
+        if (hMatrix.leafData(i)->type() == hmat::LOW_RANK_AB)
+            result += hMatrix.leafData(i)->rank();
+    return result;
+}
+
+} // namespace HMatTestProblem
+
+#endif
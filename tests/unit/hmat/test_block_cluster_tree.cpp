@@ -0,0 +1,145 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_problem.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <vector>
+
+using namespace HMatTestProblem;
+
+namespace
+{
+
+// Row range, column range and admissibility of a leaf
+typedef boost::tuple<std::size_t, std::size_t, std::size_t, std::size_t, bool>
+LeafDescription;
+
+LeafDescription describeLeaf(const hmat::DefaultClusterTreeNodeType& rowNode,
+                             const hmat::DefaultClusterTreeNodeType& columnNode,
+                             bool admissible)
+{
+    const hmat::IndexRangeType& rows = rowNode.data().indexRange;
+    const hmat::IndexRangeType& columns = columnNode.data().indexRange;
+    return LeafDescription(rows[0], rows[1], columns[0], columns[1],
+                           admissible);
+}
+
+// Straightforward recursive construction of the leaves of a block cluster
+// tree, in depth-first order. The sons of an inadmissible block are tested
+// for admissibility with the bounding boxes of the clusters of that block.
+void referenceLeaves(const hmat::DefaultClusterTreeNodeType& rowNode,
+                     const hmat::DefaultClusterTreeNodeType& columnNode,
+                     bool admissible, std::size_t maxBlockSize,
+                     const hmat::AdmissibilityFunction& admissibilityFunction,
+                     std::vector<LeafDescription>& leaves)
+{
+    const hmat::IndexRangeType& rows = rowNode.data().indexRange;
+    const hmat::IndexRangeType& columns = columnNode.data().indexRange;
+    if (rows[1] - rows[0] > maxBlockSize ||
+            columns[1] - columns[0] > maxBlockSize)
+        admissible = false;
+    if (admissible || rowNode.isLeaf() || columnNode.isLeaf()) {
+        leaves.push_back(describeLeaf(rowNode, columnNode, admissible));
+        return;
+    }
+    const bool sonsAdmissible = admissibilityFunction(
+                rowNode.data().boundingBox, columnNode.data().boundingBox);
+    for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 2; ++j)
+            referenceLeaves(*rowNode.child(i), *columnNode.child(j),
+                            sonsAdmissible, maxBlockSize,
+                            admissibilityFunction, leaves);
+}
+
+void checkBlockStructure(
+        const hmat::shared_ptr<hmat::DefaultClusterTreeType>& rowTree,
+        const hmat::shared_ptr<hmat::DefaultClusterTreeType>& columnTree,
+        int maxBlockSize, double eta)
+{
+    const hmat::StandardAdmissibility admissibility(eta);
+    hmat::DefaultBlockClusterTreeType tree(rowTree, columnTree, maxBlockSize,
+                                           admissibility);
+
+    std::vector<LeafDescription> expected;
+    referenceLeaves(*rowTree->root(), *columnTree->root(),
+                    admissibility(rowTree->root()->data().boundingBox,
+                                  columnTree->root()->data().boundingBox),
+                    maxBlockSize, admissibility, expected);
+
+    const std::vector<const hmat::DefaultBlockClusterTreeNodeType*>& leaves =
+            tree.leafNodes();
+    BOOST_REQUIRE_EQUAL(leaves.size(), expected.size());
+    BOOST_CHECK_EQUAL(tree.numberOfLeaves(), expected.size());
+    std::size_t area = 0;
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        const LeafDescription actual = describeLeaf(
+                    *leaves[i]->data().rowClusterTreeNode,
+                    *leaves[i]->data().columnClusterTreeNode,
+                    leaves[i]->data().admissible);
+        BOOST_CHECK(actual == expected[i]);
+        BOOST_CHECK(leaves[i]->isLeaf());
+        BOOST_CHECK_EQUAL(leaves[i]->leafIndex(), i);
+        area += (actual.get<1>() - actual.get<0>()) *
+                (actual.get<3>() - actual.get<2>());
+    }
+    // The leaves tile the matrix
+    BOOST_CHECK_EQUAL(area, tree.rows() * tree.columns());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(BlockClusterTree)
+
+BOOST_AUTO_TEST_CASE(block_structure_agrees_with_recursive_construction)
+{
+    arma::Mat<double> points = spherePoints(1500);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 20);
+    const int maxBlockSizes[] = {64, 2048};
+    const double etas[] = {0.5, 1.2, 2.};
+    for (int m = 0; m < 2; ++m)
+        for (int e = 0; e < 3; ++e)
+            checkBlockStructure(tree, tree, maxBlockSizes[m], etas[e]);
+}
+
+BOOST_AUTO_TEST_CASE(block_structure_of_separated_clusters_agrees_with_recursive_construction)
+{
+    // Row and column clusters on two spheres far apart, so that the root
+    // block is admissible unless it is too large
+    arma::Mat<double> rowPoints = spherePoints(600);
+    arma::Mat<double> columnPoints = spherePoints(400);
+    columnPoints.row(0) += 5.;
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> rowTree =
+            clusterTree(rowPoints, 20);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> columnTree =
+            clusterTree(columnPoints, 20);
+    checkBlockStructure(rowTree, columnTree, 2048, 1.2);
+    checkBlockStructure(rowTree, columnTree, 100, 1.2);
+
+    hmat::DefaultBlockClusterTreeType tree(rowTree, columnTree, 2048,
+                                           hmat::StandardAdmissibility(1.2));
+    BOOST_CHECK_EQUAL(tree.numberOfLeaves(), 1u);
+    BOOST_CHECK(tree.root().data().admissible);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
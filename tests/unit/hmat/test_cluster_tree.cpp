@@ -0,0 +1,195 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_problem.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace HMatTestProblem;
+
+namespace
+{
+
+const hmat::ClusterSplittingStrategy STRATEGIES[] = {
+    hmat::GEOMETRIC_BISECTION, hmat::MEDIAN_SPLIT, hmat::PRINCIPAL_AXIS_SPLIT};
+
+bool boxContainsPoint(const hmat::BoundingBox& box,
+                      const arma::Mat<double>& points, std::size_t point)
+{
+    const std::array<double, 6>& bounds = box.bounds();
+    for (int dim = 0; dim < 3; ++dim)
+        if (points(dim, point) < bounds[2 * dim] ||
+                points(dim, point) > bounds[2 * dim + 1])
+            return false;
+    return true;
+}
+
+// Check the properties every cluster tree must have, whatever the
+// splitting strategy
+void checkClusterTree(const hmat::DefaultClusterTreeType& tree,
+                      const arma::Mat<double>& points, int minBlockSize)
+{
+    const std::size_t pointCount = points.n_cols;
+    BOOST_REQUIRE_EQUAL(tree.numberOfDofs(), pointCount);
+
+    // The dof maps are inverse permutations
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        BOOST_REQUIRE_LT(tree.mapHMatDofToOriginalDof(i), pointCount);
+        BOOST_CHECK_EQUAL(
+                    tree.mapOriginalDofToHMatDof(tree.mapHMatDofToOriginalDof(i)),
+                    i);
+    }
+
+    // The leaves cover the dofs in order, are not too large and contain
+    // their points
+    std::vector<hmat::shared_ptr<const hmat::DefaultClusterTreeNodeType> >
+            leaves = tree.leafNodes();
+    std::sort(leaves.begin(), leaves.end(),
+              [](const hmat::shared_ptr<const hmat::DefaultClusterTreeNodeType>& a,
+                 const hmat::shared_ptr<const hmat::DefaultClusterTreeNodeType>& b) {
+        return a->data().indexRange[0] < b->data().indexRange[0];
+    });
+    std::size_t nextDof = 0;
+    for (std::size_t l = 0; l < leaves.size(); ++l) {
+        const hmat::IndexRangeType& range = leaves[l]->data().indexRange;
+        BOOST_CHECK_EQUAL(range[0], nextDof);
+        BOOST_CHECK_GT(range[1], range[0]);
+        BOOST_CHECK_LE(range[1] - range[0], std::size_t(minBlockSize));
+        for (std::size_t dof = range[0]; dof < range[1]; ++dof)
+            BOOST_CHECK(boxContainsPoint(leaves[l]->data().boundingBox, points,
+                                         tree.mapHMatDofToOriginalDof(dof)));
+        nextDof = range[1];
+    }
+    BOOST_CHECK_EQUAL(nextDof, pointCount);
+
+    // The statistics describe the same leaves
+    const hmat::ClusterTreeStatistics stats = tree.statistics();
+    BOOST_CHECK_EQUAL(stats.numberOfLeaves, leaves.size());
+    std::size_t histogramLeaves = 0, histogramDofs = 0;
+    for (std::size_t size = 0; size < stats.leafSizeHistogram.size(); ++size) {
+        histogramLeaves += stats.leafSizeHistogram[size];
+        histogramDofs += size * stats.leafSizeHistogram[size];
+    }
+    BOOST_CHECK_EQUAL(histogramLeaves, leaves.size());
+    BOOST_CHECK_EQUAL(histogramDofs, pointCount);
+    BOOST_CHECK_EQUAL(stats.leafSizeHistogram[0], 0u);
+    BOOST_CHECK_LE(stats.leafSizeHistogram.size(), std::size_t(minBlockSize + 1));
+    BOOST_REQUIRE_EQUAL(stats.leafDepthHistogram.size(), stats.depth + 1);
+    BOOST_CHECK_GT(stats.leafDepthHistogram[stats.depth], 0u);
+    std::size_t depthLeaves = 0;
+    for (std::size_t depth = 0; depth < stats.leafDepthHistogram.size(); ++depth)
+        depthLeaves += stats.leafDepthHistogram[depth];
+    BOOST_CHECK_EQUAL(depthLeaves, leaves.size());
+}
+
+// Smallest depth of a leaf
+std::size_t minimumLeafDepth(const hmat::ClusterTreeStatistics& stats)
+{
+    std::size_t depth = 0;
+    while (stats.leafDepthHistogram[depth] == 0)
+        ++depth;
+    return depth;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ClusterTree)
+
+BOOST_AUTO_TEST_CASE(all_strategies_produce_valid_cluster_trees)
+{
+    const int minBlockSize = 30;
+    arma::Mat<double> points = spherePoints(2000);
+    for (int s = 0; s < 3; ++s)
+        checkClusterTree(*clusterTree(points, minBlockSize, STRATEGIES[s]),
+                         points, minBlockSize);
+}
+
+BOOST_AUTO_TEST_CASE(all_strategies_produce_valid_cluster_trees_when_split_in_parallel)
+{
+    // More points than the threshold above which sons are split in
+    // separate tasks
+    const int minBlockSize = 50;
+    arma::Mat<double> points = spherePoints(10000);
+    for (int s = 0; s < 3; ++s)
+        checkClusterTree(*clusterTree(points, minBlockSize, STRATEGIES[s]),
+                         points, minBlockSize);
+}
+
+BOOST_AUTO_TEST_CASE(median_splits_produce_balanced_trees)
+{
+    const hmat::ClusterSplittingStrategy medianStrategies[] = {
+        hmat::MEDIAN_SPLIT, hmat::PRINCIPAL_AXIS_SPLIT};
+    arma::Mat<double> points = spherePoints(1000);
+    for (int s = 0; s < 2; ++s) {
+        const hmat::ClusterTreeStatistics stats =
+                clusterTree(points, 32, medianStrategies[s])->statistics();
+        // Sons differ in size by at most one, so 1000 points end up in
+        // 32 leaves of 31 or 32 points, all at depth 5
+        BOOST_CHECK_EQUAL(stats.numberOfLeaves, 32u);
+        BOOST_CHECK_EQUAL(stats.depth, 5u);
+        BOOST_CHECK_EQUAL(minimumLeafDepth(stats), 5u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(principal_axis_split_separates_points_along_an_oblique_line)
+{
+    // Points along the direction (1, 1, 0), in shuffled order; the
+    // bounding box has no longest side
+    const std::size_t pointCount = 100;
+    arma::Mat<double> points(3, pointCount);
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        const double t = double((i * 37) % pointCount);
+        points(0, i) = t;
+        points(1, i) = t;
+        points(2, i) = 0.;
+    }
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 10, hmat::PRINCIPAL_AXIS_SPLIT);
+    checkClusterTree(*tree, points, 10);
+
+    const hmat::IndexRangeType& firstRange =
+            tree->root()->child(0)->data().indexRange;
+    BOOST_REQUIRE_EQUAL(firstRange[1] - firstRange[0], pointCount / 2);
+    // The sign of the principal axis is arbitrary, so either half may come
+    // first
+    const bool lowerHalfFirst =
+            points(0, tree->mapHMatDofToOriginalDof(0)) < 49.5;
+    for (std::size_t dof = 0; dof < pointCount; ++dof) {
+        const double t = points(0, tree->mapHMatDofToOriginalDof(dof));
+        BOOST_CHECK_EQUAL(t < 49.5, (dof < firstRange[1]) == lowerHalfFirst);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(geometric_bisection_handles_coincident_points)
+{
+    // Bisection cannot separate these points; the tree must still be built
+    // and respect the minimum block size
+    arma::Mat<double> points(3, 200);
+    points.fill(0.5);
+    points.col(0).fill(-1.);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 16, hmat::GEOMETRIC_BISECTION);
+    checkClusterTree(*tree, points, 16);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
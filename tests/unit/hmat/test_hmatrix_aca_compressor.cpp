@@ -0,0 +1,121 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_problem.hpp"
+
+#include "hmat/hmatrix_aca_compressor.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <vector>
+
+using namespace HMatTestProblem;
+
+namespace
+{
+
+const double ACA_EPS = 1e-6;
+
+double relativeError(const hmat::DefaultHMatrixType<double>& hMatrix,
+                     const arma::Mat<double>& expected)
+{
+    return arma::norm(expand(hMatrix) - expected, "fro") /
+            arma::norm(expected, "fro");
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatrixAcaCompressor)
+
+BOOST_AUTO_TEST_CASE(warm_started_aca_is_as_accurate_as_cold_aca_with_no_larger_rank)
+{
+    arma::Mat<double> points = spherePoints(1200);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 30);
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockTree =
+            blockClusterTree(tree);
+
+    // Pivots of a nearby wavenumber
+    hmat::AcaPivotMemory<2> pivotMemory;
+    KernelDataAccessor previousAccessor(points, *tree, 2.);
+    hmat::HMatrixAcaCompressor<double, 2> previousCompressor(
+                previousAccessor, ACA_EPS, 1000, 10, &pivotMemory);
+    hmat::DefaultHMatrixType<double> previous(blockTree, previousCompressor);
+
+    KernelDataAccessor accessor(points, *tree, 2.1);
+    hmat::HMatrixAcaCompressor<double, 2> coldCompressor(
+                accessor, ACA_EPS, 1000);
+    hmat::HMatrixAcaCompressor<double, 2> warmCompressor(
+                accessor, ACA_EPS, 1000, 10, &pivotMemory);
+    hmat::DefaultHMatrixType<double> cold(blockTree, coldCompressor);
+    hmat::DefaultHMatrixType<double> warm(blockTree, warmCompressor);
+
+    const arma::Mat<double> expected = denseMatrix(points, 2.1);
+    const double coldError = relativeError(cold, expected);
+    const double warmError = relativeError(warm, expected);
+    BOOST_CHECK_LT(coldError, 100. * ACA_EPS);
+    BOOST_CHECK_LT(warmError, 100. * ACA_EPS);
+    BOOST_CHECK_LT(warmError, 10. * coldError);
+    // Random pivots make the cold rank vary slightly between runs
+    BOOST_CHECK_LE(totalRank(warm), totalRank(cold) + totalRank(cold) / 10);
+}
+
+BOOST_AUTO_TEST_CASE(unusable_warm_start_rows_do_not_shift_the_accepted_pivots)
+{
+    arma::Mat<double> points = spherePoints(800);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 30);
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockTree =
+            blockClusterTree(tree);
+    KernelDataAccessor accessor(points, *tree, 1.);
+
+    hmat::AcaPivotMemory<2> pivotMemory;
+    hmat::HMatrixAcaCompressor<double, 2> compressor(
+                accessor, ACA_EPS, 1000, 10, &pivotMemory);
+    hmat::DefaultHMatrixType<double> first(blockTree, compressor);
+
+    // Put a row lying outside each block in front of its stored pivots.
+    // Recompressing the same matrix must then reproduce the original pivots.
+    const std::vector<const hmat::DefaultBlockClusterTreeNodeType*>& leaves =
+            blockTree->leafNodes();
+    std::vector<std::vector<std::size_t> > originalPivots(leaves.size());
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        if (!leaves[i]->data().admissible)
+            continue;
+        BOOST_REQUIRE(pivotMemory.rowPivots(*leaves[i], originalPivots[i]));
+        std::vector<std::size_t> shifted(originalPivots[i]);
+        shifted.insert(shifted.begin(),
+                       std::numeric_limits<std::size_t>::max());
+        pivotMemory.storeRowPivots(*leaves[i], shifted);
+    }
+
+    hmat::DefaultHMatrixType<double> second(blockTree, compressor);
+
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        if (!leaves[i]->data().admissible)
+            continue;
+        std::vector<std::size_t> pivots;
+        BOOST_REQUIRE(pivotMemory.rowPivots(*leaves[i], pivots));
+        BOOST_CHECK(pivots == originalPivots[i]);
+        BOOST_CHECK_EQUAL(second.leafData(i)->rank(), first.leafData(i)->rank());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
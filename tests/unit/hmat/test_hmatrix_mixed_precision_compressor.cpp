@@ -0,0 +1,80 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_problem.hpp"
+
+#include "hmat/hmatrix_aca_compressor.hpp"
+#include "hmat/hmatrix_mixed_precision_compressor.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+
+using namespace HMatTestProblem;
+
+BOOST_AUTO_TEST_SUITE(HMatrixMixedPrecisionCompressor)
+
+BOOST_AUTO_TEST_CASE(rounding_error_matches_difference_from_full_precision_hmatrix)
+{
+    arma::Mat<double> points = spherePoints(1000);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 30);
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockTree =
+            blockClusterTree(tree);
+    KernelDataAccessor accessor(points, *tree, 1.);
+
+    // Fixed pivots make both H-matrices start from the same low-rank blocks
+    hmat::AcaPivotMemory<2> pivotMemory;
+    hmat::HMatrixAcaCompressor<double, 2> compressor(
+                accessor, 1e-10, 1000, 10, &pivotMemory);
+    hmat::DefaultHMatrixType<double> full(blockTree, compressor);
+    hmat::HMatrixMixedPrecisionCompressor<double, 2> mixedCompressor(
+                compressor);
+    hmat::DefaultHMatrixType<double> mixed(blockTree, mixedCompressor);
+
+    const hmat::MixedPrecisionStatistics stats = mixedCompressor.statistics();
+    BOOST_REQUIRE_GT(stats.numberOfBlocks, 0u);
+    BOOST_CHECK_LT(stats.storedMemSizeKb, 0.6 * stats.fullPrecisionMemSizeKb);
+    BOOST_CHECK_GT(stats.roundingRelativeError, 0.);
+    BOOST_CHECK_LT(stats.roundingRelativeError,
+                   10. * std::numeric_limits<float>::epsilon());
+
+    // The reported error covers the far field only, so it bounds the
+    // difference of the whole matrices relative to the far-field norm
+    const arma::Mat<double> fullEntries = expand(full);
+    const arma::Mat<double> mixedEntries = expand(mixed);
+    const double difference = arma::norm(mixedEntries - fullEntries, "fro");
+    double farFieldSquaredNorm = 0.;
+    for (std::size_t i = 0; i < blockTree->numberOfLeaves(); ++i)
+        if (mixed.leafData(i)->type() == hmat::LOW_RANK_AB) {
+            const double norm = full.leafData(i)->frobeniusNorm();
+            farFieldSquaredNorm += norm * norm;
+        }
+    BOOST_CHECK_CLOSE(difference / std::sqrt(farFieldSquaredNorm),
+                      stats.roundingRelativeError, 1. /* percent */);
+
+    // Against the operator itself the error is dominated by the rounding
+    const arma::Mat<double> expected = denseMatrix(points, 1.);
+    BOOST_CHECK_LT(arma::norm(mixedEntries - expected, "fro") /
+                   arma::norm(expected, "fro"),
+                   10. * std::numeric_limits<float>::epsilon());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,124 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_problem.hpp"
+
+#include "hmat/hmatrix_aca_compressor.hpp"
+#include "hmat/hmatrix_data.hpp"
+#include "hmat/hmatrix_statistics.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+using namespace HMatTestProblem;
+
+BOOST_AUTO_TEST_SUITE(HMatrixStatistics)
+
+BOOST_AUTO_TEST_CASE(statistics_agree_with_the_leaf_blocks)
+{
+    arma::Mat<double> points = spherePoints(1000);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 30);
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockTree =
+            blockClusterTree(tree);
+    KernelDataAccessor accessor(points, *tree, 1.);
+    hmat::HMatrixAcaCompressor<double, 2> compressor(accessor, 1e-10, 1000);
+    hmat::DefaultHMatrixType<double> hMatrix(blockTree, compressor);
+
+    const std::size_t largestBlockCount = 5;
+    const hmat::HMatrixStatistics stats =
+            hMatrix.statistics(largestBlockCount);
+
+    BOOST_CHECK_EQUAL(stats.rows, 1000u);
+    BOOST_CHECK_EQUAL(stats.columns, 1000u);
+    BOOST_CHECK_CLOSE(stats.denseMemSizeKb, 1000. * 1000. * sizeof(double) /
+                      1024., 1e-10);
+    BOOST_CHECK_CLOSE(stats.memSizeKb, hMatrix.memSizeKb(), 1e-10);
+    BOOST_CHECK_CLOSE(stats.compressionRatio,
+                      stats.memSizeKb / stats.denseMemSizeKb, 1e-10);
+    BOOST_CHECK_GT(stats.compressionRatio, 0.);
+    BOOST_CHECK_LT(stats.compressionRatio, 1.);
+
+    // Counts and the rank histogram against the leaves themselves
+    double memSizeKb = 0.;
+    std::size_t denseCount = 0;
+    std::map<int, std::size_t> rankHistogram;
+    for (std::size_t i = 0; i < blockTree->numberOfLeaves(); ++i) {
+        hmat::shared_ptr<const hmat::HMatrixData<double> > data =
+                hMatrix.leafData(i);
+        memSizeKb += data->memSizeKb();
+        if (data->type() == hmat::DENSE)
+            ++denseCount;
+        else
+            ++rankHistogram[data->rank()];
+    }
+    BOOST_CHECK_CLOSE(stats.memSizeKb, memSizeKb, 1e-10);
+    BOOST_CHECK_EQUAL(stats.numberOfDenseBlocks, denseCount);
+    BOOST_CHECK_EQUAL(stats.numberOfDenseBlocks + stats.numberOfLowRankBlocks,
+                      blockTree->numberOfLeaves());
+    BOOST_CHECK_GT(stats.numberOfLowRankBlocks, 0u);
+    BOOST_CHECK(stats.rankHistogram == rankHistogram);
+
+    // The largest blocks, in decreasing order of memory
+    const std::vector<hmat::HMatrixBlockStatistics> blocks =
+            hMatrix.blockStatistics();
+    BOOST_REQUIRE_EQUAL(stats.largestBlocks.size(), largestBlockCount);
+    for (std::size_t k = 1; k < largestBlockCount; ++k)
+        BOOST_CHECK_GE(stats.largestBlocks[k - 1].memSizeKb,
+                       stats.largestBlocks[k].memSizeKb);
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+        BOOST_CHECK_LE(blocks[i].memSizeKb,
+                       stats.largestBlocks.front().memSizeKb);
+}
+
+BOOST_AUTO_TEST_CASE(error_estimates_are_unavailable_until_computed)
+{
+    arma::Mat<double> points = spherePoints(1000);
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> tree =
+            clusterTree(points, 30);
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockTree =
+            blockClusterTree(tree);
+    KernelDataAccessor accessor(points, *tree, 1.);
+    hmat::HMatrixAcaCompressor<double, 2> compressor(accessor, 1e-8, 1000);
+    hmat::DefaultHMatrixType<double> hMatrix(blockTree, compressor);
+
+    BOOST_CHECK_EQUAL(hMatrix.statistics(1).maxErrorEstimate, -1.);
+    std::vector<hmat::HMatrixBlockStatistics> blocks =
+            hMatrix.blockStatistics();
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+        BOOST_CHECK_EQUAL(blocks[i].errorEstimate, -1.);
+
+    hMatrix.estimateBlockErrors(accessor);
+    const hmat::HMatrixStatistics stats = hMatrix.statistics(1);
+    BOOST_CHECK_GE(stats.maxErrorEstimate, 0.);
+    BOOST_CHECK_LT(stats.maxErrorEstimate, 1e-6);
+    blocks = hMatrix.blockStatistics();
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].rank < 0)
+            BOOST_CHECK_EQUAL(blocks[i].errorEstimate, 0.);
+        else
+            BOOST_CHECK_GE(blocks[i].errorEstimate, 0.);
+        BOOST_CHECK_LE(blocks[i].errorEstimate, stats.maxErrorEstimate);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
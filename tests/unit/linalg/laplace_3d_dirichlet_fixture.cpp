@@ -19,13 +19,14 @@ Laplace3dDirichletFixture<BFT, RT>::Laplace3dDirichletFixture(
     SpaceType dirichletDataDomain,
     SpaceType neumannDataDomain,
     SpaceType range,
-    SpaceType dualToRange)
+    SpaceType dualToRange,
+    const std::string& meshFileName,
+    bool hMatMode)
 {
     GridParameters params;
     params.topology = GridParameters::TRIANGULAR;
     grid = GridFactory::importGmshGrid(
-                params, "meshes/cube-12-reoriented.msh",
-                false /* verbose */);
+                params, meshFileName, false /* verbose */);
 
     shared_ptr<Space<BFT> > pwiseConstants(
         new PiecewiseConstantScalarSpace<BFT>(grid));
@@ -34,6 +35,8 @@ Laplace3dDirichletFixture<BFT, RT>::Laplace3dDirichletFixture(
 
     AssemblyOptions assemblyOptions;
     assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    if (hMatMode)
+        assemblyOptions.switchToHMatMode();
     shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
         new NumericalQuadratureStrategy<BFT, RT>);
     shared_ptr<Context<BFT, RT> > context(
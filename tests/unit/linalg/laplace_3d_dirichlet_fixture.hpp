@@ -32,6 +32,7 @@
 #include "grid/grid.hpp"
 
 #include <memory>
+#include <string>
 
 namespace Bempp
 {
@@ -64,7 +65,9 @@ public:
         SpaceType dirichletDataDomain = PIECEWISE_LINEARS,
         SpaceType neumannDataDomain = PIECEWISE_CONSTANTS,
         SpaceType range = PIECEWISE_LINEARS,
-        SpaceType dualToRange = PIECEWISE_CONSTANTS);
+        SpaceType dualToRange = PIECEWISE_CONSTANTS,
+        const std::string& meshFileName = "meshes/cube-12-reoriented.msh",
+        bool hMatMode = false);
 
     shared_ptr<Grid> grid;
     BoundaryOperator<BFT, RT> lhsOp;
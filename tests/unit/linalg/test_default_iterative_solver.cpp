@@ -24,6 +24,7 @@
 
 #include "../type_template.hpp"
 #include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
 
 #include "laplace_3d_dirichlet_fixture.hpp"
 
@@ -35,6 +36,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/type_traits/is_complex.hpp>
+#include <stdexcept>
 
 using namespace Bempp;
 
@@ -355,6 +357,151 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(boundary_operator_agrees_with_2x2_blocked_boundary
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_from_exact_initial_guess_takes_no_iterations,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    IterSolver solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(defaultGmresParameterList(solverTol / 100.));
+    Solution<BFT, RT> exactSolution = solver.solve(fixture.rhs);
+    BOOST_CHECK_GT(exactSolution.iterationCount(), 0);
+
+    // The first solution is 100 times more accurate than needed now
+    solver.initializeSolver(defaultGmresParameterList(solverTol));
+    Solution<BFT, RT> solution =
+        solver.solve(fixture.rhs, exactSolution.gridFunction());
+    BOOST_CHECK_EQUAL(solution.iterationCount(), 0);
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    solution.gridFunction().coefficients(),
+                    exactSolution.gridFunction().coefficients(), solverTol / 100.));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(repeated_gcrodr_solve_takes_fewer_iterations,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    IterSolver solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(defaultGcrodrParameterList(
+                                solverTol, 1000, 10 /* blockCount */,
+                                3 /* recycledBlockCount */));
+    Solution<BFT, RT> firstSolution = solver.solve(fixture.rhs);
+    // The second solve starts from the recycled subspace of the first one
+    Solution<BFT, RT> secondSolution = solver.solve(2. * fixture.rhs);
+
+    BOOST_CHECK_LT(secondSolution.iterationCount(),
+                   firstSolution.iterationCount());
+    arma::Col<RT> secondSolutionVector =
+        secondSolution.gridFunction().coefficients() / 2.;
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    firstSolution.gridFunction().coefficients(),
+                    secondSolutionVector, solverTol * 10));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_time_is_reported,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    IterSolver solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(defaultGmresParameterList(solverTol));
+    Solution<BFT, RT> solution = solver.solve(fixture.rhs);
+    BOOST_CHECK_GE(solution.solveTime(), 0.);
+
+    BlockedOperatorStructure<BFT, RT> structure;
+    structure.setBlock(0, 0, fixture.lhsOp);
+    BlockedBoundaryOperator<BFT, RT> lhsBlockedOp(structure);
+    std::vector<GridFunction<BFT, RT> > blockedRhs(1, fixture.rhs);
+
+    IterSolver blockedSolver(
+        lhsBlockedOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    blockedSolver.initializeSolver(defaultGmresParameterList(solverTol));
+    BlockedSolution<BFT, RT> blockedSolution = blockedSolver.solve(blockedRhs);
+    BOOST_CHECK_GE(blockedSolution.solveTime(), 0.);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(block_gmres_solve_agrees_with_separate_solves,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    // Block GMRES breaks down on linearly dependent right-hand sides
+    std::vector<GridFunction<BFT, RT> > rhs;
+    rhs.push_back(fixture.rhs);
+    rhs.push_back(GridFunction<BFT, RT>(
+                      fixture.lhsOp.context(), fixture.lhsOp.range(),
+                      generateRandomVector<RT>(
+                          fixture.lhsOp.range()->globalDofCount())));
+
+    std::vector<arma::Col<RT> > separateSolutionVectors;
+    {
+        IterSolver solver(
+            fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+        solver.initializeSolver(defaultGmresParameterList(solverTol));
+        for (size_t i = 0; i < rhs.size(); ++i)
+            separateSolutionVectors.push_back(
+                solver.solve(rhs[i]).gridFunction().coefficients());
+    }
+
+    // Block size chosen automatically (one block) and set explicitly
+    // (one right-hand side per block)
+    const int blockSizes[] = {0, 1};
+    for (int b = 0; b < 2; ++b) {
+        IterSolver solver(
+            fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+        solver.initializeSolver(defaultBlockGmresParameterList(
+                                    solverTol, 1000, blockSizes[b]));
+        std::vector<Solution<BFT, RT> > solutions =
+            solver.solveMultipleRhs(rhs);
+
+        BOOST_CHECK_EQUAL(solutions.size(), rhs.size());
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            BOOST_CHECK_EQUAL(solutions[i].status(), SolutionStatus::CONVERGED);
+            BOOST_CHECK(check_arrays_are_close<ValueType>(
+                            solutions[i].gridFunction().coefficients(),
+                            separateSolutionVectors[i], solverTol * 10));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(negative_block_gmres_block_size_is_rejected)
+{
+    BOOST_CHECK_THROW(defaultBlockGmresParameterList(1e-5, 1000, -1),
+                      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
@@ -0,0 +1,219 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#ifdef WITH_TRILINOS
+
+#include "../type_template.hpp"
+#include "../check_arrays_are_close.hpp"
+
+#include "laplace_3d_dirichlet_fixture.hpp"
+
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "linalg/default_iterative_solver.hpp"
+#include "linalg/preconditioner.hpp"
+#include "linalg/solver.hpp"
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+#include <Teuchos_RCP.hpp>
+
+using namespace Bempp;
+
+namespace {
+
+// Single-layer operator on a 12-element mesh. All its 12 dofs fit in a
+// single cluster, so its H-matrix consists of one dense block.
+template <typename BFT, typename RT>
+BoundaryOperator<BFT, RT> singleLayerOperator(bool hMatMode)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, "meshes/cube-12-reoriented.msh",
+                false /* verbose */);
+
+    shared_ptr<Space<BFT> > pwiseConstants(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    if (hMatMode)
+        assemblyOptions.switchToHMatMode();
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+        new NumericalQuadratureStrategy<BFT, RT>);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    return laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+        context, pwiseConstants, pwiseConstants, pwiseConstants);
+}
+
+template <typename RT>
+arma::Mat<RT> preconditionerMatrix(const Preconditioner<RT>& prec)
+{
+    Teuchos::RCP<const DiscreteBoundaryOperator<RT> > op =
+        Teuchos::rcp_dynamic_cast<const DiscreteBoundaryOperator<RT> >(
+            prec.get()->getUnspecifiedPrecOp(), true /* throw on failure */);
+    return op->asMatrix();
+}
+
+// Number of iterations taken by GMRES to solve the Dirichlet problem on a
+// mesh whose H-matrices consist of many blocks
+template <typename BFT, typename RT>
+int iterationCount(const Laplace3dDirichletFixture<BFT, RT>& fixture,
+                   const Preconditioner<RT>* prec)
+{
+    typedef typename ScalarTraits<RT>::RealType RealType;
+    const RealType solverTol = 1e-5;
+
+    DefaultIterativeSolver<BFT, RT> solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    if (prec)
+        solver.initializeSolver(defaultGmresParameterList(solverTol), *prec);
+    else
+        solver.initializeSolver(defaultGmresParameterList(solverTol));
+    Solution<BFT, RT> solution = solver.solve(fixture.rhs);
+    BOOST_CHECK_EQUAL(solution.status(), SolutionStatus::CONVERGED);
+    return solution.iterationCount();
+}
+
+template <typename BFT, typename RT>
+Laplace3dDirichletFixture<BFT, RT>* largeDirichletFixture()
+{
+    return new Laplace3dDirichletFixture<BFT, RT>(
+        PIECEWISE_LINEARS, PIECEWISE_CONSTANTS,
+        PIECEWISE_CONSTANTS, PIECEWISE_CONSTANTS,
+        "meshes/sphere-ico-2.msh", true /* hMatMode */);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatPreconditioners)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(block_jacobi_of_single_block_hmatrix_is_inverse,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    BoundaryOperator<BFT, RT> op = singleLayerOperator<BFT, RT>(true);
+    Preconditioner<RT> prec =
+        hMatBlockJacobiPreconditioner<RT>(op.weakForm());
+    arma::Mat<RT> product =
+        preconditionerMatrix(prec) * op.weakForm()->asMatrix();
+    arma::Mat<RT> identity = arma::eye<arma::Mat<RT> >(
+        product.n_rows, product.n_cols);
+
+    BOOST_CHECK(check_arrays_are_close<RT>(product, identity, 1e-4));
+    BOOST_CHECK(prec.setupTime() >= 0.);
+    BOOST_CHECK(prec.memSizeKb() > 0.);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(spai_with_full_pattern_is_inverse,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    BoundaryOperator<BFT, RT> op = singleLayerOperator<BFT, RT>(true);
+    const int dofCount = op.weakForm()->rowCount();
+    Preconditioner<RT> prec =
+        hMatSparseApproximateInversePreconditioner<RT>(
+            op.weakForm(), dofCount);
+    arma::Mat<RT> product =
+        preconditionerMatrix(prec) * op.weakForm()->asMatrix();
+    arma::Mat<RT> identity = arma::eye<arma::Mat<RT> >(
+        product.n_rows, product.n_cols);
+
+    BOOST_CHECK(check_arrays_are_close<RT>(product, identity, 1e-4));
+    BOOST_CHECK(prec.memSizeKb() > 0.);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(block_jacobi_reduces_iteration_count,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    std::unique_ptr<Laplace3dDirichletFixture<BFT, RT> > fixture(
+        largeDirichletFixture<BFT, RT>());
+    shared_ptr<const DiscreteBoundaryOperator<RT> > weakForm =
+        fixture->lhsOp.weakForm();
+    const size_t dofCount = weakForm->rowCount();
+
+    Preconditioner<RT> prec = hMatBlockJacobiPreconditioner<RT>(weakForm);
+    // The operator is split into several diagonal blocks, so the
+    // preconditioner takes less memory than a dense inverse
+    BOOST_CHECK_LT(prec.memSizeKb(),
+                   dofCount * dofCount * sizeof(RT) / 1024.);
+
+    BOOST_CHECK_LT(iterationCount(*fixture, &prec),
+                   iterationCount<BFT, RT>(*fixture, 0));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(spai_reduces_iteration_count,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    std::unique_ptr<Laplace3dDirichletFixture<BFT, RT> > fixture(
+        largeDirichletFixture<BFT, RT>());
+    shared_ptr<const DiscreteBoundaryOperator<RT> > weakForm =
+        fixture->lhsOp.weakForm();
+
+    Preconditioner<RT> prec =
+        hMatSparseApproximateInversePreconditioner<RT>(weakForm);
+    BOOST_CHECK_LT(iterationCount(*fixture, &prec),
+                   iterationCount<BFT, RT>(*fixture, 0));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(preconditioners_reject_dense_operators,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    BoundaryOperator<BFT, RT> op = singleLayerOperator<BFT, RT>(false);
+    BOOST_CHECK_THROW(hMatBlockJacobiPreconditioner<RT>(op.weakForm()),
+                      std::invalid_argument);
+    BOOST_CHECK_THROW(
+        hMatSparseApproximateInversePreconditioner<RT>(op.weakForm()),
+        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // WITH_TRILINOS